@@ -228,6 +228,14 @@ void DefaultPipeline::doCollisionResponse()
     msg_info_when(d_doPrintInfoMessage.getValue())
         << "Create Contacts "<<contactManager->getName() ;
 
+    if (AdvancedTimer::isActive())
+    {
+        std::size_t numContacts = 0;
+        for (const auto& output : narrowPhaseDetection->getDetectionOutputs())
+            if (output.second) numContacts += output.second->size();
+        AdvancedTimer::valSet("numContacts", (double)numContacts);
+    }
+
     contactManager->createContacts(narrowPhaseDetection->getDetectionOutputs());
 
     // finally we start the creation of collisionGroup
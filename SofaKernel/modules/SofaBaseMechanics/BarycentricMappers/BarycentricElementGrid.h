@@ -0,0 +1,202 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_COMPONENT_MAPPING_BARYCENTRICELEMENTGRID_H
+#define SOFA_COMPONENT_MAPPING_BARYCENTRICELEMENTGRID_H
+
+#include <sofa/defaulttype/Vec.h>
+#include <sofa/helper/vector.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace mapping
+{
+
+/// Regular grid over the bounding boxes of the elements of a mesh. Each cell stores the elements
+/// whose bounding box overlaps it, in a compressed (CSR) layout. Used by the barycentric mappers to
+/// locate the mapped points without testing every element.
+class BarycentricElementGrid
+{
+public:
+    typedef sofa::defaulttype::Vector3 Vector3;
+    typedef sofa::defaulttype::Vec3i Vec3i;
+
+    /// Build the grid from the bounding box of each element.
+    /// The cell size is the average extent of the boxes, limited so that the grid does not
+    /// have much more cells than elements.
+    void build(const helper::vector<Vector3>& boxMin, const helper::vector<Vector3>& boxMax)
+    {
+        m_cellStart.clear();
+        m_items.clear();
+        m_dims = Vec3i(0,0,0);
+        const size_t nbElements = boxMin.size();
+        if (nbElements == 0) return;
+
+        Vector3 gridMin = boxMin[0], gridMax = boxMax[0];
+        SReal averageSize = 0;
+        for (size_t e=0; e<nbElements; ++e)
+        {
+            for (int k=0; k<3; ++k)
+            {
+                gridMin[k] = std::min(gridMin[k], boxMin[e][k]);
+                gridMax[k] = std::max(gridMax[k], boxMax[e][k]);
+                averageSize += boxMax[e][k] - boxMin[e][k];
+            }
+        }
+        averageSize /= SReal(3*nbElements);
+
+        const Vector3 extent = gridMax - gridMin;
+        const SReal volume = std::max(extent[0],(SReal)1e-12) * std::max(extent[1],(SReal)1e-12) * std::max(extent[2],(SReal)1e-12);
+        const SReal minCellSize = std::cbrt(volume / SReal(4*nbElements));
+        m_cellSize = std::max(averageSize, minCellSize);
+        if (!(m_cellSize > 0)) m_cellSize = 1;
+        m_origin = gridMin;
+        for (int k=0; k<3; ++k)
+            m_dims[k] = std::max(1, int(std::floor(extent[k] / m_cellSize)) + 1);
+
+        // counting pass, then filling pass
+        m_cellStart.assign(size_t(m_dims[0])*m_dims[1]*m_dims[2] + 1, 0);
+        forEachCell(boxMin, boxMax, [&](size_t c, size_t) { ++m_cellStart[c+1]; });
+        for (size_t c=1; c<m_cellStart.size(); ++c)
+            m_cellStart[c] += m_cellStart[c-1];
+
+        m_items.resize(m_cellStart.back());
+        helper::vector<size_t> cursor(m_cellStart.begin(), m_cellStart.end()-1);
+        forEachCell(boxMin, boxMax, [&](size_t c, size_t e) { m_items[cursor[c]++] = (unsigned int)e; });
+    }
+
+    bool empty() const { return m_items.empty(); }
+    SReal cellSize() const { return m_cellSize; }
+
+    /// Find the element minimizing distance(e) around pos, visiting the cells ring by ring.
+    /// distance(e) returns a non-positive value when pos is inside e, and the squared distance
+    /// from pos to the center of e otherwise. Returns -1 when the grid is empty.
+    template<class DistanceFunction>
+    int findNearest(const Vector3& pos, DistanceFunction distance) const
+    {
+        if (empty()) return -1;
+
+        // the projection of pos on the grid does not increase distances, so the bound below holds
+        const Vec3i center = cellOf(pos);
+        int maxRing = 0;
+        for (int k=0; k<3; ++k)
+            maxRing = std::max(maxRing, std::max(center[k], m_dims[k]-1-center[k]));
+
+        // an element is stored in every cell overlapped by its box: the items of the visited
+        // cells are deduplicated, so that distance is evaluated once per element
+        int best = -1;
+        double bestDistance = std::numeric_limits<double>::max();
+        helper::vector<unsigned int> checked; // sorted
+        helper::vector<unsigned int> candidates;
+        auto visitCell = [&](int x, int y, int z)
+        {
+            if (x<0 || y<0 || z<0 || x>=m_dims[0] || y>=m_dims[1] || z>=m_dims[2]) return;
+            const size_t c = index(x,y,z);
+            candidates.insert(candidates.end(), m_items.begin()+m_cellStart[c], m_items.begin()+m_cellStart[c+1]);
+        };
+
+        for (int ring=0; ring<=maxRing; ++ring)
+        {
+            for (int x=center[0]-ring; x<=center[0]+ring; ++x)
+                for (int y=center[1]-ring; y<=center[1]+ring; ++y)
+                {
+                    if (std::abs(x-center[0])==ring || std::abs(y-center[1])==ring)
+                    {
+                        for (int z=center[2]-ring; z<=center[2]+ring; ++z)
+                            visitCell(x,y,z);
+                    }
+                    else
+                    {
+                        visitCell(x,y,center[2]-ring);
+                        visitCell(x,y,center[2]+ring);
+                    }
+                }
+
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            const size_t nbChecked = checked.size();
+            for (unsigned int e : candidates)
+            {
+                if (std::binary_search(checked.begin(), checked.begin()+nbChecked, e)) continue;
+                const double d = distance(e);
+                if (d < bestDistance) { bestDistance = d; best = int(e); }
+                checked.push_back(e);
+            }
+            std::inplace_merge(checked.begin(), checked.begin()+nbChecked, checked.end());
+            candidates.clear();
+
+            // every element not visited yet is at least 'ring' cells away from pos
+            const double ringDistance = ring*m_cellSize;
+            if (best >= 0 && (bestDistance <= 0 || bestDistance <= ringDistance*ringDistance))
+                break;
+        }
+        return best;
+    }
+
+protected:
+    Vec3i cellOf(const Vector3& pos) const
+    {
+        Vec3i c;
+        for (int k=0; k<3; ++k)
+            c[k] = std::max(0, std::min(m_dims[k]-1, int(std::floor((pos[k]-m_origin[k])/m_cellSize))));
+        return c;
+    }
+
+    size_t index(int x, int y, int z) const
+    {
+        return (size_t(z)*m_dims[1] + size_t(y))*m_dims[0] + size_t(x);
+    }
+
+    /// Call f(cell, element) for each cell overlapped by the bounding box of each element
+    template<class F>
+    void forEachCell(const helper::vector<Vector3>& boxMin, const helper::vector<Vector3>& boxMax, F f) const
+    {
+        for (size_t e=0; e<boxMin.size(); ++e)
+        {
+            const Vec3i cMin = cellOf(boxMin[e]), cMax = cellOf(boxMax[e]);
+            for (int z=cMin[2]; z<=cMax[2]; ++z)
+                for (int y=cMin[1]; y<=cMax[1]; ++y)
+                    for (int x=cMin[0]; x<=cMax[0]; ++x)
+                        f(index(x,y,z), e);
+        }
+    }
+
+    Vector3 m_origin;
+    SReal m_cellSize {1};
+    Vec3i m_dims {0,0,0};
+    helper::vector<size_t> m_cellStart;
+    helper::vector<unsigned int> m_items;
+};
+
+} // namespace mapping
+
+} // namespace component
+
+} // namespace sofa
+
+#endif // SOFA_COMPONENT_MAPPING_BARYCENTRICELEMENTGRID_H
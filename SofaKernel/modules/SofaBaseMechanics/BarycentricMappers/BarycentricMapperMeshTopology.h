@@ -111,6 +111,11 @@ private:
     void clearMap1dAndReserve(int size=0);
     void clearMap2dAndReserve(int size=0);
     void clearMap3dAndReserve(int size=0);
+
+    /// Append the bounding box of element to boxMin/boxMax, used to index the elements
+    template <class Element>
+    static void addElementBox(const Element& element, const typename In::VecCoord& in,
+                              helper::vector<defaulttype::Vector3>& boxMin, helper::vector<defaulttype::Vector3>& boxMax);
 };
 
 #if !defined(SOFA_COMPONENT_MAPPING_BARYCENTRICMAPPERMESHTOPOLOGY_CPP)
@@ -23,6 +23,8 @@
 #define SOFA_COMPONENT_MAPPING_BARYCENTRICMAPPERMESHTOPOLOGY_INL
 
 #include "BarycentricMapperMeshTopology.h"
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricElementGrid.h>
+#include <sofa/helper/IndexOpenMP.h>
 #include <sofa/core/visual/VisualParams.h>
 
 namespace sofa
@@ -77,6 +79,24 @@ void BarycentricMapperMeshTopology<In,Out>::addMatrixContrib(MatrixType* m,
     Inherit1::addMatrixContrib(m, row, col, value);
 }
 
+template <class In, class Out>
+template <class Element>
+void BarycentricMapperMeshTopology<In,Out>::addElementBox ( const Element& element, const typename In::VecCoord& in,
+                                                            helper::vector<Vector3>& boxMin, helper::vector<Vector3>& boxMax )
+{
+    Vector3 min = in[element[0]], max = in[element[0]];
+    for ( unsigned int j=1; j<element.size(); j++ )
+    {
+        for ( int k=0; k<3; k++ )
+        {
+            min[k] = std::min ( min[k], SReal(in[element[j]][k]) );
+            max[k] = std::max ( max[k], SReal(in[element[j]][k]) );
+        }
+    }
+    boxMin.push_back ( min );
+    boxMax.push_back ( max );
+}
+
 template <class In, class Out>
 void BarycentricMapperMeshTopology<In,Out>::init ( const typename Out::VecCoord& out, const typename In::VecCoord& in )
 {
@@ -151,30 +171,50 @@ void BarycentricMapperMeshTopology<In,Out>::init ( const typename Out::VecCoord&
                 bases[nbTriangles+q].invert ( mt );
                 centers[nbTriangles+q] = ( in[quads[q][0]]+in[quads[q][1]]+in[quads[q][2]]+in[quads[q][3]] ) *0.25;
             }
-            for ( unsigned int i=0; i<out.size(); i++ )
+            // Index the elements, then locate the points independently
+            helper::vector<Vector3> boxMin, boxMax;
+            for ( unsigned int t = 0; t < triangles.size(); t++ )
+                addElementBox ( triangles[t], in, boxMin, boxMax );
+            for ( unsigned int q = 0; q < quads.size(); q++ )
+                addElementBox ( quads[q], in, boxMin, boxMax );
+            BarycentricElementGrid grid;
+            grid.build ( boxMin, boxMax );
+
+            auto elementDistance = [&] ( unsigned int e, const Vector3& outPos, Vec3d& v ) -> double
             {
-                Vector3 outPos = Out::getCPos(out[i]);
-                Vector3 coefs;
-                int index = -1;
-                double distance = 1e10;
-                for ( unsigned int t = 0; t < triangles.size(); t++ )
+                if ( e < nbTriangles )
                 {
-                    Vec3d v = bases[t] * ( outPos - in[triangles[t][0]] );
+                    v = bases[e] * ( outPos - in[triangles[e][0]] );
                     double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( ( v[2]<0?-v[2]:v[2] )-0.01,v[0]+v[1]-1 ) );
-                    if ( d>0 ) d = ( outPos-centers[t] ).norm2();
-                    if ( d<distance ) { coefs = v; distance = d; index = int(t); }
-                }
-                for ( unsigned int q = 0; q < quads.size(); q++ )
-                {
-                    Vec3d v = bases[nbTriangles+q] * ( outPos - in[quads[q][0]] );
-                    double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( v[1]-1,v[0]-1 ),std::max ( v[2]-0.01,-v[2]-0.01 ) ) );
-                    if ( d>0 ) d = ( outPos-centers[nbTriangles+q] ).norm2();
-                    if ( d<distance ) { coefs = v; distance = d; index = nbTriangles+q; }
+                    if ( d>0 ) d = ( outPos-centers[e] ).norm2();
+                    return d;
                 }
+                v = bases[e] * ( outPos - in[quads[e-nbTriangles][0]] );
+                double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( v[1]-1,v[0]-1 ),std::max ( v[2]-0.01,-v[2]-0.01 ) ) );
+                if ( d>0 ) d = ( outPos-centers[e] ).norm2();
+                return d;
+            };
+
+            helper::vector<int> indices ( out.size() );
+            helper::vector<Vector3> coefs ( out.size() );
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for ( helper::IndexOpenMP<unsigned int>::type i=0; i<out.size(); i++ )
+            {
+                const Vector3 outPos = Out::getCPos(out[i]);
+                Vec3d v;
+                indices[i] = grid.findNearest ( outPos, [&] ( unsigned int e ) { return elementDistance ( e, outPos, v ); } );
+                if ( indices[i] >= 0 ) elementDistance ( unsigned(indices[i]), outPos, coefs[i] );
+            }
+
+            for ( unsigned int i=0; i<out.size(); i++ )
+            {
+                const int index = indices[i];
                 if ( index < int(nbTriangles) )
-                    addPointInTriangle ( index, coefs.ptr() );
+                    addPointInTriangle ( index, coefs[i].ptr() );
                 else
-                    addPointInQuad ( index-nbTriangles, coefs.ptr() );
+                    addPointInQuad ( index-nbTriangles, coefs[i].ptr() );
             }
         }
     }
@@ -204,30 +244,50 @@ void BarycentricMapperMeshTopology<In,Out>::init ( const typename Out::VecCoord&
             bases[nbTetras+h].invert ( mt );
             centers[nbTetras+h] = ( in[hexas[h][0]]+in[hexas[h][1]]+in[hexas[h][2]]+in[hexas[h][3]]+in[hexas[h][4]]+in[hexas[h][5]]+in[hexas[h][6]]+in[hexas[h][7]] ) *0.125;
         }
-        for ( unsigned int i=0; i<out.size(); i++ )
+        // Index the elements, then locate the points independently
+        helper::vector<Vector3> boxMin, boxMax;
+        for ( unsigned int t = 0; t < tetras.size(); t++ )
+            addElementBox ( tetras[t], in, boxMin, boxMax );
+        for ( unsigned int h = 0; h < hexas.size(); h++ )
+            addElementBox ( hexas[h], in, boxMin, boxMax );
+        BarycentricElementGrid grid;
+        grid.build ( boxMin, boxMax );
+
+        auto elementDistance = [&] ( unsigned int e, const Vector3& pos, Vector3& v ) -> double
         {
-            Vector3 pos = Out::getCPos(out[i]);
-            Vector3 coefs;
-            int index = -1;
-            double distance = 1e10;
-            for ( unsigned int t = 0; t < tetras.size(); t++ )
+            if ( e < nbTetras )
             {
-                Vector3 v = bases[t] * ( pos - in[tetras[t][0]] );
+                v = bases[e] * ( pos - in[tetras[e][0]] );
                 double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( -v[2],v[0]+v[1]+v[2]-1 ) );
-                if ( d>0 ) d = ( pos-centers[t] ).norm2();
-                if ( d<distance ) { coefs = v; distance = d; index = int(t); }
-            }
-            for ( unsigned int h = 0; h < hexas.size(); h++ )
-            {
-                Vector3 v = bases[nbTetras+h] * ( pos - in[hexas[h][0]] );
-                double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( -v[2],v[0]-1 ),std::max ( v[1]-1,v[2]-1 ) ) );
-                if ( d>0 ) d = ( pos-centers[nbTetras+h] ).norm2();
-                if ( d<distance ) { coefs = v; distance = d; index = int(nbTetras+h); }
+                if ( d>0 ) d = ( pos-centers[e] ).norm2();
+                return d;
             }
+            v = bases[e] * ( pos - in[hexas[e-nbTetras][0]] );
+            double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( -v[2],v[0]-1 ),std::max ( v[1]-1,v[2]-1 ) ) );
+            if ( d>0 ) d = ( pos-centers[e] ).norm2();
+            return d;
+        };
+
+        helper::vector<int> indices ( out.size() );
+        helper::vector<Vector3> coefs ( out.size() );
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for ( helper::IndexOpenMP<unsigned int>::type i=0; i<out.size(); i++ )
+        {
+            const Vector3 pos = Out::getCPos(out[i]);
+            Vector3 v;
+            indices[i] = grid.findNearest ( pos, [&] ( unsigned int e ) { return elementDistance ( e, pos, v ); } );
+            if ( indices[i] >= 0 ) elementDistance ( unsigned(indices[i]), pos, coefs[i] );
+        }
+
+        for ( unsigned int i=0; i<out.size(); i++ )
+        {
+            const int index = indices[i];
             if ( index < int(nbTetras) )
-                addPointInTetra ( index, coefs.ptr() );
+                addPointInTetra ( index, coefs[i].ptr() );
             else
-                addPointInCube ( index-nbTetras, coefs.ptr() );
+                addPointInCube ( index-nbTetras, coefs[i].ptr() );
         }
     }
 }
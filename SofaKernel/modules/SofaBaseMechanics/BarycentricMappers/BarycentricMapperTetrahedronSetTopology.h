@@ -72,6 +72,8 @@ protected:
     //handle topology changes depending on the topology
     void processTopologicalChanges(const typename Out::VecCoord& out, const typename In::VecCoord& in, core::topology::Topology* t);
 
+    /// Locate pos in the input tetrahedra using the element index, which must be up to date with in
+    /// (see initHashing and computeBasesAndCenters).
     void processAddPoint(const sofa::defaulttype::Vec3d & pos, const typename In::VecCoord& in, MappingData & vectorData);
 
     topology::TetrahedronSetTopologyContainer*      m_fromContainer {nullptr};
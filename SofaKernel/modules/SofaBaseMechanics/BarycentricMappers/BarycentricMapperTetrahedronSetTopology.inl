@@ -23,6 +23,7 @@
 #define SOFA_COMPONENT_MAPPING_BARYCENTRICMAPPERTETRAHEDRONSETTOPOLOGY_INL
 
 #include "BarycentricMapperTetrahedronSetTopology.h"
+#include <sofa/helper/IndexOpenMP.h>
 
 namespace sofa
 {
@@ -137,7 +138,14 @@ void BarycentricMapperTetrahedronSetTopology<In, Out>::processTopologicalChanges
             const core::topology::PointsAdded * pa = static_cast<const core::topology::PointsAdded*>(*changeIt);
             auto& array = pa->getElementArray();
 
-            for (unsigned i = 0; i<array.size(); i++) {
+            // The input positions may have changed since init: update the element index once for the whole batch
+            this->initHashing(in);
+            this->computeBasesAndCenters(in);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (helper::IndexOpenMP<unsigned int>::type i = 0; i<array.size(); i++) {
                 unsigned pid = array[i];
                 processAddPoint(Out::getCPos(out[pid]),
                     in,
@@ -174,30 +182,11 @@ void BarycentricMapperTetrahedronSetTopology<In, Out>::processTopologicalChanges
 template <class In, class Out>
 void BarycentricMapperTetrahedronSetTopology<In, Out>::processAddPoint(const sofa::defaulttype::Vec3d & pos, const typename In::VecCoord& in, MappingData & vectorData)
 {
-    const sofa::helper::vector<core::topology::BaseMeshTopology::Tetrahedron>& tetrahedra = this->m_fromTopology->getTetrahedra();
-
-    sofa::defaulttype::Vector3 coefs;
-    int index = -1;
-    double distance = std::numeric_limits<double>::max();
-    for (unsigned int t = 0; t < tetrahedra.size(); t++)
-    {
-        sofa::defaulttype::Mat3x3d base;
-        sofa::defaulttype::Vector3 center;
-        computeBase(base, in, tetrahedra[t]);
-        computeCenter(center, in, tetrahedra[t]);
-
-        sofa::defaulttype::Vec3d v = base * (pos - in[tetrahedra[t][0]]);
-        double d = std::max(std::max(-v[0], -v[1]), std::max(-v[2], v[0] + v[1] + v[2] - 1));
+    typename Inherit1::NearestParams nearestParams;
+    this->findNearestElement(pos, in, this->m_fromTopology->getTetrahedra(), nearestParams);
 
-        if (d>0) d = (pos - center).norm2();
-
-        if (d<distance)
-        {
-            coefs = v;
-            distance = d;
-            index = t;
-        }
-    }
+    const sofa::defaulttype::Vector3& coefs = nearestParams.baryCoords;
+    const int index = (nearestParams.elementId == std::numeric_limits<unsigned int>::max()) ? -1 : int(nearestParams.elementId);
 
     vectorData.in_index = index;
     vectorData.baryCoords[0] = (Real)coefs[0];
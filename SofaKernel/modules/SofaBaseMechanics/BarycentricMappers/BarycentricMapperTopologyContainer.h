@@ -151,6 +151,8 @@ protected:
     Real m_convFactor;
     std::unordered_map<Key, helper::vector<unsigned int>, HashFunction, HashEqual> m_hashTable;
     unsigned int m_hashTableSize;
+    Vec3i m_gridMin; ///< lowest cell indices covered by the elements
+    Vec3i m_gridMax; ///< highest cell indices covered by the elements
 
 
     BarycentricMapperTopologyContainer(core::topology::BaseMeshTopology* fromTopology, topology::PointSetTopologyContainer* toTopology);
@@ -176,6 +178,19 @@ protected:
                                   NearestParams& nearestParams);
 
 
+    /// Find the nearest element of outPos, searching the hashed cells ring by ring around the cell
+    /// of outPos until no unvisited element can be closer than the best one found.
+    /// Falls back to an exhaustive search when the rings would visit more cells than there are elements.
+    /// Requires initHashing and computeBasesAndCenters to be up to date with the input positions.
+    /// \param outPos position of the point we want to compute the barycentric coordinates
+    /// \param in is the vector of points
+    /// \param elements elements of the input topology
+    /// \param nearestParams output parameters (nearest element id, distance, and barycentric coordinates)
+    void findNearestElement(const Vector3& outPos,
+                            const typename In::VecCoord& in,
+                            const helper::vector<Element>& elements,
+                            NearestParams& nearestParams);
+
     /// Compute the datas needed to find the nearest element
     /// \param in is the vector of points
     void computeBasesAndCenters( const typename In::VecCoord& in );
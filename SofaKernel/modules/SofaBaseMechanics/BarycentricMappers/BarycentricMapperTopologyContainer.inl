@@ -24,6 +24,9 @@
 #include <sofa/core/visual/VisualParams.h>
 
 #include "BarycentricMapperTopologyContainer.h"
+#include <sofa/helper/IndexOpenMP.h>
+#include <sofa/helper/io/PrecomputedDataCache.h>
+#include <algorithm>
 
 namespace sofa
 {
@@ -39,6 +42,7 @@ namespace _barycentricmappertopologycontainer_
 
 using defaulttype::Vec3d;
 using defaulttype::Vec3i;
+using helper::io::PrecomputedDataCache;
 typedef typename core::topology::BaseMeshTopology::SeqEdges SeqEdges;
 
 template <class In, class Out, class MappingDataType, class Element>
@@ -112,6 +116,9 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::compute
     if(m_hashTable.size()<m_hashTableSize)
         m_hashTable.reserve(m_hashTableSize);
 
+    m_gridMin = Vec3i(0,0,0);
+    m_gridMax = Vec3i(-1,-1,-1);
+
     for(unsigned int i=0; i<elements.size(); i++)
     {
         Element element = elements[i];
@@ -130,6 +137,12 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::compute
         Vec3i i_min=getGridIndices(min);
         Vec3i i_max=getGridIndices(max);
 
+        for(int k=0; k<3; k++)
+        {
+            if(i==0 || i_min[k]<m_gridMin[k]) m_gridMin[k]=i_min[k];
+            if(i==0 || i_max[k]>m_gridMax[k]) m_gridMax[k]=i_max[k];
+        }
+
         for(int j=i_min[0]; j<=i_max[0]; j++)
             for(int k=i_min[1]; k<=i_max[1]; k++)
                 for(int l=i_min[2]; l<=i_max[2]; l++)
@@ -141,64 +154,136 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::compute
 template <class In, class Out, class MappingDataType, class Element>
 void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::init ( const typename Out::VecCoord& out, const typename In::VecCoord& in )
 {
-    initHashing(in);
     this->clear ( int(out.size()) );
-    computeBasesAndCenters(in);
 
-    // Compute distances to get nearest element and corresponding bary coef
     const helper::vector<Element>& elements = getElements();
-    for ( unsigned int i=0; i<out.size(); i++ )
+    helper::vector<NearestParams> nearest;
+
+    // The nearest elements only depend on the positions and on the elements: look for
+    // the result of a previous run in the precomputed data cache
+    PrecomputedDataCache::Key key("BarycentricMapper", 1);
+    PrecomputedDataCache::Entry entry;
+    if (PrecomputedDataCache::isEnabled())
     {
-        Vector3 outPos = Out::getCPos(out[i]);
-        NearestParams nearestParams;
+        // only the positions of the mapped points are used (rigid coordinates cannot be hashed as is)
+        helper::vector<Vector3> outPos(out.size());
+        for ( unsigned int i=0; i<out.size(); i++ )
+            outPos[i] = Out::getCPos(out[i]);
+        key.add(this->getClassName()).add(outPos).add(in).add(elements);
+    }
 
-        // Search nearest element in grid cell
-        Vec3i gridIds = getGridIndices(outPos);
-        Key key(gridIds[0],gridIds[1],gridIds[2]);
+    if (!PrecomputedDataCache::load(key, entry) || !entry.read(nearest) || nearest.size() != out.size())
+    {
+        initHashing(in);
+        computeBasesAndCenters(in);
 
-        auto it_entries = m_hashTable.find(key);
-        if( it_entries != m_hashTable.end() )
+        // Compute distances to get nearest element and corresponding bary coef.
+        // The searches are independent, the mapping data is then filled in order.
+        nearest.clear();
+        nearest.resize(out.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for ( helper::IndexOpenMP<unsigned int>::type i=0; i<out.size(); i++ )
+            findNearestElement(Out::getCPos(out[i]), in, elements, nearest[i]);
+
+        if (PrecomputedDataCache::isEnabled())
         {
-            for(auto entry : it_entries->second)
+            entry.clear();
+            entry.write(nearest);
+            PrecomputedDataCache::store(key, entry);
+        }
+    }
+
+    for ( unsigned int i=0; i<out.size(); i++ )
+        addPointInElement(nearest[i].elementId, nearest[i].baryCoords.ptr());
+}
+
+
+template <class In, class Out, class MappingDataType, class Element>
+void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::findNearestElement(const Vector3& outPos,
+                                                                                            const typename In::VecCoord& in,
+                                                                                            const helper::vector<Element>& elements,
+                                                                                            NearestParams& nearestParams)
+{
+    if (m_gridMax[0] < m_gridMin[0]) // no element
+        return;
+
+    // Start from the cell of outPos, clamped to the cells covered by the elements.
+    // The projection on the covered box does not increase distances, so the bound below still holds.
+    Vec3i center = getGridIndices(outPos);
+    int maxRing = 0;
+    for(int k=0; k<3; k++)
+    {
+        center[k] = std::max(m_gridMin[k], std::min(m_gridMax[k], center[k]));
+        maxRing = std::max(maxRing, std::max(center[k]-m_gridMin[k], m_gridMax[k]-center[k]));
+    }
+
+    // An element is listed in every cell overlapped by its bounding box: the entries of the visited
+    // cells are gathered and deduplicated, so that each element is tested once
+    helper::vector<unsigned int> checked; // sorted
+    helper::vector<unsigned int> candidates;
+    size_t nbVisitedCells = 0;
+    auto visitCell = [&](int x, int y, int z)
+    {
+        if (x<m_gridMin[0] || x>m_gridMax[0] || y<m_gridMin[1] || y>m_gridMax[1] || z<m_gridMin[2] || z>m_gridMax[2])
+            return;
+        ++nbVisitedCells;
+        auto it_entries = m_hashTable.find(Key(x,y,z));
+        if( it_entries != m_hashTable.end() )
+            candidates.insert(candidates.end(), it_entries->second.begin(), it_entries->second.end());
+    };
+
+    for(int ring=0; ring<=maxRing; ring++)
+    {
+        // Visit the shell of cells at distance 'ring' of the center cell
+        for(int x=center[0]-ring; x<=center[0]+ring; x++)
+            for(int y=center[1]-ring; y<=center[1]+ring; y++)
             {
-                Vector3 inPos = in[elements[entry][0]];
-                checkDistanceFromElement(entry, outPos, inPos, nearestParams);
+                if (std::abs(x-center[0])==ring || std::abs(y-center[1])==ring)
+                {
+                    for(int z=center[2]-ring; z<=center[2]+ring; z++)
+                        visitCell(x,y,z);
+                }
+                else
+                {
+                    visitCell(x,y,center[2]-ring);
+                    visitCell(x,y,center[2]+ring);
+                }
             }
-        }
 
-        if(nearestParams.elementId==std::numeric_limits<unsigned int>::max()) // No element in grid cell, perform exhaustive search
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        const size_t nbChecked = checked.size();
+        for(unsigned int entry : candidates)
         {
-            for ( unsigned int e = 0; e < elements.size(); e++ )
+            if(!std::binary_search(checked.begin(), checked.begin()+nbChecked, entry))
             {
-                Vector3 inPos = in[elements[e][0]];
-                checkDistanceFromElement(e, outPos, inPos, nearestParams);
+                checkDistanceFromElement(entry, outPos, in[elements[entry][0]], nearestParams);
+                checked.push_back(entry);
             }
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
         }
-        else if(fabs(nearestParams.distance)>m_gridCellSize/2.) // Nearest element in grid cell may not be optimal, check neighbors
+        std::inplace_merge(checked.begin(), checked.begin()+nbChecked, checked.end());
+        candidates.clear();
+
+        if(nearestParams.elementId!=std::numeric_limits<unsigned int>::max())
         {
-            Vec3i centerGridIds = gridIds;
-            for(int xId=-1; xId<=1; xId++)
-                for(int yId=-1; yId<=1; yId++)
-                    for(int zId=-1; zId<=1; zId++)
-                    {
-                        gridIds = Vec3i(centerGridIds[0]+xId,centerGridIds[1]+yId,centerGridIds[2]+zId);
-                        Key key(gridIds[0],gridIds[1],gridIds[2]);
-
-                        auto it_entries = m_hashTable.find(key);
-                        if( it_entries != m_hashTable.end() )
-                        {
-                            for(auto entry : it_entries->second)
-                            {
-                                Vector3 inPos = in[elements[entry][0]];
-                                checkDistanceFromElement(entry, outPos, inPos, nearestParams);
-                            }
-                        }
-                    }
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
+            // Every element not visited yet is at least 'ring' cells away from outPos
+            const double ringDistance = ring*m_gridCellSize;
+            if(nearestParams.distance<=0 || nearestParams.distance<=ringDistance*ringDistance)
+                return;
         }
-        else
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
+
+        if(nbVisitedCells > elements.size())
+            break;
+    }
+
+    // Sparse or far away region, perform exhaustive search
+    for ( unsigned int e = 0; e < elements.size(); e++ )
+    {
+        if(!std::binary_search(checked.begin(), checked.end(), e))
+            checkDistanceFromElement(e, outPos, in[elements[e][0]], nearestParams);
     }
 }
 
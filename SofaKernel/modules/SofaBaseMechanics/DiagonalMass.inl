@@ -31,6 +31,7 @@
 #include <SofaBaseTopology/RegularGridTopology.h>
 #include <SofaBaseMechanics/AddMToMatrixFunctor.h>
 #include <sofa/simulation/AnimateEndEvent.h>
+#include <sofa/helper/IndexOpenMP.h>
 
 
 namespace sofa
@@ -602,14 +603,20 @@ void DiagonalMass<DataTypes, MassType>::addMDx(const core::MechanicalParams* /*m
     if (_res.size() < n) n = _res.size();
     if (factor == 1.0)
     {
-        for (size_t i=0; i<n; i++)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (helper::IndexOpenMP<size_t>::type i=0; i<n; i++)
         {
             _res[i] += _dx[i] * masses[i];
         }
     }
     else
     {
-        for (size_t i=0; i<n; i++)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (helper::IndexOpenMP<size_t>::type i=0; i<n; i++)
         {
             _res[i] += (_dx[i] * masses[i]) * Real(factor);
         }
@@ -626,7 +633,10 @@ void DiagonalMass<DataTypes, MassType>::accFromF(const core::MechanicalParams* /
     helper::WriteOnlyAccessor< DataVecDeriv > _a = a;
     const VecDeriv& _f = f.getValue();
 
-    for (unsigned int i=0; i<masses.size(); i++)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<size_t>::type i=0; i<masses.size(); i++)
     {
         _a[i] = _f[i] / masses[i];
     }
@@ -1471,7 +1481,10 @@ void DiagonalMass<DataTypes, MassType>::addForce(const core::MechanicalParams* /
 
 
     // add weight and inertia force
-    for (unsigned int i=0; i<masses.size(); i++)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<size_t>::type i=0; i<masses.size(); i++)
     {
         _f[i] += theGravity*masses[i];
     }
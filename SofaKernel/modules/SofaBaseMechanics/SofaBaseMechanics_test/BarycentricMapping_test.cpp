@@ -21,7 +21,11 @@
 ******************************************************************************/
 #include <SofaBaseMechanics/BarycentricMapping.h>
 #include <SofaBaseMechanics/BarycentricMappers/BarycentricMapperTriangleSetTopology.h>
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricMapperTetrahedronSetTopology.h>
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricElementGrid.h>
+using sofa::component::mapping::BarycentricElementGrid;
 using sofa::component::mapping::BarycentricMapperTriangleSetTopology;
+using sofa::component::mapping::BarycentricMapperTetrahedronSetTopology;
 using sofa::component::mapping::BarycentricMapping;
 
 #include <SofaBaseTopology/TriangleSetTopologyContainer.h>
@@ -32,6 +36,8 @@ using sofa::component::topology::TetrahedronSetTopologyContainer;
 using sofa::core::topology::BaseMeshTopology;
 
 #include <gtest/gtest.h>
+#include <cmath>
+#include <map>
 using testing::Test;
 
 using sofa::defaulttype::Vector3;
@@ -143,4 +149,181 @@ TEST_F(BarycentricMapperTriangleSetTopologyTest_d, initHashing)
     initHashing_test();
 }
 
+/// Locate points in a lattice of cubes split in tetrahedra, with the hashed search of the
+/// topology container mappers, and compare with an exhaustive search.
+template <class In, class Out>
+struct BarycentricMapperTetrahedronSetTopologyTest :  public Test, public BarycentricMapperTetrahedronSetTopology<In,Out>
+{
+    typedef BarycentricMapperTetrahedronSetTopology<In,Out> Inherit;
+    typedef typename Inherit::NearestParams NearestParams;
+
+    using Inherit::m_fromTopology;
+    using Inherit::d_map;
+    using Inherit::init;
+    using Inherit::getElements;
+    using Inherit::getBaryCoef;
+    using Inherit::checkDistanceFromElement;
+
+    static const int N = 3; // cubes per axis
+
+    typename In::VecCoord m_in;
+    typename Out::VecCoord m_out;
+    TetrahedronSetTopologyContainer::SPtr m_topology;
+
+    BarycentricMapperTetrahedronSetTopologyTest() : Inherit(nullptr, nullptr) {}
+
+    int vertex(int i, int j, int k) { return i + (N+1)*(j + (N+1)*k); }
+
+    void SetUp() override
+    {
+        for(int k=0; k<=N; k++)
+            for(int j=0; j<=N; j++)
+                for(int i=0; i<=N; i++)
+                    m_in.push_back(Vector3(i, j, k));
+
+        m_topology = New<TetrahedronSetTopologyContainer>();
+        m_fromTopology = m_topology.get();
+
+        // each cube is split in the 6 tetrahedra sharing its diagonal
+        const int permutations[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+        for(int k=0; k<N; k++)
+            for(int j=0; j<N; j++)
+                for(int i=0; i<N; i++)
+                    for(const auto& axes : permutations)
+                    {
+                        int p[3] = { i, j, k };
+                        int ids[4];
+                        ids[0] = vertex(p[0], p[1], p[2]);
+                        for(int a=0; a<3; a++)
+                        {
+                            p[axes[a]]++;
+                            ids[a+1] = vertex(p[0], p[1], p[2]);
+                        }
+                        m_topology->addTetra(ids[0], ids[1], ids[2], ids[3]);
+                    }
+
+        // points inside and around the lattice
+        for(int n=0; n<200; n++)
+        {
+            const double x = -0.5 + (N+1) * std::fmod(n*0.6180339887, 1.0);
+            const double y = -0.5 + (N+1) * std::fmod(n*0.7548776662, 1.0);
+            const double z = -0.5 + (N+1) * std::fmod(n*0.5698402910, 1.0);
+            m_out.push_back(Vector3(x, y, z));
+        }
+    }
+
+    void init_test()
+    {
+        init(m_out, m_in);
+        const auto& map = d_map.getValue();
+        ASSERT_EQ(map.size(), m_out.size());
+
+        const auto elements = getElements();
+        for(unsigned int i=0; i<m_out.size(); i++)
+        {
+            const Vector3& p = m_out[i];
+            ASSERT_GE(map[i].in_index, 0);
+            ASSERT_LT(map[i].in_index, int(elements.size()));
+
+            NearestParams exhaustive, found;
+            for(unsigned int e=0; e<elements.size(); e++)
+                checkDistanceFromElement(e, p, m_in[elements[e][0]], exhaustive);
+            checkDistanceFromElement(unsigned(map[i].in_index), p, m_in[elements[map[i].in_index][0]], found);
+            EXPECT_DOUBLE_EQ(found.distance, exhaustive.distance) << "point " << i << " " << p;
 
+            bool inside = true;
+            for(int k=0; k<3; k++)
+                inside = inside && p[k] > 1e-6 && p[k] < N - 1e-6;
+            if(inside)
+            {
+                // the barycentric coordinates in the found tetrahedron give back the point
+                const auto coefs = getBaryCoef(map[i].baryCoords);
+                Vector3 q;
+                for(int v=0; v<4; v++)
+                {
+                    EXPECT_GE(coefs[v], -1e-10) << "point " << i;
+                    q += m_in[elements[map[i].in_index][v]] * coefs[v];
+                }
+                EXPECT_LT((q-p).norm(), 1e-10) << "point " << i;
+            }
+        }
+    }
+};
+
+typedef BarycentricMapperTetrahedronSetTopologyTest< Vec3dTypes, Vec3dTypes> BarycentricMapperTetrahedronSetTopologyTest_d;
+
+TEST_F(BarycentricMapperTetrahedronSetTopologyTest_d, initMatchesExhaustiveSearch)
+{
+    init_test();
+}
+
+TEST(BarycentricElementGrid, findNearestEvaluatesEachElementOnce)
+{
+    // Boxes overlapping many cells, so that each element is listed in several of them
+    sofa::helper::vector<Vector3> boxMin, boxMax;
+    for(int x=0; x<4; x++)
+        for(int y=0; y<4; y++)
+        {
+            boxMin.push_back(Vector3(x, y, 0));
+            boxMax.push_back(Vector3(x+3, y+3, 3));
+        }
+    for(int i=0; i<10; i++)
+    {
+        boxMin.push_back(Vector3(i*0.1, i*0.1, 0));
+        boxMax.push_back(Vector3(i*0.1+0.05, i*0.1+0.05, 0.05));
+    }
+
+    BarycentricElementGrid grid;
+    grid.build(boxMin, boxMax);
+
+    const Vector3 points[] = { Vector3(0.5,0.5,0.5), Vector3(3,3,1.5), Vector3(20,20,20) };
+    for(const Vector3& p : points)
+    {
+        std::map<unsigned int, int> nbEvaluations;
+        grid.findNearest(p, [&](unsigned int e) -> double
+        {
+            ++nbEvaluations[e];
+            return (p - (boxMin[e]+boxMax[e])*0.5).norm2();
+        });
+        EXPECT_FALSE(nbEvaluations.empty());
+        for(const auto& count : nbEvaluations)
+            EXPECT_EQ(count.second, 1) << "element " << count.first << " around " << p;
+    }
+}
+
+TEST(BarycentricElementGrid, findNearestMatchesExhaustiveSearch)
+{
+    // Unit cubes on a 4x3x2 lattice, located from points inside and outside the lattice
+    sofa::helper::vector<Vector3> boxMin, boxMax, centers;
+    for(int x=0; x<4; x++)
+        for(int y=0; y<3; y++)
+            for(int z=0; z<2; z++)
+            {
+                boxMin.push_back(Vector3(x,y,z));
+                boxMax.push_back(Vector3(x+1,y+1,z+1));
+                centers.push_back(Vector3(x+0.5,y+0.5,z+0.5));
+            }
+
+    BarycentricElementGrid grid;
+    grid.build(boxMin, boxMax);
+
+    const Vector3 points[] = { Vector3(0.2,0.3,0.4), Vector3(3.9,2.5,1.1), Vector3(-5,1,1), Vector3(10,-3,7), Vector3(2,1.5,-0.5) };
+    for(const Vector3& p : points)
+    {
+        auto distance = [&](unsigned int e) -> double
+        {
+            bool inside = true;
+            for(int k=0; k<3; k++)
+                inside = inside && p[k]>=boxMin[e][k] && p[k]<=boxMax[e][k];
+            return inside ? -1.0 : (p-centers[e]).norm2();
+        };
+
+        int expected = 0;
+        for(unsigned int e=1; e<centers.size(); e++)
+            if(distance(e) < distance(unsigned(expected))) expected = int(e);
+
+        const int found = grid.findNearest(p, distance);
+        ASSERT_GE(found, 0);
+        EXPECT_DOUBLE_EQ(distance(unsigned(found)), distance(unsigned(expected)));
+    }
+}
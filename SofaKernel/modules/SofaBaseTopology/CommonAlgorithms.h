@@ -25,6 +25,8 @@
 
 #include <sofa/defaulttype/VecTypes.h>
 #include <sofa/helper/vector.h>
+#include <sofa/helper/IndexOpenMP.h>
+#include <algorithm>
 
 namespace sofa
 {
@@ -184,6 +186,92 @@ Real binomialVector(const sofa::defaulttype::Vec<N,unsigned char>  tbi1,const so
     }
     return(result);
 }
+
+/// Number the distinct keys of a list in order of first appearance, as would a std::map<Key,ID>
+/// filled while scanning the list, but by sorting (key, position) pairs which is much faster on
+/// large meshes.
+/// \param keys one key per candidate element, in scan order
+/// \param firstOccurrence output: position in keys of the first occurrence of each distinct key, by increasing position
+/// \param uniqueIndex optional output: for each position in keys, the index of its key in firstOccurrence
+template<class Key>
+void numberDistinctKeys(const helper::vector<Key>& keys, helper::vector<unsigned int>& firstOccurrence,
+                        helper::vector<unsigned int>* uniqueIndex = nullptr)
+{
+    const size_t n = keys.size();
+    helper::vector<unsigned int> order(n);
+    for (size_t i=0; i<n; ++i)
+        order[i] = (unsigned int)i;
+    std::sort(order.begin(), order.end(), [&keys](unsigned int a, unsigned int b)
+    {
+        return keys[a] < keys[b] || (!(keys[b] < keys[a]) && a < b);
+    });
+
+    // the first position of each group of equal keys is its first occurrence
+    helper::vector<unsigned int> leader(uniqueIndex ? n : 0);
+    firstOccurrence.clear();
+    for (size_t i=0; i<n; )
+    {
+        size_t j = i+1;
+        while (j<n && !(keys[order[i]] < keys[order[j]]))
+            ++j;
+        if (uniqueIndex)
+            for (size_t k=i; k<j; ++k)
+                leader[order[k]] = order[i];
+        firstOccurrence.push_back(order[i]);
+        i = j;
+    }
+    std::sort(firstOccurrence.begin(), firstOccurrence.end());
+
+    if (uniqueIndex)
+    {
+        helper::vector<unsigned int> rank(n);
+        for (size_t r=0; r<firstOccurrence.size(); ++r)
+            rank[firstOccurrence[r]] = (unsigned int)r;
+        uniqueIndex->resize(n);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (helper::IndexOpenMP<unsigned int>::type i=0; i<n; ++i)
+            (*uniqueIndex)[i] = rank[leader[i]];
+    }
+}
+
+/// Build the shells (e.g. TrianglesAroundVertex) of nbShells entities from the elements around them.
+/// Element e is appended to the shells shellIndex(e,j) for j in [0,nbPerElement), by increasing e, as
+/// successive push_back would do. Indices out of [0,nbShells) are ignored. The shells are first
+/// gathered in a compressed (offsets + indices) array so that each one is allocated once, then copied
+/// in parallel.
+template<class Shell, class ShellIndex>
+void buildShells(helper::vector<Shell>& shells, size_t nbShells, size_t nbElements, unsigned int nbPerElement, ShellIndex shellIndex)
+{
+    helper::vector<size_t> offsets(nbShells+1, 0);
+    for (size_t e=0; e<nbElements; ++e)
+        for (unsigned int j=0; j<nbPerElement; ++j)
+        {
+            const size_t s = shellIndex(e,j);
+            if (s < nbShells) ++offsets[s+1];
+        }
+    for (size_t s=0; s<nbShells; ++s)
+        offsets[s+1] += offsets[s];
+
+    helper::vector<typename Shell::value_type> indices(offsets.back());
+    helper::vector<size_t> cursor(offsets.begin(), offsets.end()-1);
+    for (size_t e=0; e<nbElements; ++e)
+        for (unsigned int j=0; j<nbPerElement; ++j)
+        {
+            const size_t s = shellIndex(e,j);
+            if (s < nbShells) indices[cursor[s]++] = (typename Shell::value_type)e;
+        }
+
+    shells.clear();
+    shells.resize(nbShells);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type s=0; s<nbShells; ++s)
+        shells[s].assign(indices.begin()+offsets[s], indices.begin()+offsets[s+1]);
+}
+
 } // namespace topology
 
 } // namespace component
@@ -20,6 +20,7 @@
 * Contact information: contact@sofa-framework.org                             *
 ******************************************************************************/
 #include <SofaBaseTopology/EdgeSetTopologyContainer.h>
+#include <SofaBaseTopology/CommonAlgorithms.h>
 #include <sofa/core/visual/VisualParams.h>
 
 #include <sofa/core/ObjectFactory.h>
@@ -85,6 +86,14 @@ void EdgeSetTopologyContainer::init()
         initTopology();
 }
 
+bool EdgeSetTopologyContainer::readInternalState(const char* buffer, std::size_t size)
+{
+    SOFA_UNUSED(buffer);
+    if (hasEdges())
+        initTopology();
+    return size == 0;
+}
+
 void EdgeSetTopologyContainer::initTopology()
 {
     // force computation of neighborhood elements
@@ -122,22 +131,23 @@ void EdgeSetTopologyContainer::createEdgesAroundVertexArray()
     if (nbPoints == 0) // in case only Data have been copied and not going thourgh AddTriangle methods.
         this->setNbPoints(d_initPoints.getValue().size());
 
-    m_edgesAroundVertex.resize(getNbPoints());
+    const size_t nbShells = getNbPoints();
     for (unsigned int edgeId=0; edgeId<edges.size(); ++edgeId)
     {
         const Edge& edge = edges[edgeId];
-        // adding edge in the edge shell of both points
-        
         if (edge[0] >= unsigned(nbPoints) || edge[1] >= unsigned(nbPoints))
-        {
             msg_warning() << "EdgesAroundVertex creation failed, Edge buffer is not concistent with number of points: Edge: " << edge << " for: " << nbPoints << " points.";
-            continue;
-        }
-
-        m_edgesAroundVertex[ edge[0] ].push_back(edgeId);
-        m_edgesAroundVertex[ edge[1] ].push_back(edgeId);
     }
 
+    // adding each valid edge in the edge shell of both points
+    buildShells(m_edgesAroundVertex, nbShells, edges.size(), 2, [&](size_t edgeId, unsigned int j)
+    {
+        const Edge& edge = edges[edgeId];
+        if (edge[0] >= unsigned(nbPoints) || edge[1] >= unsigned(nbPoints))
+            return nbShells;
+        return size_t(edge[j]);
+    });
+
     if (m_checkConnexity.getValue())
         this->checkConnexity();
 }
@@ -118,6 +118,9 @@ public:
     /// BaseObject method should be overwritten by children
     void reinit() override;
 
+    /// The grid is computed from its own Data only
+    bool hasSelfContainedInit() const override { return true; }
+
 
     /** \brief Set grid resolution in the 3 directions
      * @param nx x resolution
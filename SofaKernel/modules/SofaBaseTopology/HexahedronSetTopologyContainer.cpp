@@ -90,6 +90,14 @@ void HexahedronSetTopologyContainer::init()
         initTopology();
 }
 
+bool HexahedronSetTopologyContainer::readInternalState(const char* buffer, std::size_t size)
+{
+    SOFA_UNUSED(buffer);
+    if (hasHexahedra())
+        initTopology();
+    return size == 0;
+}
+
 void HexahedronSetTopologyContainer::initTopology()
 {
     QuadSetTopologyContainer::initTopology();
@@ -93,6 +93,9 @@ protected:
 public:
     void init() override;
 
+    /// Rebuild the neighborhood buffers once the hexahedra are restored from a checkpoint
+    bool readInternalState(const char* buffer, std::size_t size) override;
+
 
     /// Procedural creation methods
     /// @{
@@ -21,6 +21,7 @@
 ******************************************************************************/
 #include <iostream>
 #include <SofaBaseTopology/MeshTopology.h>
+#include <SofaBaseTopology/CommonAlgorithms.h>
 #include <sofa/core/visual/VisualParams.h>
 #include <sofa/core/ObjectFactory.h>
 #include <sofa/helper/fixed_array.h>
@@ -75,81 +76,49 @@ void MeshTopology::EdgeUpdate::updateFromVolume()
 
     SeqEdges& seqEdges = *topology->seqEdges.beginEdit();
     seqEdges.clear();
-    std::map<Edge,unsigned int> edgeMap;
-    unsigned int edgeIndex;
 
     const SeqTetrahedra& tetrahedra = topology->getTetrahedra(); // do not use seqTetrahedra directly as it might not be up-to-date
+    const SeqHexahedra& hexahedra = topology->getHexahedra(); // do not use seqHexahedra directly as it might not be up-to-date
     const unsigned int edgesInTetrahedronArray[6][2]= {{0,1},{0,2},{0,3},{1,2},{1,3},{2,3}};
-    for (unsigned int i = 0; i < tetrahedra.size(); ++i)
+    const unsigned int edgeHexahedronDescriptionArray[12][2]= {{0,1},{0,3},{0,4},{1,2},{1,5},{2,3},{2,6},{3,7},{4,5},{4,7},{5,6},{6,7}};
+
+    // list the edges of the tetrahedra then of the hexahedra, sorted in lexicographics order
+    const size_t nbTetraEdges = tetrahedra.size()*6;
+    vector<Edge> edges(nbTetraEdges + hexahedra.size()*12);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type i = 0; i < tetrahedra.size(); ++i)
     {
         const Tetra &t=tetrahedra[i];
-        std::map<Edge,unsigned int>::iterator ite;
-        Edge e;
         for (unsigned int j=0; j<6; ++j)
         {
             unsigned int v1=t[edgesInTetrahedronArray[j][0]];
             unsigned int v2=t[edgesInTetrahedronArray[j][1]];
-            // sort vertices in lexicographics order
-            if (v1<v2)
-                e=Edge(v1,v2);
-            else
-                e=Edge(v2,v1);
-
-            ite=edgeMap.find(e);
-            if (ite==edgeMap.end())
-            {
-                // edge not in edgeMap so create a new one
-                edgeIndex=(unsigned int)seqEdges.size();
-                edgeMap[e]=edgeIndex;
-                seqEdges.push_back(e);
-            }
-//            else
-//            {
-//                edgeIndex=(*ite).second;
-//            }
-            //m_edgesInTetrahedron[i][j]=edgeIndex;
+            edges[i*6+j] = (v1<v2) ? Edge(v1,v2) : Edge(v2,v1);
         }
     }
-
-    // fjourdes :
-    // should the edgeMap be cleared here ? Sounds strange but it seems that is what was done in previous method.
-
-    const SeqHexahedra& hexahedra = topology->getHexahedra(); // do not use seqHexahedra directly as it might not be up-to-date
-    const unsigned int edgeHexahedronDescriptionArray[12][2]= {{0,1},{0,3},{0,4},{1,2},{1,5},{2,3},{2,6},{3,7},{4,5},{4,7},{5,6},{6,7}};
-    // create a temporary map to find redundant edges
-
-    /// create the m_edge array at the same time than it fills the m_edgesInHexahedron array
-    for (unsigned int i = 0; i < hexahedra.size(); ++i)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type i = 0; i < hexahedra.size(); ++i)
     {
         const Hexa &h=hexahedra[i];
-        std::map<Edge,unsigned int>::iterator ite;
-        Edge e;
         for (unsigned int j=0; j<12; ++j)
         {
             unsigned int v1=h[edgeHexahedronDescriptionArray[j][0]];
             unsigned int v2=h[edgeHexahedronDescriptionArray[j][1]];
-            // sort vertices in lexicographics order
-            if (v1<v2)
-                e=Edge(v1,v2);
-            else
-                e=Edge(v2,v1);
-
-            ite=edgeMap.find(e);
-            if (ite==edgeMap.end())
-            {
-                // edge not in edgeMap so create a new one
-                edgeIndex=(unsigned int)seqEdges.size();
-                edgeMap[e]=edgeIndex;
-                seqEdges.push_back(e);
-
-            }
-//            else
-//            {
-//                edgeIndex=(*ite).second;
-//            }
-            //m_edgesInHexahedron[i][j]=edgeIndex;
+            edges[nbTetraEdges+i*12+j] = (v1<v2) ? Edge(v1,v2) : Edge(v2,v1);
         }
     }
+
+    // keep each distinct edge once, in order of first appearance
+    vector<unsigned int> firstOccurrence;
+    numberDistinctKeys(edges, firstOccurrence);
+    seqEdges.reserve(firstOccurrence.size());
+    for (unsigned int position : firstOccurrence)
+        seqEdges.push_back(edges[position]);
+
     topology->seqEdges.endEdit();
 }
 
@@ -161,74 +130,53 @@ void MeshTopology::EdgeUpdate::updateFromSurface()
     typedef MeshTopology::Triangle     Triangle;
     typedef MeshTopology::Quad         Quad;
 
-    std::map<Edge,unsigned int> edgeMap;
-    unsigned int edgeIndex;
     SeqEdges& seqEdges = *topology->seqEdges.beginEdit();
     seqEdges.clear();
     const SeqTriangles& triangles = topology->getTriangles(); // do not use seqTriangles directly as it might not be up-to-date
-    for (unsigned int i = 0; i < triangles.size(); ++i)
+    const SeqQuads& quads = topology->getQuads(); // do not use seqQuads directly as it might not be up-to-date
+
+    // list the edges of the triangles then of the quads. The keys are sorted in lexicographics order.
+    const size_t nbTriangleEdges = triangles.size()*3;
+    const size_t nbEdges = nbTriangleEdges + quads.size()*4;
+    vector<Edge> edges(nbEdges), keys(nbEdges);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type i = 0; i < triangles.size(); ++i)
     {
         const Triangle &t=triangles[i];
-        std::map<Edge,unsigned int>::iterator ite;
-        Edge e;
         for (unsigned int j=0; j<3; ++j)
         {
             unsigned int v1=t[(j+1)%3];
             unsigned int v2=t[(j+2)%3];
-            // sort vertices in lexicographics order
-            if (v1<v2)
-                e=Edge(v1,v2);
-            else
-                e=Edge(v2,v1);
-            ite=edgeMap.find(e);
-            if (ite==edgeMap.end())
-            {
-                // edge not in edgeMap so create a new one
-                edgeIndex=(unsigned int)seqEdges.size();
-                edgeMap[e]=edgeIndex;
-                // To be similar to TriangleSetTopologyContainer::createEdgeSetArray
-                //seqEdges.push_back(e); Changed to have oriented edges on the border of the triangulation. 
-                seqEdges.push_back(Edge(v1, v2));
-            }
-//            else
-//            {
-//                edgeIndex=(*ite).second;
-//            }
-            //m_edgesInTriangle[i][j]=edgeIndex;
+            keys[i*3+j] = (v1<v2) ? Edge(v1,v2) : Edge(v2,v1);
+            // To be similar to TriangleSetTopologyContainer::createEdgeSetArray
+            // oriented edges on the border of the triangulation.
+            edges[i*3+j] = Edge(v1, v2);
         }
     }
-
-    const SeqQuads& quads = topology->getQuads(); // do not use seqQuads directly as it might not be up-to-date
-    for (unsigned int i = 0; i < quads.size(); ++i)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type i = 0; i < quads.size(); ++i)
     {
         const Quad &t=quads[i];
-        std::map<Edge,unsigned int>::iterator ite;
-        Edge e;
         for (unsigned int j=0; j<4; ++j)
         {
             unsigned int v1=t[(j+1)%4];
             unsigned int v2=t[(j+2)%4];
-            // sort vertices in lexicographics order
-            if (v1<v2)
-                e=Edge(v1,v2);
-            else
-                e=Edge(v2,v1);
-            ite=edgeMap.find(e);
-            if (ite==edgeMap.end())
-            {
-                // edge not in edgeMap so create a new one
-                edgeIndex=(unsigned int)seqEdges.size();
-                edgeMap[e]=edgeIndex;
-                seqEdges.push_back(e);
-            }
-//            else
-//            {
-//                edgeIndex=(*ite).second;
-//            }
-            //m_edgesInQuad[i][j]=edgeIndex;
+            keys[nbTriangleEdges+i*4+j] = (v1<v2) ? Edge(v1,v2) : Edge(v2,v1);
+            edges[nbTriangleEdges+i*4+j] = keys[nbTriangleEdges+i*4+j];
         }
     }
 
+    // keep each distinct edge once, in order of first appearance
+    vector<unsigned int> firstOccurrence;
+    numberDistinctKeys(keys, firstOccurrence);
+    seqEdges.reserve(firstOccurrence.size());
+    for (unsigned int position : firstOccurrence)
+        seqEdges.push_back(edges[position]);
+
     topology->seqEdges.endEdit();
 }
 
@@ -249,18 +197,18 @@ void MeshTopology::TriangleUpdate::doUpdate()
     const SeqTetrahedra& tetrahedra = topology->getTetrahedra();
     SeqTriangles& seqTriangles = *topology->seqTriangles.beginEdit();
     seqTriangles.clear();
-    // create a temporary map to find redundant triangles
-    std::map<Triangle,unsigned int> triangleMap;
-    std::map<Triangle,unsigned int>::iterator itt;
-    Triangle tr;
-    unsigned int triangleIndex;
-    unsigned int v[3],val;
-    /// create the m_edge array at the same time than it fills the m_trianglesInTetrahedron array
-    for (unsigned int i = 0; i < tetrahedra.size(); ++i)
+
+    // list the faces of the tetrahedra, keyed independently of their orientation
+    vector<Triangle> faces(tetrahedra.size()*4), keys(tetrahedra.size()*4);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type i = 0; i < tetrahedra.size(); ++i)
     {
-        const Tetra &t=topology->seqTetrahedra.getValue()[i];
+        const Tetra &t=tetrahedra[i];
         for (TriangleID j=0; j<4; ++j)
         {
+            unsigned int v[3],val;
             for (PointID k=0; k<3; ++k)
                 v[k] = t[sofa::core::topology::trianglesOrientationInTetrahedronArray[j][k]];
 
@@ -270,20 +218,18 @@ void MeshTopology::TriangleUpdate::doUpdate()
                 val=v[0]; v[0]=v[1]; v[1]=v[2]; v[2]=val;
             }
 
-            // check if a triangle with an opposite orientation already exists
-            tr=Triangle(v[0],v[2],v[1]);
-            itt=triangleMap.find(tr);
-            if (itt==triangleMap.end())
-            {
-                // edge not in edgeMap so create a new one
-                triangleIndex=(unsigned int)seqTriangles.size();
-                tr=Triangle(v[0],v[1],v[2]);
-                triangleMap[tr]=triangleIndex;
-                seqTriangles.push_back(tr);
-            }
+            faces[i*4+j] = Triangle(v[0],v[1],v[2]);
+            keys[i*4+j] = (v[1]<v[2]) ? Triangle(v[0],v[1],v[2]) : Triangle(v[0],v[2],v[1]);
         }
     }
 
+    // keep each distinct triangle once, with the orientation of its first appearance
+    vector<unsigned int> firstOccurrence;
+    numberDistinctKeys(keys, firstOccurrence);
+    seqTriangles.reserve(firstOccurrence.size());
+    for (unsigned int position : firstOccurrence)
+        seqTriangles.push_back(faces[position]);
+
     topology->seqTriangles.endEdit();
 }
 
@@ -859,12 +805,9 @@ void MeshTopology::createEdgesAroundVertexArray ()
         else*/
     {
         // 1D mesh : put inbound edges before outbound edges
-        for (unsigned int i = 0; i < edges.size(); ++i)
-        {
-            // adding edge i in the edge shell of both points
-            m_edgesAroundVertex[ edges[i][0] ].push_back( i );
-            m_edgesAroundVertex[ edges[i][1] ].push_back( i );
-        }
+        // adding edge i in the edge shell of both points
+        buildShells(m_edgesAroundVertex, nbPoints, edges.size(), 2,
+                    [&](size_t i, unsigned int j) { return size_t(edges[i][j]); });
     }
 }
 
@@ -952,15 +895,9 @@ void MeshTopology::createEdgesInHexahedronArray ()
 void MeshTopology::createTrianglesAroundVertexArray ()
 {
     const SeqTriangles& triangles = getTriangles(); // do not use seqTriangles directly as it might not be up-to-date
-    m_trianglesAroundVertex.clear();
-    m_trianglesAroundVertex.resize( nbPoints );
-
-    for (unsigned int i = 0; i < triangles.size(); ++i)
-    {
-        // adding triangle i in the triangle shell of all points
-        for (unsigned int j=0; j<3; ++j)
-            m_trianglesAroundVertex[ triangles[i][j]  ].push_back( i );
-    }
+    // adding triangle i in the triangle shell of all points
+    buildShells(m_trianglesAroundVertex, nbPoints, triangles.size(), 3,
+                [&](size_t i, unsigned int j) { return size_t(triangles[i][j]); });
 }
 
 void MeshTopology::createOrientedTrianglesAroundVertexArray()
@@ -1363,87 +1300,57 @@ void MeshTopology::createQuadsInHexahedronArray ()
 
 void MeshTopology::createTetrahedraAroundVertexArray ()
 {
-    m_tetrahedraAroundVertex.resize( nbPoints );
-    unsigned int j;
-
-    for (unsigned int i = 0; i < seqTetrahedra.getValue().size(); ++i)
-    {
-        for (j=0; j<4; ++j)
-            m_tetrahedraAroundVertex[ seqTetrahedra.getValue()[i][j]  ].push_back( i );
-    }
+    const SeqTetrahedra& tetrahedra = seqTetrahedra.getValue();
+    buildShells(m_tetrahedraAroundVertex, nbPoints, tetrahedra.size(), 4,
+                [&](size_t i, unsigned int j) { return size_t(tetrahedra[i][j]); });
 }
 
 void MeshTopology::createTetrahedraAroundEdgeArray ()
 {
     if (!m_edgesInTetrahedron.size())
         createEdgesInTetrahedronArray();
-    m_tetrahedraAroundEdge.resize( getNbEdges() );
     const vector< EdgesInTetrahedron > &tea = m_edgesInTetrahedron;
-    unsigned int j;
 
-    for (unsigned int i = 0; i < seqTetrahedra.getValue().size(); ++i)
-    {
-        for (j=0; j<6; ++j)
-            m_tetrahedraAroundEdge[ tea[i][j] ].push_back( i );
-    }
+    buildShells(m_tetrahedraAroundEdge, getNbEdges(), seqTetrahedra.getValue().size(), 6,
+                [&](size_t i, unsigned int j) { return size_t(tea[i][j]); });
 }
 
 void MeshTopology::createTetrahedraAroundTriangleArray ()
 {
     if (!m_trianglesInTetrahedron.size())
         createTrianglesInTetrahedronArray();
-    m_tetrahedraAroundTriangle.resize( getNbTriangles());
-    unsigned int j;
     const vector< TrianglesInTetrahedron > &tta=m_trianglesInTetrahedron;
 
-    for (unsigned int i = 0; i < seqTetrahedra.getValue().size(); ++i)
-    {
-        for (j=0; j<4; ++j)
-            m_tetrahedraAroundTriangle[ tta[i][j] ].push_back( i );
-    }
+    buildShells(m_tetrahedraAroundTriangle, getNbTriangles(), seqTetrahedra.getValue().size(), 4,
+                [&](size_t i, unsigned int j) { return size_t(tta[i][j]); });
 }
 
 void MeshTopology::createHexahedraAroundVertexArray ()
 {
-    m_hexahedraAroundVertex.resize( nbPoints );
-    unsigned int j;
-
-    for (unsigned int i = 0; i < seqHexahedra.getValue().size(); ++i)
-    {
-        for (j=0; j<8; ++j)
-            m_hexahedraAroundVertex[ seqHexahedra.getValue()[i][j]  ].push_back( i );
-    }
+    const SeqHexahedra& hexahedra = seqHexahedra.getValue();
+    buildShells(m_hexahedraAroundVertex, nbPoints, hexahedra.size(), 8,
+                [&](size_t i, unsigned int j) { return size_t(hexahedra[i][j]); });
 }
 
 void MeshTopology::createHexahedraAroundEdgeArray ()
 {
     if (!m_edgesInHexahedron.size())
         createEdgesInHexahedronArray();
-    m_hexahedraAroundEdge.resize(getNbEdges());
-    unsigned int j;
     const vector< EdgesInHexahedron > &hea=m_edgesInHexahedron;
 
-    for (unsigned int i = 0; i < seqHexahedra.getValue().size(); ++i)
-    {
-        for (j=0; j<12; ++j)
-            m_hexahedraAroundEdge[ hea[i][j] ].push_back( i );
-    }
+    buildShells(m_hexahedraAroundEdge, getNbEdges(), seqHexahedra.getValue().size(), 12,
+                [&](size_t i, unsigned int j) { return size_t(hea[i][j]); });
 }
 
 void MeshTopology::createHexahedraAroundQuadArray ()
 {
     if (!m_quadsInHexahedron.size())
         createQuadsInHexahedronArray();
-    m_hexahedraAroundQuad.resize( getNbQuads());
-    unsigned int j;
     const vector< QuadsInHexahedron > &qha=m_quadsInHexahedron;
 
-    for (unsigned int i = 0; i < seqHexahedra.getValue().size(); ++i)
-    {
-        // adding quad i in the edge shell of both points
-        for (j=0; j<6; ++j)
-            m_hexahedraAroundQuad[ qha[i][j] ].push_back( i );
-    }
+    // adding hexahedron i in the quad shell of its six faces
+    buildShells(m_hexahedraAroundQuad, getNbQuads(), seqHexahedra.getValue().size(), 6,
+                [&](size_t i, unsigned int j) { return size_t(qha[i][j]); });
 }
 
 const MeshTopology::EdgesAroundVertex& MeshTopology::getEdgesAroundVertex(PointID i)
@@ -79,6 +79,14 @@ void QuadSetTopologyContainer::init()
         initTopology();
 }
 
+bool QuadSetTopologyContainer::readInternalState(const char* buffer, std::size_t size)
+{
+    SOFA_UNUSED(buffer);
+    if (hasQuads())
+        initTopology();
+    return size == 0;
+}
+
 void QuadSetTopologyContainer::initTopology()
 {
     // Force creation of Edge Neighboordhood buffers.
@@ -62,6 +62,9 @@ protected:
 public:
     void init() override;
 
+    /// Rebuild the neighborhood buffers once the quads are restored from a checkpoint
+    bool readInternalState(const char* buffer, std::size_t size) override;
+
 
     /// Procedural creation methods
     /// @{
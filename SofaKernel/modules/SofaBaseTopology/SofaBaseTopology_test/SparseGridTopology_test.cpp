@@ -31,6 +31,7 @@ struct SparseGridTopology_test : public BaseTest
 
     bool buildFromMeshFile();
     bool buildFromMeshParams();
+    bool buildFineGrid();
 };
 
 
@@ -108,8 +109,36 @@ bool SparseGridTopology_test::buildFromMeshParams()
     return true;
 }
 
+bool SparseGridTopology_test::buildFineGrid()
+{
+    // the voxelization and the filling are done by slabs of cells along z:
+    // this grid is made of several slabs
+    EXPECT_MSG_NOEMIT(Error);
+    SparseGridTopology::SPtr sparseGrid = New<SparseGridTopology>();
+    EXPECT_NE(sparseGrid, nullptr);
+    sofa::core::objectmodel::DataFileName* dataFilename = static_cast<sofa::core::objectmodel::DataFileName*>(sparseGrid->findData("filename"));
+    EXPECT_NE(dataFilename, nullptr);
+    dataFilename->setValue("mesh/dragon.OBJ");
+    sparseGrid->setN({ 20, 20, 20 });
+    sparseGrid->init();
+
+    EXPECT_EQ(sparseGrid->getNbPoints(), 3197);
+    EXPECT_EQ(sparseGrid->getNbHexahedra(), 2134);
+
+    // the points are numbered by increasing position
+    for (int i=1; i<sparseGrid->getNbPoints(); ++i)
+    {
+        const Vector3 previous(sparseGrid->getPosX(i-1), sparseGrid->getPosY(i-1), sparseGrid->getPosZ(i-1));
+        const Vector3 current(sparseGrid->getPosX(i), sparseGrid->getPosY(i), sparseGrid->getPosZ(i));
+        EXPECT_TRUE(previous < current);
+    }
+
+    return true;
+}
+
 TEST_F(SparseGridTopology_test, buildFromMeshFile) { ASSERT_TRUE(buildFromMeshFile()); }
 TEST_F(SparseGridTopology_test, buildFromMeshParams) { ASSERT_TRUE(buildFromMeshParams()); }
+TEST_F(SparseGridTopology_test, buildFineGrid) { ASSERT_TRUE(buildFineGrid()); }
 
 
 
@@ -25,13 +25,16 @@
 #include <sofa/core/topology/BaseMeshTopology.h>
 #include <sofa/core/ObjectFactory.h>
 #include <sofa/helper/io/Mesh.h>
+#include <sofa/helper/io/PrecomputedDataCache.h>
 #include <sofa/core/loader/MeshLoader.h>
 #include <sofa/helper/system/FileSystem.h>
 #include <sofa/helper/fixed_array.h>
+#include <sofa/helper/IndexOpenMP.h>
 #include <sofa/helper/polygon_cube_intersection/polygon_cube_intersection.h>
 #include <sofa/helper/system/FileRepository.h>
 #include <sofa/defaulttype/VecTypes.h>
 
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <cmath>
@@ -40,6 +43,7 @@
 
 using std::pair;
 using sofa::core::loader::VoxelLoader;
+using sofa::helper::io::PrecomputedDataCache;
 using namespace sofa::defaulttype;
 using namespace sofa::helper;
 namespace sofa
@@ -51,6 +55,14 @@ namespace component
 namespace topology
 {
 
+namespace
+{
+
+/// Number of cell layers along z of the slabs processed in parallel by the voxelization
+const int s_slabThickness = 8;
+
+} // anonymous namespace
+
 int SparseGridTopologyClass = core::RegisterObject("Sparse grid in 3D")
         .addAlias("SparseGrid")
         .add< SparseGridTopology >()
@@ -702,7 +714,30 @@ void SparseGridTopology::buildFromTriangleMesh(sofa::helper::io::Mesh* mesh)
     _regularGrid->setPos(getXmin(),getXmax(),getYmin(),getYmax(),getZmin(),getZmax());
 
     vector<Type> regularGridTypes; // to compute filling types (OUTSIDE, INSIDE, BOUNDARY)
-    voxelizeTriangleMesh(mesh, _regularGrid, regularGridTypes);
+
+    // The voxelization only depends on the surface and on the regular grid: look for
+    // the result of a previous run in the precomputed data cache
+    PrecomputedDataCache::Key key("SparseGridTypes", 1);
+    PrecomputedDataCache::Entry entry;
+    if (PrecomputedDataCache::isEnabled())
+    {
+        key.add(mesh->getVertices()).add(n.getValue()).add(_min.getValue()).add(_max.getValue());
+        for (const auto& facet : mesh->getFacets())
+            key.add(facet[0]);
+    }
+
+    if (!PrecomputedDataCache::load(key, entry) || !entry.read(regularGridTypes)
+            || regularGridTypes.size() != size_t(_regularGrid->getNbHexahedra()))
+    {
+        voxelizeTriangleMesh(mesh, _regularGrid, regularGridTypes);
+
+        if (PrecomputedDataCache::isEnabled())
+        {
+            entry.clear();
+            entry.write(regularGridTypes);
+            PrecomputedDataCache::store(key, entry);
+        }
+    }
 
     buildFromRegularGridTypes(_regularGrid, regularGridTypes);
 }
@@ -718,24 +753,24 @@ void SparseGridTopology::voxelizeTriangleMesh(helper::io::Mesh* mesh,
     const size_t vertexSize = vertices.size();
     helper::vector< int > verticesHexa(vertexSize);
     const Vector3 delta = (regularGrid->getDx() + regularGrid->getDy() + regularGrid->getDz()) / 2;
+    const Vector3 gmin = regularGrid->getMin();
+    const Vector3 gmax = regularGrid->getMax();
 
     // Compute the grid element for each mesh vertex
-    for (size_t i = 0; i < vertexSize; ++i)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<size_t>::type i = 0; i < vertexSize; ++i)
     {
         const Vector3& vertex = vertices[i];
         int index = regularGrid->findHexa(vertex);
 
-        if (index > 0)
-            regularGridTypes[index] = BOUNDARY;
-
         // Case where 'findHexa' did not find the right hexa
         // Here we test the case where the point is close the surface (delta /2)
         // Useful when the point is on the boundary
         if (index == -1)
         {
             Vector3 vertex2 = vertex;
-            const Vector3 gmin = regularGrid->getMin();
-            const Vector3 gmax = regularGrid->getMax();
 
             if ( (vertex2[0] - std::numeric_limits<float>::epsilon()) < gmin[0] )
                 vertex2[0] = gmin[0] + delta[0];
@@ -753,47 +788,87 @@ void SparseGridTopology::voxelizeTriangleMesh(helper::io::Mesh* mesh,
                 vertex2[2] = gmax[2] - delta[2];
 
             index = regularGrid->findHexa(vertex2);
-
-            if(index == -1)
-                msg_error() << "vertex "<<i<<" not found in hexahedral topology";
         }
 
         verticesHexa[i] = index;
     }
 
-    // For each triangle, compute BBox and test each element in bb if needed
-    const helper::vector< helper::vector < helper::vector <int> > >& facets = mesh->getFacets();
+    for (size_t i = 0; i < vertexSize; ++i)
+    {
+        if (verticesHexa[i] == -1)
+            msg_error() << "vertex "<<i<<" not found in hexahedral topology";
+        else if (verticesHexa[i] > 0)
+            regularGridTypes[verticesHexa[i]] = BOUNDARY;
+    }
 
+    // Triangularize the facets and compute the range of cells covered by each triangle
+    const helper::vector< helper::vector < helper::vector <int> > >& facets = mesh->getFacets();
+    helper::vector< fixed_array<int,3> > triangles;
     for (unsigned int f=0; f<facets.size(); f++)
     {
         const helper::vector<int>& facet = facets[f][0];
-        for (unsigned int j=2; j<facet.size(); j++) // Triangularize
+        for (unsigned int j=2; j<facet.size(); j++)
+            triangles.push_back(fixed_array<int,3>(facet[0], facet[j-1], facet[j]));
+    }
+
+    helper::vector< fixed_array<Vec3i,2> > triangleCells(triangles.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<size_t>::type t = 0; t < triangles.size(); ++t)
+    {
+        const Vector3 i0 = regularGrid->getCubeCoordinate(verticesHexa[triangles[t][0]]);
+        const Vector3 i1 = regularGrid->getCubeCoordinate(verticesHexa[triangles[t][1]]);
+        const Vector3 i2 = regularGrid->getCubeCoordinate(verticesHexa[triangles[t][2]]);
+        for (unsigned int w=0; w<3; ++w)
         {
-            int c0 = verticesHexa[facet[0]];
-            int c1 = verticesHexa[facet[j-1]];
-            int c2 = verticesHexa[facet[j]];
-            if((c0==c1)&&(c0==c2)&&(c0!=-1)) // All vertices in same box discard now if possible
-            {
-                if(regularGridTypes[c0]==BOUNDARY)
-                    continue;
-            }
-            // Compute box
-            const Vector3 i0 = regularGrid->getCubeCoordinate(c0);
-            const Vector3 i1 = regularGrid->getCubeCoordinate(c1);
-            const Vector3 i2 = regularGrid->getCubeCoordinate(c2);
-
-            const Vector3 iMin(	std::min(i0[0],std::min(i1[0],i2[0])),
-                    std::min(i0[1],std::min(i1[1],i2[1])),
-                    std::min(i0[2],std::min(i1[2],i2[2])));
-            const Vector3 iMax(	std::max(i0[0],std::max(i1[0],i2[0])),
-                    std::max(i0[1],std::max(i1[1],i2[1])),
-                    std::max(i0[2],std::max(i1[2],i2[2])));
-
-            for(unsigned int x=(unsigned int)iMin[0]; x<=(unsigned int)iMax[0]; ++x)
+            triangleCells[t][0][w] = (int)std::min(i0[w],std::min(i1[w],i2[w]));
+            triangleCells[t][1][w] = (int)std::max(i0[w],std::max(i1[w],i2[w]));
+        }
+    }
+
+    // The triangles are tested against the cells slab by slab along z. Each slab is
+    // processed by one thread, which is then the only one to write the types of its cells.
+    const int nbCellsZ = regularGrid->getNz()-1;
+    const int nbSlabs = std::max(1, (nbCellsZ + s_slabThickness - 1) / s_slabThickness);
+    helper::vector< helper::vector<unsigned int> > slabTriangles(nbSlabs);
+    for (unsigned int t=0; t<triangles.size(); ++t)
+    {
+        // a vertex outside of the grid gives a negative coordinate: such triangles are ignored
+        if (triangleCells[t][0][0] < 0 || triangleCells[t][0][1] < 0 || triangleCells[t][0][2] < 0)
+            continue;
+        const int lastSlab = std::min(triangleCells[t][1][2] / s_slabThickness, nbSlabs-1);
+        for (int s = triangleCells[t][0][2] / s_slabThickness; s <= lastSlab; ++s)
+            slabTriangles[s].push_back(t);
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (helper::IndexOpenMP<int>::type s = 0; s < nbSlabs; ++s)
+    {
+        const int slabBegin = s * s_slabThickness;
+        const int slabEnd = slabBegin + s_slabThickness - 1;
+
+        for (unsigned int t : slabTriangles[s])
+        {
+            const fixed_array<int,3>& triangle = triangles[t];
+            const Vec3i& iMin = triangleCells[t][0];
+            const Vec3i& iMax = triangleCells[t][1];
+
+            int c0 = verticesHexa[triangle[0]];
+            if(iMin == iMax && regularGridTypes[c0]==BOUNDARY) // All vertices in same box discard now if possible
+                continue;
+
+            const Vector3& A = vertices[triangle[0]];
+            const Vector3& B = vertices[triangle[1]];
+            const Vector3& C = vertices[triangle[2]];
+
+            for(int x=iMin[0]; x<=iMax[0]; ++x)
             {
-                for(unsigned int y=(unsigned int)iMin[1]; y<=(unsigned int)iMax[1]; ++y)
+                for(int y=iMin[1]; y<=iMax[1]; ++y)
                 {
-                    for(unsigned int z=(unsigned int)iMin[2]; z<=(unsigned int)iMax[2]; ++z)
+                    for(int z=std::max(iMin[2], slabBegin); z<=std::min(iMax[2], slabEnd); ++z)
                     {
                         // if already inserted discard
                         unsigned int index = regularGrid->getCubeIndex(x,y,z);
@@ -811,10 +886,6 @@ void SparseGridTopology::voxelizeTriangleMesh(helper::io::Mesh* mesh,
 
                         Vector3 cubeCenter = corners[0] + cubeDiagonal*.5;
 
-                        const Vector3& A = vertices[facet[0]];
-                        const Vector3& B = vertices[facet[j-1]];
-                        const Vector3& C = vertices[facet[j]];
-
                         // Scale the triangle to the unit cube matching
                         float points[3][3];
 
@@ -838,61 +909,95 @@ void SparseGridTopology::voxelizeTriangleMesh(helper::io::Mesh* mesh,
         }
     }
 
+    fillOutsideCells(regularGrid, regularGridTypes);
+}
+
 
-    // TODO: regarder les cellules pleines, et les ajouter
-    vector<bool> alreadyTested(regularGrid->getNbHexahedra(),false);
-    std::stack< Vec3i > seed;
-    // x==0 and x=nx-2
-    for(int y=0; y<regularGrid->getNy()-1; ++y)
+void SparseGridTopology::fillOutsideCells(RegularGridTopology::SPtr regularGrid,
+        vector<Type>& regularGridTypes) const
+{
+    const int nx = regularGrid->getNx()-1;
+    const int ny = regularGrid->getNy()-1;
+    const int nz = regularGrid->getNz()-1;
+    if (nx <= 0 || ny <= 0 || nz <= 0)
+        return;
+
+    // The OUTSIDE filling is propagated from the border cells of the grid until it meets
+    // BOUNDARY cells. Each slab of cells along z is filled by one thread. When the filling
+    // reaches the face of a slab, the neighbor cell is sent to the adjacent slab, which
+    // continues the propagation at the next round.
+    const int nbSlabs = (nz + s_slabThickness - 1) / s_slabThickness;
+    const int layerSize = nx * ny;
+    helper::vector< helper::vector<int> > seeds(nbSlabs);
+    helper::vector< helper::vector<int> > toLowerSlab(nbSlabs);
+    helper::vector< helper::vector<int> > toUpperSlab(nbSlabs);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<int>::type s = 0; s < nbSlabs; ++s)
     {
-        for(int z=0; z<regularGrid->getNz()-1; ++z)
-        {
-            launchPropagationFromSeed(Vec3i(0,y,z), regularGrid, regularGridTypes, alreadyTested,seed );
-            launchPropagationFromSeed(Vec3i(regularGrid->getNx()-2,y,z), regularGrid, regularGridTypes, alreadyTested,seed );
-        }
+        const int slabEnd = std::min(nz, (s+1) * s_slabThickness);
+        for (int z = s * s_slabThickness; z < slabEnd; ++z)
+            for (int y = 0; y < ny; ++y)
+                for (int x = 0; x < nx; ++x)
+                    if (x == 0 || x == nx-1 || y == 0 || y == ny-1 || z == 0 || z == nz-1)
+                        seeds[s].push_back(x + nx * (y + ny * z));
+    }
 
-        // y==0 and y=ny-2
-        for(int x=0; x<regularGrid->getNx()-1; ++x)
+    bool hasSeeds = true;
+    while (hasSeeds)
+    {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (helper::IndexOpenMP<int>::type s = 0; s < nbSlabs; ++s)
         {
-            for(int z=0; z<regularGrid->getNz()-1; ++z)
-            {
-                launchPropagationFromSeed(Vec3i(x,0,z), regularGrid, regularGridTypes, alreadyTested,seed );
-                launchPropagationFromSeed(Vec3i(x,regularGrid->getNy()-2,z), regularGrid, regularGridTypes, alreadyTested,seed );
-            }
+            const int slabBegin = s * s_slabThickness;
+            const int slabEnd = std::min(nz, slabBegin + s_slabThickness);
+            std::vector<int>& stack = seeds[s];
+            toLowerSlab[s].clear();
+            toUpperSlab[s].clear();
 
-            // z==0 and z==Nz-2
-            for(int y=0; y<regularGrid->getNy()-1; ++y)
+            while (!stack.empty())
             {
-                for(int x=0; x<regularGrid->getNx()-1; ++x)
-                {
-                    launchPropagationFromSeed(Vec3i(x,y,0), regularGrid, regularGridTypes, alreadyTested,seed );
-                    launchPropagationFromSeed(Vec3i(x,y,regularGrid->getNz()-2), regularGrid, regularGridTypes, alreadyTested,seed );
-                }
+                const int index = stack.back();
+                stack.pop_back();
+                if (regularGridTypes[index] != INSIDE)
+                    continue;
+                regularGridTypes[index] = OUTSIDE;
+
+                const int x = index % nx;
+                const int y = (index / nx) % ny;
+                const int z = index / layerSize;
+
+                if (x > 0)    stack.push_back(index - 1);
+                if (x < nx-1) stack.push_back(index + 1);
+                if (y > 0)    stack.push_back(index - nx);
+                if (y < ny-1) stack.push_back(index + nx);
+
+                if (z > slabBegin)     stack.push_back(index - layerSize);
+                else if (z > 0)        toLowerSlab[s].push_back(index - layerSize);
+                if (z < slabEnd-1)     stack.push_back(index + layerSize);
+                else if (z < nz-1)     toUpperSlab[s].push_back(index + layerSize);
             }
         }
-    }
-}
-
 
-void SparseGridTopology::launchPropagationFromSeed(const Vec3i &point,
-        RegularGridTopology::SPtr regularGrid,
-        vector<Type>& regularGridTypes,
-        vector<bool>& alreadyTested,
-        std::stack<Vec3i> &seed) const
-{
-    seed.push(point);
-    while (!seed.empty())
-    {
-        const Vec3i &s=seed.top();
-        seed.pop();
-        propagateFrom(s,regularGrid,regularGridTypes,alreadyTested,seed);
+        hasSeeds = false;
+        for (int s = 0; s < nbSlabs; ++s)
+        {
+            if (s > 0)
+                seeds[s].insert(seeds[s].end(), toUpperSlab[s-1].begin(), toUpperSlab[s-1].end());
+            if (s < nbSlabs-1)
+                seeds[s].insert(seeds[s].end(), toLowerSlab[s+1].begin(), toLowerSlab[s+1].end());
+            hasSeeds = hasSeeds || !seeds[s].empty();
+        }
     }
 }
 
 void SparseGridTopology::buildFromRegularGridTypes(RegularGridTopology::SPtr regularGrid, const vector<Type>& regularGridTypes)
 {
-    vector< CubeCorners > cubeCorners; // saving temporary positions of all cube corners
-    MapBetweenCornerPositionAndIndice cubeCornerPositionIndiceMap; // to compute cube corner indice values
+    helper::vector<int> regularCells; // indices in the regular grid of the valid cells
 
     _indicesOfRegularCubeInSparseGrid.resize( _regularGrid->getNbHexahedra(), -1 ); // to redirect an indice of a cube in the regular grid to its indice in the sparse grid
     int cubeCntr = 0;
@@ -905,16 +1010,7 @@ void SparseGridTopology::buildFromRegularGridTypes(RegularGridTopology::SPtr reg
             _types.push_back(BOUNDARY);
             _indicesOfRegularCubeInSparseGrid[w] = cubeCntr++;
             _indicesOfCubeinRegularGrid.push_back( w );
-
-
-            Hexa c = regularGrid->getHexaCopy(w);
-            CubeCorners corners;
-            for(int j=0; j<8; ++j)
-            {
-                corners[j] = regularGrid->getPoint( c[j] );
-                cubeCornerPositionIndiceMap[corners[j]] = 0;
-            }
-            cubeCorners.push_back(corners);
+            regularCells.push_back( int(w) );
         }
     }
 
@@ -926,43 +1022,70 @@ void SparseGridTopology::buildFromRegularGridTypes(RegularGridTopology::SPtr reg
             _types.push_back(INSIDE);
             _indicesOfRegularCubeInSparseGrid[w] = cubeCntr++;
             _indicesOfCubeinRegularGrid.push_back( w );
-
-            Hexa c = regularGrid->getHexaCopy(w);
-            CubeCorners corners;
-            for(int j=0; j<8; ++j)
-            {
-                corners[j] = regularGrid->getPoint( c[j] );
-                cubeCornerPositionIndiceMap[corners[j]] = 0;
-            }
-            cubeCorners.push_back(corners);
+            regularCells.push_back( int(w) );
         }
     }
 
-    helper::vector<defaulttype::Vec<3,SReal> >& seqPoints = *this->seqPoints.beginEdit(); seqPoints.clear();
-    // compute corner indices
-    int cornerCounter=0;
+    buildCellCorners(regularGrid, regularCells);
+}
+
 
-    for(MapBetweenCornerPositionAndIndice::iterator it = cubeCornerPositionIndiceMap.begin();
-        it!=cubeCornerPositionIndiceMap.end(); ++it, ++cornerCounter)
+void SparseGridTopology::buildCellCorners(RegularGridTopology::SPtr regularGrid, const helper::vector<int>& regularCells)
+{
+    // corners of the cells, as indices of points in the regular grid
+    const size_t nbCells = regularCells.size();
+    helper::vector<int> corners(8*nbCells);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<size_t>::type w = 0; w < nbCells; ++w)
     {
-        (*it).second = cornerCounter;
-        seqPoints.push_back( (*it).first );
+        const Hexa c = regularGrid->getHexaCopy(regularCells[w]);
+        for (int j=0; j<8; ++j)
+            corners[8*w+j] = c[j];
     }
 
-    this->seqPoints.beginEdit();
-    nbPoints = (int)cubeCornerPositionIndiceMap.size();
+    // the points used by the cells, numbered by increasing position
+    helper::vector<int> regularPoints(corners);
+    std::sort(regularPoints.begin(), regularPoints.end());
+    regularPoints.erase(std::unique(regularPoints.begin(), regularPoints.end()), regularPoints.end());
+
+    helper::vector<Vector3> positions(regularPoints.size());
+    for (size_t i=0; i<regularPoints.size(); ++i)
+        positions[i] = regularGrid->getPoint(regularPoints[i]);
+
+    helper::vector<int> order(regularPoints.size());
+    for (size_t i=0; i<order.size(); ++i)
+        order[i] = int(i);
+    std::sort(order.begin(), order.end(), [&positions](int a, int b) { return positions[a] < positions[b]; });
+
+    helper::vector<int> pointIndices(regularPoints.size());
+    helper::vector<defaulttype::Vec<3,SReal> >& seqPoints = *this->seqPoints.beginEdit();
+    seqPoints.clear();
+    seqPoints.reserve(regularPoints.size());
+    for (int i : order)
+    {
+        if (seqPoints.empty() || seqPoints.back() < positions[i])
+            seqPoints.push_back(positions[i]);
+        pointIndices[i] = int(seqPoints.size())-1;
+    }
+    this->seqPoints.endEdit();
+    nbPoints = (int)seqPoints.size();
 
     SeqHexahedra& hexahedra = *seqHexahedra.beginEdit();
-
-    for( unsigned w=0; w<cubeCorners.size(); ++w)
+    const size_t firstHexa = hexahedra.size();
+    hexahedra.resize(firstHexa + nbCells);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<size_t>::type w = 0; w < nbCells; ++w)
     {
-        Hexa c;
-        for(int j=0; j<8; ++j)
-            c[j] = cubeCornerPositionIndiceMap[cubeCorners[w][j]];
-
-        hexahedra.push_back(c);
+        for (int j=0; j<8; ++j)
+        {
+            const size_t p = std::lower_bound(regularPoints.begin(), regularPoints.end(), corners[8*w+j]) - regularPoints.begin();
+            hexahedra[firstHexa+w][j] = pointIndices[p];
+        }
     }
-
     seqHexahedra.endEdit();
 }
 
@@ -1025,8 +1148,7 @@ void SparseGridTopology::buildFromFiner()
 
     _indicesOfRegularCubeInSparseGrid.resize( _regularGrid->getNbHexahedra(), -1 ); // to redirect an indice of a cube in the regular grid to its indice in the sparse grid
 
-    vector< CubeCorners > cubeCorners; // saving temporary positions of all cube corners
-    MapBetweenCornerPositionAndIndice cubeCornerPositionIndiceMap; // to compute cube corner indice values
+    helper::vector<int> regularCells; // indices in the regular grid of the valid cells
 
     for(int i=0; i<getNx()-1; i++)
     {
@@ -1075,18 +1197,9 @@ void SparseGridTopology::buildFromFiner()
 
 
                 int coarseRegularIndice = _regularGrid->cube( i,j,k );
-                Hexa c = _regularGrid->getHexaCopy( coarseRegularIndice );
-
-                CubeCorners corners;
-                for(int w=0; w<8; ++w)
-                {
-                    corners[w] = _regularGrid->getPoint( c[w] );
-                    cubeCornerPositionIndiceMap[corners[w]] = 0;
-                }
-
-                cubeCorners.push_back(corners);
+                regularCells.push_back( coarseRegularIndice );
 
-                _indicesOfRegularCubeInSparseGrid[coarseRegularIndice] = (int)cubeCorners.size()-1;
+                _indicesOfRegularCubeInSparseGrid[coarseRegularIndice] = (int)regularCells.size()-1;
                 _indicesOfCubeinRegularGrid.push_back( coarseRegularIndice );
 
                 // 			_hierarchicalCubeMap[cubeCorners.size()-1]=fineIndices;
@@ -1096,27 +1209,7 @@ void SparseGridTopology::buildFromFiner()
     }
 
 
-    // compute corner indices
-    int cornerCounter=0;
-    helper::vector<defaulttype::Vec<3,SReal> >& seqPoints = *this->seqPoints.beginEdit(); seqPoints.clear();
-    for(MapBetweenCornerPositionAndIndice::iterator it=cubeCornerPositionIndiceMap.begin(); it!=cubeCornerPositionIndiceMap.end(); ++it,++cornerCounter)
-    {
-        (*it).second = cornerCounter;
-        seqPoints.push_back( (*it).first );
-    }
-    this->seqPoints.endEdit();
-    nbPoints = (int)cubeCornerPositionIndiceMap.size();
-
-    SeqHexahedra& hexahedra = *seqHexahedra.beginEdit();
-    for( unsigned w=0; w<cubeCorners.size(); ++w)
-    {
-        Hexa c;
-        for(int j=0; j<8; ++j)
-            c[j] = cubeCornerPositionIndiceMap[cubeCorners[w][j]];
-
-        hexahedra.push_back(c);
-    }
-    seqHexahedra.endEdit();
+    buildCellCorners(_regularGrid, regularCells);
 
 
     // for interpolation and restriction
@@ -1424,33 +1517,6 @@ void SparseGridTopology::updateQuads()
 }
 
 
-void SparseGridTopology::propagateFrom( const Vec3i &point,
-        RegularGridTopology::SPtr regularGrid,
-        vector<Type>& regularGridTypes,
-        vector<bool>& alreadyTested,
-        std::stack< Vec<3,int> > &seed) const
-{
-    const int x=point[0];
-    const int y=point[1];
-    const int z=point[2];
-    assert( x>=0 && x<=regularGrid->getNx()-2 && y>=0 && y<=regularGrid->getNy()-2 && z>=0 && z<=regularGrid->getNz()-2 );
-
-    unsigned indice = regularGrid->cube( x, y, z );
-    if( alreadyTested[indice] || regularGridTypes[indice] == BOUNDARY ) return;
-
-    alreadyTested[indice] = true;
-    regularGridTypes[indice] = OUTSIDE;
-
-    if(x>0)                     seed.push(Vec3i(x-1,y,z));
-    if(x<regularGrid->getNx()-2) seed.push(Vec3i(x+1,y,z));
-
-    if(y>0)                     seed.push(Vec3i(x,y-1,z));
-    if(y<regularGrid->getNy()-2) seed.push(Vec3i(x,y+1,z));
-
-    if(z>0)                     seed.push(Vec3i(x,y,z-1));
-    if(z<regularGrid->getNz()-2) seed.push(Vec3i(x,y,z+1));
-}
-
 } // namespace topology
 
 } // namespace component
@@ -232,18 +232,9 @@ protected:
     helper::vector< float > _stiffnessCoefs; ///< a stiffness coefficient per hexa (BOUNDARY=.5, FULL=1)
     helper::vector< float > _massCoefs; ///< a stiffness coefficient per hexa (BOUNDARY=.5, FULL=1)
 
-    /// start from a seed cell (i,j,k) the OUTSIDE filling is propagated to neighboor cells until meet a BOUNDARY cell (this function is called from all border cells of the RegularGrid)
-    void launchPropagationFromSeed(const Vec3i& point,
-            RegularGridTopology::SPtr regularGrid,
-            helper::vector<Type>& regularGrdidTypes,
-            helper::vector<bool>& alreadyTested,
-            std::stack<Vec3i>& seed) const;
-
-    void propagateFrom(  const Vec3i& point,
-            RegularGridTopology::SPtr regularGrid,
-            helper::vector<Type>& regularGridTypes,
-            helper::vector<bool>& alreadyTested,
-            std::stack< sofa::defaulttype::Vec<3,int> > &seed) const;
+    /// mark as OUTSIDE the cells which are not separated from the border of the regular grid by BOUNDARY cells
+    void fillOutsideCells(RegularGridTopology::SPtr regularGrid,
+            helper::vector<Type>& regularGridTypes) const;
 
     void computeBoundingBox(const helper::vector<Vector3>& vertices,
             SReal& xmin, SReal& xmax,
@@ -258,6 +249,10 @@ protected:
 
     void buildFromRegularGridTypes(RegularGridTopology::SPtr regularGrid, const helper::vector<Type>& regularGridTypes);
 
+    /// build the points and the hexahedra of the given cells of the regular grid,
+    /// the points being numbered by increasing position
+    void buildCellCorners(RegularGridTopology::SPtr regularGrid, const helper::vector<int>& regularCells);
+
 
 
     /** Create a sparse grid from a .voxel file
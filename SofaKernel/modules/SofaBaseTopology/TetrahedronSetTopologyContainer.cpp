@@ -21,6 +21,7 @@
 ******************************************************************************/
 
 #include <SofaBaseTopology/TetrahedronSetTopologyContainer.h>
+#include <SofaBaseTopology/CommonAlgorithms.h>
 #include <sofa/core/visual/VisualParams.h>
 #include <sofa/core/ObjectFactory.h>
 
@@ -86,6 +87,14 @@ void TetrahedronSetTopologyContainer::init()
         initTopology();
 }
 
+bool TetrahedronSetTopologyContainer::readInternalState(const char* buffer, std::size_t size)
+{
+    SOFA_UNUSED(buffer);
+    if (hasTetrahedra())
+        initTopology();
+    return size == 0;
+}
+
 void TetrahedronSetTopologyContainer::initTopology()
 {
     TriangleSetTopologyContainer::initTopology();
@@ -121,13 +130,16 @@ void TetrahedronSetTopologyContainer::createEdgeSetArray()
         clearTetrahedraAroundEdge();
     }
 
-    // create a temporary map to find redundant edges
-    std::map<Edge,EdgeID> edgeMap;
     helper::WriteAccessor< Data< sofa::helper::vector<Edge> > > m_edge = d_edge;
     helper::ReadAccessor< Data< sofa::helper::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
 
-    /// create the m_edge array at the same time than it fills the m_edgesInTetrahedron array
-    for (size_t i = 0; i < m_tetrahedron.size(); ++i)
+    // list the edges of all tetrahedra, then number the distinct ones in order of appearance
+    const size_t nbTetra = m_tetrahedron.size();
+    sofa::helper::vector<Edge> edges(nbTetra*6);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type i = 0; i < nbTetra; ++i)
     {
         const Tetrahedron &t = m_tetrahedron[i];
         for (EdgeID j=0; j<6; ++j)
@@ -136,17 +148,16 @@ void TetrahedronSetTopologyContainer::createEdgeSetArray()
             const PointID v2 = t[edgesInTetrahedronArray[j][1]];
 
             // sort vertices in lexicographic order
-            const Edge e((v1<v2) ? Edge(v1,v2) : Edge(v2,v1));
-
-            if (edgeMap.find(e)==edgeMap.end())
-            {
-                // edge not in edgeMap so create a new one
-                const size_t edgeIndex = edgeMap.size();
-                edgeMap[e] = (EdgeID)edgeIndex;
-                m_edge.push_back(e);
-            }
+            edges[i*6+j] = ((v1<v2) ? Edge(v1,v2) : Edge(v2,v1));
         }
     }
+
+    sofa::helper::vector<unsigned int> firstOccurrence;
+    numberDistinctKeys(edges, firstOccurrence);
+
+    m_edge.reserve(m_edge.size() + firstOccurrence.size());
+    for (unsigned int position : firstOccurrence)
+        m_edge.push_back(edges[position]);
 }
 
 void TetrahedronSetTopologyContainer::createEdgesInTetrahedronArray()
@@ -255,13 +266,18 @@ void TetrahedronSetTopologyContainer::createTriangleSetArray()
         clearTetrahedraAroundTriangle();
     }
 
-    // create a temporary map to find redundant triangles
-    std::map<Triangle,TriangleID> triangleMap;
     helper::WriteAccessor< Data< sofa::helper::vector<Triangle> > > m_triangle = d_triangle;
     helper::ReadAccessor< Data< sofa::helper::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
 
-    /// create the m_edge array at the same time than it fills the m_edgesInTetrahedron array
-    for (size_t i=0; i<m_tetrahedron.size(); ++i)
+    // list the faces of all tetrahedra, keyed independently of their orientation, then number
+    // the distinct ones in order of appearance. The first occurrence gives the orientation.
+    const size_t nbTetra = m_tetrahedron.size();
+    sofa::helper::vector<Triangle> faces(nbTetra*4);
+    sofa::helper::vector<Triangle> keys(nbTetra*4);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type i = 0; i < nbTetra; ++i)
     {
         const Tetrahedron &t = m_tetrahedron[i];
 
@@ -280,25 +296,25 @@ void TetrahedronSetTopologyContainer::createTriangleSetArray()
                 v[2]=val;
             }
 
-            // check if a triangle with an opposite orientation already exists
-            Triangle tr = Triangle(v[0], v[2], v[1]);
-
-            if (triangleMap.find(tr) == triangleMap.end())
-            {
-                // triangle not in triangleMap so create a new one
-                tr = Triangle(v[0], v[1], v[2]);
-                if (triangleMap.find(tr) == triangleMap.end())
-                {
-                    triangleMap[tr] = (TriangleID)m_triangle.size();
-                    m_triangle.push_back(tr);
-                }
-                else
-                {
-					msg_error() << "Duplicate triangle " << tr << " in tetra " << i <<" : " << t;
-                }
-            }
+            faces[i*4+j] = Triangle(v[0], v[1], v[2]);
+            keys[i*4+j] = (v[1]<v[2]) ? Triangle(v[0], v[1], v[2]) : Triangle(v[0], v[2], v[1]);
         }
     }
+
+    sofa::helper::vector<unsigned int> firstOccurrence, uniqueIndex;
+    numberDistinctKeys(keys, firstOccurrence, &uniqueIndex);
+
+    // a face shared with the same orientation by two tetrahedra denotes an invalid mesh
+    for (size_t p = 0; p < faces.size(); ++p)
+    {
+        const unsigned int first = firstOccurrence[uniqueIndex[p]];
+        if (first != p && !(faces[first] < faces[p]) && !(faces[p] < faces[first]))
+            msg_error() << "Duplicate triangle " << faces[p] << " in tetra " << p/4 <<" : " << m_tetrahedron[p/4];
+    }
+
+    m_triangle.reserve(m_triangle.size() + firstOccurrence.size());
+    for (unsigned int position : firstOccurrence)
+        m_triangle.push_back(faces[position]);
 }
 
 void TetrahedronSetTopologyContainer::createTrianglesInTetrahedronArray()
@@ -347,17 +363,10 @@ void TetrahedronSetTopologyContainer::createTetrahedraAroundVertexArray()
     if (getNbPoints() == 0) // in case only Data have been copied and not going thourgh AddTriangle methods.
         this->setNbPoints(d_initPoints.getValue().size());
 
-    m_tetrahedraAroundVertex.resize( getNbPoints() );
     helper::ReadAccessor< Data< sofa::helper::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
 
-    for (size_t i = 0; i < getNumberOfTetrahedra(); ++i)
-    {
-        // adding edge i in the edge shell of both points
-        for (PointID j=0; j<4; ++j)
-        {
-            m_tetrahedraAroundVertex[ m_tetrahedron[i][j]  ].push_back( (TetrahedronID)i );
-        }
-    }
+    buildShells(m_tetrahedraAroundVertex, getNbPoints(), getNumberOfTetrahedra(), 4,
+                [&](size_t i, unsigned int j) { return size_t(m_tetrahedron[i][j]); });
 }
 
 void TetrahedronSetTopologyContainer::createTetrahedraAroundEdgeArray ()
@@ -368,15 +377,8 @@ void TetrahedronSetTopologyContainer::createTetrahedraAroundEdgeArray ()
     if(!hasEdgesInTetrahedron())
         createEdgesInTetrahedronArray();
 
-    m_tetrahedraAroundEdge.resize(getNumberOfEdges());
-    for (size_t i=0; i< getNumberOfTetrahedra(); ++i)
-    {
-        // adding edge i in the edge shell of both points
-        for (EdgeID j=0; j<6; ++j)
-        {
-            m_tetrahedraAroundEdge[ m_edgesInTetrahedron[i][j] ].push_back( (TetrahedronID)i );
-        }
-    }
+    buildShells(m_tetrahedraAroundEdge, getNumberOfEdges(), getNumberOfTetrahedra(), 6,
+                [&](size_t i, unsigned int j) { return size_t(m_edgesInTetrahedron[i][j]); });
 }
 
 void TetrahedronSetTopologyContainer::createTetrahedraAroundTriangleArray ()
@@ -417,16 +419,9 @@ void TetrahedronSetTopologyContainer::createTetrahedraAroundTriangleArray ()
         return;
     }
 
-    m_tetrahedraAroundTriangle.resize(numTriangles);
-
-    for (size_t i=0; i<numTetra; ++i)
-    {
-        // adding tetrahedron i in the shell of all neighbors triangles
-        for (TriangleID j=0; j<4; ++j)
-        {
-            m_tetrahedraAroundTriangle[ m_trianglesInTetrahedron[i][j] ].push_back( (TetrahedronID)i );
-        }
-    }
+    // adding each tetrahedron in the shell of all neighbors triangles
+    buildShells(m_tetrahedraAroundTriangle, numTriangles, numTetra, 4,
+                [&](size_t i, unsigned int j) { return size_t(m_trianglesInTetrahedron[i][j]); });
 }
 
 const sofa::helper::vector<TetrahedronSetTopologyContainer::Tetrahedron> &TetrahedronSetTopologyContainer::getTetrahedronArray()
@@ -72,6 +72,9 @@ protected:
 public:
     void init() override;
 
+    /// Rebuild the neighborhood buffers once the tetrahedra are restored from a checkpoint
+    bool readInternalState(const char* buffer, std::size_t size) override;
+
     //add removed tetrahedron index
     void addRemovedTetraIndex(sofa::helper::vector< TetrahedronID >& tetrahedra);
 
@@ -24,6 +24,7 @@
 
 #include <SofaBaseTopology/TopologySparseDataHandler.h>
 #include <SofaBaseTopology/TopologySparseData.h>
+#include <algorithm>
 
 namespace sofa
 {
@@ -123,12 +124,28 @@ void TopologySparseDataHandler <TopologyElementType, VecT>::remove( const sofa::
     container_type& data = *(_topologyData->beginEdit());
     size_type last = data.size() -1;
 
+    // position of each element in the map, so that each removal does not have to search the map.
+    // It is only used if the map does not contain duplicates, otherwise the first occurrence is searched.
+    const unsigned int invalid = sofa::core::topology::Topology::InvalidID;
+    unsigned int maxKey = 0;
+    for (size_type i = 0; i < keys.size(); ++i)
+        maxKey = std::max(maxKey, keys[i]);
+    sofa::helper::vector<unsigned int> position;
+    position.assign(keys.empty() ? 0 : size_t(maxKey)+1, invalid);
+    bool indexed = true;
+    for (size_type i = 0; i < keys.size() && indexed; ++i)
+    {
+        indexed = (position[keys[i]] == invalid);
+        position[keys[i]] = (unsigned int)i;
+    }
+
     // check for each element remove if it concern this sparseData
     unsigned int cptDone = 0;
     for (size_type i = 0; i < index.size(); ++i)
     {
         unsigned int elemId = index[i];
-        unsigned int id = _topologyData->indexOfElement(elemId);
+        unsigned int id = indexed ? (elemId < position.size() ? position[elemId] : invalid)
+                                  : _topologyData->indexOfElement(elemId);
 
         if (id == sofa::core::topology::Topology::InvalidID)
             continue;
@@ -136,6 +153,11 @@ void TopologySparseDataHandler <TopologyElementType, VecT>::remove( const sofa::
         cptDone++;
         this->applyDestroyFunction( id, data[id] );
         this->swap( id, last );
+        if (indexed)
+        {
+            position[keys[id]] = id;
+            position[keys[last]] = (unsigned int)last;
+        }
         --last;
     }
 
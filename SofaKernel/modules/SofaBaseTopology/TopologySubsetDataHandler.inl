@@ -23,6 +23,7 @@
 #define SOFA_COMPONENT_TOPOLOGY_TOPOLOGYSUBSETDATAHANDLER_INL
 
 #include <SofaBaseTopology/TopologySubsetDataHandler.h>
+#include <algorithm>
 
 namespace sofa
 {
@@ -97,11 +98,78 @@ template <typename TopologyElementType, typename VecT>
 void TopologySubsetDataHandler <TopologyElementType, VecT>::remove( const sofa::helper::vector<unsigned int> &index )
 {
     container_type& data = *(m_topologyData->beginEdit());
-    unsigned int it1;
-    unsigned int it2;
 
-    for (unsigned int i = 0; i < index.size(); ++i)
+    // Position of each element in the subset, so that each removal does not have to search the subset.
+    // It is only valid if the subset does not contain duplicates, otherwise the first occurrence is searched.
+    const unsigned int notInSubset = sofa::core::topology::Topology::InvalidID;
+    sofa::helper::vector<unsigned int> position;
+    auto buildPositions = [&]() -> bool
     {
+        unsigned int maxIndex = 0;
+        for (unsigned int i = 0; i < data.size(); ++i)
+            maxIndex = std::max(maxIndex, (unsigned int)data[i]);
+        for (unsigned int i = 0; i < index.size(); ++i)
+            maxIndex = std::max(maxIndex, index[i]);
+
+        position.assign(maxIndex+1, notInSubset);
+        for (unsigned int i = 0; i < data.size(); ++i)
+        {
+            if (position[data[i]] != notInSubset)
+                return false;
+            position[data[i]] = i;
+        }
+        return true;
+    };
+    auto find = [&](unsigned int elem) -> unsigned int
+    {
+        return elem < position.size() ? position[elem] : notInSubset;
+    };
+
+    unsigned int i = 0;
+    bool indexed = buildPositions();
+    for (; indexed && i < index.size(); ++i)
+    {
+        const unsigned int elem = index[i];
+        const unsigned int it1 = find(elem);
+        const unsigned int it2 = find(this->lastElementIndex);
+
+        // the last element is renumbered as the removed one
+        if (it2 != notInSubset && it2 != it1)
+        {
+            data[it2] = elem;
+            position[this->lastElementIndex] = notInSubset;
+            position[elem] = it2;
+        }
+        else if (it1 != notInSubset)
+            position[elem] = notInSubset;
+
+        if (it1 != notInSubset)
+        {
+            const unsigned int lastPos = (unsigned int)data.size()-1;
+            data[it1] = data[lastPos];
+            if (it1 != lastPos)
+                position[data[it1]] = it1;
+
+            size_t size_before = data.size();
+
+            // Call destroy function implemented in specific component
+            this->applyDestroyFunction(elem, data[data.size()-1]);
+
+            // As applyDestroyFunction could already perfom the suppression, if implemented. Size is checked again. If no change this handler really perform the suppresion
+            if (size_before == data.size())
+                data.resize(data.size() - 1);
+            else
+                indexed = buildPositions();
+        }
+        --this->lastElementIndex;
+    }
+
+    // subset with duplicated elements: search each element
+    for (; i < index.size(); ++i)
+    {
+        unsigned int it1;
+        unsigned int it2;
+
         it1=0;
         while(it1<data.size())
         {
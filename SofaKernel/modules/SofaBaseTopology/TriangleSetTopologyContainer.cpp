@@ -20,6 +20,7 @@
 * Contact information: contact@sofa-framework.org                             *
 ******************************************************************************/
 #include <SofaBaseTopology/TriangleSetTopologyContainer.h>
+#include <SofaBaseTopology/CommonAlgorithms.h>
 #include <sofa/core/visual/VisualParams.h>
 
 #include <sofa/core/ObjectFactory.h>
@@ -80,6 +81,14 @@ void TriangleSetTopologyContainer::init()
         initTopology();
 }
 
+bool TriangleSetTopologyContainer::readInternalState(const char* buffer, std::size_t size)
+{
+    SOFA_UNUSED(buffer);
+    if (hasTriangles())
+        initTopology();
+    return size == 0;
+}
+
 void TriangleSetTopologyContainer::initTopology()
 {
     // Force creation of Edge Neighboordhood buffers.
@@ -126,13 +135,9 @@ void TriangleSetTopologyContainer::createTrianglesAroundVertexArray()
     if (nbPoints == 0) // in case only Data have been copied and not going thourgh AddTriangle methods.
         this->setNbPoints(d_initPoints.getValue().size());
 
-    m_trianglesAroundVertex.resize(getNbPoints());
-    for (size_t i = 0; i < m_triangle.size(); ++i)
-    {
-        // adding edge i in the edge shell of both points
-        for (unsigned int j=0; j<3; ++j)
-            m_trianglesAroundVertex[ m_triangle[i][j]  ].push_back( (TriangleID)i );
-    }
+    // adding triangle i in the triangle shell of its three points
+    buildShells(m_trianglesAroundVertex, getNbPoints(), m_triangle.size(), 3,
+                [&](size_t i, unsigned int j) { return size_t(m_triangle[i][j]); });
 }
 
 void TriangleSetTopologyContainer::createTrianglesAroundEdgeArray ()
@@ -204,12 +209,17 @@ void TriangleSetTopologyContainer::createEdgeSetArray()
             clearTrianglesAroundEdge();
     }
 
-    // create a temporary map to find redundant edges
-    std::map<Edge, EdgeID> edgeMap;
     helper::WriteAccessor< Data< sofa::helper::vector<Edge> > > m_edge = d_edge;
     helper::ReadAccessor< Data< sofa::helper::vector<Triangle> > > m_triangle = d_triangle;
 
-    for (size_t i=0; i<m_triangle.size(); ++i)
+    // list the edges of all triangles, then number the distinct ones in order of appearance
+    const size_t nbTriangles = m_triangle.size();
+    sofa::helper::vector<Edge> edges(nbTriangles*3);
+    sofa::helper::vector<Edge> keys(nbTriangles*3);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type i=0; i<nbTriangles; ++i)
     {
         const Triangle &t = m_triangle[i];
         for(unsigned int j=0; j<3; ++j)
@@ -218,18 +228,18 @@ void TriangleSetTopologyContainer::createEdgeSetArray()
             const PointID v2 = t[(j+2)%3];
 
             // sort vertices in lexicographic order
-            const Edge e = ((v1<v2) ? Edge(v1,v2) : Edge(v2,v1));
-
-            if(edgeMap.find(e) == edgeMap.end())
-            {
-                // edge not in edgeMap so create a new one
-                const size_t edgeIndex = edgeMap.size();
-                edgeMap[e] = (EdgeID)edgeIndex;
-                //m_edge.push_back(e); Changed to have oriented edges on the border of the triangulation
-                m_edge.push_back(Edge(v1,v2));
-            }
+            keys[i*3+j] = ((v1<v2) ? Edge(v1,v2) : Edge(v2,v1));
+            // keep the orientation of the first triangle to have oriented edges on the border of the triangulation
+            edges[i*3+j] = Edge(v1,v2);
         }
     }
+
+    sofa::helper::vector<unsigned int> firstOccurrence;
+    numberDistinctKeys(keys, firstOccurrence);
+
+    m_edge.reserve(m_edge.size() + firstOccurrence.size());
+    for (unsigned int position : firstOccurrence)
+        m_edge.push_back(edges[position]);
 }
 
 void TriangleSetTopologyContainer::createEdgesInTriangleArray()
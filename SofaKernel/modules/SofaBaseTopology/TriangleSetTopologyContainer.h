@@ -65,6 +65,9 @@ protected:
 public:
     void init() override;
 
+    /// Rebuild the neighborhood buffers once the triangles are restored from a checkpoint
+    bool readInternalState(const char* buffer, std::size_t size) override;
+
     void reinit() override;
 
 
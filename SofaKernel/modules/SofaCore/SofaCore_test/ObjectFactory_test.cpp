@@ -0,0 +1,148 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/objectmodel/BaseObjectDescription.h>
+#include <sofa/defaulttype/TemplatesAliases.h>
+#include <sofa/defaulttype/VecTypes.h>
+
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest ;
+
+
+namespace sofa {
+
+using core::ObjectFactory;
+using core::objectmodel::BaseObjectDescription;
+
+template<class DataTypes>
+class ObjectFactoryTestComponent : public core::objectmodel::BaseObject
+{
+public:
+    SOFA_CLASS(SOFA_TEMPLATE(ObjectFactoryTestComponent, DataTypes), core::objectmodel::BaseObject);
+
+    std::string getTemplateName() const override
+    {
+        return templateName(this);
+    }
+
+    static std::string templateName(const ObjectFactoryTestComponent<DataTypes>* = nullptr)
+    {
+        return DataTypes::Name();
+    }
+};
+
+int ObjectFactoryTestComponentClass = core::RegisterObject("Component used to test the ObjectFactory")
+        .add< ObjectFactoryTestComponent<defaulttype::Vec3dTypes> >(true)
+        .add< ObjectFactoryTestComponent<defaulttype::Vec2dTypes> >()
+        .addAlias("ObjectFactoryTestAlias")
+        ;
+
+struct ObjectFactory_test: public BaseTest
+{
+    core::objectmodel::BaseObject::SPtr create(const std::string& type, const std::string& templatename = "")
+    {
+        BaseObjectDescription desc("test", type.c_str());
+        if (!templatename.empty())
+            desc.setAttribute("template", templatename);
+        return ObjectFactory::CreateObject(nullptr, &desc);
+    }
+
+    void TearDown() override
+    {
+        ObjectFactory::getInstance()->setProfiling(false);
+        ObjectFactory::getInstance()->clearProfilingStats();
+    }
+};
+
+TEST_F(ObjectFactory_test, lookup)
+{
+    EXPECT_TRUE( ObjectFactory::HasCreator("ObjectFactoryTestComponent") );
+    EXPECT_TRUE( ObjectFactory::HasCreator("ObjectFactoryTestAlias") );
+    EXPECT_FALSE( ObjectFactory::HasCreator("ObjectFactoryTestUnknown") );
+
+    core::objectmodel::BaseObject::SPtr obj = create("ObjectFactoryTestComponent");
+    ASSERT_NE( obj, nullptr );
+    EXPECT_EQ( obj->getTemplateName(), "Vec3d" );
+
+    obj = create("ObjectFactoryTestAlias", "Vec2d");
+    ASSERT_NE( obj, nullptr );
+    EXPECT_EQ( obj->getTemplateName(), "Vec2d" );
+
+    // the resolution of the template aliases is cached, check it twice
+    for (int i=0; i<2; ++i)
+    {
+        obj = create("ObjectFactoryTestComponent", "Vec2");
+        ASSERT_NE( obj, nullptr );
+        EXPECT_EQ( obj->getTemplateName(), "Vec2d" );
+    }
+
+    EXPECT_EQ( create("ObjectFactoryTestUnknown"), nullptr );
+}
+
+TEST_F(ObjectFactory_test, templateAliasAddedAfterResolution)
+{
+    // unknown template, the default one is used
+    core::objectmodel::BaseObject::SPtr obj = create("ObjectFactoryTestComponent", "ObjectFactoryTestTemplate");
+    ASSERT_NE( obj, nullptr );
+    EXPECT_EQ( obj->getTemplateName(), "Vec3d" );
+
+    // the cached resolution must not hide the new alias
+    ASSERT_TRUE( defaulttype::TemplateAliases::addAlias("ObjectFactoryTestTemplate", "Vec2d", false) );
+    obj = create("ObjectFactoryTestComponent", "ObjectFactoryTestTemplate");
+    ASSERT_NE( obj, nullptr );
+    EXPECT_EQ( obj->getTemplateName(), "Vec2d" );
+}
+
+TEST_F(ObjectFactory_test, profiling)
+{
+    ObjectFactory* factory = ObjectFactory::getInstance();
+    factory->clearProfilingStats();
+    factory->setProfiling(true);
+
+    create("ObjectFactoryTestComponent");
+    create("ObjectFactoryTestComponent", "Vec2d");
+    create("ObjectFactoryTestAlias");
+    create("ObjectFactoryTestUnknown");
+    factory->addInitTime("ObjectFactoryTestComponent", 0.5);
+
+    const ObjectFactory::ClassStatsMap& stats = factory->getProfilingStats();
+    ASSERT_EQ( stats.count("ObjectFactoryTestComponent"), 1u );
+    const ObjectFactory::ClassStats& s = stats.at("ObjectFactoryTestComponent");
+    EXPECT_EQ( s.nbCreated, 3u );
+    EXPECT_EQ( s.nbFailed, 0u );
+    EXPECT_EQ( s.nbCanCreate, 3u );
+    EXPECT_DOUBLE_EQ( s.initTime, 0.5 );
+    ASSERT_EQ( stats.count("ObjectFactoryTestUnknown"), 1u );
+    EXPECT_EQ( stats.at("ObjectFactoryTestUnknown").nbFailed, 1u );
+
+    std::ostringstream report;
+    factory->dumpProfilingReport(report);
+    EXPECT_NE( report.str().find("ObjectFactoryTestComponent"), std::string::npos );
+    EXPECT_NE( report.str().find("TOTAL"), std::string::npos );
+
+    // nothing is recorded when profiling is disabled
+    factory->setProfiling(false);
+    create("ObjectFactoryTestComponent");
+    EXPECT_EQ( factory->getProfilingStats().at("ObjectFactoryTestComponent").nbCreated, 3u );
+}
+
+} // namespace sofa
@@ -37,6 +37,7 @@ public:
     typedef helper::WriteAccessor< Data<helper::vector<sofa::defaulttype::Vector3> > > waPositions;
     typedef helper::WriteAccessor< Data< helper::vector< Triangle > > > waTtriangles;
     typedef helper::WriteAccessor< Data< helper::vector< Tetrahedron > > > waTetrahedra;
+    typedef helper::WriteAccessor< Data< helper::vector< Quad > > > waQuads;
 
     bool load() override
     {
@@ -74,6 +75,41 @@ protected:
 
     }
 
+    /// n x n grid of quads whose points are numbered in a scattered order
+    void populateMesh_scatteredGrid(unsigned n)
+    {
+        const unsigned nbPoints = (n+1)*(n+1);
+        const unsigned stride = 7919; // prime, not dividing nbPoints
+        helper::vector<unsigned> gridToPoint(nbPoints);
+        for (unsigned i = 0; i < nbPoints; ++i)
+            gridToPoint[i] = (i * stride) % nbPoints;
+
+        MeshTestLoader::waPositions my_positions(meshLoader.d_positions);
+        my_positions.resize(nbPoints);
+        for (unsigned j = 0; j <= n; ++j)
+            for (unsigned i = 0; i <= n; ++i)
+                my_positions[gridToPoint[j*(n+1)+i]] = sofa::defaulttype::Vector3(i, j, 0);
+
+        MeshTestLoader::waQuads my_quads(meshLoader.d_quads);
+        for (unsigned j = 0; j < n; ++j)
+            for (unsigned i = 0; i < n; ++i)
+            {
+                const unsigned p = j*(n+1)+i;
+                meshLoader.addQuad(&(my_quads.wref()), gridToPoint[p], gridToPoint[p+1], gridToPoint[p+n+2], gridToPoint[p+n+1]);
+            }
+    }
+
+    size_t quadsBandwidth()
+    {
+        size_t bandwidth = 0;
+        for (const MeshLoader::Quad& q : meshLoader.d_quads.getValue())
+            for (unsigned j = 0; j < 4; ++j)
+                for (unsigned k = 0; k < 4; ++k)
+                    if (q[j] > q[k])
+                        bandwidth = std::max(bandwidth, size_t(q[j] - q[k]));
+        return bandwidth;
+    }
+
     MeshTestLoader meshLoader;
 
 };
@@ -99,4 +135,62 @@ TEST_F(MeshLoader_test, createSubElements)
 
 }
 
+TEST_F(MeshLoader_test, reorderPoints)
+{
+    const unsigned n = 20;
+    populateMesh_scatteredGrid(n);
+    const helper::vector<sofa::defaulttype::Vector3> positions = meshLoader.d_positions.getValue();
+    const helper::vector<MeshLoader::Quad> quads = meshLoader.d_quads.getValue();
+    EXPECT_GT(quadsBandwidth(), 10*(n+2));
+
+    meshLoader.d_reorderPoints.setValue(true);
+    meshLoader.reorderMesh();
+
+    // a grid numbered by RCM has a bandwidth close to its width
+    EXPECT_LE(quadsBandwidth(), 2*(n+2));
+
+    const helper::vector<MeshLoader::PointID>& originalPoints = meshLoader.d_originalPointIndices.getValue();
+    ASSERT_EQ(positions.size(), originalPoints.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+        EXPECT_EQ(positions[originalPoints[i]], meshLoader.d_positions.getValue()[i]);
+
+    ASSERT_EQ(quads.size(), meshLoader.d_quads.getValue().size());
+    for (size_t i = 0; i < quads.size(); ++i)
+        for (unsigned j = 0; j < 4; ++j)
+            EXPECT_EQ(quads[i][j], originalPoints[meshLoader.d_quads.getValue()[i][j]]);
+}
+
+TEST_F(MeshLoader_test, reorderElements)
+{
+    const unsigned n = 16;
+    populateMesh_scatteredGrid(n);
+    const helper::vector<MeshLoader::Quad> quads = meshLoader.d_quads.getValue();
+
+    meshLoader.d_reorderElements.setValue(true);
+    meshLoader.reorderMesh();
+
+    const helper::vector<MeshLoader::Quad>& sortedQuads = meshLoader.d_quads.getValue();
+    const helper::vector<core::topology::Topology::QuadID>& originalQuads = meshLoader.d_originalQuadIndices.getValue();
+    ASSERT_EQ(quads.size(), originalQuads.size());
+    for (size_t i = 0; i < quads.size(); ++i)
+        for (unsigned j = 0; j < 4; ++j)
+            EXPECT_EQ(quads[originalQuads[i]][j], sortedQuads[i][j]);
+
+    // along a Z-order curve, each quarter of the sorted quads covers one quadrant of the grid
+    const helper::vector<sofa::defaulttype::Vector3>& positions = meshLoader.d_positions.getValue();
+    const size_t quarter = sortedQuads.size() / 4;
+    for (size_t b = 0; b < sortedQuads.size(); b += quarter)
+    {
+        sofa::defaulttype::Vector3 bbmin = positions[sortedQuads[b][0]], bbmax = bbmin;
+        for (size_t i = b; i < b + quarter; ++i)
+            for (unsigned j = 0; j < 4; ++j)
+                for (unsigned c = 0; c < 3; ++c)
+                {
+                    bbmin[c] = std::min(bbmin[c], positions[sortedQuads[i][j]][c]);
+                    bbmax[c] = std::max(bbmax[c], positions[sortedQuads[i][j]][c]);
+                }
+        EXPECT_EQ(sofa::defaulttype::Vector3(n/2, n/2, 0), bbmax - bbmin);
+    }
+}
+
 }// namespace sofa
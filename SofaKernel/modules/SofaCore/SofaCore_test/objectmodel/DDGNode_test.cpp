@@ -26,6 +26,8 @@ using sofa::helper::testing::BaseTest ;
 #include <sofa/core/objectmodel/DDGNode.h>
 using sofa::core::objectmodel::DDGNode;
 
+#include <thread>
+
 class DDGNodeTestClass : public DDGNode
 {
 public:
@@ -167,3 +169,97 @@ TEST_F(DDGNode_test, propagationScenario3)
     EXPECT_EQ(m_ddgnode1.m_cpt, 1);
     EXPECT_EQ(m_ddgnode2.m_cpt, 1);
 }
+
+TEST_F(DDGNode_test, propagationCounters)
+{
+    m_ddgnode1.addInput(&m_ddgnode2);
+    m_ddgnode2.addInput(&m_ddgnode3);
+    m_ddgnode1.cleanDirty();
+    m_ddgnode2.cleanDirty();
+
+    DDGNode::resetPropagationCounters();
+    m_ddgnode3.setDirtyOutputs();
+    DDGNode::PropagationCounters counters = DDGNode::getPropagationCounters();
+    // m_ddgnode1 has no outputs, they were marked dirty when its input was added
+    EXPECT_EQ(counters.nbPropagations, 2u);
+    EXPECT_EQ(counters.nbDirtyValues, 2u);
+    EXPECT_EQ(counters.nbShortCircuits, 1u);
+
+    // the outputs are already dirty, the propagation stops immediately
+    m_ddgnode3.setDirtyOutputs();
+    counters = DDGNode::getPropagationCounters();
+    EXPECT_EQ(counters.nbPropagations, 2u);
+    EXPECT_EQ(counters.nbShortCircuits, 2u);
+}
+
+TEST_F(DDGNode_test, propagationCountersOfOtherThreads)
+{
+    m_ddgnode1.addInput(&m_ddgnode2);
+    m_ddgnode1.cleanDirty();
+
+    DDGNode::resetPropagationCounters();
+    const DDGNode::PropagationCounters before = DDGNode::getThreadPropagationCounters();
+    std::thread other([this]()
+    {
+        m_ddgnode2.setDirtyOutputs();
+        EXPECT_EQ(DDGNode::getThreadPropagationCounters().nbPropagations, 1u);
+    });
+    other.join();
+
+    // counted by the other thread only, and still summed once it has finished
+    EXPECT_EQ(DDGNode::getThreadPropagationCounters().nbPropagations, before.nbPropagations);
+    EXPECT_EQ(DDGNode::getPropagationCounters().nbPropagations, 1u);
+    EXPECT_EQ(DDGNode::getPropagationCounters().nbDirtyValues, 1u);
+}
+
+TEST_F(DDGNode_test, batchEdit)
+{
+    m_ddgnode1.addInput(&m_ddgnode2);
+    m_ddgnode1.addInput(&m_ddgnode3);
+    m_ddgnode1.cleanDirty();
+
+    DDGNode::resetPropagationCounters();
+    {
+        DDGNode::BatchEdit batch;
+        for (int i=0; i<10; ++i)
+        {
+            m_ddgnode2.setDirtyOutputs();
+            m_ddgnode3.setDirtyOutputs();
+        }
+        EXPECT_FALSE(m_ddgnode1.isDirty());
+        {
+            DDGNode::BatchEdit nested;
+            m_ddgnode2.setDirtyOutputs();
+        }
+        EXPECT_FALSE(m_ddgnode1.isDirty());
+        EXPECT_EQ(DDGNode::getPropagationCounters().nbDeferred, 2u);
+        EXPECT_EQ(DDGNode::getPropagationCounters().nbPropagations, 0u);
+    }
+    EXPECT_TRUE(m_ddgnode1.isDirty());
+    EXPECT_EQ(DDGNode::getPropagationCounters().nbDirtyValues, 1u);
+
+    // flush propagates, and the following edits are deferred again
+    m_ddgnode1.cleanDirty();
+    {
+        DDGNode::BatchEdit batch;
+        m_ddgnode2.setDirtyOutputs();
+        batch.flush();
+        EXPECT_TRUE(m_ddgnode1.isDirty());
+        m_ddgnode1.cleanDirty();
+        m_ddgnode2.setDirtyOutputs();
+        EXPECT_FALSE(m_ddgnode1.isDirty());
+    }
+    EXPECT_TRUE(m_ddgnode1.isDirty());
+}
+
+TEST_F(DDGNode_test, batchEditDeletedNode)
+{
+    DDGNode::BatchEdit batch;
+    {
+        DDGNodeTestClass node;
+        node.addOutput(&m_ddgnode1);
+        node.setDirtyOutputs();
+    }
+    m_ddgnode2.setDirtyOutputs();
+    // the deleted node is removed from the batch
+}
@@ -22,6 +22,8 @@
 #include <sofa/core/objectmodel/Data.h>
 #include <sofa/helper/vectorData.h>
 #include <sofa/core/objectmodel/DataFileName.h>
+#include <sofa/defaulttype/Vec.h>
+#include <sofa/defaulttype/VecTypes.h>
 
 #include <sofa/helper/testing/BaseTest.h>
 using sofa::helper::testing::BaseTest ;
@@ -147,4 +149,79 @@ TEST_F(DataFileNameVector_test , read_spaces )
 }
 
 
+/** Test suite for the binary serialization of Data. */
+struct DataBinary_test: public BaseTest
+{
+};
+
+TEST_F(DataBinary_test , serializable )
+{
+    EXPECT_TRUE( Data<int>().isBinarySerializable() );
+    EXPECT_TRUE( Data<defaulttype::Vec3d>().isBinarySerializable() );
+    EXPECT_TRUE( Data< helper::vector<defaulttype::Vec3d> >().isBinarySerializable() );
+    EXPECT_TRUE( Data< helper::vector<unsigned int> >().isBinarySerializable() );
+    EXPECT_FALSE( Data<std::string>().isBinarySerializable() );
+    EXPECT_FALSE( Data< helper::vector<bool> >().isBinarySerializable() );
+    EXPECT_FALSE( Data< helper::vector<std::string> >().isBinarySerializable() );
+}
+
+TEST_F(DataBinary_test , roundTrip )
+{
+    Data< helper::vector<defaulttype::Vec3d> > data1;
+    Data< helper::vector<defaulttype::Vec3d> > data2;
+    helper::vector<defaulttype::Vec3d> v;
+    for (int i=0; i<1000; ++i)
+        v.push_back(defaulttype::Vec3d(i, 0.1*i, -1.0/(i+1)));
+    data1.setValue(v);
+
+    std::vector<char> buffer;
+    ASSERT_TRUE( data1.writeBinary(buffer) );
+    EXPECT_EQ( data2.readBinary(buffer.data(), buffer.size()), buffer.size() );
+    EXPECT_EQ( data2.getValue(), v );
+
+    // a truncated buffer is rejected
+    EXPECT_EQ( data2.readBinary(buffer.data(), buffer.size()-1), 0u );
+
+    // the values are stored as raw memory, so another value type is rejected
+    Data< helper::vector<defaulttype::Vec3f> > data3;
+    EXPECT_EQ( data3.readBinary(buffer.data(), buffer.size()), 0u );
+    Data< helper::vector<long long> > data4;
+    EXPECT_EQ( data4.readBinary(buffer.data(), buffer.size()), 0u );
+
+    // fixed size types only accept their number of values
+    Data<defaulttype::Vec3d> data5;
+    EXPECT_EQ( data5.readBinary(buffer.data(), buffer.size()), 0u );
+}
+
+TEST_F(DataBinary_test , base64 )
+{
+    Data< helper::vector<unsigned int> > data1;
+    Data< helper::vector<unsigned int> > data2;
+    for (unsigned int n=0; n<5; ++n)
+    {
+        helper::vector<unsigned int> v;
+        for (unsigned int i=0; i<n; ++i)
+            v.push_back(i*123456u);
+        data1.setValue(v);
+
+        const std::string str = data1.getValueBase64();
+        ASSERT_TRUE( BaseData::isBase64Value(str) );
+        // read() accepts the base64 form
+        EXPECT_TRUE( data2.read(str) );
+        EXPECT_EQ( data2.getValue(), v );
+    }
+
+    Data<std::string> text;
+    EXPECT_TRUE( text.getValueBase64().empty() );
+    EXPECT_FALSE( data2.read("base64:#") );
+
+    // the types without a binary form keep such a text verbatim
+    EXPECT_TRUE( text.read("base64:abc") );
+    EXPECT_EQ( text.getValue(), "base64:abc" );
+    Data< helper::vector<std::string> > texts;
+    EXPECT_TRUE( texts.read("base64:abc") );
+    ASSERT_EQ( texts.getValue().size(), 1u );
+    EXPECT_EQ( texts.getValue()[0], "base64:abc" );
+}
+
 }// namespace sofa
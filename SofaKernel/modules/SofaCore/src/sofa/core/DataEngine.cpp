@@ -22,6 +22,8 @@
 
 #include <sofa/core/DataEngine.h>
 
+#include <atomic>
+
 namespace sofa
 {
 
@@ -67,8 +69,26 @@ void DataEngine::updateAllInputs()
     }
 }
 
+namespace
+{
+std::atomic<DataEngine::UpdateUpstreamFunction> s_updateUpstream { nullptr };
+}
+
+void DataEngine::setUpdateUpstreamFunction(UpdateUpstreamFunction f)
+{
+    s_updateUpstream = f;
+}
+
+DataEngine::UpdateUpstreamFunction DataEngine::getUpdateUpstreamFunction()
+{
+    return s_updateUpstream;
+}
+
 void DataEngine::update()
 {
+    UpdateUpstreamFunction updateUpstream = s_updateUpstream.load(std::memory_order_relaxed);
+    if (updateUpstream)
+        updateUpstream(this);
     updateAllInputs();
     DDGNode::cleanDirty();
     doUpdate();
@@ -95,6 +95,13 @@ public:
     /// Add a new output to this engine
     void addOutput(objectmodel::BaseData* n);
 
+    /// Function called by update() before updating the inputs of the engine. It can update
+    /// the dirty engines upstream in another order, i.e. in parallel as done by
+    /// simulation::DataEngineTaskGraph. Without it, they are pulled one at a time by the inputs.
+    typedef void (*UpdateUpstreamFunction)(DataEngine* engine);
+    static void setUpdateUpstreamFunction(UpdateUpstreamFunction f);
+    static UpdateUpstreamFunction getUpdateUpstreamFunction();
+
     // The methods below must be redefined because of the
     // double inheritance from Base and DDGNode
 
@@ -25,33 +25,73 @@
 #include <sofa/helper/logging/Messaging.h>
 #include <sofa/helper/ComponentChange.h>
 #include <sofa/helper/StringUtils.h>
+#include <sofa/helper/system/thread/CTime.h>
+#include <algorithm>
+#include <iomanip>
 
 namespace sofa
 {
 namespace core
 {
 
+ObjectFactory::ObjectFactory()
+    : m_templateAliasesRevision(sofa::defaulttype::TemplateAliases::getRevision())
+    , m_profiling(false)
+{
+}
+
 ObjectFactory::~ObjectFactory()
 {
 }
 
 ObjectFactory::ClassEntry& ObjectFactory::getEntry(std::string classname)
 {
+    std::unique_lock<std::shared_mutex> registryLock(m_registryMutex);
     if (registry.find(classname) == registry.end()) {
         registry[classname] = ClassEntry::SPtr(new ClassEntry);
         registry[classname]->className = classname;
+        m_entryIndex[classname] = registry[classname];
+
+        // the new class may come with new template aliases
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_resolvedTemplates.clear();
     }
 
     return *registry[classname];
 }
 
+ObjectFactory::ClassEntry::SPtr ObjectFactory::findEntry(const std::string& classname)
+{
+    auto it = m_entryIndex.find(classname);
+    if (it == m_entryIndex.end())
+        return nullptr;
+    return it->second;
+}
+
+ObjectFactory::CreatorMap ObjectFactory::getCreators(const std::string& classname)
+{
+    std::shared_lock<std::shared_mutex> registryLock(m_registryMutex);
+    ClassEntry::SPtr entry = findEntry(classname);
+    if (!entry)
+        return CreatorMap();
+    return entry->creatorMap;
+}
+
+void ObjectFactory::addDataAlias(const std::string& classname, const std::string& dataname, const std::string& alias)
+{
+    std::unique_lock<std::shared_mutex> registryLock(m_registryMutex);
+    ClassEntry::SPtr entry = findEntry(classname);
+    if (entry)
+        entry->m_dataAlias[dataname].push_back(alias);
+}
+
 /// Test if a creator exists for a given classname
 bool ObjectFactory::hasCreator(std::string classname)
 {
-    ClassEntryMap::iterator it = registry.find(classname);
-    if (it == registry.end())
+    std::shared_lock<std::shared_mutex> registryLock(m_registryMutex);
+    ClassEntry::SPtr entry = findEntry(classname);
+    if (!entry)
         return false;
-    ClassEntry::SPtr entry = it->second;
     return (!entry->creatorMap.empty());
 }
 
@@ -59,10 +99,10 @@ std::string ObjectFactory::shortName(std::string classname)
 {
     std::string shortname;
 
-    ClassEntryMap::iterator it = registry.find(classname);
-    if (it != registry.end())
+    std::shared_lock<std::shared_mutex> registryLock(m_registryMutex);
+    ClassEntry::SPtr entry = findEntry(classname);
+    if (entry)
     {
-        ClassEntry::SPtr entry = it->second;
         if(!entry->creatorMap.empty())
         {
             CreatorMap::iterator it = entry->creatorMap.begin();
@@ -76,6 +116,7 @@ std::string ObjectFactory::shortName(std::string classname)
 bool ObjectFactory::addAlias(std::string name, std::string target, bool force,
                              ClassEntry::SPtr* previous)
 {
+    std::unique_lock<std::shared_mutex> registryLock(m_registryMutex);
     // Check that the pointed class does exist
     ClassEntryMap::iterator it = registry.find(target);
     if (it == registry.end())
@@ -100,23 +141,34 @@ bool ObjectFactory::addAlias(std::string name, std::string target, bool force,
     }
 
     registry[name] = pointedEntry;
+    m_entryIndex[name] = pointedEntry;
     pointedEntry->aliases.insert(name);
     return true;
 }
 
 void ObjectFactory::resetAlias(std::string name, ClassEntry::SPtr previous)
 {
+    std::unique_lock<std::shared_mutex> registryLock(m_registryMutex);
     registry[name] = previous;
+    m_entryIndex[name] = previous;
 }
 
-
-objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseContext* context, objectmodel::BaseObjectDescription* arg)
+ObjectFactory::ResolvedTemplate ObjectFactory::resolveTemplate(const std::string& usertemplatename)
 {
-    objectmodel::BaseObject::SPtr object = nullptr;
-    std::vector< std::pair<std::string, Creator::SPtr> > creators;
-    std::string classname = arg->getAttribute( "type", "");
-    std::string usertemplatename = arg->getAttribute( "template", "");
-    ClassEntry::SPtr entry ;
+    if (usertemplatename.empty())
+        return ResolvedTemplate();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // the aliases added since the cache was filled may change the resolved names
+    const unsigned int aliasesRevision = sofa::defaulttype::TemplateAliases::getRevision();
+    if (aliasesRevision != m_templateAliasesRevision)
+    {
+        m_resolvedTemplates.clear();
+        m_templateAliasesRevision = aliasesRevision;
+    }
+    auto it = m_resolvedTemplates.find(usertemplatename);
+    if (it != m_resolvedTemplates.end())
+        return it->second;
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     /// Process the template aliases.
@@ -128,8 +180,8 @@ objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseConte
     ///      and "undefined" behavior means that the template is converting a specifically given
     ///      type precision into a different one.
     ///  (4) rebuild the template string by joining them all with ','.
+    ResolvedTemplate& resolved = m_resolvedTemplates[usertemplatename];
     std::vector<std::string> usertemplatenames = sofa::helper::split(usertemplatename, ',');
-    std::vector<std::string> deprecatedTemplates;
     for(auto& name : usertemplatenames)
     {
         const sofa::defaulttype::TemplateAlias* alias;
@@ -139,17 +191,32 @@ objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseConte
             /// This alias results in "undefined" behavior.
             if( alias->second )
             {
-                deprecatedTemplates.push_back("The deprecated template '"+name+"' has been replaced by "+alias->first+". As they have different precisions this may result in undefined behavior. To remove this message, please update your scene to use the generic 'Vec3' templates or one of 'Vec3f/Vec3d' that match your the precision of your Sofa binary.");
+                resolved.deprecatedTemplates.push_back("The deprecated template '"+name+"' has been replaced by "+alias->first+". As they have different precisions this may result in undefined behavior. To remove this message, please update your scene to use the generic 'Vec3' templates or one of 'Vec3f/Vec3d' that match your the precision of your Sofa binary.");
             }
 
             name = alias->first;
         }
     }
-    std::string templatename = sofa::helper::join(usertemplatenames, ",");
-    std::string userresolved = templatename; // Copy in case we change for the default one
-    ////////////////////////////////////////////////////////////////////////////////////////////////
+    resolved.name = sofa::helper::join(usertemplatenames, ",");
+    return resolved;
+}
 
 
+objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseContext* context, objectmodel::BaseObjectDescription* arg)
+{
+    const sofa::helper::system::thread::ctime_t startTime = m_profiling ? sofa::helper::system::thread::CTime::getRefTime() : 0;
+    std::size_t nbCanCreate = 0;
+
+    objectmodel::BaseObject::SPtr object = nullptr;
+    std::vector< std::pair<std::string, Creator::SPtr> > creators;
+    std::string classname = arg->getAttribute( "type", "");
+    std::string usertemplatename = arg->getAttribute( "template", "");
+
+    ResolvedTemplate resolvedTemplate = resolveTemplate(usertemplatename);
+    std::vector<std::string>& deprecatedTemplates = resolvedTemplate.deprecatedTemplates;
+    std::string templatename = resolvedTemplate.name;
+    const std::string& userresolved = resolvedTemplate.name; // templatename may be changed for the default one
+
     // In order to get the errors from the creators only, we save the current errors at this point
     // and we clear them. Once we extracted the errors from the creators, we put push them back.
     std::map<std::string, std::vector<std::string>> creators_errors; // (template_name, errors)
@@ -157,18 +224,47 @@ objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseConte
     arg->clearErrors();
 
     // For every classes in the registery
-    ClassEntryMap::iterator it = registry.find(classname);
-    if (it != registry.end()) // Found the classname
+    // What is used of the entry is copied, the creators are called without the lock as they may
+    // load plugins
+    ClassEntry entry;
+    bool found = false;
+    {
+        std::shared_lock<std::shared_mutex> registryLock(m_registryMutex);
+        ClassEntry::SPtr registered = findEntry(classname);
+        if (registered)
+        {
+            found = true;
+            entry.className = registered->className;
+            entry.defaultTemplate = registered->defaultTemplate;
+            entry.creatorMap = registered->creatorMap;
+            entry.m_dataAlias = registered->m_dataAlias;
+        }
+    }
+
+    auto recordStats = [&](bool created)
+    {
+        if (!m_profiling)
+            return;
+        const double t = double(sofa::helper::system::thread::CTime::getRefTime() - startTime)
+                / double(sofa::helper::system::thread::CTime::getRefTicksPerSec());
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ClassStats& stats = m_profilingStats[found ? entry.className : classname];
+        if (created) ++stats.nbCreated; else ++stats.nbFailed;
+        stats.nbCanCreate += nbCanCreate;
+        stats.creationTime += t;
+    };
+
+    if (found) // Found the classname
     {
-        entry = it->second;
         // If no template has been given or if the template does not exist, first try with the default one
-        if(templatename.empty() || entry->creatorMap.find(templatename) == entry->creatorMap.end())
-            templatename = entry->defaultTemplate;
+        if(templatename.empty() || entry.creatorMap.find(templatename) == entry.creatorMap.end())
+            templatename = entry.defaultTemplate;
 
-        CreatorMap::iterator it2 = entry->creatorMap.find(templatename);
-        if (it2 != entry->creatorMap.end())
+        CreatorMap::const_iterator it2 = entry.creatorMap.find(templatename);
+        if (it2 != entry.creatorMap.end())
         {
             Creator::SPtr c = it2->second;
+            ++nbCanCreate;
             if (c->canCreate(context, arg)) {
                 creators.push_back(*it2);
             } else {
@@ -180,13 +276,14 @@ objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseConte
         // If object cannot be created with the given template (or the default one), try all possible ones
         if (creators.empty())
         {
-            CreatorMap::iterator it3;
-            for (it3 = entry->creatorMap.begin(); it3 != entry->creatorMap.end(); ++it3)
+            CreatorMap::const_iterator it3;
+            for (it3 = entry.creatorMap.begin(); it3 != entry.creatorMap.end(); ++it3)
             {
                 if (it3->first == templatename)
                     continue; // We already tried to create the object with the specified (or default) template
 
                 Creator::SPtr c = it3->second;
+                ++nbCanCreate;
                 if (c->canCreate(context, arg)){
                     creators.push_back(*it3);
                 } else {
@@ -211,7 +308,7 @@ objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseConte
         {
             arg->logError( uncreatableComponents.at(classname).getMessage() );
         }
-        else if(it == registry.end())
+        else if(!found)
         {
             arg->logError("The object is not in the factory.");
         }
@@ -224,7 +321,7 @@ objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseConte
                 tmp << "Used template      : None" << msgendl;
             } else {
                 tmp << "Used template      : " << templatename;
-                if (templatename == entry->defaultTemplate) {
+                if (templatename == entry.defaultTemplate) {
                     tmp << " (default)";
                 }
                 tmp << msgendl;
@@ -265,6 +362,7 @@ objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseConte
             }
             arg->logError(tmp.str());
         }
+        recordStats(false);
         return nullptr;
     }
 
@@ -291,7 +389,7 @@ objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseConte
 
     ///////////////////////// All this code is just there to implement the MakeDataAlias component.
     std::vector<std::string> todelete;
-    for(auto& kv : entry->m_dataAlias)
+    for(auto& kv : entry.m_dataAlias)
     {
         if(object->findData(kv.first)==nullptr)
         {
@@ -302,12 +400,19 @@ objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseConte
         }
     }
 
-    for(auto& todeletename : todelete)
+    if (!todelete.empty())
     {
-        entry->m_dataAlias.erase( entry->m_dataAlias.find(todeletename) ) ;
+        std::unique_lock<std::shared_mutex> registryLock(m_registryMutex);
+        ClassEntry::SPtr registered = findEntry(classname);
+        for(auto& todeletename : todelete)
+        {
+            entry.m_dataAlias.erase(todeletename) ;
+            if (registered)
+                registered->m_dataAlias.erase(todeletename) ;
+        }
     }
 
-    for(auto& kv : entry->m_dataAlias)
+    for(auto& kv : entry.m_dataAlias)
     {
         objectmodel::BaseObjectDescription newdesc;
         for(std::string& alias : kv.second){
@@ -329,9 +434,60 @@ objectmodel::BaseObject::SPtr ObjectFactory::createObject(objectmodel::BaseConte
         msg_deprecated(object.get()) << sofa::helper::join(deprecatedTemplates, msgendl) ;
     }
 
+    recordStats(true);
     return object;
 }
 
+void ObjectFactory::addInitTime(const std::string& classname, double seconds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_profilingStats[classname].initTime += seconds;
+}
+
+void ObjectFactory::clearProfilingStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_profilingStats.clear();
+}
+
+void ObjectFactory::dumpProfilingReport(std::ostream& out)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<ClassStatsMap::const_iterator> classes;
+    ClassStats total;
+    for (ClassStatsMap::const_iterator it = m_profilingStats.begin(); it != m_profilingStats.end(); ++it)
+    {
+        classes.push_back(it);
+        total.nbCreated += it->second.nbCreated;
+        total.nbFailed += it->second.nbFailed;
+        total.nbCanCreate += it->second.nbCanCreate;
+        total.creationTime += it->second.creationTime;
+        total.initTime += it->second.initTime;
+    }
+    std::sort(classes.begin(), classes.end(), [](ClassStatsMap::const_iterator a, ClassStatsMap::const_iterator b)
+    {
+        return a->second.creationTime + a->second.initTime > b->second.creationTime + b->second.initTime;
+    });
+
+    out << std::left << std::setw(40) << "Class" << std::right
+        << std::setw(10) << "Created" << std::setw(8) << "Failed" << std::setw(11) << "canCreate"
+        << std::setw(14) << "Create (ms)" << std::setw(12) << "Init (ms)" << std::setw(14) << "Total (ms)" << std::setw(8) << "%" << "\n";
+    const double totalTime = total.creationTime + total.initTime;
+    auto printLine = [&](const std::string& name, const ClassStats& stats)
+    {
+        const double t = stats.creationTime + stats.initTime;
+        out << std::left << std::setw(40) << name << std::right
+            << std::setw(10) << stats.nbCreated << std::setw(8) << stats.nbFailed << std::setw(11) << stats.nbCanCreate
+            << std::fixed << std::setprecision(3)
+            << std::setw(14) << 1000.0*stats.creationTime << std::setw(12) << 1000.0*stats.initTime << std::setw(14) << 1000.0*t
+            << std::setprecision(1) << std::setw(8) << (totalTime > 0 ? 100.0*t/totalTime : 0.0) << "\n";
+        out.unsetf(std::ios_base::floatfield);
+    };
+    for (const auto& it : classes)
+        printLine(it->first, it->second);
+    printLine("TOTAL", total);
+}
+
 ObjectFactory* ObjectFactory::getInstance()
 {
     static ObjectFactory instance;
@@ -340,6 +496,7 @@ ObjectFactory* ObjectFactory::getInstance()
 
 void ObjectFactory::getAllEntries(std::vector<ClassEntry::SPtr>& result)
 {
+    std::shared_lock<std::shared_mutex> registryLock(m_registryMutex);
     result.clear();
     for(ClassEntryMap::iterator it = registry.begin(), itEnd = registry.end();
         it != itEnd; ++it)
@@ -353,6 +510,7 @@ void ObjectFactory::getAllEntries(std::vector<ClassEntry::SPtr>& result)
 
 void ObjectFactory::getEntriesFromTarget(std::vector<ClassEntry::SPtr>& result, std::string target)
 {
+    std::shared_lock<std::shared_mutex> registryLock(m_registryMutex);
     result.clear();
     for(ClassEntryMap::iterator it = registry.begin(), itEnd = registry.end();
         it != itEnd; ++it)
@@ -386,6 +544,7 @@ std::string ObjectFactory::listClassesFromTarget(std::string target, std::string
 
 void ObjectFactory::dump(std::ostream& out)
 {
+    std::shared_lock<std::shared_mutex> registryLock(m_registryMutex);
     for (ClassEntryMap::iterator it = registry.begin(), itend = registry.end(); it != itend; ++it)
     {
         ClassEntry::SPtr entry = it->second;
@@ -431,6 +590,7 @@ static std::string xmlencode(const std::string& str)
 
 void ObjectFactory::dumpXML(std::ostream& out)
 {
+    std::shared_lock<std::shared_mutex> registryLock(m_registryMutex);
     for (ClassEntryMap::iterator it = registry.begin(), itend = registry.end(); it != itend; ++it)
     {
         ClassEntry::SPtr entry = it->second;
@@ -456,6 +616,7 @@ void ObjectFactory::dumpXML(std::ostream& out)
 
 void ObjectFactory::dumpHTML(std::ostream& out)
 {
+    std::shared_lock<std::shared_mutex> registryLock(m_registryMutex);
     out << "<ul>\n";
     for (ClassEntryMap::iterator it = registry.begin(), itend = registry.end(); it != itend; ++it)
     {
@@ -494,6 +655,48 @@ void ObjectFactory::dumpHTML(std::ostream& out)
     out << "</ul>\n";
 }
 
+void ObjectFactory::registerEntry(const ClassEntry& entry)
+{
+    std::vector<std::string> aliases;
+    {
+        ClassEntry& reg = getEntry(entry.className);
+        std::unique_lock<std::shared_mutex> registryLock(m_registryMutex);
+        reg.description += entry.description;
+        reg.authors += entry.authors;
+        reg.license += entry.license;
+        if (!entry.defaultTemplate.empty())
+        {
+            if (!reg.defaultTemplate.empty())
+            {
+                msg_warning("ObjectFactory") << "Default template for class " << entry.className << " already registered (" << reg.defaultTemplate << "), do not register " << entry.defaultTemplate << " as the default";
+            }
+            else
+            {
+                reg.defaultTemplate = entry.defaultTemplate;
+            }
+        }
+        for (CreatorMap::const_iterator itc = entry.creatorMap.begin(), itcend = entry.creatorMap.end(); itc != itcend; ++itc)
+        {
+            if (reg.creatorMap.find(itc->first) != reg.creatorMap.end())
+            {
+                msg_warning("ObjectFactory") << "Class already registered: " << itc->first;
+            }
+            else
+            {
+                reg.creatorMap.insert(*itc);
+            }
+        }
+        for (std::set<std::string>::const_iterator it = entry.aliases.begin(), itend = entry.aliases.end(); it != itend; ++it)
+        {
+            if (reg.aliases.find(*it) == reg.aliases.end())
+                aliases.push_back(*it);
+        }
+    }
+    // addAlias locks the registry itself
+    for (const std::string& alias : aliases)
+        addAlias(alias, entry.className);
+}
+
 RegisterObject::RegisterObject(const std::string& description)
 {
     if (!description.empty())
@@ -557,39 +760,7 @@ RegisterObject::operator int()
     }
     else
     {
-        ObjectFactory::ClassEntry& reg = ObjectFactory::getInstance()->getEntry(entry.className);
-        reg.description += entry.description;
-        reg.authors += entry.authors;
-        reg.license += entry.license;
-        if (!entry.defaultTemplate.empty())
-        {
-            if (!reg.defaultTemplate.empty())
-            {
-                msg_warning("ObjectFactory") << "Default template for class " << entry.className << " already registered (" << reg.defaultTemplate << "), do not register " << entry.defaultTemplate << " as the default";
-            }
-            else
-            {
-                reg.defaultTemplate = entry.defaultTemplate;
-            }
-        }
-        for (ObjectFactory::CreatorMap::iterator itc = entry.creatorMap.begin(), itcend = entry.creatorMap.end(); itc != itcend; ++itc)
-        {
-            if (reg.creatorMap.find(itc->first) != reg.creatorMap.end())
-            {
-                msg_warning("ObjectFactory") << "Class already registered: " << itc->first;
-            }
-            else
-            {
-                reg.creatorMap.insert(*itc);
-            }
-        }
-        for (std::set<std::string>::iterator it = entry.aliases.begin(), itend = entry.aliases.end(); it != itend; ++it)
-        {
-            if (reg.aliases.find(*it) == reg.aliases.end())
-            {
-                ObjectFactory::getInstance()->addAlias(*it,entry.className);
-            }
-        }
+        ObjectFactory::getInstance()->registerEntry(entry);
         return 1;
     }
 }
@@ -24,6 +24,9 @@
 
 #include <sofa/helper/system/config.h>
 #include <sofa/core/objectmodel/BaseObject.h>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
 
 
 namespace sofa
@@ -99,18 +102,70 @@ public:
     };
     typedef std::map<std::string, ClassEntry::SPtr> ClassEntryMap;
 
+    /// Statistics about the creation of the objects of a class, see setProfiling()
+    struct ClassStats
+    {
+        ClassStats() : nbCreated(0), nbFailed(0), nbCanCreate(0), creationTime(0), initTime(0) {}
+        std::size_t nbCreated; ///< number of objects created
+        std::size_t nbFailed; ///< number of objects which could not be created
+        std::size_t nbCanCreate; ///< number of calls to Creator::canCreate()
+        double creationTime; ///< time spent in createObject(), in seconds
+        double initTime; ///< time spent in the initialization of the objects, in seconds (see addInitTime())
+    };
+    typedef std::map<std::string, ClassStats> ClassStatsMap;
+
 protected:
     /// Main class registry
     ClassEntryMap registry;
+    /// Hashed index of the registry used by the lookups, kept in sync by getEntry(), addAlias() and resetAlias()
+    std::unordered_map<std::string, ClassEntry::SPtr> m_entryIndex;
+    /// Protects registry, m_entryIndex and the content of the entries: the plugins may register
+    /// classes while other threads create objects
+    mutable std::shared_mutex m_registryMutex;
     OnCreateCallback m_callbackOnCreate ;
 
+    /// Template name given by the user, once the template aliases are resolved
+    struct ResolvedTemplate
+    {
+        std::string name;
+        std::vector<std::string> deprecatedTemplates;
+    };
+    /// Cache of the resolved template names, cleared when a class or a template alias is registered
+    std::unordered_map<std::string, ResolvedTemplate> m_resolvedTemplates;
+    /// TemplateAliases::getRevision() when m_resolvedTemplates was last cleared
+    unsigned int m_templateAliasesRevision;
+
+    bool m_profiling;
+    ClassStatsMap m_profilingStats;
+    std::mutex m_mutex; ///< protects the caches and the statistics
+
+    /// Get an entry given a class name (or alias), nullptr if it is not registered.
+    /// m_registryMutex must be locked.
+    ClassEntry::SPtr findEntry(const std::string& classname);
+
+    /// Resolve the template aliases of the template name given by the user
+    ResolvedTemplate resolveTemplate(const std::string& usertemplatename);
+
 public:
 
+    ObjectFactory();
     ~ObjectFactory();
 
     /// Get an entry given a class name (or alias)
+    ///
+    /// The content of the returned entry is not protected against the concurrent registrations,
+    /// prefer getCreators() and addDataAlias() when plugins may be loaded by another thread.
     ClassEntry& getEntry(std::string classname);
 
+    /// Copy of the creators registered for a class name (or alias), empty if it is not registered
+    CreatorMap getCreators(const std::string& classname);
+
+    /// Add the alias of a Data to the objects of a class created from now on (see MakeDataAlias)
+    void addDataAlias(const std::string& classname, const std::string& dataname, const std::string& alias);
+
+    /// Merge the description, creators and aliases of a class into the registry, see RegisterObject
+    void registerEntry(const ClassEntry& entry);
+
     /// Test if a creator exists for a given classname
     bool hasCreator(std::string classname);
 
@@ -188,6 +243,24 @@ public:
     void dumpHTML(std::ostream& out = std::cout);
 
     void setCallback(OnCreateCallback cb) { m_callbackOnCreate = cb ; }
+
+    /// @name Profiling of the scene loading
+    /// @{
+
+    /// Record the time spent creating the objects of each class
+    void setProfiling(bool profiling) { m_profiling = profiling; }
+    bool isProfiling() const { return m_profiling; }
+
+    /// Add the time spent initializing an object of the given class (called by the simulation)
+    void addInitTime(const std::string& classname, double seconds);
+
+    const ClassStatsMap& getProfilingStats() const { return m_profilingStats; }
+    void clearProfilingStats();
+
+    /// Print the statistics of each class, sorted by decreasing total time.
+    void dumpProfilingReport(std::ostream& out = std::cout);
+
+    /// @}
 };
 
 /**
@@ -45,6 +45,10 @@ public:
     virtual bool load() = 0;
     virtual bool canLoad() ;
 
+    /// Loaders only read their file and their own Data. The ones changing a process-wide
+    /// state while reading, like the locale, must return false.
+    bool hasSelfContainedInit() const override { return true; }
+
     void parse(objectmodel::BaseObjectDescription *arg) override ;
 
     void setFilename(std::string f)  ;
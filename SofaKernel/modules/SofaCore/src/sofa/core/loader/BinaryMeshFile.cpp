@@ -0,0 +1,296 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/core/loader/BinaryMeshFile.h>
+
+#include <sofa/helper/logging/Messaging.h>
+
+#include <cstdio>
+#include <fstream>
+
+namespace sofa
+{
+
+namespace core
+{
+
+namespace loader
+{
+
+namespace
+{
+
+const char s_magic[8] = { 'S', 'O', 'F', 'A', 'M', 'E', 'S', 'H' };
+const std::uint32_t s_byteOrder = 0x01020304;
+const std::size_t s_alignment = 64;
+
+std::size_t align(std::size_t offset)
+{
+    return (offset + s_alignment - 1) / s_alignment * s_alignment;
+}
+
+template<class T>
+void append(std::vector<char>& buffer, const T& value)
+{
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void appendString(std::vector<char>& buffer, const std::string& str)
+{
+    append(buffer, std::uint32_t(str.size()));
+    buffer.insert(buffer.end(), str.begin(), str.end());
+}
+
+template<class T>
+bool extract(const char*& cursor, const char* end, T& value)
+{
+    if (std::size_t(end - cursor) < sizeof(T))
+        return false;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+}
+
+bool extractString(const char*& cursor, const char* end, std::string& str)
+{
+    std::uint32_t length;
+    if (!extract(cursor, end, length) || std::size_t(end - cursor) < length)
+        return false;
+    str.assign(cursor, length);
+    cursor += length;
+    return true;
+}
+
+} // anonymous namespace
+
+static_assert(sizeof(BinaryMeshFile::Header) == 64, "BinaryMeshFile::Header must be 64 bytes");
+static_assert(sizeof(BinaryMeshFile::SectionEntry) == 32, "BinaryMeshFile::SectionEntry must be 32 bytes");
+
+BinaryMeshFile::BinaryMeshFile()
+{
+}
+
+std::uint64_t BinaryMeshFile::checksum(const char* data, std::size_t size)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool BinaryMeshFile::open(const std::string& filename, bool verifyChecksum)
+{
+    close();
+
+    if (!m_file.open(filename))
+    {
+        m_error = "unable to map the file";
+        return false;
+    }
+
+    Header header;
+    if (m_file.size() < sizeof(Header) || std::memcmp(m_file.data(), s_magic, sizeof(s_magic)) != 0)
+    {
+        m_error = "not a binary mesh file";
+        close();
+        return false;
+    }
+    std::memcpy(&header, m_file.data(), sizeof(Header));
+
+    const std::size_t tableEnd = sizeof(Header) + std::size_t(header.nbSections) * sizeof(SectionEntry);
+    if (header.version > s_version)
+        m_error = "file version " + std::to_string(header.version) + " is not supported";
+    else if (header.byteOrder != s_byteOrder)
+        m_error = "file written with a different byte order";
+    else if (header.fileSize != m_file.size() || tableEnd > m_file.size())
+        m_error = "truncated file";
+    else if (verifyChecksum && checksum(m_file.data() + sizeof(Header), m_file.size() - sizeof(Header)) != header.checksum)
+        m_error = "checksum mismatch";
+    else
+    {
+        m_sections.resize(header.nbSections);
+        if (header.nbSections)
+            std::memcpy(m_sections.data(), m_file.data() + sizeof(Header), header.nbSections * sizeof(SectionEntry));
+        for (const SectionEntry& section : m_sections)
+        {
+            if (section.itemSize == 0 || section.offset < tableEnd || section.offset > m_file.size()
+                    || section.count > (m_file.size() - section.offset) / section.itemSize)
+            {
+                m_error = "section " + std::to_string(section.type) + " is out of the file";
+                close();
+                return false;
+            }
+        }
+        m_error.clear();
+        return true;
+    }
+
+    close();
+    return false;
+}
+
+void BinaryMeshFile::close()
+{
+    m_file.close();
+    m_sections.clear();
+}
+
+const BinaryMeshFile::SectionEntry* BinaryMeshFile::findSection(std::uint32_t type) const
+{
+    for (const SectionEntry& section : m_sections)
+        if (section.type == type)
+            return &section;
+    return nullptr;
+}
+
+bool BinaryMeshFile::readGroups(std::uint32_t type, helper::vector<PrimitiveGroup>& out) const
+{
+    out.clear();
+    const SectionEntry* section = findSection(type);
+    if (!section || section->itemSize != 1)
+        return false;
+
+    const char* cursor = m_file.data() + section->offset;
+    const char* end = cursor + section->count;
+    std::uint32_t nbGroups;
+    if (!extract(cursor, end, nbGroups))
+        return false;
+    out.reserve(nbGroups);
+    for (std::uint32_t i = 0; i < nbGroups; ++i)
+    {
+        std::int32_t p0, nbp, materialId;
+        PrimitiveGroup group;
+        if (!extract(cursor, end, p0) || !extract(cursor, end, nbp) || !extract(cursor, end, materialId)
+                || !extractString(cursor, end, group.groupName) || !extractString(cursor, end, group.materialName))
+        {
+            out.clear();
+            return false;
+        }
+        group.p0 = p0;
+        group.nbp = nbp;
+        group.materialId = materialId;
+        out.push_back(group);
+    }
+    return true;
+}
+
+std::vector<char> BinaryMeshFile::encodeGroups(const helper::vector<PrimitiveGroup>& groups)
+{
+    std::vector<char> buffer;
+    if (groups.empty())
+        return buffer;
+    append(buffer, std::uint32_t(groups.size()));
+    for (const PrimitiveGroup& group : groups)
+    {
+        append(buffer, std::int32_t(group.p0));
+        append(buffer, std::int32_t(group.nbp));
+        append(buffer, std::int32_t(group.materialId));
+        appendString(buffer, group.groupName);
+        appendString(buffer, group.materialName);
+    }
+    return buffer;
+}
+
+bool BinaryMeshFile::write(const std::string& filename, const std::vector<Section>& sections)
+{
+    std::vector<SectionEntry> table;
+    for (const Section& section : sections)
+    {
+        if (section.count == 0)
+            continue;
+        SectionEntry entry;
+        entry.type = section.type;
+        entry.itemSize = section.itemSize;
+        entry.count = section.count;
+        entry.offset = 0;
+        entry.reserved = 0;
+        table.push_back(entry);
+    }
+
+    // Layout of the file: header, table of sections, then each array on an aligned offset
+    std::size_t offset = sizeof(Header) + table.size() * sizeof(SectionEntry);
+    for (SectionEntry& entry : table)
+    {
+        offset = align(offset);
+        entry.offset = offset;
+        offset += entry.count * entry.itemSize;
+    }
+
+    std::vector<char> buffer(offset, 0);
+    if (!table.empty())
+        std::memcpy(buffer.data() + sizeof(Header), table.data(), table.size() * sizeof(SectionEntry));
+    std::size_t entryId = 0;
+    for (const Section& section : sections)
+    {
+        if (section.count == 0)
+            continue;
+        const SectionEntry& entry = table[entryId++];
+        std::memcpy(buffer.data() + entry.offset, section.data, entry.count * entry.itemSize);
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, s_magic, sizeof(s_magic));
+    header.version = s_version;
+    header.byteOrder = s_byteOrder;
+    header.nbSections = std::uint32_t(table.size());
+    header.fileSize = buffer.size();
+    header.checksum = checksum(buffer.data() + sizeof(Header), buffer.size() - sizeof(Header));
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    // Write in a temporary file renamed at the end, so that processes mapping
+    // the previous version of the file never see a partially written mesh.
+    const std::string tmpFilename = filename + ".tmp";
+    {
+        std::ofstream out(tmpFilename.c_str(), std::ofstream::binary | std::ofstream::trunc);
+        if (!out.is_open())
+        {
+            msg_error("BinaryMeshFile") << "Unable to write file " << tmpFilename;
+            return false;
+        }
+        out.write(buffer.data(), std::streamsize(buffer.size()));
+        if (!out.good())
+        {
+            msg_error("BinaryMeshFile") << "Error while writing file " << tmpFilename;
+            return false;
+        }
+    }
+#ifdef WIN32
+    // rename does not replace an existing file on Windows
+    std::remove(filename.c_str());
+#endif
+    if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0)
+    {
+        msg_error("BinaryMeshFile") << "Unable to rename " << tmpFilename << " into " << filename;
+        return false;
+    }
+    return true;
+}
+
+} // namespace loader
+
+} // namespace core
+
+} // namespace sofa
@@ -0,0 +1,171 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_CORE_LOADER_BINARYMESHFILE_H
+#define SOFA_CORE_LOADER_BINARYMESHFILE_H
+
+#include <sofa/core/core.h>
+#include <sofa/helper/vector.h>
+#include <sofa/helper/io/MemoryMappedFile.h>
+#include <sofa/core/loader/PrimitiveGroup.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace sofa
+{
+
+namespace core
+{
+
+namespace loader
+{
+
+/**
+ *  \brief Native binary mesh file, read from a memory mapping.
+ *
+ *  A file starts with a fixed size header (magic, version, byte order, number
+ *  of sections and a checksum of the rest of the file), followed by a table of
+ *  sections and by their payloads. Each section stores a flat array of items
+ *  (positions as 3 doubles, elements as 32 bits indices, groups as encoded
+ *  records), starting on a 64 bytes boundary, so that reading a mesh is a copy
+ *  of each array instead of a parse of its text.
+ */
+class SOFA_CORE_API BinaryMeshFile
+{
+public:
+    enum SectionType : std::uint32_t
+    {
+        POSITIONS = 1, NORMALS,
+        EDGES, TRIANGLES, QUADS, TETRAHEDRA, HEXAHEDRA, PENTAHEDRA, PYRAMIDS,
+        EDGES_GROUPS, TRIANGLES_GROUPS, QUADS_GROUPS, TETRAHEDRA_GROUPS, HEXAHEDRA_GROUPS, PENTAHEDRA_GROUPS, PYRAMIDS_GROUPS
+    };
+
+    static const std::uint32_t s_version = 1;
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t nbSections;
+        std::uint32_t reserved0;
+        std::uint64_t fileSize;
+        std::uint64_t checksum; ///< FNV-1a hash of the file after the header
+        std::uint64_t reserved[3];
+    };
+
+    struct SectionEntry
+    {
+        std::uint32_t type;
+        std::uint32_t itemSize; ///< size in bytes of one item of the array
+        std::uint64_t count;    ///< number of items
+        std::uint64_t offset;   ///< position of the array from the beginning of the file
+        std::uint64_t reserved;
+    };
+
+    /// Array given to write(). The data must stay valid until write() returns.
+    struct Section
+    {
+        Section(std::uint32_t type, std::uint32_t itemSize, std::uint64_t count, const void* data)
+            : type(type), itemSize(itemSize), count(count), data(data) {}
+
+        template<class T>
+        Section(std::uint32_t type, const helper::vector<T>& array)
+            : type(type), itemSize(sizeof(T)), count(array.size()), data(array.data()) {}
+
+        std::uint32_t type;
+        std::uint32_t itemSize;
+        std::uint64_t count;
+        const void* data;
+    };
+
+    BinaryMeshFile();
+
+    /// Map the file and check its header and its table of sections.
+    bool open(const std::string& filename, bool verifyChecksum);
+    void close();
+
+    const std::string& getErrorMessage() const { return m_error; }
+
+    bool hasSection(std::uint32_t type) const { return findSection(type) != nullptr; }
+
+    /// Copy the array of a section into out. Returns false if the section is missing or if its items
+    /// do not have the size of T; out is then left empty.
+    template<class T>
+    bool read(std::uint32_t type, helper::vector<T>& out) const
+    {
+        out.clear();
+        const SectionEntry* section = findSection(type);
+        if (!section || section->itemSize != sizeof(T))
+            return false;
+        out.resize(section->count);
+        if (section->count)
+            std::memcpy(out.data(), m_file.data() + section->offset, section->count * sizeof(T));
+        return true;
+    }
+
+    /// Positions are stored as doubles, they are converted when read with another scalar type.
+    template<class Vec3>
+    bool readPositions(std::uint32_t type, helper::vector<Vec3>& out) const
+    {
+        if (sizeof(Vec3) == 3*sizeof(double))
+            return read(type, out);
+
+        out.clear();
+        const SectionEntry* section = findSection(type);
+        if (!section || section->itemSize != 3*sizeof(double))
+            return false;
+        out.resize(section->count);
+        const double* values = reinterpret_cast<const double*>(m_file.data() + section->offset);
+        for (std::size_t i = 0; i < section->count; ++i)
+            for (unsigned int j = 0; j < 3; ++j)
+                out[i][j] = static_cast<typename Vec3::value_type>(values[3*i+j]);
+        return true;
+    }
+
+    bool readGroups(std::uint32_t type, helper::vector<PrimitiveGroup>& out) const;
+
+    /// Encode groups as the payload of a *_GROUPS section (one byte items).
+    static std::vector<char> encodeGroups(const helper::vector<PrimitiveGroup>& groups);
+
+    /// Write the sections into filename. Empty sections are skipped.
+    static bool write(const std::string& filename, const std::vector<Section>& sections);
+
+    static std::uint64_t checksum(const char* data, std::size_t size);
+
+protected:
+    const SectionEntry* findSection(std::uint32_t type) const;
+
+    helper::io::MemoryMappedFile m_file;
+    std::vector<SectionEntry> m_sections;
+    std::string m_error;
+};
+
+} // namespace loader
+
+} // namespace core
+
+} // namespace sofa
+
+#endif // SOFA_CORE_LOADER_BINARYMESHFILE_H
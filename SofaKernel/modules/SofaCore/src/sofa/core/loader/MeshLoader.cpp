@@ -22,6 +22,8 @@
 #include <sofa/core/loader/MeshLoader.h>
 #include <sofa/helper/io/Mesh.h>
 #include <cstdlib>
+#include <cstdint>
+#include <algorithm>
 
 namespace sofa
 {
@@ -63,6 +65,14 @@ MeshLoader::MeshLoader() : BaseLoader()
   , d_triangulate(initData(&d_triangulate, false, "triangulate", "Divide all polygons into triangles"))
   , d_createSubelements(initData(&d_createSubelements, false, "createSubelements", "Divide all n-D elements into their (n-1)-D boundary elements (e.g. tetrahedra to triangles)"))
   , d_onlyAttachedPoints(initData(&d_onlyAttachedPoints, false, "onlyAttachedPoints", "Only keep points attached to elements of the mesh"))
+  , d_reorderPoints(initData(&d_reorderPoints, false, "reorderPoints", "Renumber the points in Reverse Cuthill-McKee order of the mesh graph, to improve memory locality and reduce the bandwidth of assembled matrices"))
+  , d_reorderElements(initData(&d_reorderElements, false, "reorderElements", "Sort the edges, triangles, quads, tetrahedra and hexahedra along a Morton (Z-order) curve of their barycenters. Element types organized in groups are kept in their order"))
+  , d_originalPointIndices(initData(&d_originalPointIndices, "originalPointIndices", "For each point, its index in the loaded mesh (filled when reorderPoints is set)"))
+  , d_originalEdgeIndices(initData(&d_originalEdgeIndices, "originalEdgeIndices", "For each edge, its index in the loaded mesh (filled when reorderElements is set)"))
+  , d_originalTriangleIndices(initData(&d_originalTriangleIndices, "originalTriangleIndices", "For each triangle, its index in the loaded mesh (filled when reorderElements is set)"))
+  , d_originalQuadIndices(initData(&d_originalQuadIndices, "originalQuadIndices", "For each quad, its index in the loaded mesh (filled when reorderElements is set)"))
+  , d_originalTetrahedronIndices(initData(&d_originalTetrahedronIndices, "originalTetrahedronIndices", "For each tetrahedron, its index in the loaded mesh (filled when reorderElements is set)"))
+  , d_originalHexahedronIndices(initData(&d_originalHexahedronIndices, "originalHexahedronIndices", "For each hexahedron, its index in the loaded mesh (filled when reorderElements is set)"))
   , d_translation(initData(&d_translation, Vec3(), "translation", "Translation of the DOFs"))
   , d_rotation(initData(&d_rotation, Vec3(), "rotation", "Rotation of the DOFs"))
   , d_scale(initData(&d_scale, Vec3(1.0, 1.0, 1.0), "scale3d", "Scale of the DOFs in 3 dimensions"))
@@ -77,6 +87,8 @@ MeshLoader::MeshLoader() : BaseLoader()
     d_triangulate.setAutoLink(false);
     d_createSubelements.setAutoLink(false);
     d_onlyAttachedPoints.setAutoLink(false);
+    d_reorderPoints.setAutoLink(false);
+    d_reorderElements.setAutoLink(false);
     d_translation.setAutoLink(false);
     d_rotation.setAutoLink(false);
     d_scale.setAutoLink(false);
@@ -120,6 +132,27 @@ MeshLoader::MeshLoader() : BaseLoader()
     d_trianglesGroups.setGroup("Groups");
     d_pentahedraGroups.setGroup("Groups");
     d_tetrahedraGroups.setGroup("Groups");
+
+    d_originalPointIndices.setReadOnly(true);
+    d_originalEdgeIndices.setReadOnly(true);
+    d_originalTriangleIndices.setReadOnly(true);
+    d_originalQuadIndices.setReadOnly(true);
+    d_originalTetrahedronIndices.setReadOnly(true);
+    d_originalHexahedronIndices.setReadOnly(true);
+
+    d_originalPointIndices.setPersistent(false);
+    d_originalEdgeIndices.setPersistent(false);
+    d_originalTriangleIndices.setPersistent(false);
+    d_originalQuadIndices.setPersistent(false);
+    d_originalTetrahedronIndices.setPersistent(false);
+    d_originalHexahedronIndices.setPersistent(false);
+
+    d_originalPointIndices.setGroup("Reordering");
+    d_originalEdgeIndices.setGroup("Reordering");
+    d_originalTriangleIndices.setGroup("Reordering");
+    d_originalQuadIndices.setGroup("Reordering");
+    d_originalTetrahedronIndices.setGroup("Reordering");
+    d_originalHexahedronIndices.setGroup("Reordering");
 }
 
 
@@ -146,6 +179,7 @@ void MeshLoader::init()
 {
     BaseLoader::init();
     this->reinit();
+    this->reorderMesh();
 }
 
 void MeshLoader::reinit()
@@ -688,6 +722,325 @@ void MeshLoader::updateNormals()
 }
 
 
+namespace
+{
+
+typedef Topology::PointID PointID;
+
+/// Append the links between all the points of each element.
+template<class Elements>
+void addElementLinks(std::vector< std::pair<PointID, PointID> >& links, const Elements& elems)
+{
+    for (const auto& e : elems)
+        for (size_t j = 0; j < e.size(); ++j)
+            for (size_t k = j + 1; k < e.size(); ++k)
+                if (e[j] != e[k])
+                {
+                    links.emplace_back(e[j], e[k]);
+                    links.emplace_back(e[k], e[j]);
+                }
+}
+
+/// Compressed adjacency of the mesh graph: the neighbors of point i are
+/// neighbors[offsets[i]] ... neighbors[offsets[i+1]-1]
+struct PointGraph
+{
+    std::vector<size_t> offsets;
+    std::vector<PointID> neighbors;
+
+    size_t degree(PointID i) const { return offsets[i + 1] - offsets[i]; }
+};
+
+PointGraph buildPointGraph(size_t nbPoints, std::vector< std::pair<PointID, PointID> >& links)
+{
+    std::sort(links.begin(), links.end());
+    links.erase(std::unique(links.begin(), links.end()), links.end());
+
+    PointGraph graph;
+    graph.offsets.assign(nbPoints + 1, 0);
+    graph.neighbors.reserve(links.size());
+    for (const auto& l : links)
+    {
+        ++graph.offsets[l.first + 1];
+        graph.neighbors.push_back(l.second);
+    }
+    for (size_t i = 0; i < nbPoints; ++i)
+        graph.offsets[i + 1] += graph.offsets[i];
+    return graph;
+}
+
+/// Level structure of a breadth-first traversal
+struct Levels
+{
+    size_t nbLevels;
+    size_t lastLevelBegin; ///< index in the traversal order of the first point of the last level
+};
+
+/// Breadth-first traversal of the component of root, appending the points to order and
+/// marking them with stamp. Neighbors are visited by increasing degree (Cuthill-McKee order).
+Levels breadthFirstOrder(const PointGraph& graph, PointID root, unsigned stamp,
+                         std::vector<unsigned>& marks, std::vector<PointID>& order)
+{
+    Levels levels = { 0, order.size() };
+    size_t levelEnd = order.size();
+    marks[root] = stamp;
+    order.push_back(root);
+    std::vector<PointID> next;
+    for (size_t k = levels.lastLevelBegin; k < order.size(); ++k)
+    {
+        if (k == levelEnd)
+        {
+            ++levels.nbLevels;
+            levels.lastLevelBegin = k;
+            levelEnd = order.size();
+        }
+        const PointID p = order[k];
+        next.clear();
+        for (size_t n = graph.offsets[p]; n < graph.offsets[p + 1]; ++n)
+        {
+            const PointID q = graph.neighbors[n];
+            if (marks[q] != stamp)
+            {
+                marks[q] = stamp;
+                next.push_back(q);
+            }
+        }
+        std::sort(next.begin(), next.end(), [&graph](PointID a, PointID b)
+        {
+            const size_t da = graph.degree(a), db = graph.degree(b);
+            return da < db || (da == db && a < b);
+        });
+        order.insert(order.end(), next.begin(), next.end());
+    }
+    return levels;
+}
+
+/// Reverse Cuthill-McKee ordering of the points. Each connected component is started
+/// from a pseudo-peripheral point found with the George-Liu heuristic.
+/// Returns, for each new index, the previous index of the point.
+helper::vector<PointID> reverseCuthillMcKee(const PointGraph& graph)
+{
+    const size_t nbPoints = graph.offsets.size() - 1;
+
+    std::vector<PointID> byDegree(nbPoints);
+    for (size_t i = 0; i < nbPoints; ++i)
+        byDegree[i] = PointID(i);
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&graph](PointID a, PointID b)
+    {
+        return graph.degree(a) < graph.degree(b);
+    });
+
+    std::vector<unsigned> marks(nbPoints, 0);
+    std::vector<bool> placed(nbPoints, false);
+    unsigned stamp = 0;
+    helper::vector<PointID> order;
+    order.reserve(nbPoints);
+    std::vector<PointID> component, trial;
+
+    for (PointID start : byDegree)
+    {
+        if (placed[start])
+            continue;
+
+        component.clear();
+        Levels levels = breadthFirstOrder(graph, start, ++stamp, marks, component);
+        for (;;)
+        {
+            PointID candidate = component[levels.lastLevelBegin];
+            for (size_t k = levels.lastLevelBegin + 1; k < component.size(); ++k)
+                if (graph.degree(component[k]) < graph.degree(candidate))
+                    candidate = component[k];
+
+            trial.clear();
+            const Levels candidateLevels = breadthFirstOrder(graph, candidate, ++stamp, marks, trial);
+            if (candidateLevels.nbLevels <= levels.nbLevels)
+                break;
+            levels = candidateLevels;
+            component.swap(trial);
+        }
+
+        for (PointID p : component)
+            placed[p] = true;
+        order.insert(order.end(), component.begin(), component.end());
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+/// Spread the 21 lowest bits of x so that there are two zero bits between each of them.
+std::uint64_t spreadBits(std::uint64_t x)
+{
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffull;
+    x = (x | x << 16) & 0x1f0000ff0000ffull;
+    x = (x | x << 8) & 0x100f00f00f00f00full;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+    x = (x | x << 2) & 0x1249249249249249ull;
+    return x;
+}
+
+/// Sort the elements by the Morton code of their barycenter in the bounding box of the points,
+/// and store in originalIndices the previous index of each element.
+/// Elements organized in groups are left untouched, and false is returned.
+template<class Element>
+bool sortAlongMortonCurve(Data< helper::vector<Element> >& data, const Data< helper::vector<PrimitiveGroup> >& groups,
+                          Data< helper::vector<Topology::ElemID> >& originalIndices, const helper::vector<Vec3>& positions)
+{
+    if (!groups.getValue().empty())
+        return false;
+
+    Vec3 bbmin, bbmax;
+    if (!positions.empty())
+        bbmin = bbmax = positions[0];
+    for (const Vec3& p : positions)
+        for (unsigned c = 0; c < 3; ++c)
+        {
+            bbmin[c] = std::min(bbmin[c], p[c]);
+            bbmax[c] = std::max(bbmax[c], p[c]);
+        }
+    const SReal maxCoord = SReal((1 << 21) - 1);
+    Vec3 scale;
+    for (unsigned c = 0; c < 3; ++c)
+        scale[c] = (bbmax[c] > bbmin[c]) ? maxCoord / (bbmax[c] - bbmin[c]) : SReal(0);
+
+    helper::WriteAccessor<Data< helper::vector<Element> > > elems = data;
+    std::vector<std::uint64_t> codes(elems.size());
+    for (size_t i = 0; i < elems.size(); ++i)
+    {
+        Vec3 center;
+        for (size_t j = 0; j < elems[i].size(); ++j)
+            center += positions[elems[i][j]];
+        center /= SReal(elems[i].size());
+        std::uint64_t code = 0;
+        for (unsigned c = 0; c < 3; ++c)
+        {
+            const SReal q = std::min(std::max((center[c] - bbmin[c]) * scale[c], SReal(0)), maxCoord);
+            code |= spreadBits(std::uint64_t(q)) << c;
+        }
+        codes[i] = code;
+    }
+
+    helper::vector<Topology::ElemID> order(elems.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = Topology::ElemID(i);
+    std::stable_sort(order.begin(), order.end(), [&codes](Topology::ElemID a, Topology::ElemID b)
+    {
+        return codes[a] < codes[b];
+    });
+
+    const helper::vector<Element> previous(elems.begin(), elems.end());
+    for (size_t i = 0; i < order.size(); ++i)
+        elems[i] = previous[order[i]];
+    originalIndices.setValue(order);
+    return true;
+}
+
+template<class Elements>
+void renumberPoints(Data<Elements>& data, const helper::vector<PointID>& old2new)
+{
+    helper::WriteAccessor<Data<Elements> > elems = data;
+    for (size_t i = 0; i < elems.size(); ++i)
+        for (size_t j = 0; j < elems[i].size(); ++j)
+            elems[i][j] = old2new[elems[i][j]];
+}
+
+} // anonymous namespace
+
+void MeshLoader::reorderMesh()
+{
+    if (!d_reorderPoints.getValue() && !d_reorderElements.getValue())
+        return;
+
+    if (!d_highOrderEdgePositions.getValue().empty() || !d_highOrderTrianglePositions.getValue().empty()
+        || !d_highOrderQuadPositions.getValue().empty() || !d_highOrderTetrahedronPositions.getValue().empty()
+        || !d_highOrderHexahedronPositions.getValue().empty())
+    {
+        msg_warning() << "Reordering is not supported for meshes with high order positions: the mesh is kept in its loaded order.";
+        return;
+    }
+
+    if (d_reorderPoints.getValue())
+    {
+        const size_t nbPoints = d_positions.getValue().size();
+
+        std::vector< std::pair<PointID, PointID> > links;
+        addElementLinks(links, d_edges.getValue());
+        addElementLinks(links, d_triangles.getValue());
+        addElementLinks(links, d_quads.getValue());
+        addElementLinks(links, d_polygons.getValue());
+        addElementLinks(links, d_tetrahedra.getValue());
+        addElementLinks(links, d_hexahedra.getValue());
+        addElementLinks(links, d_pentahedra.getValue());
+        addElementLinks(links, d_pyramids.getValue());
+        for (const Polyline& polyline : d_polylines.getValue())
+            for (size_t j = 1; j < polyline.size(); ++j)
+            {
+                links.emplace_back(polyline[j - 1], polyline[j]);
+                links.emplace_back(polyline[j], polyline[j - 1]);
+            }
+
+        for (const auto& l : links)
+            if (l.first >= nbPoints)
+            {
+                msg_warning() << "Element referencing point " << l.first << " while the mesh has " << nbPoints << " points: the points are kept in their loaded order.";
+                return;
+            }
+
+        const helper::vector<PointID> pointOrder = reverseCuthillMcKee(buildPointGraph(nbPoints, links));
+        helper::vector<PointID> old2new(nbPoints);
+        for (size_t i = 0; i < nbPoints; ++i)
+            old2new[pointOrder[i]] = PointID(i);
+
+        {
+            helper::WriteAccessor<Data<helper::vector<Vec3> > > positions = d_positions;
+            helper::vector<Vec3> previous(positions.begin(), positions.end());
+            for (size_t i = 0; i < nbPoints; ++i)
+                positions[i] = previous[pointOrder[i]];
+        }
+        if (d_normals.getValue().size() == nbPoints)
+        {
+            helper::WriteAccessor<Data<helper::vector<Vec3> > > normals = d_normals;
+            helper::vector<Vec3> previous(normals.begin(), normals.end());
+            for (size_t i = 0; i < nbPoints; ++i)
+                normals[i] = previous[pointOrder[i]];
+        }
+
+        renumberPoints(d_polylines, old2new);
+        renumberPoints(d_edges, old2new);
+        renumberPoints(d_triangles, old2new);
+        renumberPoints(d_quads, old2new);
+        renumberPoints(d_polygons, old2new);
+        renumberPoints(d_tetrahedra, old2new);
+        renumberPoints(d_hexahedra, old2new);
+        renumberPoints(d_pentahedra, old2new);
+        renumberPoints(d_pyramids, old2new);
+
+        d_originalPointIndices.setValue(pointOrder);
+        reorderPointData(pointOrder);
+    }
+
+    if (d_reorderElements.getValue())
+    {
+        const helper::vector<Vec3>& positions = d_positions.getValue();
+        if (!sortAlongMortonCurve(d_edges, d_edgesGroups, d_originalEdgeIndices, positions))
+            msg_info() << "Edges are organized in groups, they are kept in their loaded order.";
+        if (!sortAlongMortonCurve(d_triangles, d_trianglesGroups, d_originalTriangleIndices, positions))
+            msg_info() << "Triangles are organized in groups, they are kept in their loaded order.";
+        if (!sortAlongMortonCurve(d_quads, d_quadsGroups, d_originalQuadIndices, positions))
+            msg_info() << "Quads are organized in groups, they are kept in their loaded order.";
+        if (!sortAlongMortonCurve(d_tetrahedra, d_tetrahedraGroups, d_originalTetrahedronIndices, positions))
+            msg_info() << "Tetrahedra are organized in groups, they are kept in their loaded order.";
+        if (!sortAlongMortonCurve(d_hexahedra, d_hexahedraGroups, d_originalHexahedronIndices, positions))
+            msg_info() << "Hexahedra are organized in groups, they are kept in their loaded order.";
+    }
+}
+
+void MeshLoader::reorderPointData(const helper::vector<Topology::PointID>& /*pointOrder*/)
+{
+}
+
+
 void MeshLoader::applyTransformation(Matrix4 const& T)
 {
     if (!T.isTransform())
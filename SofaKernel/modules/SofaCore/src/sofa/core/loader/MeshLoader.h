@@ -174,6 +174,18 @@ public:
     Data< bool > d_triangulate; ///< Divide all polygons into triangles
     Data< bool > d_createSubelements; ///< Divide all n-D elements into their (n-1)-D boundary elements (e.g. tetrahedra to triangles)
     Data< bool > d_onlyAttachedPoints; ///< Only keep points attached to elements of the mesh
+    Data< bool > d_reorderPoints; ///< Renumber the points in Reverse Cuthill-McKee order of the mesh graph
+    Data< bool > d_reorderElements; ///< Sort the elements of each type along a Morton (Z-order) curve of their barycenters
+
+    /// @name Permutations applied by the reordering: for each new index, the index in the loaded mesh.
+    /// @{
+    Data< helper::vector< Topology::PointID > > d_originalPointIndices; ///< OUTPUT: index in the loaded mesh of each point
+    Data< helper::vector< Topology::EdgeID > > d_originalEdgeIndices; ///< OUTPUT: index in the loaded mesh of each edge
+    Data< helper::vector< Topology::TriangleID > > d_originalTriangleIndices; ///< OUTPUT: index in the loaded mesh of each triangle
+    Data< helper::vector< Topology::QuadID > > d_originalQuadIndices; ///< OUTPUT: index in the loaded mesh of each quad
+    Data< helper::vector< Topology::TetrahedronID > > d_originalTetrahedronIndices; ///< OUTPUT: index in the loaded mesh of each tetrahedron
+    Data< helper::vector< Topology::HexahedronID > > d_originalHexahedronIndices; ///< OUTPUT: index in the loaded mesh of each hexahedron
+    /// @}
 
     Data< Vec3 > d_translation; ///< Translation of the DOFs
     Data< Vec3 > d_rotation; ///< Rotation of the DOFs
@@ -186,8 +198,16 @@ public:
     virtual void updatePoints();
     virtual void updateNormals();
 
+    /// Apply the point and element reorderings requested by d_reorderPoints and d_reorderElements.
+    /// Called once at init, after the mesh is updated.
+    virtual void reorderMesh();
+
 protected:
 
+    /// Called by reorderMesh after the points were renumbered, so that derived loaders can
+    /// permute their own per-point Data. pointOrder[i] is the previous index of the new point i.
+    virtual void reorderPointData(const helper::vector<Topology::PointID>& pointOrder);
+
     /// to be able to call reinit w/o applying several time the same transform
     defaulttype::Matrix4 d_previousTransformation;
 
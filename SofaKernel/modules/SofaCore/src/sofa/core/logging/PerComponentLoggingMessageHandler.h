@@ -63,6 +63,9 @@ public:
 
     /// Inherited from MessageHandler
     void process(Message& m) override ;
+
+    /// The message is stored in its component while the component is known to exist
+    bool isSynchronous() const override { return true; }
 } ;
 
 ///
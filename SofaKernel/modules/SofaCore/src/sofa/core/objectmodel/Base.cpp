@@ -78,6 +78,8 @@ Base::Base()
 
 Base::~Base()
 {
+    // no message emitted by this component may still be waiting to be processed
+    sofa::helper::logging::MessageDispatcher::flush();
 }
 
 void Base::addRef()
@@ -231,6 +233,7 @@ void Base::processStream(std::ostream& out)
 
 void Base::addMessage(const Message &m) const
 {
+    std::lock_guard<std::mutex> guard(m_messageslogMutex);
     if(m_messageslog.size() >= ERROR_LOG_SIZE ){
         m_messageslog.pop_front();
     }
@@ -239,6 +242,7 @@ void Base::addMessage(const Message &m) const
 
 void Base::clearLoggedMessages() const
 {
+   std::lock_guard<std::mutex> guard(m_messageslogMutex);
    m_messageslog.clear() ;
 }
 
@@ -251,6 +255,7 @@ const std::deque<sofa::helper::logging::Message>& Base::getLoggedMessages() cons
 const std::string Base::getLoggedMessagesAsString(const sofa::helper::logging::Message::TypeSet t) const
 {
     std::stringstream tmpstr ;
+    std::lock_guard<std::mutex> guard(m_messageslogMutex);
     for(Message& m : m_messageslog){
         if( t.find(m.type()) !=  t.end() )
         {
@@ -263,6 +268,7 @@ const std::string Base::getLoggedMessagesAsString(const sofa::helper::logging::M
 size_t Base::countLoggedMessages(const sofa::helper::logging::Message::TypeSet t) const
 {
     size_t tmp=0;
+    std::lock_guard<std::mutex> guard(m_messageslogMutex);
     for(Message& m : m_messageslog){
         if( t.find(m.type()) !=  t.end() )
         {
@@ -572,7 +578,7 @@ static std::string xmlencode(const std::string& str)
     return res;
 }
 
-void  Base::writeDatas (std::ostream& out, const std::string& separator)
+void  Base::writeDatas (std::ostream& out, const std::string& separator, std::size_t binaryThreshold)
 {
     for(VecData::const_iterator iData = m_vecData.begin(); iData != m_vecData.end(); ++iData)
     {
@@ -585,6 +591,13 @@ void  Base::writeDatas (std::ostream& out, const std::string& separator)
         {
             if(field->isPersistent() && field->isSet())
             {
+                if (binaryThreshold && field->isBinarySerializable()
+                        && field->getValueTypeInfo()->size(field->getValueVoidPtr()) >= binaryThreshold)
+                {
+                    // base64 does not need to be xml encoded
+                    out << separator << field->getName() << "=\""<< field->getValueBase64() << "\" ";
+                    continue;
+                }
                 std::string val = field->getValueString();
                 if (!val.empty())
                     out << separator << field->getName() << "=\""<< xmlencode(val) << "\" ";
@@ -615,6 +628,7 @@ const std::string Base::getWarnings() const
                              " To remove this warning you need to use getLoggedMessage() instead. ";
 
     std::stringstream tmpstr ;
+    std::lock_guard<std::mutex> guard(m_messageslogMutex);
     for(Message& m : m_messageslog){
         if(m.type()==Message::Error || m.type()==Message::Warning || m.type()==Message::Fatal)
         {
@@ -631,6 +645,7 @@ const std::string Base::getOutputs() const
                               " To remove this warning you need to use getLoggedMessage() instead. ";
 
     std::stringstream tmpstr ;
+    std::lock_guard<std::mutex> guard(m_messageslogMutex);
     for(Message& m : m_messageslog){
         if(m.type()==Message::Info || m.type()==Message::Advice || m.type()==Message::Deprecated){
             tmpstr << m.messageAsString() ;
@@ -31,6 +31,7 @@
 #include <sofa/core/sptr.h>
 
 #include <deque>
+#include <mutex>
 
 #include <sofa/core/objectmodel/ComponentState.h>
 
@@ -242,8 +243,10 @@ public:
     void writeDatas (std::map<std::string,std::string*>& str);
 
     /// Write the current field values to the given output stream
-    /// separated with the given separator (" " used by default for XML)
-    void writeDatas (std::ostream& out, const std::string& separator = " ");
+    /// separated with the given separator (" " used by default for XML).
+    /// Values of at least binaryThreshold integers or scalars (if not 0) are written in base64
+    /// (see BaseData::getValueBase64()), which is much faster for large vectors.
+    void writeDatas (std::ostream& out, const std::string& separator = " ", std::size_t binaryThreshold = 0);
 
     /// Find a data field given its name. Return nullptr if not found.
     /// If more than one field is found (due to aliases), only the first is returned.
@@ -355,6 +358,8 @@ private:
     /// effective ostringstream for logging
     mutable std::ostringstream _serr, _sout;
     mutable std::deque<sofa::helper::logging::Message> m_messageslog ;
+    /// messages can be logged by several threads at the same time
+    mutable std::mutex m_messageslogMutex ;
 
 public:
     /// write into component buffer + Message processedby message handlers
@@ -378,6 +383,8 @@ public:
 
     void addMessage(const sofa::helper::logging::Message& m) const ;
     size_t  countLoggedMessages(sofa::helper::logging::Message::TypeSet t=sofa::helper::logging::Message::AnyTypes) const ;
+    /// The log is not protected while it is read: no message may be emitted by this component
+    /// at the same time, unlike with the other accessors.
     const std::deque<sofa::helper::logging::Message>& getLoggedMessages() const ;
     const std::string getLoggedMessagesAsString(sofa::helper::logging::Message::TypeSet t=sofa::helper::logging::Message::AnyTypes) const ;
 
@@ -24,6 +24,7 @@
 #include <sofa/helper/BackTrace.h>
 #include <sofa/helper/StringUtils.h>
 #include <sofa/helper/logging/Messaging.h>
+#include <cstring>
 
 namespace sofa
 {
@@ -305,6 +306,158 @@ bool BaseData::copyValue(const BaseData* parent)
     return false;
 }
 
+namespace
+{
+
+/// Header of the binary form of a Data value
+struct BinaryHeader
+{
+    uint64_t nbValues;
+    uint32_t valueByteSize;
+    uint32_t valueKind;
+};
+
+enum { BINARY_INTEGER = 1, BINARY_SCALAR = 2 };
+
+const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void base64Encode(const std::vector<char>& in, std::string& out)
+{
+    const std::size_t n = in.size();
+    out.reserve(out.size() + 4*((n+2)/3));
+    std::size_t i = 0;
+    for (; i+2 < n; i += 3)
+    {
+        const uint32_t v = (uint32_t((unsigned char)in[i]) << 16) | (uint32_t((unsigned char)in[i+1]) << 8) | uint32_t((unsigned char)in[i+2]);
+        out += base64Chars[(v >> 18) & 63];
+        out += base64Chars[(v >> 12) & 63];
+        out += base64Chars[(v >> 6) & 63];
+        out += base64Chars[v & 63];
+    }
+    if (i < n)
+    {
+        uint32_t v = uint32_t((unsigned char)in[i]) << 16;
+        if (i+1 < n) v |= uint32_t((unsigned char)in[i+1]) << 8;
+        out += base64Chars[(v >> 18) & 63];
+        out += base64Chars[(v >> 12) & 63];
+        out += (i+1 < n) ? base64Chars[(v >> 6) & 63] : '=';
+        out += '=';
+    }
+}
+
+bool base64Decode(const char* in, std::size_t n, std::vector<char>& out)
+{
+    static signed char table[256] = { 0 };
+    static bool tableInit = [] () {
+        for (int c = 0; c < 256; ++c) table[c] = -1;
+        for (int c = 0; c < 64; ++c) table[(unsigned char)base64Chars[c]] = (signed char)c;
+        return true;
+    } ();
+    (void)tableInit;
+
+    out.reserve(3*(n/4));
+    uint32_t v = 0;
+    int bits = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const unsigned char c = (unsigned char)in[i];
+        if (c == '=') break;
+        if (c == ' ' || c == '\n' || c == '\r' || c == '\t') continue;
+        const signed char d = table[c];
+        if (d < 0) return false;
+        v = (v << 6) | uint32_t(d);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            out.push_back((char)((v >> bits) & 0xFF));
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+bool BaseData::isBinarySerializable() const
+{
+    const defaulttype::AbstractTypeInfo* info = getValueTypeInfo();
+    if (!info->ValidInfo() || !info->SimpleLayout() || info->Text() || !(info->Integer() || info->Scalar()))
+        return false;
+    // the values must be stored contiguously, without padding
+    const defaulttype::AbstractTypeInfo* valueInfo = info->ValueType();
+    return valueInfo->FixedSize() && valueInfo->size() == 1 && valueInfo->byteSize() == info->byteSize();
+}
+
+bool BaseData::writeBinary(std::vector<char>& buffer) const
+{
+    if (!isBinarySerializable())
+        return false;
+    const defaulttype::AbstractTypeInfo* info = getValueTypeInfo();
+    const void* value = getValueVoidPtr();
+
+    BinaryHeader header;
+    header.nbValues = info->size(value);
+    header.valueByteSize = (uint32_t)info->byteSize();
+    header.valueKind = info->Integer() ? BINARY_INTEGER : BINARY_SCALAR;
+    const std::size_t nbBytes = (std::size_t)header.nbValues * header.valueByteSize;
+
+    const std::size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(BinaryHeader) + nbBytes);
+    std::memcpy(&buffer[offset], &header, sizeof(BinaryHeader));
+    if (nbBytes)
+        std::memcpy(&buffer[offset + sizeof(BinaryHeader)], info->getValuePtr(value), nbBytes);
+    return true;
+}
+
+std::size_t BaseData::readBinary(const char* buffer, std::size_t size)
+{
+    if (size < sizeof(BinaryHeader) || !isBinarySerializable())
+        return 0;
+    const defaulttype::AbstractTypeInfo* info = getValueTypeInfo();
+
+    BinaryHeader header;
+    std::memcpy(&header, buffer, sizeof(BinaryHeader));
+    if (header.valueByteSize != info->byteSize()
+            || header.valueKind != (uint32_t)(info->Integer() ? BINARY_INTEGER : BINARY_SCALAR))
+    {
+        if (m_owner)
+            msg_warning(m_owner) << "Data " << getName() << ": the binary value (" << header.valueByteSize << " bytes "
+                                 << (header.valueKind == BINARY_INTEGER ? "integers" : "scalars") << ") does not match the type " << info->name() << ".";
+        return 0;
+    }
+    const std::size_t nbBytes = (std::size_t)header.nbValues * header.valueByteSize;
+    if (size - sizeof(BinaryHeader) < nbBytes)
+        return 0;
+
+    void* value = beginEditVoidPtr();
+    info->setSize(value, (std::size_t)header.nbValues);
+    const bool sizeMatches = (info->size(value) == header.nbValues);
+    if (sizeMatches && nbBytes)
+        std::memcpy(info->getValuePtr(value), buffer + sizeof(BinaryHeader), nbBytes);
+    endEditVoidPtr();
+    return sizeMatches ? sizeof(BinaryHeader) + nbBytes : 0;
+}
+
+std::string BaseData::getValueBase64() const
+{
+    std::vector<char> buffer;
+    if (!writeBinary(buffer))
+        return std::string();
+    std::string value("base64:");
+    base64Encode(buffer, value);
+    return value;
+}
+
+bool BaseData::readBase64(const std::string& value)
+{
+    if (!isBase64Value(value))
+        return false;
+    std::vector<char> buffer;
+    if (!base64Decode(value.c_str() + 7, value.size() - 7, buffer))
+        return false;
+    return readBinary(buffer.data(), buffer.size()) == buffer.size();
+}
+
 bool BaseData::findDataLinkDest(DDGNode*& ptr, const std::string& path, const BaseLink* link)
 {
     return DDGNode::findDataLinkDest(ptr, path, link);
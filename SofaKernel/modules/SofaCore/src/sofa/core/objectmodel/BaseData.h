@@ -24,6 +24,7 @@
 
 #include <sofa/core/core.h>
 #include <sofa/core/objectmodel/DDGNode.h>
+#include <vector>
 
 namespace sofa
 {
@@ -158,6 +159,35 @@ public:
     /// @return true if the copy was successful.
     virtual bool copyValue(const BaseData* parent);
 
+    /// @name Binary serialization
+    /// Values made of integers or scalars stored contiguously in memory (i.e. SimpleLayout types
+    /// such as vector<Vec3d> or vector<unsigned int>) can be serialized as raw memory instead of
+    /// going through text streams. The binary form is a small header (number of values, size and
+    /// kind of a value) followed by the values in the native byte order.
+    /// @{
+
+    /// Returns true if the value can be serialized in binary form.
+    bool isBinarySerializable() const;
+
+    /// Append the binary form of the value to the buffer.
+    /// \return false if the value can not be serialized in binary form.
+    bool writeBinary(std::vector<char>& buffer) const;
+
+    /// Assign the value from its binary form.
+    /// \return the number of bytes read from the buffer, or 0 on failure.
+    std::size_t readBinary(const char* buffer, std::size_t size);
+
+    /// Get the binary form of the value encoded in base64 and prefixed by "base64:", which is
+    /// also accepted by read(). Returns an empty string if the value can not be serialized in binary form.
+    std::string getValueBase64() const;
+
+    /// Assign the value from a string returned by getValueBase64().
+    bool readBase64(const std::string& value);
+
+    /// Returns true if the string was produced by getValueBase64().
+    static bool isBase64Value(const std::string& value) { return value.compare(0, 7, "base64:") == 0; }
+    /// @}
+
     /// Get a help message that describes this %Data.
     const std::string& getHelp() const { return help; }
 
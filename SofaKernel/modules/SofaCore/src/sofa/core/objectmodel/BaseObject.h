@@ -102,6 +102,10 @@ public:
     /// Initialization method called at graph creation and modification, during bottom-up traversal.
     virtual void bwdInit();
 
+    /// Returns true if init() only reads the Data of this object (no lookup in the context),
+    /// so that it can be run concurrently with the init() of other such objects.
+    virtual bool hasSelfContainedInit() const { return false; }
+
     /// Update method called when variables used in precomputation are modified.
     virtual void reinit();
 
@@ -114,6 +118,15 @@ public:
     /// Reset to initial state
     virtual void reset();
 
+    /// Append to the buffer the state of this object which is not stored in its Data
+    /// (warm start, cached rotations...), see simulation::Checkpoint
+    virtual void writeInternalState(std::vector<char>& buffer) const { SOFA_UNUSED(buffer); }
+
+    /// Restore the state written by writeInternalState(). Called after the Data of the object
+    /// were restored, if one of them was modified since the checkpoint or if the buffer is not empty.
+    /// Returns false if the buffer could not be read.
+    virtual bool readInternalState(const char* buffer, std::size_t size) { SOFA_UNUSED(buffer); return size == 0; }
+
     /// Called just before deleting this object
     /// Any object in the tree bellow this object that are to be removed will be removed only after this call,
     /// so any references this object holds should still be valid.
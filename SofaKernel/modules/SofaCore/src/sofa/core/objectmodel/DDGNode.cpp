@@ -23,6 +23,11 @@
 #include <sofa/core/objectmodel/BaseData.h>
 #include <sofa/core/objectmodel/Base.h>
 #include <sofa/core/DataEngine.h>
+#include <sofa/helper/system/thread/thread_specific_ptr.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 //#define SOFA_DDG_TRACE
 
@@ -35,6 +40,77 @@ namespace core
 namespace objectmodel
 {
 
+namespace
+{
+
+/// Propagation counters of a thread. Only their thread increments them, the other threads
+/// only read them, so the hot path has no shared cache line nor locked instruction.
+struct ThreadCounters
+{
+    std::atomic<std::size_t> nbPropagations {0};
+    std::atomic<std::size_t> nbDirtyValues {0};
+    std::atomic<std::size_t> nbShortCircuits {0};
+    std::atomic<std::size_t> nbDeferred {0};
+};
+
+void increment(std::atomic<std::size_t>& counter)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/// counters of all the threads which propagated dirty flags, kept after the end of the thread
+std::mutex s_countersMutex;
+std::vector<ThreadCounters*> s_allCounters;
+/// sum of the counters when resetPropagationCounters was called
+DDGNode::PropagationCounters s_resetCounters = { 0, 0, 0, 0 };
+
+SOFA_THREAD_SPECIFIC_PTR(ThreadCounters, s_threadCounters);
+
+ThreadCounters& threadCounters()
+{
+    ThreadCounters* counters = s_threadCounters;
+    if (!counters)
+    {
+        counters = new ThreadCounters;
+        std::lock_guard<std::mutex> lock(s_countersMutex);
+        s_allCounters.push_back(counters);
+        s_threadCounters = counters;
+    }
+    return *counters;
+}
+
+DDGNode::PropagationCounters load(const ThreadCounters& c)
+{
+    DDGNode::PropagationCounters counters;
+    counters.nbPropagations = c.nbPropagations.load(std::memory_order_relaxed);
+    counters.nbDirtyValues = c.nbDirtyValues.load(std::memory_order_relaxed);
+    counters.nbShortCircuits = c.nbShortCircuits.load(std::memory_order_relaxed);
+    counters.nbDeferred = c.nbDeferred.load(std::memory_order_relaxed);
+    return counters;
+}
+
+/// sum of the counters of all the threads, s_countersMutex must be locked
+DDGNode::PropagationCounters sumCounters()
+{
+    DDGNode::PropagationCounters sum = { 0, 0, 0, 0 };
+    for (const ThreadCounters* c : s_allCounters)
+    {
+        const DDGNode::PropagationCounters counters = load(*c);
+        sum.nbPropagations += counters.nbPropagations;
+        sum.nbDirtyValues += counters.nbDirtyValues;
+        sum.nbShortCircuits += counters.nbShortCircuits;
+        sum.nbDeferred += counters.nbDeferred;
+    }
+    return sum;
+}
+
+std::atomic<unsigned int> s_lastBatchEpoch(0);
+
+/// outermost BatchEdit of the current thread
+SOFA_THREAD_SPECIFIC_PTR(DDGNode::BatchEdit, s_currentBatch);
+
+} // anonymous namespace
+
 /// Constructor
 DDGNode::DDGNode()
     : inputs(initLink("inputs", "Links to inputs Data"))
@@ -44,6 +120,9 @@ DDGNode::DDGNode()
 
 DDGNode::~DDGNode()
 {
+    BatchEdit* batch = s_currentBatch;
+    if (batch && dirtyFlags.batchEpoch == batch->m_epoch)
+        batch->m_pending.erase(std::remove(batch->m_pending.begin(), batch->m_pending.end(), this), batch->m_pending.end());
     for(DDGLinkIterator it=inputs.begin(); it!=inputs.end(); ++it)
         (*it)->doDelOutput(this);
     for(DDGLinkIterator it=outputs.begin(); it!=outputs.end(); ++it)
@@ -62,33 +141,111 @@ TClass<DDGNode,void>::TClass()
 
 void DDGNode::setDirtyValue()
 {
-    bool& dirtyValue = dirtyFlags.dirtyValue;
-    if (!dirtyValue)
+    std::atomic<bool>& dirtyValue = dirtyFlags.dirtyValue;
+    if (!dirtyValue.load(std::memory_order_relaxed))
     {
-        dirtyValue = true;
+        dirtyValue.store(true, std::memory_order_relaxed);
+        increment(threadCounters().nbDirtyValues);
         setDirtyOutputs();
     }
 }
 
 void DDGNode::setDirtyOutputs()
 {
-    bool& dirtyOutputs = dirtyFlags.dirtyOutputs;
-    if (!dirtyOutputs)
+    std::atomic<bool>& dirtyOutputs = dirtyFlags.dirtyOutputs;
+    if (dirtyOutputs.load(std::memory_order_relaxed))
+    {
+        increment(threadCounters().nbShortCircuits);
+        return;
+    }
+
+    BatchEdit* batch = s_currentBatch;
+    if (batch)
     {
-        dirtyOutputs = true;
-        for(DDGLinkIterator it=outputs.begin(), itend=outputs.end(); it != itend; ++it)
+        // the epoch tells if the node is already waiting in this batch
+        if (dirtyFlags.batchEpoch != batch->m_epoch)
         {
-            (*it)->setDirtyValue();
+            dirtyFlags.batchEpoch = batch->m_epoch;
+            batch->m_pending.push_back(this);
+            increment(threadCounters().nbDeferred);
         }
+        return;
     }
+
+    dirtyOutputs.store(true, std::memory_order_relaxed);
+    increment(threadCounters().nbPropagations);
+    for(DDGLinkIterator it=outputs.begin(), itend=outputs.end(); it != itend; ++it)
+    {
+        (*it)->setDirtyValue();
+    }
+}
+
+DDGNode::PropagationCounters DDGNode::getPropagationCounters()
+{
+    std::lock_guard<std::mutex> lock(s_countersMutex);
+    PropagationCounters counters = sumCounters();
+    counters.nbPropagations -= s_resetCounters.nbPropagations;
+    counters.nbDirtyValues -= s_resetCounters.nbDirtyValues;
+    counters.nbShortCircuits -= s_resetCounters.nbShortCircuits;
+    counters.nbDeferred -= s_resetCounters.nbDeferred;
+    return counters;
+}
+
+DDGNode::PropagationCounters DDGNode::getThreadPropagationCounters()
+{
+    return load(threadCounters());
+}
+
+void DDGNode::resetPropagationCounters()
+{
+    // the counters of the threads are never written by another thread, the sum is subtracted on read
+    std::lock_guard<std::mutex> lock(s_countersMutex);
+    s_resetCounters = sumCounters();
+}
+
+DDGNode::BatchEdit::BatchEdit()
+    : m_epoch(0)
+    , m_outermost(s_currentBatch == nullptr)
+{
+    if (m_outermost)
+    {
+        // 0 is the epoch of the nodes never deferred
+        do { m_epoch = ++s_lastBatchEpoch; } while (m_epoch == 0);
+        s_currentBatch = this;
+    }
+}
+
+DDGNode::BatchEdit::~BatchEdit()
+{
+    if (m_outermost)
+    {
+        flush();
+        s_currentBatch = nullptr;
+    }
+}
+
+void DDGNode::BatchEdit::flush()
+{
+    BatchEdit* batch = s_currentBatch;
+    if (!batch)
+        return;
+
+    // propagate outside of the batch, the epoch being renewed for the nodes modified afterwards
+    std::vector<DDGNode*> pending;
+    pending.swap(batch->m_pending);
+    s_currentBatch = nullptr;
+    for (DDGNode* node : pending)
+        node->setDirtyOutputs();
+    do { batch->m_epoch = ++s_lastBatchEpoch; } while (batch->m_epoch == 0);
+    s_currentBatch = batch;
 }
 
 void DDGNode::cleanDirty()
 {
-    bool& dirtyValue = dirtyFlags.dirtyValue;
-    if (dirtyValue)
+    std::atomic<bool>& dirtyValue = dirtyFlags.dirtyValue;
+    if (dirtyValue.load(std::memory_order_relaxed))
     {
-        dirtyValue = false;
+        dirtyValue.store(false, std::memory_order_relaxed);
         cleanDirtyOutputsOfInputs();
     }
 }
@@ -102,7 +259,7 @@ void DDGNode::notifyEndEdit()
 void DDGNode::cleanDirtyOutputsOfInputs()
 {
     for(DDGLinkIterator it=inputs.begin(), itend=inputs.end(); it != itend; ++it)
-        (*it)->dirtyFlags.dirtyOutputs = false;
+        (*it)->dirtyFlags.dirtyOutputs.store(false, std::memory_order_relaxed);
 }
 
 void DDGNode::addInput(DDGNode* n)
@@ -25,7 +25,9 @@
 #include <sofa/core/core.h>
 #include <sofa/core/objectmodel/Link.h>
 #include <sofa/core/objectmodel/BaseClass.h>
+#include <atomic>
 #include <list>
+#include <vector>
 
 namespace sofa
 {
@@ -165,7 +167,7 @@ public:
 
     /// Returns true if the DDGNode needs to be updated
     bool isDirty(const core::ExecParams*) const { return isDirty(); }
-    bool isDirty() const { return dirtyFlags.dirtyValue; }
+    bool isDirty() const { return dirtyFlags.dirtyValue.load(std::memory_order_relaxed); }
 
     /// Indicate the value needs to be updated
     [[deprecated("2020-03-25: Aspect have been deprecated for complete removal in PR #1269. You can probably update your code by removing aspect related calls. If the feature was important to you contact sofa-dev. ")]]
@@ -208,6 +210,56 @@ public:
 
     void addLink(BaseLink* l);
 
+    /// Counters of the propagation of the dirty flags, accumulated by all the DDGNodes.
+    struct PropagationCounters
+    {
+        std::size_t nbPropagations; ///< number of nodes whose outputs were walked to mark them dirty
+        std::size_t nbDirtyValues; ///< number of nodes which became dirty
+        std::size_t nbShortCircuits; ///< number of propagations stopped because the outputs were already dirty
+        std::size_t nbDeferred; ///< number of propagations deferred to the end of a BatchEdit
+    };
+
+    /// Counters of all the threads since the last call to resetPropagationCounters.
+    /// Each thread counts in its own counters, they are summed here.
+    static PropagationCounters getPropagationCounters();
+    /// Counters of the propagations done by the calling thread since its start, never reset.
+    static PropagationCounters getThreadPropagationCounters();
+    static void resetPropagationCounters();
+
+    /**
+     *  \brief Scope deferring the propagation of the dirty flags of the nodes modified by the
+     *  current thread until its end.
+     *
+     *  A node modified many times within the scope propagates only once. The outputs of the
+     *  modified nodes are not dirty yet inside the scope, so they must not be read before its end.
+     *  Nested scopes are merged in the outermost one.
+     *
+     *  \code
+     *  {
+     *      DDGNode::BatchEdit batch;
+     *      for (std::size_t i=0; i<values.size(); ++i) inputs[i]->setValue(values[i]);
+     *  } // outputs are set dirty here
+     *  \endcode
+     */
+    class SOFA_CORE_API BatchEdit
+    {
+    public:
+        BatchEdit();
+        ~BatchEdit();
+
+        /// Propagate the dirty flags of the nodes modified so far
+        void flush();
+
+    protected:
+        BatchEdit(const BatchEdit&) = delete;
+        BatchEdit& operator=(const BatchEdit&) = delete;
+
+        friend class DDGNode;
+        std::vector<DDGNode*> m_pending;
+        unsigned int m_epoch;
+        bool m_outermost;
+    };
+
 protected:
 
     BaseLink::InitLink<DDGNode>
@@ -247,10 +299,13 @@ private:
 
     struct DirtyFlags
     {
-        DirtyFlags() : dirtyValue(false), dirtyOutputs(false) {}
+        DirtyFlags() : dirtyValue(false), dirtyOutputs(false), batchEpoch(0) {}
 
-        bool dirtyValue;
-        bool dirtyOutputs;
+        /// Engines of the same level of a DataEngineTaskGraph, updated concurrently, may set the
+        /// flags of the nodes they share. Setting a flag twice only propagates twice.
+        std::atomic<bool> dirtyValue;
+        std::atomic<bool> dirtyOutputs;
+        unsigned int batchEpoch; ///< epoch of the last BatchEdit this node was deferred in
     };
     DirtyFlags dirtyFlags;
 };
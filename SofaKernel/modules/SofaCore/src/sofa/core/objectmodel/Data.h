@@ -554,6 +554,9 @@ bool TData<T>::read(const std::string& s)
         virtualEndEdit();
         return resized;
     }
+    // only the binary serializable types have a base64 form, the others may hold such text
+    if (BaseData::isBase64Value(s) && isBinarySerializable())
+        return readBase64(s);
     std::istringstream istr( s.c_str() );
     istr >> *virtualBeginEdit();
     virtualEndEdit();
@@ -40,12 +40,12 @@ void TopologyHandler::ApplyTopologyChanges(const std::list<const core::topology:
     if(!this->isTopologyDataRegistered())
         return;
 
-    std::list<const core::topology::TopologyChange *>::iterator changeIt;
-    std::list<const core::topology::TopologyChange *> _changeList = _topologyChangeEvents;
+    std::list<const core::topology::TopologyChange *>::const_iterator changeIt;
+    const std::list<const core::topology::TopologyChange *>::const_iterator changeEnd = _topologyChangeEvents.end();
 
     this->setDataSetArraySize(_dataSize);
 
-    for (changeIt=_changeList.begin(); changeIt!=_changeList.end(); ++changeIt)
+    for (changeIt=_topologyChangeEvents.begin(); changeIt!=changeEnd; ++changeIt)
     {
         core::topology::TopologyChangeType changeType = (*changeIt)->getChangeType();
         std::string topoChangeType = "DefaultTopologyHandler: " + parseTopologyChangeTypeToString(changeType);
@@ -21,6 +21,7 @@
 ******************************************************************************/
 #include "TemplatesAliases.h"
 
+#include <atomic>
 #include <iostream>
 #include <map>
 #include <sofa/helper/logging/Messaging.h>
@@ -40,6 +41,9 @@ TemplateAliasesMap& getTemplateAliasesMap()
 	return theMap;
 }
 
+/// constant initialized, so it is valid when the aliases are registered at static initialization
+static std::atomic<unsigned int> s_revision(0);
+
 bool TemplateAliases::addAlias(const std::string& name, const std::string& result, const bool doWarnUser)
 {
 	TemplateAliasesMap& templateAliases = getTemplateAliasesMap();
@@ -51,6 +55,7 @@ bool TemplateAliases::addAlias(const std::string& name, const std::string& resul
 	else
 	{
         templateAliases[name] = std::make_pair(result, doWarnUser);
+        ++s_revision;
 		return true;
 	}
 }
@@ -64,6 +69,11 @@ const TemplateAlias* TemplateAliases::getTemplateAlias(const std::string &name)
     return nullptr;
 }
 
+unsigned int TemplateAliases::getRevision()
+{
+    return s_revision;
+}
+
 std::string TemplateAliases::resolveAlias(const std::string& name)
 {
 	TemplateAliasesMap& templateAliases = getTemplateAliasesMap();
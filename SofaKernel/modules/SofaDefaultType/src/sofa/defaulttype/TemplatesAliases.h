@@ -61,6 +61,9 @@ public:
 
     /// Get the alias template associated with a given name. Return false & nullptr if none;
     static const TemplateAlias* getTemplateAlias(const std::string& name);
+
+    /// Number of aliases added so far, used to invalidate the caches of resolved templates
+    static unsigned int getRevision();
 };
 
 /**
@@ -21,6 +21,10 @@
 ******************************************************************************/
 #include <sofa/helper/AdvancedTimer.h>
 
+#include <thread>
+#include <set>
+#include <fstream>
+
 #include <SofaSimulationCommon/SceneLoaderXML.h>
 using sofa::simulation::SceneLoaderXML ;
 using sofa::simulation::Node ;
@@ -92,6 +96,9 @@ TEST_F(AdvancedTimerTest, SetOutputType)
 
 	AdvancedTimer::setOutputType("validID", "invalidType");
 	ASSERT_TRUE(AdvancedTimer::getOutputType("validID") == AdvancedTimer::STDOUT);
+
+	AdvancedTimer::setOutputType("validID", "trace");
+	ASSERT_TRUE(AdvancedTimer::getOutputType("validID") == AdvancedTimer::TRACE);
 }
 
 TEST_F(AdvancedTimerTest, End)
@@ -104,5 +111,135 @@ TEST_F(AdvancedTimerTest, End)
 	EXPECT_NO_FATAL_FAILURE(AdvancedTimer::end("validId", nullptr));
 }
 
+TEST_F(AdvancedTimerTest, IdsAreSharedByThreads)
+{
+    using namespace sofa::helper;
+
+    const unsigned int mainId = AdvancedTimer::IdStep::IdFactory::getID("AdvancedTimerTest_sharedStep");
+    unsigned int threadId = 0;
+    std::thread t([&threadId]() { threadId = AdvancedTimer::IdStep::IdFactory::getID("AdvancedTimerTest_sharedStep"); });
+    t.join();
+    EXPECT_EQ(mainId, threadId);
+    EXPECT_EQ(AdvancedTimer::IdStep::IdFactory::getName(mainId), "AdvancedTimerTest_sharedStep");
+}
+
+TEST_F(AdvancedTimerTest, RecordsOfOtherThreads)
+{
+    using namespace sofa::helper;
+
+    AdvancedTimer::IdTimer timer("AdvancedTimerTest_threads");
+    AdvancedTimer::setEnabled(timer, true);
+
+    AdvancedTimer::begin(timer);
+    AdvancedTimer::stepBegin("AdvancedTimerTest_main");
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; ++i)
+    {
+        threads.emplace_back([]()
+        {
+            AdvancedTimer::stepBegin("AdvancedTimerTest_task");
+            AdvancedTimer::valAdd("AdvancedTimerTest_value", 1.0);
+            AdvancedTimer::stepEnd("AdvancedTimerTest_task");
+        });
+    }
+    for (std::thread& t : threads)
+        t.join();
+    AdvancedTimer::stepEnd("AdvancedTimerTest_main");
+    AdvancedTimer::end(timer, std::cout);
+
+    const helper::vector<Record> records = AdvancedTimer::getRecords(timer);
+    for (const Record& r : records)
+    {
+        EXPECT_EQ(r.thread, 0u);
+        EXPECT_NE(r.label, "AdvancedTimerTest_task");
+    }
+
+    const helper::vector<Record> threadRecords = AdvancedTimer::getThreadRecords(timer);
+    ASSERT_EQ(threadRecords.size(), 9u);
+    std::set<unsigned int> recordingThreads;
+    for (std::size_t i = 0; i < threadRecords.size(); i += 3)
+    {
+        EXPECT_NE(threadRecords[i].thread, 0u);
+        recordingThreads.insert(threadRecords[i].thread);
+        EXPECT_EQ(threadRecords[i].type, Record::RSTEP_BEGIN);
+        EXPECT_EQ(threadRecords[i].label, "AdvancedTimerTest_task");
+        EXPECT_EQ(threadRecords[i+1].type, Record::RVAL_ADD);
+        EXPECT_EQ(threadRecords[i+1].thread, threadRecords[i].thread);
+        EXPECT_EQ(threadRecords[i+2].type, Record::RSTEP_END);
+        EXPECT_EQ(threadRecords[i+2].thread, threadRecords[i].thread);
+    }
+    EXPECT_EQ(recordingThreads.size(), 3u);
+
+    AdvancedTimer::clearData(timer);
+}
+
+std::size_t countEvents(const std::string& trace)
+{
+    std::size_t n = 0;
+    for (std::size_t pos = trace.find("\"ph\":"); pos != std::string::npos; pos = trace.find("\"ph\":", pos+1))
+        ++n;
+    return n;
+}
+
+TEST_F(AdvancedTimerTest, Trace)
+{
+    using namespace sofa::helper;
+
+    const std::string filename = "AdvancedTimerTest_trace.json";
+    AdvancedTimer::setTraceFile(filename);
+
+    AdvancedTimer::IdTimer timer("AdvancedTimerTest_trace");
+    AdvancedTimer::setEnabled(timer, true);
+    AdvancedTimer::setOutputType(timer, "trace");
+
+    for (int i = 0; i < 2; ++i)
+    {
+        AdvancedTimer::begin(timer);
+        AdvancedTimer::stepBegin("AdvancedTimerTest_step", "AdvancedTimerTest_object");
+        std::thread t([]() { AdvancedTimer::step("AdvancedTimerTest_\"task\""); });
+        t.join();
+        AdvancedTimer::valSet("AdvancedTimerTest_iterations", 12);
+        AdvancedTimer::valAdd("AdvancedTimerTest_contacts", 3);
+        AdvancedTimer::valAdd("AdvancedTimerTest_contacts", 4);
+        AdvancedTimer::stepEnd("AdvancedTimerTest_step", "AdvancedTimerTest_object");
+        AdvancedTimer::end(timer);
+    }
+
+    const std::string trace = AdvancedTimer::getTrace(timer);
+    EXPECT_EQ(trace.front(), '[');
+    EXPECT_EQ(trace.back(), ']');
+    // two thread names, begin, step begin, three counters, step end, end and the task
+    EXPECT_EQ(countEvents(trace), 10u);
+    EXPECT_NE(trace.find("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"main\"}}"), std::string::npos);
+    EXPECT_NE(trace.find("{\"name\":\"AdvancedTimerTest_trace\",\"cat\":\"timer\",\"ph\":\"B\""), std::string::npos);
+    EXPECT_NE(trace.find("{\"name\":\"AdvancedTimerTest_step\",\"cat\":\"step\",\"ph\":\"B\""), std::string::npos);
+    EXPECT_NE(trace.find("\"args\":{\"object\":\"AdvancedTimerTest_object\"}"), std::string::npos);
+    EXPECT_NE(trace.find("\"ph\":\"C\""), std::string::npos);
+    EXPECT_NE(trace.find("\"args\":{\"value\":12}"), std::string::npos);
+    // a counter shows the sum of the values added, from 0 at each execution of the timer
+    const std::size_t added = trace.find("{\"name\":\"AdvancedTimerTest_contacts\",\"cat\":\"value\",\"ph\":\"C\"");
+    ASSERT_NE(added, std::string::npos);
+    EXPECT_EQ(trace.find("\"args\":{\"value\":3}", added), trace.find("\"args\":{\"value\":", added));
+    EXPECT_NE(trace.find("\"args\":{\"value\":7}", added), std::string::npos);
+    EXPECT_EQ(trace.find("\"args\":{\"value\":4}"), std::string::npos);
+    const std::size_t task = trace.find("{\"name\":\"AdvancedTimerTest_\\\"task\\\"\",\"cat\":\"step\",\"ph\":\"i\"");
+    ASSERT_NE(task, std::string::npos);
+    EXPECT_EQ(trace.find("\"tid\":0", task), std::string::npos);
+
+    // closing the file terminates the array holding both iterations, the second one only
+    // names the track of its new thread
+    AdvancedTimer::setTraceFile("");
+    std::ifstream file(filename.c_str());
+    std::stringstream content;
+    content << file.rdbuf();
+    const std::string fileTrace = content.str();
+    EXPECT_EQ(fileTrace.front(), '[');
+    EXPECT_EQ(fileTrace.substr(fileTrace.size()-3), "\n]\n");
+    EXPECT_EQ(countEvents(fileTrace), 19u);
+    file.close();
+    std::remove(filename.c_str());
+
+    AdvancedTimer::clearData(timer);
+}
 
 } //namespace sofa
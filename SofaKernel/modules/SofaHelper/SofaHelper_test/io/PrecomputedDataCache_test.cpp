@@ -0,0 +1,145 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/io/PrecomputedDataCache.h>
+#include <sofa/helper/system/FileSystem.h>
+#include <sofa/helper/vector.h>
+
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest ;
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+using sofa::helper::io::PrecomputedDataCache ;
+using sofa::helper::system::FileSystem ;
+
+namespace sofa {
+
+class PrecomputedDataCache_test : public BaseTest
+{
+public:
+    std::string directory = boost::filesystem::temp_directory_path().string() + "/PrecomputedDataCache_test";
+
+    void SetUp() override
+    {
+        if (FileSystem::exists(directory))
+            FileSystem::removeAll(directory);
+        PrecomputedDataCache::setDirectory(directory);
+    }
+
+    void TearDown() override
+    {
+        PrecomputedDataCache::setDirectory("");
+        if (FileSystem::exists(directory))
+            FileSystem::removeAll(directory);
+    }
+};
+
+TEST_F(PrecomputedDataCache_test, keyDependsOnInputs)
+{
+    const helper::vector<double> values = { 1.0, 2.0, 3.0 };
+
+    PrecomputedDataCache::Key a("Test", 1);
+    a.add(values).add(42);
+    PrecomputedDataCache::Key b("Test", 1);
+    b.add(values).add(42);
+    EXPECT_EQ(a.filename(), b.filename());
+
+    PrecomputedDataCache::Key otherVersion("Test", 2);
+    otherVersion.add(values).add(42);
+    EXPECT_NE(a.filename(), otherVersion.filename());
+
+    PrecomputedDataCache::Key otherValue("Test", 1);
+    otherValue.add(values).add(43);
+    EXPECT_NE(a.filename(), otherValue.filename());
+
+    // the sizes are part of the hash: splitting the same bytes differently gives another key
+    PrecomputedDataCache::Key split("Test", 1);
+    split.add(helper::vector<double>(values.begin(), values.begin() + 1))
+         .add(helper::vector<double>(values.begin() + 1, values.end())).add(42);
+    EXPECT_NE(a.filename(), split.filename());
+}
+
+TEST_F(PrecomputedDataCache_test, storeAndLoad)
+{
+    PrecomputedDataCache::Key key("Test", 1);
+    key.add(std::string("input"));
+
+    PrecomputedDataCache::Entry entry;
+    EXPECT_FALSE(PrecomputedDataCache::load(key, entry));
+
+    const helper::vector<int> indices = { 4, 8, 15, 16, 23, 42 };
+    const std::vector<float> weights = { 0.5f, 0.25f };
+    entry.write(indices);
+    entry.write(weights);
+    ASSERT_TRUE(PrecomputedDataCache::store(key, entry));
+
+    PrecomputedDataCache::Entry loaded;
+    ASSERT_TRUE(PrecomputedDataCache::load(key, loaded));
+    helper::vector<int> loadedIndices;
+    std::vector<float> loadedWeights;
+    ASSERT_TRUE(loaded.read(loadedIndices));
+    EXPECT_FALSE(loaded.atEnd());
+    ASSERT_TRUE(loaded.read(loadedWeights));
+    EXPECT_TRUE(loaded.atEnd());
+    EXPECT_EQ(indices, loadedIndices);
+    EXPECT_EQ(weights, loadedWeights);
+
+    // reading with another type than the stored one fails
+    PrecomputedDataCache::Entry mismatch;
+    ASSERT_TRUE(PrecomputedDataCache::load(key, mismatch));
+    std::vector<double> wrongType;
+    EXPECT_FALSE(mismatch.read(wrongType));
+}
+
+TEST_F(PrecomputedDataCache_test, corruptedFileIsIgnored)
+{
+    PrecomputedDataCache::Key key("Test", 1);
+    PrecomputedDataCache::Entry entry;
+    entry.write(std::vector<int>(100, 7));
+    ASSERT_TRUE(PrecomputedDataCache::store(key, entry));
+
+    {
+        std::fstream file((directory + "/" + key.filename()).c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put(1);
+    }
+
+    EXPECT_MSG_EMIT(Warning);
+    PrecomputedDataCache::Entry loaded;
+    EXPECT_FALSE(PrecomputedDataCache::load(key, loaded));
+}
+
+TEST_F(PrecomputedDataCache_test, disabled)
+{
+    PrecomputedDataCache::setDirectory("");
+    EXPECT_FALSE(PrecomputedDataCache::isEnabled());
+
+    PrecomputedDataCache::Key key("Test", 1);
+    PrecomputedDataCache::Entry entry;
+    entry.write(std::vector<int>(1, 1));
+    EXPECT_FALSE(PrecomputedDataCache::store(key, entry));
+    EXPECT_FALSE(PrecomputedDataCache::load(key, entry));
+}
+
+} // namespace sofa
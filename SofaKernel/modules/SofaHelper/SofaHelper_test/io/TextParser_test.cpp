@@ -0,0 +1,106 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/io/TextParser.h>
+
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest ;
+
+using sofa::helper::io::TextParser ;
+
+namespace sofa {
+
+class TextParser_test : public BaseTest
+{
+};
+
+TEST_F(TextParser_test, readNumbersAndWords)
+{
+    const std::string text = "v 1.5 -2 +3e2\n\t f 1/2/3 42\r\nend";
+    TextParser parser(text);
+
+    std::string word;
+    double x, y, z;
+    ASSERT_TRUE(parser.readWord(word));
+    EXPECT_EQ("v", word);
+    ASSERT_TRUE(parser.read(x));
+    ASSERT_TRUE(parser.read(y));
+    ASSERT_TRUE(parser.read(z));
+    EXPECT_EQ(1.5, x);
+    EXPECT_EQ(-2.0, y);
+    EXPECT_EQ(300.0, z);
+
+    ASSERT_TRUE(parser.readWord(word));
+    EXPECT_EQ("f", word);
+    int index;
+    ASSERT_TRUE(parser.read(index));
+    EXPECT_EQ(1, index);
+    EXPECT_FALSE(parser.read(index)); // "/2/3" is not a number
+    parser.skipLine();
+
+    const char* lineBegin;
+    const char* lineEnd;
+    ASSERT_TRUE(parser.readLine(lineBegin, lineEnd));
+    EXPECT_EQ("end", std::string(lineBegin, lineEnd));
+    EXPECT_FALSE(parser.skipBlanks());
+    EXPECT_FALSE(parser.read(index));
+}
+
+TEST_F(TextParser_test, readLinesAndChunks)
+{
+    std::string text;
+    for (int i = 0; i < 1000; ++i)
+        text += std::to_string(i) + " " + std::to_string(0.5*i) + "\n";
+
+    const std::vector<const char*> chunks = TextParser::splitInChunks(text.data(), text.data() + text.size(), 7);
+    ASSERT_GE(chunks.size(), 2u);
+    EXPECT_EQ(text.data(), chunks.front());
+    EXPECT_EQ(text.data() + text.size(), chunks.back());
+
+    int expected = 0;
+    for (std::size_t c = 0; c + 1 < chunks.size(); ++c)
+    {
+        EXPECT_TRUE(chunks[c] == text.data() || chunks[c][-1] == '\n');
+        TextParser parser(chunks[c], chunks[c+1]);
+        int i;
+        double d;
+        while (parser.read(i))
+        {
+            ASSERT_TRUE(parser.read(d));
+            EXPECT_EQ(expected, i);
+            EXPECT_EQ(0.5*expected, d);
+            ++expected;
+        }
+    }
+    EXPECT_EQ(1000, expected);
+
+    TextParser parser(text);
+    std::vector<const char*> lines;
+    EXPECT_EQ(10u, parser.nextLines(10, lines));
+    ASSERT_EQ(10u, lines.size());
+    int i;
+    ASSERT_TRUE(TextParser(lines[9], parser.end()).read(i));
+    EXPECT_EQ(9, i);
+    ASSERT_TRUE(parser.read(i));
+    EXPECT_EQ(10, i);
+}
+
+} // namespace sofa
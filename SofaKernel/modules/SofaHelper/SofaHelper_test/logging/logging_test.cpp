@@ -195,6 +195,106 @@ TEST(LoggingTest, threadingTests)
 }
 
 
+TEST(LoggingTest, asynchronousThreadingTests)
+{
+    if(!SOFA_WITH_THREADING){
+        /// This cout shouldn't be using the msg_* API.
+        std::cout << "Test canceled because sofa is not compiled with SOFA_WITH_THREADING option." << std::endl ;
+        return ;
+    }
+
+    MessageDispatcher::clearHandlers() ;
+
+    CountingMessageHandler& mh = MainCountingMessageHandler::getInstance();
+    mh.reset();
+    MessageDispatcher::addHandler(&mh) ;
+
+    MessageDispatcher::setAsynchronous(true) ;
+    EXPECT_TRUE(MessageDispatcher::isAsynchronous()) ;
+
+    std::thread t1(f1);
+    std::thread t2(f2);
+    std::thread t3(f3);
+
+    t1.join();
+    t2.join();
+    t3.join();
+
+    MessageDispatcher::flush() ;
+    EXPECT_EQ( mh.getMessageCountFor(Message::Info), 300000) ;
+    EXPECT_EQ( mh.getMessageCountFor(Message::Warning), 300000) ;
+    EXPECT_EQ( mh.getMessageCountFor(Message::Error), 300000) ;
+
+    /// messages still queued are processed when going back to the synchronous mode
+    msg_warning("") << "queued warning" ;
+    MessageDispatcher::setAsynchronous(false) ;
+    EXPECT_FALSE(MessageDispatcher::isAsynchronous()) ;
+    EXPECT_EQ( mh.getMessageCountFor(Message::Warning), 300001) ;
+}
+
+TEST(LoggingTest, asynchronousOrdering)
+{
+    if(!SOFA_WITH_THREADING)
+        return ;
+
+    MessageDispatcher::clearHandlers() ;
+    MyMessageHandler h;
+    MessageDispatcher::addHandler(&h) ;
+
+    MessageDispatcher::setAsynchronous(true) ;
+    msg_info("") << "first" ;
+    msg_warning("") << "second" ;
+    /// errors are processed synchronously, after the queued messages
+    msg_error("") << "third" ;
+    ASSERT_EQ( h.numMessages(), 3u ) ;
+    MessageDispatcher::setAsynchronous(false) ;
+
+    EXPECT_EQ( h.messages()[0].messageAsString(), "first" ) ;
+    EXPECT_EQ( h.messages()[1].messageAsString(), "second" ) ;
+    EXPECT_EQ( h.messages()[2].messageAsString(), "third" ) ;
+}
+
+TEST(LoggingTest, minimumLevel)
+{
+    MessageDispatcher::clearHandlers() ;
+    MyMessageHandler h;
+    MessageDispatcher::addHandler(&h) ;
+
+    MessageDispatcher::setMinimumLevel(Message::Warning) ;
+    EXPECT_FALSE( MessageDispatcher::isLogged(Message::Info) ) ;
+    EXPECT_TRUE( MessageDispatcher::isLogged(Message::Error) ) ;
+
+    bool built = false ;
+    msg_info("") << "discarded" << (built = true) ;
+    msg_advice("") << "discarded" ;
+    msg_deprecated("") << "discarded" ;
+    msg_warning("") << "kept" ;
+    msg_error("") << "kept" ;
+    MessageDispatcher::setMinimumLevel(Message::Info) ;
+
+    EXPECT_FALSE( built ) ;
+    EXPECT_EQ( h.numMessages(), 2u ) ;
+}
+
+TEST(LoggingTest, rateLimit)
+{
+    MessageDispatcher::clearHandlers() ;
+    MyMessageHandler h;
+    MessageDispatcher::addHandler(&h) ;
+
+    MessageDispatcher::setRateLimit(3) ;
+    for(unsigned int i=0;i<10;i++){
+        msg_warning("") << "repeated warning" ;
+        msg_error("") << "repeated error" ;
+    }
+    msg_warning("") << "another line" ;
+    MessageDispatcher::setRateLimit(0) ;
+
+    /// three of each line, plus the other line
+    EXPECT_EQ( h.numMessages(), 7u ) ;
+    EXPECT_EQ( h.lastMessage().messageAsString(), "another line" ) ;
+}
+
 TEST(LoggingTest, withoutDevMode)
 {
     MessageDispatcher::clearHandlers() ;
@@ -446,6 +546,34 @@ TEST(LoggingTest, checkBaseObjectQueueSize)
     EXPECT_EQ(c.getLoggedMessages().size(), 100u);
 }
 
+TEST(LoggingTest, asynchronousPerComponentLogging)
+{
+    if(!SOFA_WITH_THREADING)
+        return ;
+
+    MessageDispatcher::clearHandlers() ;
+    CountingMessageHandler& mh = MainCountingMessageHandler::getInstance();
+    mh.reset();
+    MessageDispatcher::addHandler(&mh) ;
+    MessageDispatcher::addHandler(&MainPerComponentLoggingMessageHandler::getInstance()) ;
+
+    MessageDispatcher::setAsynchronous(true) ;
+    {
+        MyComponent c;
+        std::vector<std::thread> threads;
+        for(unsigned int i=0;i<4;i++)
+            threads.emplace_back([&c](){ for(unsigned int j=0;j<1000;j++) msg_warning(&c) << "a warning message" ; });
+        for(std::thread& t : threads)
+            t.join();
+
+        /// the component logs the messages on the emitting threads, before they are queued
+        EXPECT_EQ(c.getLoggedMessages().size(), 100u);
+    }
+    /// the queued messages are processed before the component is destroyed
+    EXPECT_EQ( mh.getMessageCountFor(Message::Warning), 4000) ;
+    MessageDispatcher::setAsynchronous(false) ;
+}
+
 TEST(LoggingTest, checkBaseObjectSoutSerr)
 {
     /// We install the handler that copy the message into the component.
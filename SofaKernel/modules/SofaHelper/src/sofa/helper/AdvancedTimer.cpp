@@ -33,6 +33,11 @@
 #include <stack>
 #include <algorithm>
 #include <cctype>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <set>
 
 #define DEFAULT_INTERVAL 100
 
@@ -48,6 +53,75 @@ namespace helper
 typedef sofa::helper::system::thread::ctime_t ctime_t;
 typedef sofa::helper::system::thread::CTime CTime;
 
+template<class Base>
+AdvancedTimer::Id<Base>::IdFactory::IdFactory()
+{
+    idsList.push_back(std::string("0")); // ID 0 == "0" or empty string
+}
+
+template<class Base>
+unsigned int AdvancedTimer::Id<Base>::IdFactory::getID(const std::string& name)
+{
+    if (name.empty())
+        return 0;
+
+    // ids never change once created, so each thread keeps the ones it already looked up
+    typedef std::unordered_map<std::string, unsigned int> IdCache;
+    SOFA_THREAD_SPECIFIC_PTR(IdCache, cache);
+    IdCache* threadCache = cache;
+    if (!threadCache)
+    {
+        threadCache = new IdCache;
+        cache = threadCache;
+    }
+    auto cached = threadCache->find(name);
+    if (cached != threadCache->end())
+        return cached->second;
+
+    IdFactory& idfac = getInstance();
+    unsigned int id;
+    {
+        std::lock_guard<std::mutex> lock(idfac.idsMutex);
+        auto it = idfac.idsMap.find(name);
+        if (it != idfac.idsMap.end())
+            id = it->second;
+        else
+        {
+            id = (unsigned int)idfac.idsList.size();
+            idfac.idsList.push_back(name);
+            idfac.idsMap.emplace(name, id);
+        }
+    }
+    threadCache->emplace(name, id);
+    return id;
+}
+
+template<class Base>
+std::size_t AdvancedTimer::Id<Base>::IdFactory::getLastID()
+{
+    IdFactory& idfac = getInstance();
+    std::lock_guard<std::mutex> lock(idfac.idsMutex);
+    return idfac.idsList.size()-1;
+}
+
+template<class Base>
+std::string AdvancedTimer::Id<Base>::IdFactory::getName(unsigned int id)
+{
+    IdFactory& idfac = getInstance();
+    std::lock_guard<std::mutex> lock(idfac.idsMutex);
+    if (id < idfac.idsList.size())
+        return idfac.idsList[id];
+    else
+        return "";
+}
+
+template<class Base>
+typename AdvancedTimer::Id<Base>::IdFactory& AdvancedTimer::Id<Base>::IdFactory::getInstance()
+{
+    static IdFactory instance;
+    return instance;
+}
+
 template class SOFA_HELPER_API AdvancedTimer::Id<AdvancedTimer::Timer>;
 template class SOFA_HELPER_API AdvancedTimer::Id<AdvancedTimer::Step>;
 template class SOFA_HELPER_API AdvancedTimer::Id<AdvancedTimer::Obj>;
@@ -58,6 +132,7 @@ class TimerData
 public:
     AdvancedTimer::IdTimer id;
     helper::vector<Record> records;
+    helper::vector<Record> threadRecords; ///< records of the other threads, grouped by thread
     int nbIter;
     int interval;
     int defaultInterval;
@@ -103,6 +178,7 @@ public:
     }
     void clear();
     void process();
+    void processRecords(helper::vector<Record>::const_iterator begin, helper::vector<Record>::const_iterator end, ctime_t t0, int level);
     void print();
     void print(std::ostream& result);
     json getJson(std::string stepNumber);
@@ -111,6 +187,29 @@ public:
 };
 
 std::map< AdvancedTimer::IdTimer, TimerData > timers;
+std::recursive_mutex timersMutex;
+
+class AdvancedTimer::TimerSet
+{
+public:
+    std::map< AdvancedTimer::IdTimer, TimerData > timers;
+    std::recursive_mutex mutex;
+};
+
+SOFA_THREAD_SPECIFIC_PTR(AdvancedTimer::TimerSet, curTimerSetThread);
+
+TimerData& getTimerData(AdvancedTimer::IdTimer id)
+{
+    // the timers of a context are also used by the tasks it runs on the worker threads
+    AdvancedTimer::TimerSet* timerSet = curTimerSetThread;
+    if (timerSet)
+    {
+        std::lock_guard<std::recursive_mutex> lock(timerSet->mutex);
+        return timerSet->timers[id];
+    }
+    std::lock_guard<std::recursive_mutex> lock(timersMutex);
+    return timers[id];
+}
 
 std::atomic<int> activeTimers;
 SOFA_THREAD_SPECIFIC_PTR(std::stack<AdvancedTimer::IdTimer>, curTimerThread);
@@ -141,9 +240,293 @@ void setCurRecords(helper::vector<Record>* ptr)
     else if (!ptr && prev) --activeTimers;
 }
 
+/// Records of a thread which did not begin the running timer (i.e. a TaskScheduler worker).
+/// The thread is the only writer and the thread ending the timer the only reader, so the
+/// ring buffer needs no lock. Records are dropped when it is full.
+class ThreadRecords
+{
+public:
+    static const std::size_t Capacity = 1 << 14;
+
+    explicit ThreadRecords(unsigned int thread)
+        : thread(thread), events(Capacity), head(0), tail(0), dropped(0)
+    {
+    }
+
+    void push(Record::Type type, unsigned int id, unsigned int obj, double val)
+    {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= Capacity)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Event& e = events[h & (Capacity-1)];
+        e.time = CTime::getTime();
+        e.type = type;
+        e.id = id;
+        e.obj = obj;
+        e.val = val;
+        head.store(h+1, std::memory_order_release);
+    }
+
+    /// Move the pending events recorded from tbegin to records, and return the number of dropped ones
+    unsigned int drain(helper::vector<Record>& records, ctime_t tbegin)
+    {
+        const std::size_t h = head.load(std::memory_order_acquire);
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        for (; t != h; ++t)
+        {
+            const Event& e = events[t & (Capacity-1)];
+            if (e.time < tbegin) continue;
+            Record r;
+            r.time = e.time;
+            r.type = e.type;
+            r.id = e.id;
+            r.obj = e.obj;
+            r.val = e.val;
+            r.thread = thread;
+            records.push_back(r);
+        }
+        tail.store(t, std::memory_order_release);
+        return dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    const unsigned int thread;
+
+protected:
+    struct Event
+    {
+        ctime_t time;
+        Record::Type type;
+        unsigned int id;
+        unsigned int obj;
+        double val;
+    };
+    std::vector<Event> events;
+    std::atomic<std::size_t> head;
+    std::atomic<std::size_t> tail;
+    std::atomic<unsigned int> dropped;
+};
+
+std::mutex threadRecordsMutex;
+std::vector< std::unique_ptr<ThreadRecords> > threadRecordsList;
+SOFA_THREAD_SPECIFIC_PTR(ThreadRecords, curThreadRecords);
+
+ThreadRecords& getThreadRecords()
+{
+    ThreadRecords* ptr = curThreadRecords;
+    if (!ptr)
+    {
+        std::lock_guard<std::mutex> lock(threadRecordsMutex);
+        threadRecordsList.emplace_back(new ThreadRecords((unsigned int)threadRecordsList.size()+1));
+        ptr = threadRecordsList.back().get();
+        curThreadRecords = ptr;
+    }
+    return *ptr;
+}
+
+/// Gather in data.threadRecords what the other threads recorded since the timer began
+void collectThreadRecords(TimerData& data)
+{
+    data.threadRecords.clear();
+    if (data.records.empty()) return;
+    const ctime_t tbegin = data.records.front().time;
+    unsigned int dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(threadRecordsMutex);
+        for (const auto& t : threadRecordsList)
+            dropped += t->drain(data.threadRecords, tbegin);
+    }
+    if (dropped)
+        msg_warning("AdvancedTimer") << "timer[" << data.id << "]: " << dropped << " records of other threads were lost, their buffer was full";
+}
+
 AdvancedTimer::SyncCallBack syncCallBack = nullptr;
 void* syncCallBackData = nullptr;
 
+/// Record an event of the current thread. Must only be called while a timer is active.
+void addRecord(Record::Type type, unsigned int id, unsigned int obj = 0, double val = 0, bool sync = false)
+{
+    helper::vector<Record>* curRecords = curRecordsThread;
+    if (curRecords)
+    {
+        if (sync && syncCallBack) (*syncCallBack)(syncCallBackData);
+        Record r;
+        r.time = CTime::getTime();
+        r.type = type;
+        r.id = id;
+        r.obj = obj;
+        r.val = val;
+        curRecords->push_back(r);
+    }
+    else
+    {
+        // a thread with its own disabled timer keeps discarding its records
+        std::stack<AdvancedTimer::IdTimer>* curTimer = curTimerThread;
+        if (curTimer && !curTimer->empty()) return;
+        getThreadRecords().push(type, id, obj, val);
+    }
+}
+
+/// Write the records as Chrome trace events, with timestamps in microseconds from t0.
+/// Steps are duration events, single steps are instant events and values are counters.
+/// A counter shows the current value of its IdVal: counters holds the sums of the values
+/// added since the last one set, during the current execution of the timer.
+void writeTraceEvents(std::ostream& out, const helper::vector<Record>& records, ctime_t t0, bool& first,
+                      std::map<unsigned int, double>& counters)
+{
+    const double usPerTick = 1000000.0 / (double)CTime::getTicksPerSec();
+    for (const Record& r : records)
+    {
+        std::string name;
+        const char* cat = "step";
+        const char* ph = nullptr;
+        switch (r.type)
+        {
+        case Record::RBEGIN:
+        case Record::REND:
+            name = AdvancedTimer::IdTimer::IdFactory::getName(r.id);
+            cat = "timer";
+            ph = (r.type == Record::RBEGIN) ? "B" : "E";
+            break;
+        case Record::RSTEP_BEGIN:
+        case Record::RSTEP_END:
+            name = AdvancedTimer::IdStep::IdFactory::getName(r.id);
+            ph = (r.type == Record::RSTEP_BEGIN) ? "B" : "E";
+            break;
+        case Record::RSTEP:
+            name = AdvancedTimer::IdStep::IdFactory::getName(r.id);
+            ph = "i";
+            break;
+        case Record::RVAL_SET:
+        case Record::RVAL_ADD:
+            name = AdvancedTimer::IdVal::IdFactory::getName(r.id);
+            cat = "value";
+            ph = "C";
+            break;
+        default:
+            continue;
+        }
+
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":" << json(name).dump() << ",\"cat\":\"" << cat << "\",\"ph\":\"" << ph << "\""
+            << ",\"ts\":" << std::fixed << std::setprecision(3) << (double)(r.time - t0) * usPerTick
+            << ",\"pid\":0,\"tid\":" << r.thread;
+        if (r.type == Record::RSTEP)
+            out << ",\"s\":\"t\"";
+        if (r.type == Record::RVAL_SET || r.type == Record::RVAL_ADD)
+        {
+            double& value = counters[r.id];
+            value = (r.type == Record::RVAL_SET) ? r.val : value + r.val;
+            out << ",\"args\":{\"value\":" << std::defaultfloat << std::setprecision(17) << value << "}";
+        }
+        else if (r.obj != 0)
+            out << ",\"args\":{\"object\":" << json(AdvancedTimer::IdObj::IdFactory::getName(r.obj)).dump() << "}";
+        out << "}";
+    }
+}
+
+/// Write the name of the track of each thread which has not been named yet
+void writeTraceThreadNames(std::ostream& out, const helper::vector<Record>& records, std::set<unsigned int>& named, bool& first)
+{
+    for (const Record& r : records)
+    {
+        if (!named.insert(r.thread).second) continue;
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << r.thread
+            << ",\"args\":{\"name\":\"" << (r.thread == 0 ? std::string("main") : "worker " + std::to_string(r.thread)) << "\"}}";
+    }
+}
+
+/// Timeline of the timers using the TRACE output type. The events are appended to a JSON
+/// array as the timers end, so that the file can be opened even if the array is not closed.
+class TraceWriter
+{
+public:
+    TraceWriter() : filename("sofa_trace.json"), origin(0), first(true) {}
+    ~TraceWriter() { close(); }
+
+    void setFile(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        close();
+        filename = name;
+    }
+
+    void write(const TimerData& data)
+    {
+        if (data.records.empty()) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!out.is_open())
+        {
+            if (filename.empty()) return;
+            out.open(filename.c_str(), std::ios::out | std::ios::trunc);
+            if (!out.is_open())
+            {
+                msg_error("AdvancedTimer") << "Unable to open the trace file " << filename;
+                filename.clear();
+                return;
+            }
+            out << "[";
+            origin = data.records.front().time;
+        }
+        writeTraceThreadNames(out, data.records, namedThreads, first);
+        writeTraceThreadNames(out, data.threadRecords, namedThreads, first);
+        std::map<unsigned int, double> counters;
+        writeTraceEvents(out, data.records, origin, first, counters);
+        writeTraceEvents(out, data.threadRecords, origin, first, counters);
+        out.flush();
+    }
+
+protected:
+    void close()
+    {
+        if (out.is_open())
+        {
+            out << "\n]\n";
+            out.close();
+        }
+        namedThreads.clear();
+        first = true;
+    }
+
+    std::mutex mutex;
+    std::ofstream out;
+    std::string filename;
+    ctime_t origin;
+    bool first;
+    std::set<unsigned int> namedThreads;
+};
+
+TraceWriter traceWriter;
+
+void AdvancedTimer::setTraceFile(const std::string& filename)
+{
+    traceWriter.setFile(filename);
+}
+
+std::string AdvancedTimer::getTrace(IdTimer id)
+{
+    TimerData& data = getTimerData(id);
+    std::ostringstream out;
+    out << "[";
+    if (!data.records.empty())
+    {
+        bool first = true;
+        std::set<unsigned int> namedThreads;
+        writeTraceThreadNames(out, data.records, namedThreads, first);
+        writeTraceThreadNames(out, data.threadRecords, namedThreads, first);
+        std::map<unsigned int, double> counters;
+        writeTraceEvents(out, data.records, data.records.front().time, first, counters);
+        writeTraceEvents(out, data.threadRecords, data.records.front().time, first, counters);
+    }
+    out << "\n]";
+    return out.str();
+}
+
 std::pair<AdvancedTimer::SyncCallBack,void*> AdvancedTimer::setSyncCallBack(SyncCallBack cb, void* userData)
 {
     std::pair<AdvancedTimer::SyncCallBack,void*> old;
@@ -162,12 +545,44 @@ void AdvancedTimer::clear()
         while (!ptr->empty())
             ptr->pop();
     if (activeTimers == 0)
+    {
+        AdvancedTimer::TimerSet* timerSet = curTimerSetThread;
+        if (timerSet)
+        {
+            std::lock_guard<std::recursive_mutex> lock(timerSet->mutex);
+            timerSet->timers.clear();
+            return;
+        }
+        std::lock_guard<std::recursive_mutex> lock(timersMutex);
         timers.clear();
+    }
+}
+
+AdvancedTimer::TimerSet* AdvancedTimer::createTimerSet()
+{
+    return new TimerSet;
+}
+
+void AdvancedTimer::deleteTimerSet(TimerSet* timers)
+{
+    if (curTimerSetThread == timers)
+        curTimerSetThread = nullptr;
+    delete timers;
+}
+
+void AdvancedTimer::setThreadTimers(TimerSet* timers)
+{
+    curTimerSetThread = timers;
+}
+
+AdvancedTimer::TimerSet* AdvancedTimer::getThreadTimers()
+{
+    return curTimerSetThread;
 }
 
 bool AdvancedTimer::isEnabled(IdTimer id)
 {
-    TimerData& data = timers[id];
+    TimerData& data = getTimerData(id);
     if (!data.id)
     {
         data.init(id);
@@ -177,7 +592,7 @@ bool AdvancedTimer::isEnabled(IdTimer id)
 
 void AdvancedTimer::setEnabled(IdTimer id, bool val)
 {
-    TimerData& data = timers[id];
+    TimerData& data = getTimerData(id);
     if (!data.id)
     {
         data.init(id);
@@ -190,7 +605,7 @@ void AdvancedTimer::setEnabled(IdTimer id, bool val)
 
 int  AdvancedTimer::getInterval(IdTimer id)
 {
-    TimerData& data = timers[id];
+    TimerData& data = getTimerData(id);
     if (!data.id)
     {
         data.init(id);
@@ -200,7 +615,7 @@ int  AdvancedTimer::getInterval(IdTimer id)
 
 void AdvancedTimer::setInterval(IdTimer id, int val)
 {
-    TimerData& data = timers[id];
+    TimerData& data = getTimerData(id);
     if (!data.id)
     {
         data.init(id);
@@ -213,7 +628,7 @@ void AdvancedTimer::begin(IdTimer id)
 {
     std::stack<AdvancedTimer::IdTimer>& curTimer = getCurTimer();
     curTimer.push(id);
-    TimerData& data = timers[curTimer.top()];
+    TimerData& data = getTimerData(curTimer.top());
     if (!data.id)
     {
         data.init(id);
@@ -226,6 +641,7 @@ void AdvancedTimer::begin(IdTimer id)
     helper::vector<Record>* curRecords = &(data.records);
     setCurRecords(curRecords);
     curRecords->clear();
+    data.threadRecords.clear();
     if (syncCallBack) (*syncCallBack)(syncCallBackData);
     Record r;
     r.time = CTime::getTime();
@@ -234,20 +650,12 @@ void AdvancedTimer::begin(IdTimer id)
     curRecords->push_back(r);
 }
 
-void AdvancedTimer::end(IdTimer id, std::ostream& result)
+/// Common part of the end of a timer: records the end, collects the records of the other
+/// threads and updates the statistics. output is called when the statistics must be output.
+template<class Output>
+void endTimer(AdvancedTimer::IdTimer id, Output output)
 {
     std::stack<AdvancedTimer::IdTimer>& curTimer = getCurTimer();
-
-    if (curTimer.empty())
-    {
-        msg_error("AdvancedTimer::end") << "timer[" << id << "] called while begin was not" ;
-        return;
-    }
-    if (id != curTimer.top())
-    {
-        msg_error("AdvancedTimer::end") << "timer[" << id << "] does not correspond to last call to begin(" << curTimer.top() << ")" ;
-        return;
-    }
     helper::vector<Record>* curRecords = getCurRecords();
     if (curRecords)
     {
@@ -258,11 +666,16 @@ void AdvancedTimer::end(IdTimer id, std::ostream& result)
         r.id = id;
         curRecords->push_back(r);
 
-        TimerData& data = timers[curTimer.top()];
+        TimerData& data = getTimerData(curTimer.top());
+        collectThreadRecords(data);
+        if (data.timerOutputType == AdvancedTimer::TRACE)
+            traceWriter.write(data);
         data.process();
         if (data.nbIter == data.interval)
         {
-            data.print(result);
+            // traced timers only write their timeline
+            if (data.timerOutputType != AdvancedTimer::TRACE)
+                output(data);
             data.clear();
         }
     }
@@ -273,66 +686,54 @@ void AdvancedTimer::end(IdTimer id, std::ostream& result)
     }
     else
     {
-        TimerData& data = timers[curTimer.top()];
+        TimerData& data = getTimerData(curTimer.top());
         setCurRecords((data.interval == 0) ? nullptr : &(data.records));
     }
 }
 
-void AdvancedTimer::end(IdTimer id)
+bool checkEndTimer(AdvancedTimer::IdTimer id)
 {
     std::stack<AdvancedTimer::IdTimer>& curTimer = getCurTimer();
 
     if (curTimer.empty())
     {
         msg_error("AdvancedTimer::end") << "timer[" << id << "] called while begin was not" ;
-        return;
+        return false;
     }
     if (id != curTimer.top())
     {
         msg_error("AdvancedTimer::end") << "timer[" << id << "] does not correspond to last call to begin(" << curTimer.top() << ")" ;
-        return;
+        return false;
     }
+    return true;
+}
+
+void AdvancedTimer::end(IdTimer id, std::ostream& result)
+{
+    if (!checkEndTimer(id))
+        return;
+
+    endTimer(id, [&result](TimerData& data) { data.print(result); });
+}
+
+void AdvancedTimer::end(IdTimer id)
+{
+    if (!checkEndTimer(id))
+        return;
 
-    TimerData& dataT = timers[id];
+    TimerData& dataT = getTimerData(id);
     if (dataT.timerOutputType == GUI || dataT.timerOutputType == LJSON || dataT.timerOutputType == JSON)
     {
         dataT.clear();
         return;
     }
 
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (curRecords)
-    {
-        if (syncCallBack) (*syncCallBack)(syncCallBackData);
-        Record r;
-        r.time = CTime::getTime();
-        r.type = Record::REND;
-        r.id = id;
-        curRecords->push_back(r);
-
-        TimerData& data = timers[curTimer.top()];
-        data.process();
-        if (data.nbIter == data.interval)
-        {
-            data.print();
-            data.clear();
-        }
-    }
-    curTimer.pop();
-    if (curTimer.empty())
-    {
-        setCurRecords(nullptr);
-    }
-    else
-    {
-        TimerData& data = timers[curTimer.top()];
-        setCurRecords((data.interval == 0) ? nullptr : &(data.records));
-    }
+    endTimer(id, [](TimerData& data) { data.print(); });
 }
 
 std::string AdvancedTimer::end(IdTimer id, simulation::Node* node)
 {
-    TimerData& data = timers[id];
+    TimerData& data = getTimerData(id);
     if(!data.id)
     {
         return std::string("");
@@ -352,120 +753,62 @@ std::string AdvancedTimer::end(IdTimer id, simulation::Node* node)
 
 bool AdvancedTimer::isActive()
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return false;
-    return true;
+    return activeTimers != 0;
 }
 
 void AdvancedTimer::stepBegin(IdStep id)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
-    Record r;
-    r.time = CTime::getTime();
-    r.type = Record::RSTEP_BEGIN;
-    r.id = id;
-    curRecords->push_back(r);
+    if (!activeTimers) return;
+    addRecord(Record::RSTEP_BEGIN, id);
 }
 
 void AdvancedTimer::stepBegin(IdStep id, IdObj obj)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
-    Record r;
-    r.time = CTime::getTime();
-    r.type = Record::RSTEP_BEGIN;
-    r.id = id;
-    r.obj = obj;
-    curRecords->push_back(r);
+    if (!activeTimers) return;
+    addRecord(Record::RSTEP_BEGIN, id, obj);
 }
 
 void AdvancedTimer::stepEnd  (IdStep id)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
-    if (syncCallBack) (*syncCallBack)(syncCallBackData);
-    Record r;
-    r.time = CTime::getTime();
-    r.type = Record::RSTEP_END;
-    r.id = id;
-    curRecords->push_back(r);
+    if (!activeTimers) return;
+    addRecord(Record::RSTEP_END, id, 0, 0, true);
 }
 
 void AdvancedTimer::stepEnd  (IdStep id, IdObj obj)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
-    Record r;
-    r.time = CTime::getTime();
-    r.type = Record::RSTEP_END;
-    r.id = id;
-    r.obj = obj;
-    curRecords->push_back(r);
+    if (!activeTimers) return;
+    addRecord(Record::RSTEP_END, id, obj);
 }
 
 void AdvancedTimer::stepNext (IdStep prevId, IdStep nextId)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
-    Record r;
-    if (syncCallBack) (*syncCallBack)(syncCallBackData);
-    r.time = CTime::getTime();
-    r.type = Record::RSTEP_END;
-    r.id = prevId;
-    curRecords->push_back(r);
-    r.type = Record::RSTEP_BEGIN;
-    r.id = nextId;
-    curRecords->push_back(r);
+    if (!activeTimers) return;
+    addRecord(Record::RSTEP_END, prevId, 0, 0, true);
+    addRecord(Record::RSTEP_BEGIN, nextId);
 }
 
 void AdvancedTimer::step     (IdStep id)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
-    if (syncCallBack) (*syncCallBack)(syncCallBackData);
-    Record r;
-    r.time = CTime::getTime();
-    r.type = Record::RSTEP;
-    r.id = id;
-    curRecords->push_back(r);
+    if (!activeTimers) return;
+    addRecord(Record::RSTEP, id, 0, 0, true);
 }
 
 void AdvancedTimer::step     (IdStep id, IdObj obj)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
-    if (syncCallBack) (*syncCallBack)(syncCallBackData);
-    Record r;
-    r.time = CTime::getTime();
-    r.type = Record::RSTEP;
-    r.id = id;
-    r.obj = obj;
-    curRecords->push_back(r);
+    if (!activeTimers) return;
+    addRecord(Record::RSTEP, id, obj, 0, true);
 }
 
 void AdvancedTimer::valSet(IdVal id, double val)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
-    Record r;
-    r.time = CTime::getTime();
-    r.type = Record::RVAL_SET;
-    r.id = id;
-    r.val = val;
-    curRecords->push_back(r);
+    if (!activeTimers) return;
+    addRecord(Record::RVAL_SET, id, 0, val);
 }
 
 void AdvancedTimer::valAdd(IdVal id, double val)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
-    Record r;
-    r.time = CTime::getTime();
-    r.type = Record::RVAL_ADD;
-    r.id = id;
-    r.val = val;
-    curRecords->push_back(r);
+    if (!activeTimers) return;
+    addRecord(Record::RVAL_ADD, id, 0, val);
 }
 
 // API using strings instead of Id, to remove the need for Id creation when no timing is recorded
@@ -482,85 +825,73 @@ void AdvancedTimer::end(const char* idStr)
 
 void AdvancedTimer::stepBegin(const char* idStr)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     stepBegin(IdStep(idStr));
 }
 
 void AdvancedTimer::stepBegin(const char* idStr, const char* objStr)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     stepBegin(IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::stepBegin(const char* idStr, const std::string& objStr)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     stepBegin(IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::stepEnd  (const char* idStr)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     stepEnd  (IdStep(idStr));
 }
 
 void AdvancedTimer::stepEnd  (const char* idStr, const char* objStr)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     stepEnd  (IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::stepEnd  (const char* idStr, const std::string& objStr)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     stepEnd  (IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::stepNext (const char* prevIdStr, const char* nextIdStr)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     stepNext (IdStep(prevIdStr), IdStep(nextIdStr));
 }
 
 void AdvancedTimer::step     (const char* idStr)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     step     (IdStep(idStr));
 }
 
 void AdvancedTimer::step     (const char* idStr, const char* objStr)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     step     (IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::step     (const char* idStr, const std::string& objStr)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     step     (IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::valSet(const char* idStr, double val)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     valSet(IdVal(idStr),val);
 }
 
 void AdvancedTimer::valAdd(const char* idStr, double val)
 {
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!activeTimers) return;
     valAdd(IdVal(idStr),val);
 }
 
@@ -573,20 +904,12 @@ void TimerData::clear()
     valData.clear();
 }
 
-void TimerData::process()
+void TimerData::processRecords(helper::vector<Record>::const_iterator begin, helper::vector<Record>::const_iterator end, ctime_t t0, int level)
 {
-    if (records.empty()) return;
-    ++nbIter;
-    if (nbIter == 0) return; // do not keep stats on very first iteration
-
-    ctime_t t0 = records[0].time;
-    //ctime_t last_t = 0;
-    int level = 0;
-    for (unsigned int ri = 0; ri < records.size(); ++ri)
+    for (helper::vector<Record>::const_iterator it = begin; it != end; ++it)
     {
-        const Record& r = records[ri];
+        const Record& r = *it;
         ctime_t t = r.time - t0;
-        //last_t = r.time;
         if (r.type == Record::REND || r.type == Record::RSTEP_END) --level;
         switch (r.type)
         {
@@ -671,6 +994,28 @@ void TimerData::process()
 
         if (r.type == Record::RBEGIN || r.type == Record::RSTEP_BEGIN) ++level;
     }
+}
+
+void TimerData::process()
+{
+    if (records.empty()) return;
+    ++nbIter;
+    if (nbIter == 0) return; // do not keep stats on very first iteration
+
+    ctime_t t0 = records[0].time;
+    processRecords(records.begin(), records.end(), t0, 0);
+
+    // records of the other threads are sorted by thread, each thread being processed
+    // as a sequence nested inside the timer
+    helper::vector<Record>::const_iterator threadBegin = threadRecords.begin();
+    while (threadBegin != threadRecords.end())
+    {
+        helper::vector<Record>::const_iterator threadEnd = threadBegin;
+        while (threadEnd != threadRecords.end() && threadEnd->thread == threadBegin->thread)
+            ++threadEnd;
+        processRecords(threadBegin, threadEnd, t0, 1);
+        threadBegin = threadEnd;
+    }
 
     for (unsigned int vi=0; vi < vals.size(); ++vi)
     {
@@ -938,9 +1283,11 @@ AdvancedTimer::outputType AdvancedTimer::convertOutputType(std::string type)
 		return STDOUT;
     else if(type.compare("gui") == 0)
         return GUI;
+    else if(type.compare("trace") == 0)
+        return TRACE;
 	else // Add your own outputTypes before the else
 	{
-		msg_warning("AdvancedTimer") << "Unable to set output type to " << type << ". Switching to the default 'stdout' output. Valid types are [stdout, json, ljson].";
+		msg_warning("AdvancedTimer") << "Unable to set output type to " << type << ". Switching to the default 'stdout' output. Valid types are [stdout, json, ljson, trace].";
 		return STDOUT;
 	}
 }
@@ -948,7 +1295,7 @@ AdvancedTimer::outputType AdvancedTimer::convertOutputType(std::string type)
 void AdvancedTimer::setOutputType(IdTimer id, const std::string& type)
 {
     // Seek for the timer
-    TimerData& data = timers[id];
+    TimerData& data = getTimerData(id);
     if (!data.id)
     {
         data.init(id);
@@ -959,7 +1306,7 @@ void AdvancedTimer::setOutputType(IdTimer id, const std::string& type)
 
 AdvancedTimer::outputType AdvancedTimer::getOutputType(IdTimer id)
 {
-	TimerData& data = timers[id];
+	TimerData& data = getTimerData(id);
 	return data.timerOutputType;
 }
 
@@ -1389,7 +1736,7 @@ json TimerData::getLightJson(std::string stepNumber)
 
 helper::vector<AdvancedTimer::IdStep> AdvancedTimer::getSteps(IdTimer id, bool processData)
 {
-    TimerData& data = timers[id];
+    TimerData& data = getTimerData(id);
     if (processData)
         data.process();
     return data.steps;
@@ -1397,48 +1744,60 @@ helper::vector<AdvancedTimer::IdStep> AdvancedTimer::getSteps(IdTimer id, bool p
 
 std::map<AdvancedTimer::IdStep, StepData> AdvancedTimer::getStepData(IdTimer id, bool processData)
 {
-    TimerData& data = timers[id];
+    TimerData& data = getTimerData(id);
     if (processData)
         data.process();
     return data.stepData;
 }
 
-helper::vector<Record> AdvancedTimer::getRecords(IdTimer id)
+/// Fill the labels of the records from the names of their ids
+void setRecordLabels(helper::vector<Record>& records)
 {
-    TimerData& data = timers[id];
-    for (Record & r : data.records) {
+    for (Record & r : records) {
         switch (r.type) {
             case Record::RBEGIN: // Timer begins
             case Record::REND: // Timer ends
-                r.label = IdTimer::IdFactory::getName(r.id);
-                if (r.obj != 0 || (!IdObj::IdFactory::getName(r.obj).empty() && IdObj::IdFactory::getName(r.obj) != "0")) {
-                    r.label += " (" + IdObj::IdFactory::getName(r.obj) + ")";
+                r.label = AdvancedTimer::IdTimer::IdFactory::getName(r.id);
+                if (r.obj != 0 || (!AdvancedTimer::IdObj::IdFactory::getName(r.obj).empty() && AdvancedTimer::IdObj::IdFactory::getName(r.obj) != "0")) {
+                    r.label += " (" + AdvancedTimer::IdObj::IdFactory::getName(r.obj) + ")";
                 }
                 break;
             case Record::RSTEP_BEGIN: // Step begins
             case Record::RSTEP_END: // Step ends
             case Record::RSTEP: // Step
-                r.label = IdStep::IdFactory::getName(r.id);
-                if (r.obj != 0 || (!IdObj::IdFactory::getName(r.obj).empty() && IdObj::IdFactory::getName(r.obj) != "0")) {
-                    r.label += " (" + IdObj::IdFactory::getName(r.obj) + ")";
+                r.label = AdvancedTimer::IdStep::IdFactory::getName(r.id);
+                if (r.obj != 0 || (!AdvancedTimer::IdObj::IdFactory::getName(r.obj).empty() && AdvancedTimer::IdObj::IdFactory::getName(r.obj) != "0")) {
+                    r.label += " (" + AdvancedTimer::IdObj::IdFactory::getName(r.obj) + ")";
                 }
                 break;
             case Record::RVAL_SET: // Sets a value
             case Record::RVAL_ADD: // Adds a value
-                r.label = IdVal::IdFactory::getName(r.id);
+                r.label = AdvancedTimer::IdVal::IdFactory::getName(r.id);
                 break;
             default:
                 r.label = "Unknown";
                 break;
         }
     }
+}
 
+helper::vector<Record> AdvancedTimer::getRecords(IdTimer id)
+{
+    TimerData& data = getTimerData(id);
+    setRecordLabels(data.records);
     return data.records;
 }
 
+helper::vector<Record> AdvancedTimer::getThreadRecords(IdTimer id)
+{
+    TimerData& data = getTimerData(id);
+    setRecordLabels(data.threadRecords);
+    return data.threadRecords;
+}
+
 void AdvancedTimer::clearData(IdTimer id)
 {
-    TimerData& data = timers[id];
+    TimerData& data = getTimerData(id);
     data.clear();
 }
 
@@ -1469,42 +1828,18 @@ std::string AdvancedTimer::getTimeAnalysis(IdTimer id, simulation::Node* node)
         msg_error("AdvancedTimer::end") << "timer[" << id << "] does not correspond to last call to begin(" << curTimer.top() << ")" ;
         return nullptr;
     }
-    helper::vector<Record>* curRecords = getCurRecords();
-    if (curRecords)
+    endTimer(id, [&outputJson, &stepNumber](TimerData& data)
     {
-        if (syncCallBack) (*syncCallBack)(syncCallBackData);
-        Record r;
-        r.time = CTime::getTime();
-        r.type = Record::REND;
-        r.id = id;
-        curRecords->push_back(r);
-
-        TimerData& data = timers[curTimer.top()];
-        data.process();
-        if (data.nbIter == data.interval)
+        // Get values and create the JSON output
+        switch(data.timerOutputType)
         {
-            // Get values and create the JSON output
-            switch(data.timerOutputType)
-            {
-                case JSON   : outputJson = data.getJson(stepNumber);
-                              break;
-                case LJSON  : outputJson = data.getLightJson(stepNumber);
-                              break;
-                default :     outputJson = data.getJson(stepNumber);
-            }
-            data.clear();
+            case JSON   : outputJson = data.getJson(stepNumber);
+                          break;
+            case LJSON  : outputJson = data.getLightJson(stepNumber);
+                          break;
+            default :     outputJson = data.getJson(stepNumber);
         }
-    }
-    curTimer.pop();
-    if (curTimer.empty())
-    {
-        setCurRecords(nullptr);
-    }
-    else
-    {
-        TimerData& data = timers[curTimer.top()];
-        setCurRecords((data.interval == 0) ? nullptr : &(data.records));
-    }
+    });
 
     outputStr = outputJson.dump(4);
 
@@ -28,6 +28,8 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <mutex>
+#include <unordered_map>
 
 
 namespace sofa
@@ -78,6 +80,11 @@ namespace helper
   * When reloading/reseting the simulation:
     AdvancedTimer::clear();
 
+  Steps and values can be recorded from any thread while a timer is running, for instance
+  from the tasks of the TaskScheduler. The threads which did not begin the timer write into
+  their own preallocated ring buffer without locking, and these buffers are collected when
+  the timer ends (see getThreadRecords).
+
 
   The produced stats will looks like:
 
@@ -130,7 +137,9 @@ public:
     unsigned int id;
     unsigned int obj;
     double val;
-    Record() : type(RNONE), id(0), obj(0), val(0) {}
+    /// 0 for the thread running the timer, otherwise index of the thread which recorded it
+    unsigned int thread;
+    Record() : type(RNONE), id(0), obj(0), val(0), thread(0) {}
 };
 
 class StepData
@@ -157,72 +166,35 @@ public:
     class Id : public Base
     {
     public:
-        /** Internal class used to generate IDs. */
+        /** Internal class used to generate IDs.
+            The ids are shared by all the threads, lookups by name are cached per thread. */
         class SOFA_HELPER_API IdFactory : public Base
         {
         protected:
 
             /// the list of the id names. the Ids are the indices in the vector
             std::vector<std::string> idsList;
+            /// the ids indexed by their name
+            std::unordered_map<std::string, unsigned int> idsMap;
+            std::mutex idsMutex;
+
+            IdFactory();
 
-            IdFactory()
-            {
-                idsList.push_back(std::string("0")); // ID 0 == "0" or empty string
-            }
-            
         public:
-            
+
             /**
                @return the Id corresponding to the name of the id given in parameter
                If the name isn't found in the list, it is added to it and return the new id.
             */
-            static unsigned int getID(const std::string& name)
-            {
-                if (name.empty())
-                    return 0;
-                IdFactory& idfac = getInstance();
-                std::vector<std::string>::iterator it = idfac.idsList.begin();
-                unsigned int i = 0;
-
-                while (it != idfac.idsList.end() && (*it) != name)
-                {
-                    ++it;
-                    i++;
-                }
-
-                if (it!=idfac.idsList.end())
-                    return i;
-                else
-                {
-                    idfac.idsList.push_back(name);
-                    return i;
-                }
-            }
-
-            static std::size_t getLastID()
-            {
-                return getInstance().idsList.size()-1;
-            }
+            static unsigned int getID(const std::string& name);
+
+            static std::size_t getLastID();
 
             /// return the name corresponding to the id in parameter
-            static std::string getName(unsigned int id)
-            {
-                if (id < getInstance().idsList.size())
-                    return getInstance().idsList[id];
-                else
-                    return "";
-            }
+            static std::string getName(unsigned int id);
 
             /// return the instance of the factory. Creates it if doesn't exist yet.
-            static IdFactory& getInstance()
-            {
-                SOFA_THREAD_SPECIFIC_PTR(IdFactory, instance);
-                if (instance == nullptr)
-                {
-                    instance = new IdFactory;
-                }
-                return *instance;
-            }
+            static IdFactory& getInstance();
         };
 
         Id() : id(0) {}
@@ -293,7 +265,8 @@ public:
         STDOUT,
         LJSON,
         JSON,
-        GUI
+        GUI,
+        TRACE
     };
 
 
@@ -324,6 +297,24 @@ public:
 	static AdvancedTimer::outputType getOutputType(IdTimer id);
 
 
+    /**
+     * @brief setTraceFile Set the file where the timers using the "trace" output type write
+     * their timeline, in the Chrome trace event format (readable by chrome://tracing and
+     * the Perfetto UI). The previous file, if any, is closed. An empty name only closes it.
+     * Defaults to "sofa_trace.json" in the current directory.
+     * @param filename std::string, name of the trace file
+     */
+    static void setTraceFile(const std::string& filename);
+
+    /**
+     * @brief getTrace Return the last execution of the AdvancedTimer as Chrome trace events:
+     * steps become duration events, values become counters, and each thread which recorded
+     * something has its own track.
+     * @param id IdTimer, id of the timer
+     * @return The trace events of the timer as a JSON array
+     */
+    static std::string getTrace(IdTimer id);
+
     /**
      * @brief getTimeAnalysis Return the result of the AdvancedTimer
      * @param id IdTimer, id of the timer
@@ -355,6 +346,14 @@ public:
      */
     static helper::vector<Record> getRecords(IdTimer id);
 
+    /**
+     * @brief getThreadRecords the records made by the other threads (i.e. tasks run by the
+     * TaskScheduler) while the timer was running, grouped by thread.
+     * @param id IdTimer, id of the timer
+     * @return The records of each thread, in chronological order, inside a vector of Record
+     */
+    static helper::vector<Record> getThreadRecords(IdTimer id);
+
     /**
      * @brief clearDatato clear a specific Timer Data
      * @param id IdTimer, id of the timer
@@ -362,6 +361,17 @@ public:
     static void clearData(IdTimer id);
 
     static void clear();
+
+    /// Timers (records and statistics) owned by a simulation context. The threads use the
+    /// shared timers unless another set is installed with setThreadTimers().
+    class TimerSet;
+    static TimerSet* createTimerSet();
+    static void deleteTimerSet(TimerSet* timers);
+
+    /// Use the given timers in the calling thread, nullptr restores the shared ones
+    static void setThreadTimers(TimerSet* timers);
+    static TimerSet* getThreadTimers();
+
     static void begin(IdTimer id);
     static void end  (IdTimer id);
     static void end  (IdTimer id, std::ostream& result);
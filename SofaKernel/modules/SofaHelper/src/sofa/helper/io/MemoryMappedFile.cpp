@@ -0,0 +1,163 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/io/MemoryMappedFile.h>
+#include <sofa/helper/logging/Messaging.h>
+
+#ifdef WIN32
+# include <Windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace sofa
+{
+
+namespace helper
+{
+
+namespace io
+{
+
+MemoryMappedFile::MemoryMappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+#ifdef WIN32
+    , m_fileHandle(nullptr)
+    , m_mappingHandle(nullptr)
+#endif
+{
+}
+
+MemoryMappedFile::MemoryMappedFile(const std::string& filename)
+    : MemoryMappedFile()
+{
+    open(filename);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    close();
+}
+
+bool MemoryMappedFile::open(const std::string& filename)
+{
+    close();
+
+#ifdef WIN32
+    HANDLE file = ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        msg_error("MemoryMappedFile") << "Unable to open file: " << filename;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!::GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        msg_error("MemoryMappedFile") << "Unable to map empty or unreadable file: " << filename;
+        ::CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        msg_error("MemoryMappedFile") << "Unable to create a mapping for file: " << filename;
+        ::CloseHandle(file);
+        return false;
+    }
+
+    void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        msg_error("MemoryMappedFile") << "Unable to map file: " << filename;
+        ::CloseHandle(mapping);
+        ::CloseHandle(file);
+        return false;
+    }
+
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_size = static_cast<std::size_t>(fileSize.QuadPart);
+    m_data = static_cast<const char*>(view);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        msg_error("MemoryMappedFile") << "Unable to open file: " << filename;
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        msg_error("MemoryMappedFile") << "Unable to map empty or unreadable file: " << filename;
+        ::close(fd);
+        return false;
+    }
+
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping keeps its own reference on the file
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        msg_error("MemoryMappedFile") << "Unable to map file: " << filename;
+        return false;
+    }
+
+    m_size = static_cast<std::size_t>(st.st_size);
+    m_data = static_cast<const char*>(view);
+#endif
+
+    m_filename = filename;
+    return true;
+}
+
+void MemoryMappedFile::close()
+{
+    if (m_data == nullptr)
+        return;
+
+#ifdef WIN32
+    ::UnmapViewOfFile(m_data);
+    ::CloseHandle(m_mappingHandle);
+    ::CloseHandle(m_fileHandle);
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+#else
+    ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_filename.clear();
+}
+
+} // namespace io
+
+} // namespace helper
+
+} // namespace sofa
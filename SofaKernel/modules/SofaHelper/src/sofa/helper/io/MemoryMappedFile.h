@@ -0,0 +1,86 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_HELPER_IO_MEMORYMAPPEDFILE_H
+#define SOFA_HELPER_IO_MEMORYMAPPEDFILE_H
+
+#include <sofa/helper/helper.h>
+
+#include <cstddef>
+#include <string>
+
+namespace sofa
+{
+
+namespace helper
+{
+
+namespace io
+{
+
+/**
+ * \brief Read-only view of a whole file mapped in memory.
+ *
+ * The mapping is shared: every process mapping the same file uses the same
+ * physical pages of the system file cache, which makes it suitable for large
+ * precomputed data read by several simulations running on the same node.
+ */
+class SOFA_HELPER_API MemoryMappedFile
+{
+public:
+    MemoryMappedFile();
+    explicit MemoryMappedFile(const std::string& filename);
+
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    /// Map the whole file. Any previously mapped file is released first.
+    /// @return false (with an error message) if the file cannot be mapped.
+    bool open(const std::string& filename);
+
+    /// Release the mapping. Pointers returned by data() become invalid.
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+
+    const char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    const std::string& filename() const { return m_filename; }
+
+private:
+    const char* m_data;
+    std::size_t m_size;
+    std::string m_filename;
+#ifdef WIN32
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#endif
+};
+
+} // namespace io
+
+} // namespace helper
+
+} // namespace sofa
+
+#endif // SOFA_HELPER_IO_MEMORYMAPPEDFILE_H
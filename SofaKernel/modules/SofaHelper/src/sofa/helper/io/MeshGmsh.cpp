@@ -25,6 +25,9 @@
 #include <sofa/helper/system/SetDirectory.h>
 #include <sofa/helper/system/Locale.h>
 #include <sofa/helper/logging/Messaging.h>
+#include <sofa/helper/io/TextParser.h>
+#include <sofa/helper/IndexOpenMP.h>
+#include <algorithm>
 #include <istream>
 #include <fstream>
 #include <string>
@@ -119,32 +122,75 @@ void MeshGmsh::normalizeGroup(helper::vector< sofa::core::loader::PrimitiveGroup
 }
 
 
+namespace
+{
+
+/// Element of a Gmsh file, with its nodes already renumbered
+struct GmshElement
+{
+    int etype;
+    int tag;
+    int nnodes;
+    helper::fixed_array<unsigned int, 10> nodes; ///< the known element types have at most 10 nodes
+};
+
+} // anonymous namespace
+
 bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
 {
-    int npoints = 0;
     int nlines = 0;
     int ntris = 0;
     int nquads = 0;
     int ntetrahedra = 0;
     int ncubes = 0;
 
+    // The rest of the file is parsed from memory: each node and each element is on its own
+    // line, so the lines are converted in parallel before being added in order.
+    std::string content;
+    const std::streamoff begin = file.tellg();
+    file.seekg(0, std::ios::end);
+    content.resize(std::size_t(std::max<std::streamoff>(file.tellg() - begin, 0)));
+    file.seekg(begin, std::ios::beg);
+    file.read(&content[0], std::streamsize(content.size()));
+    content.resize(std::size_t(file.gcount()));
+
+    TextParser parser(content);
     std::string cmd;
+    std::vector<const char*> lines;
 
     // --- Loading Vertices ---
-    file >> npoints; //nb points
+    int npoints = 0;
+    parser.read(npoints); //nb points
+    npoints = int(parser.nextLines(std::size_t(std::max(npoints, 0)), lines));
+
+    std::vector<int> indices(npoints);
+    m_vertices.resize(npoints);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type i = 0; i < (unsigned int)npoints; ++i)
+    {
+        TextParser line(lines[i], parser.end());
+        int index = int(i);
+        double x = 0, y = 0, z = 0;
+        line.read(index);
+        line.read(x);
+        line.read(y);
+        line.read(z);
+        m_vertices[i] = sofa::defaulttype::Vector3(x, y, z);
+        indices[i] = index;
+    }
 
     std::vector<int> pmap; // map for reordering vertices possibly not well sorted
     for (int i = 0; i<npoints; ++i)
     {
-        int index = i;
-        double x, y, z;
-        file >> index >> x >> y >> z;
-        m_vertices.push_back(sofa::defaulttype::Vector3(x, y, z));
+        const int index = indices[i];
+        if (index < 0) continue;
         if ((int)pmap.size() <= index) pmap.resize(index + 1);
         pmap[index] = i; // In case of hole or swit
     }
-    
-    file >> cmd;
+
+    parser.readWord(cmd);
     if (cmd != "$ENDNOD" && cmd != "$EndNodes")
     {
         msg_error("MeshGmsh") << "'$ENDNOD' or '$EndNodes' expected, found '" << cmd << "'";
@@ -152,7 +198,7 @@ bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
     }
 
     // --- Loading Elements ---
-    file >> cmd;
+    parser.readWord(cmd);
     if (cmd != "$ELM" && cmd != "$Elements")
     {
         msg_error("MeshGmsh") << "'$ELM' or '$Elements' expected, found '" << cmd << "'";
@@ -160,78 +206,102 @@ bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
     }
 
     int nelems = 0;
-    file >> nelems;
-
-    for (int i = 0; i<nelems; ++i) // for each elem
+    parser.read(nelems);
+    lines.clear();
+    nelems = int(parser.nextLines(std::size_t(std::max(nelems, 0)), lines));
+
+    std::vector<GmshElement> elements(nelems);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type i = 0; i < (unsigned int)nelems; ++i)
     {
-        int index = -1, etype = -1, nnodes = -1, ntags = -1, tag = -1;
+        TextParser line(lines[i], parser.end());
+        GmshElement& element = elements[i];
+        int index = -1, ntags = -1;
+        element.etype = -1;
+        element.tag = -1;
+        element.nnodes = -1;
         if (gmshFormat == 1)
         {
             // version 1.0 format is
             // elm-number elm-type reg-phys reg-elem number-of-nodes <node-number-list ...>
             int rphys = -1, relem = -1;
-            file >> index >> etype >> rphys >> relem >> nnodes;
+            line.read(index);
+            line.read(element.etype);
+            line.read(rphys);
+            line.read(relem);
+            line.read(element.nnodes);
         }
         else /*if (gmshFormat == 2)*/
         {
             // version 2.0 format is
             // elm-number elm-type number-of-tags < tag > ... node-number-list
-            file >> index >> etype >> ntags;
+            line.read(index);
+            line.read(element.etype);
+            line.read(ntags);
 
             for (int t = 0; t<ntags; t++)
             {
-                file >> tag;
+                line.read(element.tag);
                 // read the tag but don't use it
             }
 
-            switch (etype)
+            switch (element.etype)
             {
             case 15: //point
-                nnodes = 1;
+                element.nnodes = 1;
                 break;
             case 1: // Line
-                nnodes = 2;
+                element.nnodes = 2;
                 break;
             case 2: // Triangle
-                nnodes = 3;
+                element.nnodes = 3;
                 break;
             case 3: // Quad
-                nnodes = 4;
+                element.nnodes = 4;
                 break;
             case 4: // Tetra
-                nnodes = 4;
+                element.nnodes = 4;
                 break;
             case 5: // Hexa
-                nnodes = 8;
+                element.nnodes = 8;
                 break;
             case 8: // Quadratic edge
-                nnodes = 3;
+                element.nnodes = 3;
                 break;
             case 9: // Quadratic Triangle
-                nnodes = 6;
+                element.nnodes = 6;
                 break;
             case 11: // Quadratic Tetrahedron
-                nnodes = 10;
+                element.nnodes = 10;
                 break;
             default:
-                msg_error("MeshGmsh") << "Elements of type 1, 2, 3, 4, 5, or 6 expected. Element of type " << etype << " found.";
-                nnodes = 0;
+                element.nnodes = 0;
             }
         }
 
-        helper::vector<unsigned int> nodes;
-        nodes.resize(nnodes);
-        const unsigned int edgesInQuadraticTriangle[3][2] = { { 0,1 },{ 1,2 },{ 2,0 } };
-        const unsigned int edgesInQuadraticTetrahedron[6][2] = { { 0,1 },{ 1,2 },{ 0,2 },{ 0,3 },{ 2,3 },{ 1,3 } };
-        std::set<Topology::Edge> edgeSet;
-        size_t j;
-        for (int n = 0; n<nnodes; ++n)
+        element.nodes.assign(0);
+        for (int n = 0; n < element.nnodes && n < (int)element.nodes.size(); ++n)
         {
             int t = 0;
-            file >> t;
-            nodes[n] = (((unsigned int)t)<pmap.size()) ? pmap[t] : 0;
+            line.read(t);
+            element.nodes[n] = (((unsigned int)t)<pmap.size()) ? pmap[t] : 0;
         }
+    }
 
+    const unsigned int edgesInQuadraticTriangle[3][2] = { { 0,1 },{ 1,2 },{ 2,0 } };
+    const unsigned int edgesInQuadraticTetrahedron[6][2] = { { 0,1 },{ 1,2 },{ 0,2 },{ 0,3 },{ 2,3 },{ 1,3 } };
+    for (const GmshElement& element : elements) // for each elem
+    {
+        const int etype = element.etype;
+        const int tag = element.tag;
+        const helper::fixed_array<unsigned int, 10>& nodes = element.nodes;
+        if (gmshFormat != 1 && element.nnodes == 0)
+            msg_error("MeshGmsh") << "Elements of type 1, 2, 3, 4, 5, or 6 expected. Element of type " << etype << " found.";
+
+        std::set<Topology::Edge> edgeSet;
+        size_t j;
         switch (etype)
         {
         case 1: // Line
@@ -321,9 +391,8 @@ bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
             ++ntetrahedra;
             break;
         default:
-            //if the type is not handled, skip rest of the line
-            std::string tmp;
-            std::getline(file, tmp);
+            //if the type is not handled, the rest of its line is ignored
+            break;
         }
     }
 
@@ -332,7 +401,7 @@ bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
     normalizeGroup(m_tetrahedraGroups);
     normalizeGroup(m_hexahedraGroups);
 
-    file >> cmd;
+    parser.readWord(cmd);
     if (cmd != "$ENDELM" && cmd != "$EndElements")
     {
         msg_error("MeshGmsh") << "'$ENDELM' or '$EndElements' expected, found '" << cmd << "'";
@@ -0,0 +1,279 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/io/PrecomputedDataCache.h>
+
+#include <sofa/helper/logging/Messaging.h>
+#include <sofa/helper/system/FileSystem.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+namespace sofa
+{
+
+namespace helper
+{
+
+namespace io
+{
+
+namespace
+{
+
+const char s_magic[8] = { 'S', 'O', 'F', 'A', 'C', 'A', 'C', 'H' };
+const std::uint32_t s_fileVersion = 1;
+const std::uint32_t s_byteOrder = 0x01020304;
+
+struct Header
+{
+    char magic[8];
+    std::uint32_t fileVersion;
+    std::uint32_t byteOrder;
+    std::uint32_t keyVersion;
+    std::uint32_t padding;
+    std::uint64_t hash[2];
+    std::uint64_t payloadSize;
+    std::uint64_t checksum;
+};
+
+std::uint64_t fnv1a(std::uint64_t hash, const unsigned char* bytes, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/// Finalizer of splitmix64, used to build the second half of the hash on whole words.
+std::uint64_t mix(std::uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+std::mutex s_directoryMutex;
+bool s_directoryInitialized = false;
+std::string s_directory;
+
+} // anonymous namespace
+
+PrecomputedDataCache::Key::Key(const std::string& kind, unsigned int version)
+    : m_kind(kind)
+    , m_version(version)
+{
+    m_hash[0] = 14695981039346656037ull;
+    m_hash[1] = 0x9e3779b97f4a7c15ull;
+    add(kind);
+    add(version);
+}
+
+PrecomputedDataCache::Key& PrecomputedDataCache::Key::addBytes(const void* data, std::size_t size)
+{
+    const std::uint64_t size64 = size;
+    m_hash[0] = fnv1a(m_hash[0], reinterpret_cast<const unsigned char*>(&size64), sizeof(size64));
+    m_hash[1] = mix(m_hash[1] ^ size64);
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    m_hash[0] = fnv1a(m_hash[0], bytes, size);
+
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        m_hash[1] = mix(m_hash[1] ^ word) + i;
+    }
+    if (i < size)
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, bytes + i, size - i);
+        m_hash[1] = mix(m_hash[1] ^ word) + i;
+    }
+    return *this;
+}
+
+std::string PrecomputedDataCache::Key::filename() const
+{
+    std::ostringstream name;
+    name << m_kind << '-' << std::hex << std::setfill('0')
+         << std::setw(16) << m_hash[0] << std::setw(16) << m_hash[1] << ".cache";
+    return name.str();
+}
+
+void PrecomputedDataCache::Entry::writeArray(const void* data, std::size_t elementSize, std::size_t count)
+{
+    const std::uint64_t sizes[2] = { elementSize, count };
+    const char* sizeBytes = reinterpret_cast<const char*>(sizes);
+    m_buffer.insert(m_buffer.end(), sizeBytes, sizeBytes + sizeof(sizes));
+    const char* bytes = reinterpret_cast<const char*>(data);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + elementSize * count);
+}
+
+const char* PrecomputedDataCache::Entry::readArray(std::size_t elementSize, std::size_t& count)
+{
+    std::uint64_t sizes[2];
+    if (m_buffer.size() - m_cursor < sizeof(sizes))
+        return nullptr;
+    std::memcpy(sizes, m_buffer.data() + m_cursor, sizeof(sizes));
+    if (sizes[0] != elementSize || (m_buffer.size() - m_cursor - sizeof(sizes)) / elementSize < sizes[1])
+        return nullptr;
+
+    const char* bytes = m_buffer.data() + m_cursor + sizeof(sizes);
+    count = std::size_t(sizes[1]);
+    m_cursor += sizeof(sizes) + count * elementSize;
+    return bytes;
+}
+
+std::string PrecomputedDataCache::getDirectory()
+{
+    std::lock_guard<std::mutex> lock(s_directoryMutex);
+    if (!s_directoryInitialized)
+    {
+        const char* directory = std::getenv("SOFA_PRECOMPUTED_CACHE");
+        if (directory)
+            s_directory = directory;
+        s_directoryInitialized = true;
+    }
+    return s_directory;
+}
+
+void PrecomputedDataCache::setDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(s_directoryMutex);
+    s_directory = directory;
+    s_directoryInitialized = true;
+}
+
+bool PrecomputedDataCache::load(const Key& key, Entry& entry)
+{
+    entry.clear();
+
+    const std::string directory = getDirectory();
+    if (directory.empty())
+        return false;
+
+    const std::string filename = directory + "/" + key.filename();
+    std::ifstream in(filename.c_str(), std::ifstream::binary);
+    if (!in.is_open())
+        return false;
+
+    Header header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+            || std::memcmp(header.magic, s_magic, sizeof(s_magic)) != 0
+            || header.fileVersion != s_fileVersion
+            || header.byteOrder != s_byteOrder
+            || header.keyVersion != key.version()
+            || header.hash[0] != key.hash0()
+            || header.hash[1] != key.hash1())
+    {
+        msg_warning("PrecomputedDataCache") << "Ignoring invalid cache file " << filename;
+        return false;
+    }
+
+    entry.m_buffer.resize(std::size_t(header.payloadSize));
+    if (!in.read(entry.m_buffer.data(), std::streamsize(entry.m_buffer.size()))
+            || fnv1a(14695981039346656037ull, reinterpret_cast<const unsigned char*>(entry.m_buffer.data()), entry.m_buffer.size()) != header.checksum)
+    {
+        msg_warning("PrecomputedDataCache") << "Ignoring corrupted cache file " << filename;
+        entry.clear();
+        return false;
+    }
+    return true;
+}
+
+bool PrecomputedDataCache::store(const Key& key, const Entry& entry)
+{
+    const std::string directory = getDirectory();
+    if (directory.empty())
+        return false;
+
+    if (!system::FileSystem::exists(directory) && !system::FileSystem::createDirectory(directory)
+            && !system::FileSystem::isDirectory(directory))
+    {
+        msg_error("PrecomputedDataCache") << "Unable to create the cache directory " << directory;
+        return false;
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, s_magic, sizeof(s_magic));
+    header.fileVersion = s_fileVersion;
+    header.byteOrder = s_byteOrder;
+    header.keyVersion = key.version();
+    header.hash[0] = key.hash0();
+    header.hash[1] = key.hash1();
+    header.payloadSize = entry.m_buffer.size();
+    header.checksum = fnv1a(14695981039346656037ull, reinterpret_cast<const unsigned char*>(entry.m_buffer.data()), entry.m_buffer.size());
+
+    // Write in a temporary file renamed at the end, so that other processes never
+    // read a partially written file. The temporary name is random as several
+    // processes may compute the same entry at the same time.
+    const std::string filename = directory + "/" + key.filename();
+    std::ostringstream tmpFilename;
+    tmpFilename << filename << '.' << std::hex << std::random_device()() << ".tmp";
+    {
+        std::ofstream out(tmpFilename.str().c_str(), std::ofstream::binary | std::ofstream::trunc);
+        if (!out.is_open())
+        {
+            msg_error("PrecomputedDataCache") << "Unable to write file " << tmpFilename.str();
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(entry.m_buffer.data(), std::streamsize(entry.m_buffer.size()));
+        if (!out)
+        {
+            msg_error("PrecomputedDataCache") << "Error while writing file " << tmpFilename.str();
+            out.close();
+            std::remove(tmpFilename.str().c_str());
+            return false;
+        }
+    }
+
+#ifdef WIN32
+    // rename does not replace an existing file on Windows
+    std::remove(filename.c_str());
+#endif
+    if (std::rename(tmpFilename.str().c_str(), filename.c_str()) != 0)
+    {
+        msg_error("PrecomputedDataCache") << "Unable to rename " << tmpFilename.str() << " into " << filename;
+        std::remove(tmpFilename.str().c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace io
+
+} // namespace helper
+
+} // namespace sofa
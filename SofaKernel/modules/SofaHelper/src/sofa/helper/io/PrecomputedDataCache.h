@@ -0,0 +1,181 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_HELPER_IO_PRECOMPUTEDDATACACHE_H
+#define SOFA_HELPER_IO_PRECOMPUTEDDATACACHE_H
+
+#include <sofa/helper/helper.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace sofa
+{
+
+namespace helper
+{
+
+namespace io
+{
+
+/**
+ * \brief On-disk cache of data computed during the initialization of a scene.
+ *
+ * Results are stored in one file per Key, the Key being a hash of everything the
+ * computation depends on (input positions, topology, parameters...). Launching the
+ * same scene again then reads the results back instead of recomputing them.
+ *
+ * The cache is disabled by default. It is enabled by setting the environment
+ * variable SOFA_PRECOMPUTED_CACHE to a directory, or by calling setDirectory().
+ * Files are written atomically, so several processes can share the same directory.
+ *
+ * \code
+ * PrecomputedDataCache::Key key("SparseGridTypes", 1);
+ * key.add(vertices).add(n);
+ * PrecomputedDataCache::Entry entry;
+ * if (!PrecomputedDataCache::load(key, entry) || !entry.read(types))
+ * {
+ *     compute(types);
+ *     entry.clear();
+ *     entry.write(types);
+ *     PrecomputedDataCache::store(key, entry);
+ * }
+ * \endcode
+ */
+class SOFA_HELPER_API PrecomputedDataCache
+{
+public:
+    /// Identifies a cached computation: its kind, the version of the code producing
+    /// the data and a 128 bits hash of its inputs.
+    class SOFA_HELPER_API Key
+    {
+    public:
+        /// The version must be increased when the cached computation changes, to
+        /// invalidate the files written by older versions.
+        Key(const std::string& kind, unsigned int version);
+
+        /// Hash raw bytes. The size is hashed too, so that consecutive additions
+        /// of variable size cannot be confused.
+        Key& addBytes(const void* data, std::size_t size);
+
+        Key& add(const std::string& value) { return addBytes(value.data(), value.size()); }
+
+        /// Hash a trivially copyable value (integer, real, Vec, fixed_array...).
+        template<class T>
+        typename std::enable_if<std::is_trivially_copyable<T>::value, Key&>::type add(const T& value)
+        {
+            return addBytes(&value, sizeof(T));
+        }
+
+        /// Hash a contiguous array of trivially copyable values.
+        template<class T, class Alloc>
+        Key& add(const std::vector<T, Alloc>& values)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "only arrays of trivially copyable types can be hashed");
+            return addBytes(values.data(), values.size() * sizeof(T));
+        }
+
+        const std::string& kind() const { return m_kind; }
+        unsigned int version() const { return m_version; }
+        std::uint64_t hash0() const { return m_hash[0]; }
+        std::uint64_t hash1() const { return m_hash[1]; }
+
+        /// Name of the cache file, "<kind>-<hash>.cache".
+        std::string filename() const;
+
+    private:
+        std::string m_kind;
+        unsigned int m_version;
+        std::uint64_t m_hash[2];
+    };
+
+    /// Content of a cache file: a sequence of arrays, read back in the order they
+    /// were written.
+    class SOFA_HELPER_API Entry
+    {
+    public:
+        Entry() : m_cursor(0) {}
+
+        void clear() { m_buffer.clear(); m_cursor = 0; }
+
+        template<class T, class Alloc>
+        void write(const std::vector<T, Alloc>& values)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "only arrays of trivially copyable types can be cached");
+            writeArray(values.data(), sizeof(T), values.size());
+        }
+
+        /// @return false if the next array of the entry does not hold values of type T.
+        template<class T, class Alloc>
+        bool read(std::vector<T, Alloc>& values)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "only arrays of trivially copyable types can be cached");
+            std::size_t count;
+            const char* bytes = readArray(sizeof(T), count);
+            if (!bytes)
+                return false;
+            values.resize(count);
+            if (count)
+                std::memcpy(values.data(), bytes, count * sizeof(T));
+            return true;
+        }
+
+        /// @return true when all the arrays have been read.
+        bool atEnd() const { return m_cursor == m_buffer.size(); }
+
+    private:
+        void writeArray(const void* data, std::size_t elementSize, std::size_t count);
+        const char* readArray(std::size_t elementSize, std::size_t& count);
+
+        std::vector<char> m_buffer;
+        std::size_t m_cursor;
+
+        friend class PrecomputedDataCache;
+    };
+
+    /// Directory of the cache files, empty when the cache is disabled.
+    static std::string getDirectory();
+
+    /// Set the directory of the cache files, overriding SOFA_PRECOMPUTED_CACHE.
+    /// An empty string disables the cache.
+    static void setDirectory(const std::string& directory);
+
+    static bool isEnabled() { return !getDirectory().empty(); }
+
+    /// Read the entry stored for key.
+    /// @return false if the cache is disabled, or if there is no valid file for key.
+    static bool load(const Key& key, Entry& entry);
+
+    /// Write entry as the cached data of key, replacing any previous file.
+    /// @return false if the cache is disabled or if the file cannot be written.
+    static bool store(const Key& key, const Entry& entry);
+};
+
+} // namespace io
+
+} // namespace helper
+
+} // namespace sofa
+
+#endif // SOFA_HELPER_IO_PRECOMPUTEDDATACACHE_H
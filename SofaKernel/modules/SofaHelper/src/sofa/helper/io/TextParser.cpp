@@ -0,0 +1,190 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/io/TextParser.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+namespace sofa
+{
+
+namespace helper
+{
+
+namespace io
+{
+
+namespace
+{
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+inline bool isBlank(char c) { return isSpace(c) || c == '\n'; }
+
+template<class T>
+const char* parseInteger(const char* first, const char* last, T& value)
+{
+    if (first != last && *first == '+')
+        ++first;
+    const std::from_chars_result result = std::from_chars(first, last, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+/// Conversion of a token with strtod, used when from_chars does not handle it.
+template<class T>
+const char* parseWithStrtod(const char* first, const char* last, T& value)
+{
+    char buffer[128];
+    const std::size_t size = std::min<std::size_t>(std::size_t(last - first), sizeof(buffer) - 1);
+    std::memcpy(buffer, first, size);
+    buffer[size] = '\0';
+    char* end = nullptr;
+    const double d = std::strtod(buffer, &end);
+    if (end == buffer)
+        return nullptr;
+    value = static_cast<T>(d);
+    return first + (end - buffer);
+}
+
+template<class T>
+const char* parseReal(const char* first, const char* last, T& value)
+{
+    if (first != last && *first == '+')
+        ++first;
+#if defined(__cpp_lib_to_chars)
+    const std::from_chars_result result = std::from_chars(first, last, value);
+    if (result.ec == std::errc())
+        return result.ptr;
+    if (result.ec != std::errc::result_out_of_range)
+        return nullptr;
+    // underflows and overflows are converted to 0 and infinity, as strtod does
+#endif
+    return parseWithStrtod(first, last, value);
+}
+
+} // anonymous namespace
+
+bool TextParser::skipBlanks()
+{
+    while (m_cur != m_end && isBlank(*m_cur))
+        ++m_cur;
+    return m_cur != m_end;
+}
+
+bool TextParser::skipSpaces()
+{
+    while (m_cur != m_end && isSpace(*m_cur))
+        ++m_cur;
+    return m_cur != m_end && *m_cur != '\n';
+}
+
+void TextParser::skipLine()
+{
+    const char* eol = static_cast<const char*>(std::memchr(m_cur, '\n', std::size_t(m_end - m_cur)));
+    m_cur = eol ? eol + 1 : m_end;
+}
+
+bool TextParser::readWord(const char*& wordBegin, const char*& wordEnd)
+{
+    if (!skipBlanks())
+        return false;
+    wordBegin = m_cur;
+    while (m_cur != m_end && !isBlank(*m_cur))
+        ++m_cur;
+    wordEnd = m_cur;
+    return true;
+}
+
+bool TextParser::readWord(std::string& word)
+{
+    const char* wordBegin;
+    const char* wordEnd;
+    if (!readWord(wordBegin, wordEnd))
+        return false;
+    word.assign(wordBegin, wordEnd);
+    return true;
+}
+
+bool TextParser::readLine(const char*& lineBegin, const char*& lineEnd)
+{
+    if (m_cur == m_end)
+        return false;
+    lineBegin = m_cur;
+    skipLine();
+    lineEnd = m_cur;
+    if (lineEnd != lineBegin && lineEnd[-1] == '\n')
+        --lineEnd;
+    if (lineEnd != lineBegin && lineEnd[-1] == '\r')
+        --lineEnd;
+    return true;
+}
+
+std::size_t TextParser::nextLines(std::size_t nbLines, std::vector<const char*>& lineBegins)
+{
+    std::size_t nbFound = 0;
+    while (nbFound < nbLines && skipBlanks())
+    {
+        lineBegins.push_back(m_cur);
+        skipLine();
+        ++nbFound;
+    }
+    return nbFound;
+}
+
+std::vector<const char*> TextParser::splitInChunks(const char* begin, const char* end, std::size_t nbChunks)
+{
+    std::vector<const char*> boundaries(1, begin);
+    const std::size_t size = std::size_t(end - begin);
+    if (nbChunks == 0)
+        nbChunks = 1;
+    for (std::size_t i = 1; i < nbChunks; ++i)
+    {
+        const char* target = begin + size / nbChunks * i;
+        if (target <= boundaries.back())
+            continue;
+        const char* eol = static_cast<const char*>(std::memchr(target, '\n', std::size_t(end - target)));
+        if (!eol)
+            break;
+        if (eol + 1 > boundaries.back() && eol + 1 < end)
+            boundaries.push_back(eol + 1);
+    }
+    boundaries.push_back(end);
+    return boundaries;
+}
+
+const char* TextParser::parse(const char* first, const char* last, short& value) { return parseInteger(first, last, value); }
+const char* TextParser::parse(const char* first, const char* last, unsigned short& value) { return parseInteger(first, last, value); }
+const char* TextParser::parse(const char* first, const char* last, int& value) { return parseInteger(first, last, value); }
+const char* TextParser::parse(const char* first, const char* last, unsigned int& value) { return parseInteger(first, last, value); }
+const char* TextParser::parse(const char* first, const char* last, long& value) { return parseInteger(first, last, value); }
+const char* TextParser::parse(const char* first, const char* last, unsigned long& value) { return parseInteger(first, last, value); }
+const char* TextParser::parse(const char* first, const char* last, long long& value) { return parseInteger(first, last, value); }
+const char* TextParser::parse(const char* first, const char* last, unsigned long long& value) { return parseInteger(first, last, value); }
+const char* TextParser::parse(const char* first, const char* last, float& value) { return parseReal(first, last, value); }
+const char* TextParser::parse(const char* first, const char* last, double& value) { return parseReal(first, last, value); }
+
+} // namespace io
+
+} // namespace helper
+
+} // namespace sofa
@@ -0,0 +1,121 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_HELPER_IO_TEXTPARSER_H
+#define SOFA_HELPER_IO_TEXTPARSER_H
+
+#include <sofa/helper/helper.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sofa
+{
+
+namespace helper
+{
+
+namespace io
+{
+
+/**
+ * \brief Cursor reading numbers and words from a text held in memory.
+ *
+ * It is a replacement of std::istream extraction operators for the mesh
+ * loaders: numbers are converted with std::from_chars, which does not depend
+ * on the locale and does not allocate, and the text can be split in chunks
+ * of whole lines parsed by different threads.
+ */
+class SOFA_HELPER_API TextParser
+{
+public:
+    TextParser(const char* begin, const char* end) : m_cur(begin), m_end(end) {}
+    explicit TextParser(const std::string& text) : m_cur(text.data()), m_end(text.data() + text.size()) {}
+
+    const char* position() const { return m_cur; }
+    const char* end() const { return m_end; }
+
+    /// Skip spaces, tabs and end of lines.
+    /// @return false if the end of the text is reached.
+    bool skipBlanks();
+
+    /// Skip spaces and tabs, but not the end of the current line.
+    /// @return false if the end of the line (or of the text) is reached.
+    bool skipSpaces();
+
+    /// Move the cursor to the beginning of the next line.
+    void skipLine();
+
+    /// Read the next number, as the >> operator of a stream would do.
+    /// @return false (leaving the cursor at the beginning of the token) if it is not a number.
+    template<class T>
+    bool read(T& value)
+    {
+        if (!skipBlanks())
+            return false;
+        const char* next = parse(m_cur, m_end, value);
+        if (!next)
+            return false;
+        m_cur = next;
+        return true;
+    }
+
+    /// Read the next sequence of non blank characters.
+    bool readWord(std::string& word);
+    bool readWord(const char*& wordBegin, const char*& wordEnd);
+
+    /// Give the remaining characters of the current line, without the end of line, and move to the next one.
+    bool readLine(const char*& lineBegin, const char*& lineEnd);
+
+    /// Store the beginning of the next nbLines non empty lines and move after them.
+    /// @return the number of lines found before the end of the text.
+    std::size_t nextLines(std::size_t nbLines, std::vector<const char*>& lineBegins);
+
+    /// Cut the text in about nbChunks parts made of whole lines.
+    /// @return the boundaries of the parts, i.e. (number of parts + 1) pointers.
+    static std::vector<const char*> splitInChunks(const char* begin, const char* end, std::size_t nbChunks);
+
+    /// Parse a number at the beginning of [first,last), accepting a leading '+' as streams do.
+    /// @return the position after the number, or nullptr if there is no number.
+    static const char* parse(const char* first, const char* last, short& value);
+    static const char* parse(const char* first, const char* last, unsigned short& value);
+    static const char* parse(const char* first, const char* last, int& value);
+    static const char* parse(const char* first, const char* last, unsigned int& value);
+    static const char* parse(const char* first, const char* last, long& value);
+    static const char* parse(const char* first, const char* last, unsigned long& value);
+    static const char* parse(const char* first, const char* last, long long& value);
+    static const char* parse(const char* first, const char* last, unsigned long long& value);
+    static const char* parse(const char* first, const char* last, float& value);
+    static const char* parse(const char* first, const char* last, double& value);
+
+private:
+    const char* m_cur;
+    const char* m_end;
+};
+
+} // namespace io
+
+} // namespace helper
+
+} // namespace sofa
+
+#endif // SOFA_HELPER_IO_TEXTPARSER_H
@@ -46,10 +46,18 @@ using std::remove ;
 #include <sofa/helper/logging/DefaultStyleMessageFormatter.h>
 using sofa::helper::logging::DefaultStyleMessageFormatter;
 
+#include <sofa/helper/system/thread/thread_specific_ptr.h>
+
 #include <mutex>
 using std::lock_guard ;
 using std::mutex;
 
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <map>
+#include <tuple>
+
 namespace sofa
 {
 
@@ -69,6 +77,10 @@ namespace logging
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 /// Threading issues...
 ///     a mutex is serializing the access to the message API.
+///     in asynchronous mode the emitting threads push their messages in a lock-free list
+///     which is emptied by a background thread holding the mutex while processing them.
+///     The synchronous handlers, which access the emitting components, are called by the
+///     emitting threads and serialized by their own mutex.
 /// Memory management:
 ///     object are passed to the message info.
 ///     some of them are duplicated
@@ -102,6 +114,7 @@ public:
         if( std::find(m_messageHandlers.begin(), m_messageHandlers.end(), o) == m_messageHandlers.end())
         {
             m_messageHandlers.push_back(o) ;
+            updateSynchronousHandlers();
             return (int)(m_messageHandlers.size()-1);
         }
         return -1;
@@ -110,25 +123,194 @@ public:
     int rmHandler(MessageHandler* o)
     {
         m_messageHandlers.erase(remove(m_messageHandlers.begin(), m_messageHandlers.end(), o), m_messageHandlers.end());
+        updateSynchronousHandlers();
         return (int)(m_messageHandlers.size()-1);
     }
 
     void clearHandlers()
     {
         m_messageHandlers.clear() ;
+        updateSynchronousHandlers();
+    }
+
+    /// Copy of the synchronous handlers, used in asynchronous mode by the emitting threads
+    /// without taking the main mutex (protected by m_synchronousMutex)
+    mutex m_synchronousMutex;
+    std::vector<MessageHandler*> m_synchronousHandlers;
+
+    void updateSynchronousHandlers()
+    {
+        lock_guard<mutex> guard(m_synchronousMutex);
+        m_synchronousHandlers.clear();
+        for (MessageHandler* handler : m_messageHandlers)
+            if (handler->isSynchronous())
+                m_synchronousHandlers.push_back(handler);
     }
 
     void process(sofa::helper::logging::Message& m)
     {
-        for( size_t i=0 ; i<m_messageHandlers.size() ; i++ ){
-            m_messageHandlers[i]->process(m) ;
+        process(m, m_messageHandlers);
+    }
+
+    void process(sofa::helper::logging::Message& m, const std::vector<MessageHandler*>& handlers, bool queued = false)
+    {
+        if (m_rateLimit && !checkRate(m))
+            return;
+        for( size_t i=0 ; i<handlers.size() ; i++ ){
+            // the synchronous handlers already processed the queued messages
+            if (queued && handlers[i]->isSynchronous())
+                continue;
+            handlers[i]->process(m) ;
+        }
+    }
+
+    /// Rate limiting of the messages emitted from the same line
+    /// (protected by the mutex as the handlers)
+    struct RateCounter
+    {
+        std::chrono::steady_clock::time_point windowStart;
+        unsigned int count {0};
+        unsigned int suppressed {0};
+    };
+    unsigned int m_rateLimit {0};
+    std::map< std::tuple<const char*, int, int>, RateCounter > m_rateCounters;
+
+    /// Returns false if the message must be suppressed
+    bool checkRate(Message& m)
+    {
+        const FileInfo::SPtr& fileInfo = m.fileInfo();
+        if (!fileInfo || fileInfo->line == 0)
+            return true;
+
+        RateCounter& counter = m_rateCounters[std::make_tuple(fileInfo->filename, fileInfo->line, int(m.type()))];
+        const auto now = std::chrono::steady_clock::now();
+        if (now - counter.windowStart >= std::chrono::seconds(1))
+        {
+            if (counter.suppressed)
+                m << "\n(" << counter.suppressed << " similar messages were suppressed)";
+            counter.windowStart = now;
+            counter.count = 0;
+            counter.suppressed = 0;
         }
+        if (++counter.count > m_rateLimit)
+        {
+            ++counter.suppressed;
+            return false;
+        }
+        return true;
     }
+
+#if(SOFA_WITH_THREADING==1)
+    /// Lock-free list of the messages waiting to be processed, most recent first
+    struct QueuedMessage
+    {
+        QueuedMessage(const Message& m) : message(m), next(nullptr) {}
+        Message message;
+        QueuedMessage* next;
+    };
+    std::atomic<QueuedMessage*> m_queue {nullptr};
+    std::atomic<bool> m_asynchronous {false};
+    std::thread m_thread;
+    bool m_running {false};
+    mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+
+    void push(Message& m)
+    {
+        // the rate limit only applies to the queued handlers
+        {
+            lock_guard<mutex> guard(m_synchronousMutex);
+            for (MessageHandler* handler : m_synchronousHandlers)
+                handler->process(m);
+        }
+        QueuedMessage* node = new QueuedMessage(m);
+        node->next = m_queue.load(std::memory_order_relaxed);
+        while (!m_queue.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+        m_wakeCondition.notify_one();
+    }
+
+    /// Process the queued messages in their emission order, returns false if there was none.
+    /// The list is taken while holding the mutex so that concurrent calls keep the order.
+    bool processQueue()
+    {
+        lock_guard<mutex> guard(m_mutex);
+        QueuedMessage* list = m_queue.exchange(nullptr, std::memory_order_acquire);
+        if (!list)
+            return false;
+
+        QueuedMessage* ordered = nullptr;
+        while (list)
+        {
+            QueuedMessage* next = list->next;
+            list->next = ordered;
+            ordered = list;
+            list = next;
+        }
+
+        while (ordered)
+        {
+            QueuedMessage* next = ordered->next;
+            try
+            {
+                process(ordered->message, m_messageHandlers, true);
+            }
+            catch (...)
+            {
+                // handlers throwing on errors only see them synchronously
+            }
+            delete ordered;
+            ordered = next;
+        }
+        return true;
+    }
+
+    void run()
+    {
+        for (;;)
+        {
+            if (processQueue())
+                continue;
+            std::unique_lock<mutex> lock(m_wakeMutex);
+            if (!m_running)
+                break;
+            // the emitting threads notify without locking, hence the timeout
+            m_wakeCondition.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+
+    void setAsynchronous(bool async)
+    {
+        if (async == m_asynchronous)
+            return;
+        if (async)
+        {
+            {
+                lock_guard<mutex> guard(m_wakeMutex);
+                m_running = true;
+            }
+            m_thread = std::thread(&MessageDispatcherImpl::run, this);
+            m_asynchronous = true;
+        }
+        else
+        {
+            m_asynchronous = false;
+            {
+                lock_guard<mutex> guard(m_wakeMutex);
+                m_running = false;
+            }
+            m_wakeCondition.notify_one();
+            m_thread.join();
+            processQueue();
+        }
+    }
+#endif
 };
 
 
 MessageDispatcherImpl* s_messagedispatcher = nullptr ;
 
+SOFA_THREAD_SPECIFIC_PTR(std::vector<MessageHandler*>, s_threadHandlers);
+
 MessageDispatcherImpl* getMainInstance(){
     if(s_messagedispatcher==nullptr){
         s_messagedispatcher = new MessageDispatcherImpl();
@@ -157,11 +339,90 @@ void MessageDispatcher::clearHandlers(){
     getMainInstance()->clearHandlers();
 }
 
+void MessageDispatcher::setThreadHandlers(std::vector<MessageHandler*>* handlers){
+    s_threadHandlers = handlers;
+}
+
+std::vector<MessageHandler*>* MessageDispatcher::getThreadHandlers(){
+    return s_threadHandlers;
+}
+
 void MessageDispatcher::process(sofa::helper::logging::Message& m){
+    if (!isLogged(m.type()))
+        return;
+    if (std::vector<MessageHandler*>* handlers = s_threadHandlers)
+    {
+        // the handlers may be shared by several contexts, they are still serialized
+        MUTEX_IF_THREADING ;
+        getMainInstance()->process(m, *handlers);
+        return;
+    }
+#if(SOFA_WITH_THREADING==1)
+    MessageDispatcherImpl* impl = getMainInstance();
+    if (impl->m_asynchronous.load(std::memory_order_acquire))
+    {
+        if (m.type() < Message::Error)
+        {
+            impl->push(m);
+            return;
+        }
+        impl->processQueue();
+    }
+#endif
     MUTEX_IF_THREADING ;
     getMainInstance()->process(m);
 }
 
+std::atomic<int> MessageDispatcher::s_minimumLevel {Message::Info};
+
+void MessageDispatcher::setAsynchronous(bool async){
+#if(SOFA_WITH_THREADING==1)
+    static bool s_stopAtExit = false;
+    MessageDispatcherImpl* impl = getMainInstance();
+    if (async && !s_stopAtExit)
+    {
+        // the pending messages must be processed before the handlers are destroyed
+        s_stopAtExit = true;
+        std::atexit([](){ MessageDispatcher::setAsynchronous(false); });
+    }
+    impl->setAsynchronous(async);
+#else
+    SOFA_UNUSED(async);
+#endif
+}
+
+bool MessageDispatcher::isAsynchronous(){
+#if(SOFA_WITH_THREADING==1)
+    return getMainInstance()->m_asynchronous;
+#else
+    return false;
+#endif
+}
+
+void MessageDispatcher::flush(){
+#if(SOFA_WITH_THREADING==1)
+    MessageDispatcherImpl* impl = getMainInstance();
+    if (impl->m_asynchronous)
+        impl->processQueue();
+#endif
+}
+
+void MessageDispatcher::setMinimumLevel(Message::Type type){
+    s_minimumLevel = int(type);
+}
+
+void MessageDispatcher::setRateLimit(unsigned int maxRepeats){
+    MUTEX_IF_THREADING ;
+    MessageDispatcherImpl* impl = getMainInstance();
+    impl->m_rateLimit = maxRepeats;
+    impl->m_rateCounters.clear();
+}
+
+unsigned int MessageDispatcher::getRateLimit(){
+    MUTEX_IF_THREADING ;
+    return getMainInstance()->m_rateLimit;
+}
+
 
 MessageDispatcher::LoggerStream MessageDispatcher::log(Message::Class mclass, Message::Type type,
                                                        const ComponentInfo::SPtr& cinfo, const  FileInfo::SPtr& fileInfo) {
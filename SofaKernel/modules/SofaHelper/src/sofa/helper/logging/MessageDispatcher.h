@@ -29,6 +29,7 @@
 #include <sofa/helper/helper.h>
 #include "Message.h"
 #include <vector>
+#include <atomic>
 #include <sofa/helper/system/SofaOStream.h>
 
 namespace sofa
@@ -102,6 +103,12 @@ public:
         static void clearHandlers() ; ///< to remove every MessageHandlers
         static std::vector<MessageHandler*>& getHandlers(); ///< the list of MessageHandlers
 
+        /// Send the messages emitted by the calling thread to the given handlers instead of the
+        /// shared ones, nullptr restores them. These messages are processed synchronously, even
+        /// in asynchronous mode. Used by simulation::SimulationContext.
+        static void setThreadHandlers(std::vector<MessageHandler*>* handlers);
+        static std::vector<MessageHandler*>* getThreadHandlers();
+
         static LoggerStream info(Message::Class mclass, const ComponentInfo::SPtr& cinfo, const FileInfo::SPtr& fileInfo = EmptyFileInfo) ;
         static LoggerStream deprecated(Message::Class mclass, const ComponentInfo::SPtr& cinfo, const FileInfo::SPtr& fileInfo = EmptyFileInfo) ;
         static LoggerStream warning(Message::Class mclass, const ComponentInfo::SPtr& cinfo, const FileInfo::SPtr& fileInfo = EmptyFileInfo) ;
@@ -117,8 +124,35 @@ public:
         /// and can be called manually on a hand-made (possibly predefined) Message
         static void process(sofa::helper::logging::Message& m);
 
+        /// In asynchronous mode the emitting threads only push the messages in a lock-free
+        /// queue, and a background thread feeds them to the handlers. Errors and fatal
+        /// messages are still processed synchronously, after the messages queued before them,
+        /// so that handlers throwing exceptions keep working. The synchronous handlers (see
+        /// MessageHandler::isSynchronous) always process the messages on the emitting thread.
+        /// Disabling it processes the pending messages. Only available when compiled with
+        /// SOFA_WITH_THREADING.
+        static void setAsynchronous(bool async);
+        static bool isAsynchronous();
+
+        /// Process now every message queued in asynchronous mode.
+        static void flush();
+
+        /// Messages of a lower level are discarded. msg_info and msg_advice do not even
+        /// build their message when their level is discarded.
+        static void setMinimumLevel(Message::Type type);
+        static Message::Type getMinimumLevel() { return Message::Type(s_minimumLevel.load(std::memory_order_relaxed)); }
+        static bool isLogged(Message::Type type) { return int(type) >= s_minimumLevel.load(std::memory_order_relaxed); }
+
+        /// Process at most maxRepeats messages per second from the same line of code. The
+        /// number of suppressed messages is reported with the next one from this line.
+        /// 0 (the default) disables the limit.
+        static void setRateLimit(unsigned int maxRepeats);
+        static unsigned int getRateLimit();
+
     private:
 
+        static std::atomic<int> s_minimumLevel;
+
         // static interface
         MessageDispatcher();
         MessageDispatcher(const MessageDispatcher&);
@@ -45,6 +45,11 @@ class SOFA_HELPER_API MessageHandler
 public:
     virtual ~MessageHandler(){}
     virtual void process(Message& m) = 0 ;
+
+    /// A synchronous handler processes the messages on the emitting thread, even when the
+    /// MessageDispatcher is asynchronous, because it accesses the emitting component.
+    /// It must then support being called from several threads at the same time.
+    virtual bool isSynchronous() const { return false; }
 };
 
 
@@ -28,6 +28,8 @@
 #include <sofa/simulation/MechanicalOperations.h>
 #include <sofa/simulation/VectorOperations.h>
 #include <sofa/core/ObjectFactory.h>
+#include <sofa/core/behavior/LinearSolver.h>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <sofa/helper/system/thread/CTime.h>
@@ -54,7 +56,17 @@ EulerImplicitSolver::EulerImplicitSolver()
     , d_trapezoidalScheme( initData(&d_trapezoidalScheme,false,"trapezoidalScheme","Optional: use the trapezoidal scheme instead of the implicit Euler scheme and get second order accuracy in time") )
     , f_solveConstraint( initData(&f_solveConstraint,false,"solveConstraint","Apply ConstraintSolver (requires a ConstraintSolver in the same node as this solver, disabled by by default for now)") )
     , d_threadSafeVisitor(initData(&d_threadSafeVisitor, false, "threadSafeVisitor", "If true, do not use realloc and free visitors in fwdInteractionForceField."))
+    , d_newtonRaphson(initData(&d_newtonRaphson, false, "newtonRaphson", "Solve the nonlinear implicit Euler equations with Newton-Raphson iterations instead of a single linearized solve (2nd order implicit Euler only)"))
+    , d_newton_iterations(initData(&d_newton_iterations, (unsigned) 10, "newton_iterations", "Maximum number of Newton iterations per time step (with newtonRaphson)"))
+    , d_correction_tolerance_threshold(initData(&d_correction_tolerance_threshold, (double) 1e-5, "correction_tolerance_threshold", "Convergence criterion: The newton iterations will stop when the norm of correction |dv| reach this threshold."))
+    , d_residual_tolerance_threshold(initData(&d_residual_tolerance_threshold, (double) 1e-5, "residual_tolerance_threshold", "Convergence criterion: The newton iterations will stop when the norm of the residual reach this threshold. Use a negative value to disable this criterion."))
+    , d_inexactNewton(initData(&d_inexactNewton, true, "inexactNewton", "Adapt the tolerance of the iterative linear solver to the Newton residual (Eisenstat-Walker forcing terms)"))
+    , d_lineSearchMaxIterations(initData(&d_lineSearchMaxIterations, (unsigned) 5, "lineSearchMaxIterations", "Maximum number of step halvings of the backtracking line search (0 disables the line search)"))
+    , d_nbNewtonIterations(initData(&d_nbNewtonIterations, (unsigned) 0, "nbNewtonIterations", "Output: number of Newton iterations done during the last time step"))
+    , d_newtonResiduals(initData(&d_newtonResiduals, "newtonResiduals", "Output: norm of the residual before the first Newton iteration and after each one, during the last time step"))
 {
+    d_nbNewtonIterations.setReadOnly(true);
+    d_newtonResiduals.setReadOnly(true);
 }
 
 void EulerImplicitSolver::init()
@@ -67,6 +79,10 @@ void EulerImplicitSolver::init()
         for (unsigned int i=0; i<objs.size(); ++i)
             msg_info() << "  " << objs[i]->getClassName() << ' ' << objs[i]->getName();
     }
+    if (d_newtonRaphson.getValue() && (f_firstOrder.getValue() || d_trapezoidalScheme.getValue()))
+    {
+        msg_warning() << "newtonRaphson is only available for the 2nd order implicit Euler scheme, the linearized scheme is used.";
+    }
     sofa::core::behavior::OdeSolver::init();
 }
 
@@ -79,6 +95,12 @@ void EulerImplicitSolver::cleanup()
 
 void EulerImplicitSolver::solve(const core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId xResult, sofa::core::MultiVecDerivId vResult)
 {
+    if (d_newtonRaphson.getValue() && !f_firstOrder.getValue() && !d_trapezoidalScheme.getValue())
+    {
+        solveNewtonRaphson(params, dt, xResult, vResult);
+        return;
+    }
+
 #ifdef SOFA_DUMP_VISITOR_INFO
     sofa::simulation::Visitor::printNode("SolverVectorAllocation");
 #endif
@@ -300,6 +322,167 @@ void EulerImplicitSolver::solve(const core::ExecParams* params, SReal dt, sofa::
     }
 }
 
+SReal EulerImplicitSolver::computeNewtonResidual(simulation::common::MechanicalOperations& mop, SReal h,
+                                                 MultiVecCoord& x0, MultiVecDeriv& v0, MultiVecDeriv& dv,
+                                                 MultiVecCoord& newPos, MultiVecDeriv& newVel,
+                                                 MultiVecDeriv& f, MultiVecDeriv& res)
+{
+    newVel.eq(v0, dv);                  // v = v0 + dv
+    newPos.eq(x0, newVel, h);           // x = x0 + h v
+    mop.propagateXAndV(newPos, newVel);
+
+    // forces and stiffness at the current iterate
+    mop.computeForce(f);
+
+    res.eq(f, h);                                                                        // res = h f(x,v)
+    mop.addMBKv(res, -h*f_rayleighMass.getValue(), 0, h*f_rayleighStiffness.getValue()); // res += h (- rm M + rs K) v
+    mop.addMdx(res, dv, -1.0);                                                           // res -= M dv
+    mop.projectResponse(res);
+
+    return sqrt(res.dot(res));
+}
+
+void EulerImplicitSolver::solveNewtonRaphson(const core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId xResult, sofa::core::MultiVecDerivId vResult)
+{
+    sofa::simulation::common::VectorOperations vop( params, this->getContext() );
+    sofa::simulation::common::MechanicalOperations mop( params, this->getContext() );
+    MultiVecCoord pos(&vop, core::VecCoordId::position() );
+    MultiVecDeriv vel(&vop, core::VecDerivId::velocity() );
+    MultiVecDeriv f(&vop, core::VecDerivId::force() );
+    MultiVecCoord newPos(&vop, xResult );
+    MultiVecDeriv newVel(&vop, vResult );
+
+    // xResult and vResult usually are the position and velocity themselves: keep the state at the beginning of the step
+    MultiVecCoord x0(&vop);
+    MultiVecDeriv v0(&vop);
+    MultiVecDeriv dv(&vop);
+    MultiVecDeriv dvTrial(&vop);
+    MultiVecDeriv res(&vop);
+    MultiVecDeriv resTrial(&vop);
+    x0.eq(pos);
+    v0.eq(vel);
+    dv.clear();
+
+    mop.cparams.setX(xResult);
+    mop.cparams.setV(vResult);
+    mop->setImplicit(true); // this solver is implicit
+    mop->setX(newPos);
+    mop->setV(newVel);
+
+    MultiVecDeriv dx(&vop, core::VecDerivId::dx());
+    dx.realloc(&vop, !d_threadSafeVisitor.getValue(), true);
+    x.realloc(&vop, !d_threadSafeVisitor.getValue(), true);
+
+    const SReal h = dt;
+    const SReal rm = f_rayleighMass.getValue();
+    const SReal rk = f_rayleighStiffness.getValue();
+
+    // Eisenstat-Walker forcing terms (choice 2) are applied on the relative tolerance of an iterative linear solver
+    Data<SReal>* linearTolerance = nullptr;
+    core::behavior::LinearSolver* linearSolver = this->getContext()->get<core::behavior::LinearSolver>(core::objectmodel::BaseContext::Local);
+    if (d_inexactNewton.getValue() && linearSolver)
+        linearTolerance = dynamic_cast< Data<SReal>* >(linearSolver->findData("tolerance"));
+    const SReal minTolerance = linearTolerance ? linearTolerance->getValue() : 0;
+    const SReal ewGamma = 0.9, ewAlpha = 2, ewMaxTolerance = 0.9;
+    SReal eta = ewMaxTolerance;
+
+    sofa::helper::AdvancedTimer::stepBegin("NewtonRaphson");
+
+    SReal residual = computeNewtonResidual(mop, h, x0, v0, dv, newPos, newVel, f, res);
+    const SReal residualThreshold = d_residual_tolerance_threshold.getValue();
+    SReal correction = -1;
+    unsigned nbIterations = 0;
+    helper::vector<SReal> residuals;
+    residuals.push_back(residual);
+
+    while (nbIterations < d_newton_iterations.getValue())
+    {
+        if (residualThreshold > 0 && residual <= residualThreshold)
+        {
+            msg_info() << "[CONVERGED] The residual's norm " << residual << " is smaller than the threshold of " << residualThreshold;
+            break;
+        }
+
+        if (linearTolerance)
+            linearTolerance->setValue(std::max(minTolerance, eta));
+
+        // system matrix assembled at the current iterate
+        sofa::helper::AdvancedTimer::stepBegin("MBKSolve");
+        core::behavior::MultiMatrix<simulation::common::MechanicalOperations> matrix(&mop);
+        matrix = MechanicalMatrix(1+h*rm, -h, -h*(h+rk));
+        matrix.solve(x, res);
+        sofa::helper::AdvancedTimer::stepEnd("MBKSolve");
+        ++nbIterations;
+
+        // backtracking line search on the norm of the residual (Armijo condition)
+        SReal alpha = 1;
+        SReal trialResidual = 0;
+        unsigned nbHalvings = 0;
+        for (;;)
+        {
+            dvTrial.eq(dv, x, alpha);
+            trialResidual = computeNewtonResidual(mop, h, x0, v0, dvTrial, newPos, newVel, f, resTrial);
+            if (trialResidual <= (1 - 1e-4*alpha) * residual || nbHalvings >= d_lineSearchMaxIterations.getValue())
+                break;
+            alpha *= 0.5;
+            ++nbHalvings;
+        }
+        dv.eq(dvTrial);
+        res.eq(resTrial);
+
+        correction = alpha * sqrt(x.dot(x));
+        msg_info() << "Newton iteration #" << nbIterations << ": |R| = " << trialResidual << " |dv| = " << correction
+                   << " (line search step " << alpha << ", linear tolerance " << (linearTolerance ? linearTolerance->getValue() : 0) << ")";
+
+        // next forcing term, with the safeguard avoiding a too fast decrease
+        const SReal previousEta = eta;
+        eta = ewGamma * std::pow(trialResidual / residual, ewAlpha);
+        if (ewGamma * std::pow(previousEta, ewAlpha) > 0.1)
+            eta = std::max(eta, ewGamma * std::pow(previousEta, ewAlpha));
+        eta = std::min(eta, ewMaxTolerance);
+
+        const bool isDiverging = !(trialResidual < residual);
+        residual = trialResidual;
+        residuals.push_back(residual);
+
+        if (correction <= d_correction_tolerance_threshold.getValue())
+        {
+            msg_info() << "[CONVERGED] The correction's norm |dv| is smaller than the threshold of " << d_correction_tolerance_threshold;
+            break;
+        }
+        if (isDiverging && nbHalvings >= d_lineSearchMaxIterations.getValue() && d_lineSearchMaxIterations.getValue() > 0)
+        {
+            msg_info() << "[DIVERGED] The line search did not decrease the residual";
+            break;
+        }
+    }
+
+    if (linearTolerance)
+        linearTolerance->setValue(minTolerance);
+
+    d_nbNewtonIterations.setValue(nbIterations);
+    d_newtonResiduals.setValue(residuals);
+    sofa::helper::AdvancedTimer::valSet("nb_iterations", nbIterations);
+    sofa::helper::AdvancedTimer::valSet("residual", residual);
+    sofa::helper::AdvancedTimer::valSet("correction", correction);
+    sofa::helper::AdvancedTimer::stepEnd("NewtonRaphson");
+
+    // newPos and newVel hold the last iterate
+    if (f_solveConstraint.getValue())
+    {
+        sofa::helper::AdvancedTimer::stepBegin("CorrectV");
+        mop.solveConstraint(newVel,core::ConstraintParams::VEL);
+        sofa::helper::AdvancedTimer::stepNext ("CorrectV", "CorrectX");
+        mop.solveConstraint(newPos,core::ConstraintParams::POS);
+        sofa::helper::AdvancedTimer::stepEnd  ("CorrectX");
+    }
+
+    mop.addSeparateGravity(dt, newVel);	// v += dt*g . Used if mass wants to add G separately from the other forces to v
+
+    if (f_velocityDamping.getValue()!=0.0)
+        newVel *= exp(-h*f_velocityDamping.getValue());
+}
+
 
 double EulerImplicitSolver::getPositionIntegrationFactor() const
 {
@@ -24,6 +24,9 @@
 #include "config.h"
 
 #include <sofa/core/behavior/OdeSolver.h>
+#include <sofa/core/behavior/MultiVec.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#include <sofa/helper/vector.h>
 
 namespace sofa
 {
@@ -99,6 +102,18 @@ namespace odesolver
  *
  *   \f$ ( M + h/2 K ) v_{t+h} = f_ext \f$
  *
+ *** Newton-Raphson ***
+ *
+ * With newtonRaphson, the nonlinear equations of the 2nd order implicit Euler scheme are solved instead of
+ * their linearization around the beginning of the time step. The residual is
+ *
+ *   \f$ R(dv) = h ( f(x_t + h (v_t+dv), v_t+dv) - r_M M (v_t+dv) + r_K K (v_t+dv) ) - M dv \f$
+ *
+ * and each iteration solves \f$ ( (1+h r_M) M - h B - h(h + r_K) K ) \delta = R(dv) \f$ with the matrix
+ * evaluated at the current iterate, then updates \f$ dv \f$ += \f$ \alpha \delta \f$, \f$ \alpha \f$ being
+ * found by a backtracking line search on \f$ |R| \f$. With inexactNewton, the tolerance of an iterative
+ * linear solver is adapted at each iteration using the Eisenstat-Walker forcing terms.
+ *
  */
 class SOFA_IMPLICIT_ODE_SOLVER_API EulerImplicitSolver : public sofa::core::behavior::OdeSolver
 {
@@ -113,8 +128,27 @@ public:
     Data<bool> f_solveConstraint; ///< Apply ConstraintSolver (requires a ConstraintSolver in the same node as this solver, disabled by by default for now)
     Data<bool> d_threadSafeVisitor;
 
+    Data<bool> d_newtonRaphson; ///< Solve the nonlinear implicit Euler equations with Newton-Raphson iterations instead of a single linearized solve (2nd order implicit Euler only)
+    Data<unsigned> d_newton_iterations; ///< Maximum number of Newton iterations per time step
+    Data<double> d_correction_tolerance_threshold; ///< Convergence criterion: The newton iterations will stop when the norm of correction |dv| reach this threshold.
+    Data<double> d_residual_tolerance_threshold; ///< Convergence criterion: The newton iterations will stop when the norm of the residual reach this threshold. Use a negative value to disable this criterion.
+    Data<bool> d_inexactNewton; ///< Adapt the tolerance of the iterative linear solver to the Newton residual (Eisenstat-Walker forcing terms)
+    Data<unsigned> d_lineSearchMaxIterations; ///< Maximum number of step halvings of the backtracking line search (0 disables the line search)
+    Data<unsigned> d_nbNewtonIterations; ///< Output: number of Newton iterations done during the last time step
+    Data<helper::vector<SReal> > d_newtonResiduals; ///< Output: norm of the residual before the first Newton iteration and after each one, during the last time step
+
 protected:
     EulerImplicitSolver();
+
+    /// Newton-Raphson solution of the 2nd order implicit Euler scheme, see d_newtonRaphson
+    void solveNewtonRaphson(const core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId xResult, sofa::core::MultiVecDerivId vResult);
+
+    /// Set newVel = v0 + dv and newPos = x0 + h newVel, and compute the projected residual of the Newton iterations in res
+    /// @return the norm of the residual
+    SReal computeNewtonResidual(simulation::common::MechanicalOperations& mop, SReal h,
+                                core::behavior::MultiVecCoord& x0, core::behavior::MultiVecDeriv& v0, core::behavior::MultiVecDeriv& dv,
+                                core::behavior::MultiVecCoord& newPos, core::behavior::MultiVecDeriv& newVel,
+                                core::behavior::MultiVecDeriv& f, core::behavior::MultiVecDeriv& res);
 public:
     void init() override;
 
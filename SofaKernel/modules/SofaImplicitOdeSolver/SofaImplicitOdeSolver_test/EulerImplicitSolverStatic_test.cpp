@@ -54,7 +54,7 @@ typedef component::linearsolver::CGLinearSolver<component::linearsolver::GraphSc
  */
 struct EulerImplicit_test_2_particles_to_equilibrium : public Sofa_test<>
 {
-    EulerImplicit_test_2_particles_to_equilibrium()
+    void testEquilibrium(bool newtonRaphson)
     {
         EXPECT_MSG_NOEMIT(Error) ;
         //*******
@@ -63,6 +63,7 @@ struct EulerImplicit_test_2_particles_to_equilibrium : public Sofa_test<>
         // begin create scene under the root node
 
         EulerImplicitSolver::SPtr eulerSolver = addNew<EulerImplicitSolver>(root);
+        eulerSolver->d_newtonRaphson.setValue(newtonRaphson);
         CGLinearSolver::SPtr linearSolver = addNew<CGLinearSolver>(root);
         linearSolver->f_maxIter.setValue(25);
         linearSolver->f_tolerance.setValue(1e-5);
@@ -99,6 +100,18 @@ struct EulerImplicit_test_2_particles_to_equilibrium : public Sofa_test<>
         do {
             sofa::simulation::getSimulation()->animate(root.get(),1.0);
 
+            if( newtonRaphson && n==0 )
+            {
+                // the first step starts away from the equilibrium: Newton iterations must have been done
+                // and each one must have decreased the residual
+                const unsigned nbIterations = eulerSolver->d_nbNewtonIterations.getValue();
+                const helper::vector<SReal>& residuals = eulerSolver->d_newtonResiduals.getValue();
+                EXPECT_GE(nbIterations, 1u);
+                ASSERT_EQ(residuals.size(), nbIterations+1);
+                for( unsigned i=1; i<residuals.size(); i++ )
+                    EXPECT_LT(residuals[i], residuals[i-1]) << "Newton iteration #" << i;
+            }
+
             x1 = getVector( core::VecId::position() ); //cerr<<"EulerImplicit_test, new positions : " << x1.transpose() << endl;
             v1 = getVector( core::VecId::velocity() );
 
@@ -238,7 +251,8 @@ struct EulerImplicit_test_2_particles_in_different_nodes_to_equilibrium  : publi
 
 };
 
-TEST_F( EulerImplicit_test_2_particles_to_equilibrium,  ){}
+TEST_F( EulerImplicit_test_2_particles_to_equilibrium, linearized ){ testEquilibrium(false); }
+TEST_F( EulerImplicit_test_2_particles_to_equilibrium, newtonRaphson ){ testEquilibrium(true); }
 TEST_F( EulerImplicit_test_2_particles_in_different_nodes_to_equilibrium,  ){}
 
 }// namespace sofa
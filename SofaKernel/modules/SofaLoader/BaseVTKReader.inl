@@ -22,10 +22,12 @@
 #ifndef SOFA_COMPONENT_LOADER_BASEVTKREADER_INL
 #define SOFA_COMPONENT_LOADER_BASEVTKREADER_INL
 #include <SofaLoader/BaseVTKReader.h>
+#include <sofa/helper/io/TextParser.h>
 
 #include <string>
 #include <istream>
 #include <fstream>
+#include <type_traits>
 
 
 namespace sofa
@@ -43,6 +45,28 @@ namespace basevtkreader
 using std::istringstream ;
 using sofa::defaulttype::Vec ;
 
+/// Read up to n values from a line of an ascii file, returns the number of values read.
+/// Plain numbers are converted with TextParser, other types (vectors, characters) with a stream.
+template<class T>
+int readAsciiValues(const string& line, T* values, int n, std::true_type /*isNumber*/)
+{
+    sofa::helper::io::TextParser parser(line);
+    int i = 0;
+    while (i < n && parser.read(values[i]))
+        ++i;
+    return i;
+}
+
+template<class T>
+int readAsciiValues(const string& line, T* values, int n, std::false_type /*isNumber*/)
+{
+    istringstream ln(line);
+    int i = 0;
+    while (i < n && ln >> values[i])
+        ++i;
+    return i;
+}
+
 template<class T>
 const void* BaseVTKReader::VTKDataIO<T>::getData()
 {
@@ -156,9 +180,8 @@ bool BaseVTKReader::VTKDataIO<T>::read(istream& in, int n, int binary)
         while(i < dataSize && !in.eof() && !in.bad())
         {
             std::getline(in, line);
-            istringstream ln(line);
-            while (i < n && ln >> data[i])
-                ++i;
+            i += readAsciiValues(line, data + i, n - i,
+                                 std::integral_constant<bool, std::is_arithmetic<T>::value && (sizeof(T) > 1)>());
         }
         if (i < n)
         {
@@ -0,0 +1,119 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaLoader/MeshBinaryLoader.h>
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/loader/BinaryMeshFile.h>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace loader
+{
+
+using namespace sofa::core::loader;
+
+int MeshBinaryLoaderClass = core::RegisterObject("Specific mesh loader for the native binary mesh file format (.sbm).")
+        .add< MeshBinaryLoader >()
+        ;
+
+MeshBinaryLoader::MeshBinaryLoader()
+    : MeshLoader()
+    , d_verifyChecksum(initData(&d_verifyChecksum, false, "verifyChecksum", "If true, the checksum of the whole file is checked before loading it (the header and the section table are always checked)"))
+{
+    d_positions.setPersistent(false);
+    d_normals.setPersistent(false);
+    d_edges.setPersistent(false);
+    d_triangles.setPersistent(false);
+    d_quads.setPersistent(false);
+    d_tetrahedra.setPersistent(false);
+    d_hexahedra.setPersistent(false);
+    d_pentahedra.setPersistent(false);
+    d_pyramids.setPersistent(false);
+}
+
+namespace
+{
+
+template<class T>
+bool readSection(const BinaryMeshFile& file, std::uint32_t type, Data< helper::vector<T> >& data)
+{
+    if (!file.hasSection(type))
+        return true;
+    return file.read(type, helper::getWriteOnlyAccessor(data).wref());
+}
+
+bool readGroups(const BinaryMeshFile& file, std::uint32_t type, Data< helper::vector<PrimitiveGroup> >& data)
+{
+    if (!file.hasSection(type))
+        return true;
+    return file.readGroups(type, helper::getWriteOnlyAccessor(data).wref());
+}
+
+} // anonymous namespace
+
+bool MeshBinaryLoader::load()
+{
+    dmsg_info() << "Loading binary mesh file: " << m_filename;
+
+    BinaryMeshFile file;
+    if (!file.open(m_filename.getFullPath(), d_verifyChecksum.getValue()))
+    {
+        msg_error() << "Cannot read file '" << m_filename << "': " << file.getErrorMessage();
+        return false;
+    }
+
+    bool ok = true;
+    if (file.hasSection(BinaryMeshFile::POSITIONS))
+        ok &= file.readPositions(BinaryMeshFile::POSITIONS, helper::getWriteOnlyAccessor(d_positions).wref());
+    if (file.hasSection(BinaryMeshFile::NORMALS))
+        ok &= file.readPositions(BinaryMeshFile::NORMALS, helper::getWriteOnlyAccessor(d_normals).wref());
+
+    ok &= readSection(file, BinaryMeshFile::EDGES, d_edges);
+    ok &= readSection(file, BinaryMeshFile::TRIANGLES, d_triangles);
+    ok &= readSection(file, BinaryMeshFile::QUADS, d_quads);
+    ok &= readSection(file, BinaryMeshFile::TETRAHEDRA, d_tetrahedra);
+    ok &= readSection(file, BinaryMeshFile::HEXAHEDRA, d_hexahedra);
+    ok &= readSection(file, BinaryMeshFile::PENTAHEDRA, d_pentahedra);
+    ok &= readSection(file, BinaryMeshFile::PYRAMIDS, d_pyramids);
+
+    ok &= readGroups(file, BinaryMeshFile::EDGES_GROUPS, d_edgesGroups);
+    ok &= readGroups(file, BinaryMeshFile::TRIANGLES_GROUPS, d_trianglesGroups);
+    ok &= readGroups(file, BinaryMeshFile::QUADS_GROUPS, d_quadsGroups);
+    ok &= readGroups(file, BinaryMeshFile::TETRAHEDRA_GROUPS, d_tetrahedraGroups);
+    ok &= readGroups(file, BinaryMeshFile::HEXAHEDRA_GROUPS, d_hexahedraGroups);
+    ok &= readGroups(file, BinaryMeshFile::PENTAHEDRA_GROUPS, d_pentahedraGroups);
+    ok &= readGroups(file, BinaryMeshFile::PYRAMIDS_GROUPS, d_pyramidsGroups);
+
+    if (!ok)
+        msg_error() << "File '" << m_filename << "' contains sections which do not match the types of this build";
+
+    return ok;
+}
+
+} // namespace loader
+
+} // namespace component
+
+} // namespace sofa
@@ -0,0 +1,63 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_COMPONENT_LOADER_MESHBINARYLOADER_H
+#define SOFA_COMPONENT_LOADER_MESHBINARYLOADER_H
+#include "config.h"
+
+#include <sofa/core/loader/MeshLoader.h>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace loader
+{
+
+/** Loader for the native binary mesh format (.sbm), as written by MeshExporter.
+ *
+ *  The file is mapped in memory and each array is copied in one block into the
+ *  corresponding Data, without any parsing. Edges and triangles saved from a
+ *  topology container can be stored together with the volume elements, so that
+ *  they do not need to be recomputed at initialization.
+ */
+class SOFA_LOADER_API MeshBinaryLoader : public sofa::core::loader::MeshLoader
+{
+public:
+    SOFA_CLASS(MeshBinaryLoader,sofa::core::loader::MeshLoader);
+protected:
+    MeshBinaryLoader();
+
+public:
+    bool load() override;
+
+    Data<bool> d_verifyChecksum; ///< if true, the checksum of the whole file is checked before loading it (the header and the section table are always checked)
+};
+
+} // namespace loader
+
+} // namespace component
+
+} // namespace sofa
+
+#endif // SOFA_COMPONENT_LOADER_MESHBINARYLOADER_H
@@ -23,7 +23,12 @@
 #include <SofaLoader/MeshObjLoader.h>
 #include <sofa/core/visual/VisualParams.h>
 #include <sofa/helper/system/SetDirectory.h>
+#include <sofa/helper/io/TextParser.h>
+#include <sofa/helper/IndexOpenMP.h>
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <limits>
 
 namespace sofa
 {
@@ -42,6 +47,135 @@ int MeshObjLoaderClass = core::RegisterObject("Specific mesh loader for Obj file
         .add< MeshObjLoader >()
         ;
 
+using sofa::helper::io::TextParser;
+
+namespace
+{
+
+/// Size of the parts of a file parsed in parallel
+const std::size_t s_objChunkSize = std::size_t(1) << 22;
+
+/// Index of a face corner which is not given, e.g. the texture coordinate of "f 1//1 2//2 3//3"
+const int s_noIndex = std::numeric_limits<int>::min();
+
+/// Line of an OBJ file whose effect depends on the previous lines
+struct ObjStatement
+{
+    enum Kind { FACE, MTLLIB, USEMTL, GROUP };
+
+    Kind kind;
+    unsigned int first; ///< first (v,vt,vn) triplet of a face in ObjChunk::indices, or name in ObjChunk::names
+    unsigned int count; ///< number of corners of a face, or number of names
+    unsigned int nbPositions, nbTexCoords, nbNormals; ///< vertices defined in the chunk before a face
+};
+
+/// Result of the parsing of a part of an OBJ file
+struct ObjChunk
+{
+    helper::vector<Vector3> positions;
+    helper::vector<Vector3> normals;
+    helper::vector<Vector2> texCoords;
+    std::vector<int> indices;
+    std::vector<std::string> names;
+    std::vector<ObjStatement> statements;
+};
+
+bool isKeyword(const char* wordBegin, const char* wordEnd, const char* keyword)
+{
+    const std::size_t length = std::strlen(keyword);
+    return std::size_t(wordEnd - wordBegin) == length && std::memcmp(wordBegin, keyword, length) == 0;
+}
+
+void parseObjChunk(const char* begin, const char* end, ObjChunk& chunk)
+{
+    TextParser parser(begin, end);
+    const char* lineBegin;
+    const char* lineEnd;
+    while (parser.readLine(lineBegin, lineEnd))
+    {
+        TextParser line(lineBegin, lineEnd);
+        const char* tokenBegin;
+        const char* tokenEnd;
+        if (!line.readWord(tokenBegin, tokenEnd))
+            continue;
+
+        if (isKeyword(tokenBegin, tokenEnd, "v"))
+        {
+            Vector3 value;
+            for (unsigned int i = 0; i < 3 && line.read(value[i]); ++i) {}
+            chunk.positions.push_back(value);
+        }
+        else if (isKeyword(tokenBegin, tokenEnd, "vn"))
+        {
+            Vector3 value;
+            for (unsigned int i = 0; i < 3 && line.read(value[i]); ++i) {}
+            chunk.normals.push_back(value);
+        }
+        else if (isKeyword(tokenBegin, tokenEnd, "vt"))
+        {
+            Vector2 value;
+            for (unsigned int i = 0; i < 2 && line.read(value[i]); ++i) {}
+            chunk.texCoords.push_back(value);
+        }
+        else if (isKeyword(tokenBegin, tokenEnd, "l") || isKeyword(tokenBegin, tokenEnd, "f"))
+        {
+            ObjStatement statement = { ObjStatement::FACE, unsigned(chunk.indices.size() / 3), 0,
+                                       unsigned(chunk.positions.size()), unsigned(chunk.texCoords.size()), unsigned(chunk.normals.size()) };
+            const char* cornerBegin;
+            const char* cornerEnd;
+            while (line.readWord(cornerBegin, cornerEnd))
+            {
+                // v, v/vt, v//vn or v/vt/vn
+                for (int j = 0; j < 3; j++)
+                {
+                    const char* slash = std::find(cornerBegin, cornerEnd, '/');
+                    int index = s_noIndex;
+                    if (slash != cornerBegin)
+                    {
+                        index = 0; // reported as invalid if it is not a number
+                        TextParser::parse(cornerBegin, slash, index);
+                    }
+                    chunk.indices.push_back(index);
+                    cornerBegin = (slash == cornerEnd) ? cornerEnd : slash + 1;
+                }
+                ++statement.count;
+            }
+            chunk.statements.push_back(statement);
+        }
+        else if (isKeyword(tokenBegin, tokenEnd, "mtllib"))
+        {
+            std::string name;
+            while (line.readWord(name))
+            {
+                chunk.statements.push_back({ ObjStatement::MTLLIB, unsigned(chunk.names.size()), 1, 0, 0, 0 });
+                chunk.names.push_back(name);
+            }
+        }
+        else if (isKeyword(tokenBegin, tokenEnd, "usemtl"))
+        {
+            std::string name;
+            const bool hasName = line.readWord(name);
+            chunk.statements.push_back({ ObjStatement::USEMTL, unsigned(chunk.names.size()), hasName ? 1u : 0u, 0, 0, 0 });
+            chunk.names.push_back(name);
+        }
+        else if (isKeyword(tokenBegin, tokenEnd, "g"))
+        {
+            std::string groupName, name;
+            while (line.readWord(name))
+            {
+                if (!groupName.empty())
+                    groupName += " ";
+                groupName += name;
+            }
+            chunk.statements.push_back({ ObjStatement::GROUP, unsigned(chunk.names.size()), 1, 0, 0, 0 });
+            chunk.names.push_back(groupName);
+        }
+        // other statements (comments, smoothing groups, ...) are ignored
+    }
+}
+
+} // anonymous namespace
+
 
 
 MeshObjLoader::MeshObjLoader()
@@ -155,6 +289,24 @@ void MeshObjLoader::addGroup (const PrimitiveGroup& g)
     d_quadsGroups.endEdit();
 }
 
+template<class T>
+static void permutePointData(Data< helper::vector<T> >& data, const helper::vector<sofa::core::topology::Topology::PointID>& pointOrder)
+{
+    if (data.getValue().size() != pointOrder.size())
+        return;
+    helper::WriteAccessor<Data< helper::vector<T> > > values = data;
+    const helper::vector<T> previous(values.begin(), values.end());
+    for (size_t i = 0; i < pointOrder.size(); ++i)
+        values[i] = previous[pointOrder[i]];
+}
+
+void MeshObjLoader::reorderPointData(const helper::vector<sofa::core::topology::Topology::PointID>& pointOrder)
+{
+    permutePointData(d_texCoords, pointOrder);
+    permutePointData(d_vertPosIdx, pointOrder);
+    permutePointData(d_vertNormIdx, pointOrder);
+}
+
 bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
 {
  
@@ -191,7 +343,6 @@ bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
     d_quadsGroups.beginEdit()->clear(); d_quadsGroups.endEdit();
 
     int vtn[3];
-    Vector3 result;
     helper::WriteAccessor<Data<helper::vector< PrimitiveGroup> > > my_faceGroups[NBFACETYPE] =
     {
         d_edgesGroups,
@@ -203,172 +354,152 @@ bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
     int curMaterialId = -1;
     int nbFaces[NBFACETYPE] = {0}; // number of edges, triangles, quads
     int groupF0[NBFACETYPE] = {0}; // first primitives indices in current group for edges, triangles, quads
-    std::string line;
-    while( std::getline(file,line) )
+    // Read the whole file, and parse it by chunks of lines in parallel. The statements which
+    // depend on the previous ones (groups, materials, relative indices) are then applied in order.
+    std::string content;
+    file.seekg(0, std::ios::end);
+    content.resize(std::size_t(std::max<std::streamoff>(file.tellg(), 0)));
+    file.seekg(0, std::ios::beg);
+    file.read(&content[0], std::streamsize(content.size()));
+    content.resize(std::size_t(file.gcount()));
+
+    const std::vector<const char*> chunkBounds = TextParser::splitInChunks(content.data(), content.data() + content.size(),
+                                                                           content.size() / s_objChunkSize + 1);
+    std::vector<ObjChunk> chunks(chunkBounds.size() - 1);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<unsigned int>::type c = 0; c < chunks.size(); ++c)
+        parseObjChunk(chunkBounds[c], chunkBounds[c+1], chunks[c]);
+
+    for (const ObjChunk& chunk : chunks)
     {
-        if (line.empty()) continue;
-        std::istringstream values(line);
-        std::string token;
-        values >> token;
+        my_positions.insert(my_positions.end(), chunk.positions.begin(), chunk.positions.end());
+        my_normals.insert(my_normals.end(), chunk.normals.begin(), chunk.normals.end());
+        my_texCoords.insert(my_texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+    }
 
-        if (token == "#")
-        {
-            // comment
-        }
-        else if (token == "v")
-        {
-            // vertex
-            values >> result[0] >> result[1] >> result[2];
-            my_positions.push_back(Vector3(result[0],result[1], result[2]));
-        }
-        else if (token == "vn")
-        {
-            // normal 
-            values >> result[0] >> result[1] >> result[2];
-            my_normals.push_back(Vector3(result[0],result[1], result[2]));
-        }
-        else if (token == "vt")
-        {
-            // texcoord
-            values >> result[0] >> result[1];
-            my_texCoords.push_back(Vector2(result[0],result[1]));
-        }
-        else if ((token == "mtllib") && d_loadMaterial.getValue())
+    std::size_t nbPreviousPositions = 0, nbPreviousTexCoords = 0, nbPreviousNormals = 0;
+    for (const ObjChunk& chunk : chunks)
+    {
+        for (const ObjStatement& statement : chunk.statements)
         {
-            while (!values.eof())
+            if (statement.kind == ObjStatement::MTLLIB)
             {
-                std::string materialLibaryName;
-                values >> materialLibaryName;
-                std::string mtlfile = sofa::helper::system::SetDirectory::GetRelativeFromFile(materialLibaryName.c_str(), filename);
-                this->readMTL(mtlfile.c_str(), my_materials);
-            }
-        }
-        else if (token == "usemtl" || token == "g")
-        {
-            // end of current group
-            //curGroup.nbp = nbf - curGroup.p0;
-            for (int ft = 0; ft < NBFACETYPE; ++ft)
-                if (nbFaces[ft] > groupF0[ft])
+                if (d_loadMaterial.getValue())
                 {
-                    my_faceGroups[ft].push_back(PrimitiveGroup(groupF0[ft], nbFaces[ft]-groupF0[ft], curMaterialName, curGroupName, curMaterialId));
-                    groupF0[ft] = nbFaces[ft];
+                    std::string mtlfile = sofa::helper::system::SetDirectory::GetRelativeFromFile(chunk.names[statement.first].c_str(), filename);
+                    this->readMTL(mtlfile.c_str(), my_materials);
                 }
-            if (token == "usemtl")
+            }
+            else if (statement.kind == ObjStatement::USEMTL || statement.kind == ObjStatement::GROUP)
             {
-                values >> curMaterialName;
-                curMaterialId = -1;
-                helper::vector<Material>::iterator it = my_materials.begin();
-                helper::vector<Material>::iterator itEnd = my_materials.end();
-                for (; it != itEnd; ++it)
+                // end of current group
+                for (int ft = 0; ft < NBFACETYPE; ++ft)
+                    if (nbFaces[ft] > groupF0[ft])
+                    {
+                        my_faceGroups[ft].push_back(PrimitiveGroup(groupF0[ft], nbFaces[ft]-groupF0[ft], curMaterialName, curGroupName, curMaterialId));
+                        groupF0[ft] = nbFaces[ft];
+                    }
+                if (statement.kind == ObjStatement::USEMTL)
                 {
-                    if (it->name == curMaterialName)
+                    if (statement.count)
+                        curMaterialName = chunk.names[statement.first];
+                    curMaterialId = -1;
+                    helper::vector<Material>::iterator it = my_materials.begin();
+                    helper::vector<Material>::iterator itEnd = my_materials.end();
+                    for (; it != itEnd; ++it)
                     {
-                        (*it).activated = true;
-                        if (!material.activated)
-                            material = *it;
-                        curMaterialId = it - my_materials.begin();
-                        break;
+                        if (it->name == curMaterialName)
+                        {
+                            (*it).activated = true;
+                            if (!material.activated)
+                                material = *it;
+                            curMaterialId = it - my_materials.begin();
+                            break;
+                        }
                     }
                 }
-            }
-            else if (token == "g")
-            {
-                curGroupName.clear();
-                while (!values.eof())
+                else
                 {
-                    std::string g;
-                    values >> g;
-                    if (!curGroupName.empty())
-                        curGroupName += " ";
-                    curGroupName += g;
+                    curGroupName = chunk.names[statement.first];
                 }
             }
-        }
-        else if (token == "l" || token == "f")
-        {
-            // face
-            nodes.clear();
-            nIndices.clear();
-            tIndices.clear();
-
-            while (!values.eof())
+            else // face
             {
-                std::string face;
-                values >> face;
-                if (face.empty()) continue;
-                for (int j = 0; j < 3; j++)
+                nodes.clear();
+                nIndices.clear();
+                tIndices.clear();
+
+                const std::size_t nbPrevious[3] = { nbPreviousPositions + statement.nbPositions,
+                                                    nbPreviousTexCoords + statement.nbTexCoords,
+                                                    nbPreviousNormals + statement.nbNormals };
+                for (unsigned int k = 0; k < statement.count; ++k)
                 {
-                    vtn[j] = -1;
-                    std::string::size_type pos = face.find('/');
-                    std::string tmp = face.substr(0, pos);
-                    if (pos == std::string::npos)
-                        face = "";
-                    else
-                    {
-                        face = face.substr(pos + 1);
-                    }
-
-                    if (!tmp.empty())
+                    for (int j = 0; j < 3; j++)
                     {
-                        vtn[j] = atoi(tmp.c_str());
-                        if (vtn[j] >= 1)
-                            vtn[j] -=1; // -1 because the numerotation begins at 1 and a vector begins at 0
-                        else if (vtn[j] < 0)
-                            vtn[j] += (j==0) ? my_positions.size() : (j==1) ? my_texCoords.size() : my_normals.size();
-                        else
+                        const int index = chunk.indices[3*(statement.first+k)+j];
+                        vtn[j] = -1;
+                        if (index != s_noIndex)
                         {
-                            msg_error() << "Invalid index " << tmp;
-                            vtn[j] = -1;
+                            vtn[j] = index;
+                            if (vtn[j] >= 1)
+                                vtn[j] -=1; // -1 because the numerotation begins at 1 and a vector begins at 0
+                            else if (vtn[j] < 0)
+                                vtn[j] += int(nbPrevious[j]);
+                            else
+                            {
+                                msg_error() << "Invalid index " << index;
+                                vtn[j] = -1;
+                            }
                         }
                     }
-                }
 
-                nodes.push_back(vtn[0]);
-                tIndices.push_back(vtn[1]);
-                nIndices.push_back(vtn[2]);
-            }
+                    nodes.push_back(vtn[0]);
+                    tIndices.push_back(vtn[1]);
+                    nIndices.push_back(vtn[2]);
+                }
 
-            my_faceList.push_back(nodes);
-            my_normalsList.push_back(nIndices);
-            my_texturesList.push_back(tIndices);
+                my_faceList.push_back(nodes);
+                my_normalsList.push_back(nIndices);
+                my_texturesList.push_back(tIndices);
 
-            if (nodes.size() == 2) // Edge
-            {
-                if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
+                if (nodes.size() == 2) // Edge
                 {
-                    if (nodes[0]<nodes[1])
-                        addEdge(&my_edges, Edge(nodes[0], nodes[1]));
-                    else
-                        addEdge(&my_edges, Edge(nodes[1], nodes[0]));
+                    if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
+                    {
+                        if (nodes[0]<nodes[1])
+                            addEdge(&my_edges, Edge(nodes[0], nodes[1]));
+                        else
+                            addEdge(&my_edges, Edge(nodes[1], nodes[0]));
+                    }
+                    ++nbFaces[MeshObjLoader::EDGE];
+                    faceType = MeshObjLoader::EDGE;
                 }
-                ++nbFaces[MeshObjLoader::EDGE];
-                faceType = MeshObjLoader::EDGE;
-            }
-            else if (nodes.size()==4 && !this->d_triangulate.getValue()) // Quad
-            {
-                if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
+                else if (nodes.size()==4 && !this->d_triangulate.getValue()) // Quad
                 {
-                    addQuad(&my_quads, Quad(nodes[0], nodes[1], nodes[2], nodes[3]));
+                    if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
+                    {
+                        addQuad(&my_quads, Quad(nodes[0], nodes[1], nodes[2], nodes[3]));
+                    }
+                    ++nbFaces[MeshObjLoader::QUAD];
+                    faceType = MeshObjLoader::QUAD;
                 }
-                ++nbFaces[MeshObjLoader::QUAD];
-                faceType = MeshObjLoader::QUAD;
-            }
-            else // Triangulate
-            {
-                if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
+                else // Triangulate
                 {
-                    for (size_t j=2; j<nodes.size(); j++)
-                        addTriangle(&my_triangles, Triangle(nodes[0], nodes[j-1], nodes[j]));
+                    if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
+                    {
+                        for (size_t j=2; j<nodes.size(); j++)
+                            addTriangle(&my_triangles, Triangle(nodes[0], nodes[j-1], nodes[j]));
+                    }
+                    ++nbFaces[MeshObjLoader::TRIANGLE];
+                    faceType = MeshObjLoader::TRIANGLE;
                 }
-                ++nbFaces[MeshObjLoader::TRIANGLE];
-                faceType = MeshObjLoader::TRIANGLE;
             }
-
-        }
-        else
-        {
-
         }
+        nbPreviousPositions += chunk.positions.size();
+        nbPreviousTexCoords += chunk.texCoords.size();
+        nbPreviousNormals += chunk.normals.size();
     }
 
     // end of current group
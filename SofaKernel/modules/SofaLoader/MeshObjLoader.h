@@ -53,6 +53,7 @@ protected:
     bool readOBJ (std::ifstream &file, const char* filename);
     bool readMTL (const char* filename, helper::vector <sofa::helper::types::Material>& d_materials);
     void addGroup (const sofa::core::loader::PrimitiveGroup& g);
+    void reorderPointData(const helper::vector<sofa::core::topology::Topology::PointID>& pointOrder) override;
 
     std::string textureName;
     FaceType faceType;
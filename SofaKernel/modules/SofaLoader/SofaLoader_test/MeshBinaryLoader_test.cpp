@@ -0,0 +1,109 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+
+#include <SofaTest/Sofa_test.h>
+
+#include <SofaLoader/MeshBinaryLoader.h>
+#include <sofa/core/loader/BinaryMeshFile.h>
+#include <sofa/helper/system/FileSystem.h>
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+using namespace sofa::component::loader;
+using sofa::core::loader::BinaryMeshFile;
+using sofa::core::loader::PrimitiveGroup;
+using sofa::helper::system::FileSystem;
+
+namespace sofa
+{
+namespace meshbinaryloader_test
+{
+
+class MeshBinaryLoader_test : public ::testing::Test, public MeshBinaryLoader
+{
+public:
+    std::string filename = boost::filesystem::temp_directory_path().string() + "/MeshBinaryLoader_test.sbm";
+
+    void TearDown() override
+    {
+        if (FileSystem::exists(filename))
+            FileSystem::removeAll(filename);
+    }
+
+    void writeTetrahedron()
+    {
+        helper::vector<defaulttype::Vec3d> positions = { {0,0,0}, {1,0,0}, {0,1,0}, {0,0,1} };
+        helper::vector<Triangle> triangles = { Triangle(0,2,1), Triangle(0,1,3), Triangle(1,2,3), Triangle(0,3,2) };
+        helper::vector<Tetrahedron> tetrahedra = { Tetrahedron(0,1,2,3) };
+        helper::vector<PrimitiveGroup> groups = { PrimitiveGroup(0, 1, "steel", "body", 2) };
+        const std::vector<char> encodedGroups = BinaryMeshFile::encodeGroups(groups);
+
+        std::vector<BinaryMeshFile::Section> sections;
+        sections.push_back(BinaryMeshFile::Section(BinaryMeshFile::POSITIONS, positions));
+        sections.push_back(BinaryMeshFile::Section(BinaryMeshFile::TRIANGLES, triangles));
+        sections.push_back(BinaryMeshFile::Section(BinaryMeshFile::TETRAHEDRA, tetrahedra));
+        sections.push_back(BinaryMeshFile::Section(BinaryMeshFile::TETRAHEDRA_GROUPS, 1, encodedGroups.size(), encodedGroups.data()));
+        ASSERT_TRUE(BinaryMeshFile::write(filename, sections));
+    }
+};
+
+TEST_F(MeshBinaryLoader_test, RoundTrip)
+{
+    writeTetrahedron();
+    this->setFilename(filename);
+    ASSERT_TRUE(this->load());
+
+    ASSERT_EQ(4u, this->d_positions.getValue().size());
+    EXPECT_EQ(1.0, this->d_positions.getValue()[3][2]);
+    ASSERT_EQ(4u, this->d_triangles.getValue().size());
+    EXPECT_EQ(3u, this->d_triangles.getValue()[3][1]);
+    ASSERT_EQ(1u, this->d_tetrahedra.getValue().size());
+    EXPECT_EQ(3u, this->d_tetrahedra.getValue()[0][3]);
+    EXPECT_EQ(0u, this->d_edges.getValue().size());
+    EXPECT_EQ(0u, this->d_hexahedra.getValue().size());
+
+    ASSERT_EQ(1u, this->d_tetrahedraGroups.getValue().size());
+    const PrimitiveGroup& group = this->d_tetrahedraGroups.getValue()[0];
+    EXPECT_EQ(1, group.nbp);
+    EXPECT_EQ(2, group.materialId);
+    EXPECT_EQ("body", group.groupName);
+    EXPECT_EQ("steel", group.materialName);
+}
+
+TEST_F(MeshBinaryLoader_test, CorruptedFile)
+{
+    writeTetrahedron();
+    {
+        std::fstream file(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put('x');
+    }
+    // the checksum of the whole file is only verified on demand
+    EXPECT_FALSE(this->d_verifyChecksum.getValue());
+    this->d_verifyChecksum.setValue(true);
+    this->setFilename(filename);
+    EXPECT_FALSE(this->load());
+}
+
+} // namespace meshbinaryloader_test
+} // namespace sofa
@@ -97,5 +97,144 @@ TEST_F(MeshObjLoader_test, LoadCall)
     loadTest("mesh/torus.obj", 800, 0, 1600,  0, 0, 0, 0, 0, 0, 861, 0);
 }
 
+/// Path of the meshes of the framework test resources
+std::string testMesh(const std::string& filename)
+{
+    return std::string(FRAMEWORK_TEST_RESOURCES_DIR) + "/mesh/" + filename;
+}
+
+/// Indices of an element or of a face definition, for comparisons
+template<class Indices>
+std::vector<int> indices(const Indices& element)
+{
+    return std::vector<int>(element.begin(), element.end());
+}
+
+/// Indices of all the elements of a list, one after the other
+template<class Element>
+std::vector<int> allIndices(const helper::vector<Element>& elements)
+{
+    std::vector<int> result;
+    for (const Element& e : elements)
+        result.insert(result.end(), e.begin(), e.end());
+    return result;
+}
+
+void expectGroup(const sofa::core::loader::PrimitiveGroup& g, int p0, int nbp, const std::string& groupName,
+                 const std::string& materialName, int materialId)
+{
+    EXPECT_EQ(p0, g.p0);
+    EXPECT_EQ(nbp, g.nbp);
+    EXPECT_EQ(groupName, g.groupName);
+    EXPECT_EQ(materialName, g.materialName);
+    EXPECT_EQ(materialId, g.materialId);
+}
+
+/// Relative indices refer to the vertices defined before the face
+TEST_F(MeshObjLoader_test, NegativeIndices)
+{
+    this->setFilename(testMesh("meshtest_negative_indices.obj"));
+    ASSERT_TRUE(this->load());
+
+    ASSERT_EQ(4u, this->d_positions.getValue().size());
+    ASSERT_EQ(2u, this->d_triangles.getValue().size());
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), indices(this->d_triangles.getValue()[0]));
+    EXPECT_EQ(std::vector<int>({0, 2, 3}), indices(this->d_triangles.getValue()[1]));
+    ASSERT_EQ(1u, this->d_edges.getValue().size());
+    EXPECT_EQ(std::vector<int>({0, 3}), indices(this->d_edges.getValue()[0]));
+
+    const helper::SVector<helper::SVector<int> >& texIndices = this->d_texIndexList.getValue();
+    const helper::SVector<helper::SVector<int> >& normalIndices = this->d_normalsIndexList.getValue();
+    ASSERT_EQ(3u, texIndices.size());
+    ASSERT_EQ(3u, normalIndices.size());
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), indices(texIndices[0]));
+    EXPECT_EQ(std::vector<int>({0, 2, 3}), indices(texIndices[1]));
+    EXPECT_EQ(std::vector<int>({-1, -1}), indices(texIndices[2]));
+    EXPECT_EQ(std::vector<int>({0, 0, 0}), indices(normalIndices[0]));
+    EXPECT_EQ(std::vector<int>({0, 0, 0}), indices(normalIndices[1]));
+    EXPECT_EQ(4u, this->d_normals.getValue().size());
+}
+
+/// Each "g" or "usemtl" statement ends the current group of primitives
+TEST_F(MeshObjLoader_test, GroupsAndMaterials)
+{
+    this->setFilename(testMesh("meshtest_groups.obj"));
+    ASSERT_TRUE(this->load());
+
+    EXPECT_EQ(6u, this->d_positions.getValue().size());
+    const helper::vector<Triangle>& triangles = this->d_triangles.getValue();
+    ASSERT_EQ(4u, triangles.size());
+    EXPECT_EQ(std::vector<int>({0, 1, 4}), indices(triangles[0]));
+    EXPECT_EQ(std::vector<int>({0, 4, 3}), indices(triangles[1]));
+    EXPECT_EQ(std::vector<int>({1, 5, 4}), indices(triangles[2]));
+    EXPECT_EQ(std::vector<int>({1, 2, 5}), indices(triangles[3]));
+    ASSERT_EQ(1u, this->d_quads.getValue().size());
+    EXPECT_EQ(std::vector<int>({1, 2, 5, 4}), indices(this->d_quads.getValue()[0]));
+    ASSERT_EQ(1u, this->d_edges.getValue().size());
+    EXPECT_EQ(std::vector<int>({0, 3}), indices(this->d_edges.getValue()[0]));
+
+    const helper::vector<sofa::helper::types::Material>& materials = this->d_materials.getValue();
+    ASSERT_EQ(2u, materials.size());
+    EXPECT_EQ("red", materials[0].name);
+    EXPECT_EQ("blue", materials[1].name);
+
+    const helper::vector<sofa::core::loader::PrimitiveGroup>& triangleGroups = this->d_trianglesGroups.getValue();
+    ASSERT_EQ(3u, triangleGroups.size());
+    expectGroup(triangleGroups[0], 0, 1, "Default_Group", "", -1);
+    expectGroup(triangleGroups[1], 1, 1, "left", "red", 0);
+    expectGroup(triangleGroups[2], 2, 2, "right side", "blue", 1);
+    ASSERT_EQ(1u, this->d_quadsGroups.getValue().size());
+    expectGroup(this->d_quadsGroups.getValue()[0], 0, 1, "left", "red", 0);
+    ASSERT_EQ(1u, this->d_edgesGroups.getValue().size());
+    expectGroup(this->d_edgesGroups.getValue()[0], 0, 1, "right side", "blue", 1);
+}
+
+/// A file with CRLF line endings gives the same mesh as with LF line endings
+TEST_F(MeshObjLoader_test, CRLFLineEndings)
+{
+    this->setFilename(testMesh("meshtest_groups.obj"));
+    ASSERT_TRUE(this->load());
+    const helper::vector<sofa::defaulttype::Vector3> positions = this->d_positions.getValue();
+    const std::vector<int> edges = allIndices(this->d_edges.getValue());
+    const std::vector<int> triangles = allIndices(this->d_triangles.getValue());
+    const std::vector<int> quads = allIndices(this->d_quads.getValue());
+    const helper::vector<sofa::core::loader::PrimitiveGroup> triangleGroups = this->d_trianglesGroups.getValue();
+
+    this->setFilename(testMesh("meshtest_crlf.obj"));
+    ASSERT_TRUE(this->load());
+    EXPECT_EQ(positions, this->d_positions.getValue());
+    EXPECT_EQ(edges, allIndices(this->d_edges.getValue()));
+    EXPECT_EQ(triangles, allIndices(this->d_triangles.getValue()));
+    EXPECT_EQ(quads, allIndices(this->d_quads.getValue()));
+    EXPECT_EQ(2u, this->d_materials.getValue().size());
+    const helper::vector<sofa::core::loader::PrimitiveGroup>& crlfGroups = this->d_trianglesGroups.getValue();
+    ASSERT_EQ(triangleGroups.size(), crlfGroups.size());
+    for (std::size_t i = 0; i < crlfGroups.size(); ++i)
+        expectGroup(crlfGroups[i], triangleGroups[i].p0, triangleGroups[i].nbp, triangleGroups[i].groupName,
+                    triangleGroups[i].materialName, triangleGroups[i].materialId);
+}
+
+/// Faces without normals, with or without texture coordinates
+TEST_F(MeshObjLoader_test, FacesWithoutNormals)
+{
+    this->setFilename(testMesh("meshtest_nonormals.obj"));
+    ASSERT_TRUE(this->load());
+
+    EXPECT_EQ(4u, this->d_positions.getValue().size());
+    ASSERT_EQ(2u, this->d_triangles.getValue().size());
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), indices(this->d_triangles.getValue()[0]));
+    EXPECT_EQ(std::vector<int>({0, 2, 3}), indices(this->d_triangles.getValue()[1]));
+    EXPECT_EQ(0u, this->d_normals.getValue().size());
+    EXPECT_EQ(0u, this->d_normalsList.getValue().size());
+    EXPECT_EQ(4u, this->d_texCoords.getValue().size());
+
+    const helper::SVector<helper::SVector<int> >& normalIndices = this->d_normalsIndexList.getValue();
+    ASSERT_EQ(2u, normalIndices.size());
+    EXPECT_EQ(std::vector<int>({-1, -1, -1}), indices(normalIndices[0]));
+    EXPECT_EQ(std::vector<int>({-1, -1, -1}), indices(normalIndices[1]));
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), indices(this->d_texIndexList.getValue()[0]));
+    EXPECT_EQ(std::vector<int>({-1, -1, -1}), indices(this->d_texIndexList.getValue()[1]));
+}
+
 } // namespace meshobjloader_test
 } // namespace sofa
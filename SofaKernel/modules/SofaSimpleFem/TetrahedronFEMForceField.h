@@ -257,6 +257,10 @@ public:
     void init() override;
     void reinit() override;
 
+    /// Store the rotations and plastic strains of the elements
+    void writeInternalState(std::vector<char>& buffer) const override;
+    bool readInternalState(const char* buffer, std::size_t size) override;
+
     void addForce(const core::MechanicalParams* mparams, DataVecDeriv& d_f, const DataVecCoord& d_x, const DataVecDeriv& d_v) override;
     void addDForce(const core::MechanicalParams* mparams, DataVecDeriv& d_df, const DataVecDeriv& d_dx) override;
 
@@ -26,6 +26,7 @@
 #include <sofa/core/visual/VisualParams.h>
 #include <SofaBaseTopology/GridTopology.h>
 #include <sofa/simulation/Simulation.h>
+#include <sofa/simulation/Checkpoint.h>
 #include <sofa/helper/decompose.h>
 #include <cassert>
 #include <iostream>
@@ -1464,6 +1465,41 @@ void TetrahedronFEMForceField<DataTypes>::reset()
 }
 
 
+template <class DataTypes>
+void TetrahedronFEMForceField<DataTypes>::writeInternalState(std::vector<char>& buffer) const
+{
+    using simulation::Checkpoint;
+    Checkpoint::writeValue(buffer, (unsigned int)rotations.size());
+    for (const Transformation& r : rotations)
+        for (int i=0; i<3; ++i)
+            for (int j=0; j<3; ++j)
+                Checkpoint::writeValue(buffer, r[i][j]);
+    Checkpoint::writeValue(buffer, (unsigned int)_plasticStrains.size());
+    for (const VoigtTensor& e : _plasticStrains)
+        for (int i=0; i<6; ++i)
+            Checkpoint::writeValue(buffer, e[i]);
+}
+
+template <class DataTypes>
+bool TetrahedronFEMForceField<DataTypes>::readInternalState(const char* buffer, std::size_t size)
+{
+    if (!size) return true;
+    simulation::Checkpoint::StateReader reader(buffer, size);
+    unsigned int n = 0;
+    if (!reader.readValue(n)) return false;
+    rotations.resize(n);
+    for (Transformation& r : rotations)
+        for (int i=0; i<3; ++i)
+            for (int j=0; j<3; ++j)
+                if (!reader.readValue(r[i][j])) return false;
+    if (!reader.readValue(n)) return false;
+    _plasticStrains.resize(n);
+    for (VoigtTensor& e : _plasticStrains)
+        for (int i=0; i<6; ++i)
+            if (!reader.readValue(e[i])) return false;
+    return reader.atEnd();
+}
+
 template <class DataTypes>
 inline void TetrahedronFEMForceField<DataTypes>::reinit()
 {
@@ -58,18 +58,15 @@ const std::string multi2mappingName = "Multi2Mapping";
 
 bool deriveFromMultiMapping( const std::string& className)
 {
-    if( sofa::core::ObjectFactory::HasCreator(className) )
+    const sofa::core::ObjectFactory::CreatorMap creators = core::ObjectFactory::getInstance()->getCreators(className);
+    sofa::core::ObjectFactory::CreatorMap::const_iterator iter;
+    for( iter = creators.begin(); iter != creators.end(); ++iter )
     {
-        sofa::core::ObjectFactory::ClassEntry& entry = core::ObjectFactory::getInstance()->getEntry(className);
-        sofa::core::ObjectFactory::CreatorMap::const_iterator iter;
-        for( iter = entry.creatorMap.begin(); iter != entry.creatorMap.end(); ++iter )
+        const std::string& name = iter->first;
+        if(name.substr(0,multimappingName.size()) == multimappingName
+           || name.substr(0,multi2mappingName.size()) == multi2mappingName)
         {
-            const std::string& name = iter->first;
-            if(name.substr(0,multimappingName.size()) == multimappingName
-               || name.substr(0,multi2mappingName.size()) == multi2mappingName)
-            {
-                return true;
-            }
+            return true;
         }
     }
     return false;
@@ -106,7 +103,10 @@ void recursiveMergeNode(BaseElement* destNode, BaseElement* srcNode);
 
 int numDefault=0;
 
-BaseElement* createNode(TiXmlNode* root, const char *basefilename,ElementNameHelper& elementNameHelper, bool isRoot = false)
+/// Create the element tree of the given XML node.
+/// If releaseDom is true, the XML nodes are removed from their document as soon as they have been
+/// converted, so that the document and the element tree never both hold the whole scene.
+BaseElement* createNode(TiXmlNode* root, const char *basefilename,ElementNameHelper& elementNameHelper, bool isRoot = false, bool releaseDom = false)
 {
     //if (!xmlStrcmp(root->name,(const xmlChar*)"text")) return nullptr;
 
@@ -208,9 +208,13 @@ BaseElement* createNode(TiXmlNode* root, const char *basefilename,ElementNameHel
         node->setAttribute(attr->Name(), std::string(attr->Value()));
     }
 
-    for (TiXmlNode* child = root->FirstChild() ; child != nullptr; child = child->NextSibling())
+    TiXmlNode* next = nullptr;
+    for (TiXmlNode* child = root->FirstChild() ; child != nullptr; child = next)
     {
-        BaseElement* childnode = createNode(child, basefilename, elementNameHelper);
+        next = child->NextSibling();
+        BaseElement* childnode = createNode(child, basefilename, elementNameHelper, false, releaseDom);
+        if (releaseDom)
+            root->RemoveChild(child);
         if (childnode != nullptr)
         {
             //  if the current node is an included node, with the special name Group, we only add the objects.
@@ -265,10 +269,13 @@ static void dumpNode(BaseElement* node, std::string prefix0="==", std::string pr
 }
 */
 
-BaseElement* processXMLLoading(const char *filename, const TiXmlDocument &doc, bool fromMem)
+namespace
+{
+
+BaseElement* processXMLDocument(const char *filename, TiXmlDocument &doc, bool fromMem, bool releaseDom)
 {
     ElementNameHelper resolveElementName;
-    const TiXmlElement* hRoot = doc.RootElement();
+    TiXmlElement* hRoot = doc.RootElement();
 
     if (hRoot == nullptr)
     {
@@ -281,7 +288,7 @@ BaseElement* processXMLLoading(const char *filename, const TiXmlDocument &doc, b
         basefilename = filename ;
     else
         basefilename = sofa::helper::system::SetDirectory::GetRelativeFromDir(filename,sofa::helper::system::SetDirectory::GetCurrentDir().c_str());
-    BaseElement* graph = createNode((TiXmlElement*)hRoot, basefilename.c_str(),resolveElementName, true);
+    BaseElement* graph = createNode(hRoot, basefilename.c_str(),resolveElementName, true, releaseDom);
 
     if (graph == nullptr)
     {
@@ -292,6 +299,13 @@ BaseElement* processXMLLoading(const char *filename, const TiXmlDocument &doc, b
     return graph;
 }
 
+} // namespace
+
+BaseElement* processXMLLoading(const char *filename, const TiXmlDocument &doc, bool fromMem)
+{
+    return processXMLDocument(filename, const_cast<TiXmlDocument&>(doc), fromMem, false);
+}
+
 BaseElement* loadFromMemory(const char *filename, const char *data, unsigned int /*size*/ )
 {
     TiXmlDocument doc; // the resulting document tree
@@ -304,7 +318,7 @@ BaseElement* loadFromMemory(const char *filename, const char *data, unsigned int
         msg_error("XMLParser") << "Failed to open " << filename << "\n" << doc.ErrorDesc() << " at line " << doc.ErrorRow() << " row " << doc.ErrorCol() ;
         return nullptr;
     }
-    return processXMLLoading(filename, doc, true);
+    return processXMLDocument(filename, doc, true, true);
 }
 
 BaseElement* loadFromFile(const char *filename)
@@ -328,7 +342,7 @@ BaseElement* loadFromFile(const char *filename)
         return nullptr;
     }
 
-    BaseElement* r = processXMLLoading(filename, *doc);
+    BaseElement* r = processXMLDocument(filename, *doc, false, true);
     //dmsg_error("XML") << "clear doc";
     doc->Clear();
     //dmsg_error("XML") << "delete doc";
@@ -369,7 +383,8 @@ BaseElement* includeNode(TiXmlNode* root,const char *basefilename, ElementNameHe
         //xmlFreeDoc(doc);
         return nullptr;
     }
-    BaseElement* result = createNode(newroot, filename.c_str(),resolveElementName, true);
+    // the included document is owned here, it can always be released while being converted
+    BaseElement* result = createNode(newroot, filename.c_str(),resolveElementName, true, true);
     if (result)
     {
         if (result->getName() == "Group") result->setIncludeNodeType(INCLUDE_NODE_GROUP);
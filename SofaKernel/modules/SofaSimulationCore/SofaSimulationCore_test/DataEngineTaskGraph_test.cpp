@@ -0,0 +1,204 @@
+#include <sofa/simulation/DataEngineTaskGraph.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/helper/testing/BaseTest.h>
+
+#include <atomic>
+
+namespace sofa
+{
+
+/// Engine summing its two inputs, and counting its updates
+class SumEngine : public core::DataEngine
+{
+public:
+    SOFA_CLASS(SumEngine, core::DataEngine);
+
+    Data< int > a;
+    Data< int > b;
+    Data< int > sum;
+    std::atomic<int> nbUpdates;
+
+    SumEngine()
+        : a(initData(&a, 0, "a", "a"))
+        , b(initData(&b, 0, "b", "b"))
+        , sum(initData(&sum, 0, "sum", "a+b"))
+        , nbUpdates(0)
+    {
+        addInput(&a);
+        addInput(&b);
+        addOutput(&sum);
+    }
+
+    void doUpdate() override
+    {
+        sum.setValue(a.getValue() + b.getValue());
+        ++nbUpdates;
+    }
+};
+
+/// Engine copying its input to a Data it does not own
+class CopyEngine : public core::DataEngine
+{
+public:
+    SOFA_CLASS(CopyEngine, core::DataEngine);
+
+    Data< int > value;
+    Data< int >* target;
+    std::atomic<int> nbUpdates;
+
+    CopyEngine()
+        : value(initData(&value, 0, "value", "value"))
+        , target(nullptr)
+        , nbUpdates(0)
+    {
+        addInput(&value);
+    }
+
+    void setTarget(Data< int >* data)
+    {
+        target = data;
+        addOutput(data);
+    }
+
+    void doUpdate() override
+    {
+        target->setValue(value.getValue());
+        ++nbUpdates;
+    }
+};
+
+struct DataEngineTaskGraph_test : public helper::testing::BaseTest
+{
+    SumEngine::SPtr A, B, C;
+
+    void SetUp() override
+    {
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(simulation::DefaultTaskScheduler::name());
+        scheduler->init(4);
+
+        // A and B are independent, C sums their outputs
+        A = core::objectmodel::New<SumEngine>();
+        B = core::objectmodel::New<SumEngine>();
+        C = core::objectmodel::New<SumEngine>();
+        C->a.setParent(&A->sum);
+        C->b.setParent(&B->sum);
+        A->a.setValue(1); A->b.setValue(2);
+        B->a.setValue(3); B->b.setValue(4);
+    }
+
+    void TearDown() override
+    {
+        simulation::DataEngineTaskGraph::setParallelUpdate(false);
+    }
+};
+
+TEST_F(DataEngineTaskGraph_test, levels)
+{
+    simulation::DataEngineTaskGraph graph;
+    graph.addRequest(&C->sum);
+    ASSERT_TRUE(graph.isValid());
+    ASSERT_EQ(graph.getNbEngines(), 3u);
+    ASSERT_EQ(graph.getLevels().size(), 2u);
+    EXPECT_EQ(graph.getLevels()[0].size(), 2u);
+    ASSERT_EQ(graph.getLevels()[1].size(), 1u);
+    EXPECT_EQ(graph.getLevels()[1][0], C.get());
+
+    graph.update();
+    EXPECT_FALSE(C->isDirty());
+    EXPECT_EQ(C->sum.getValue(), 10);
+    EXPECT_EQ(A->nbUpdates, 1);
+    EXPECT_EQ(B->nbUpdates, 1);
+    EXPECT_EQ(C->nbUpdates, 1);
+
+    // clean engines are not collected
+    graph.addRequest(&C->sum);
+    EXPECT_EQ(graph.getNbEngines(), 0u);
+}
+
+TEST_F(DataEngineTaskGraph_test, pullOutput)
+{
+    simulation::DataEngineTaskGraph::setParallelUpdate(true);
+    EXPECT_EQ(C->sum.getValue(), 10);
+    EXPECT_EQ(A->nbUpdates, 1);
+    EXPECT_EQ(B->nbUpdates, 1);
+    EXPECT_EQ(C->nbUpdates, 1);
+
+    // only the modified branch is updated again
+    B->a.setValue(10);
+    EXPECT_EQ(C->sum.getValue(), 17);
+    EXPECT_EQ(A->nbUpdates, 1);
+    EXPECT_EQ(B->nbUpdates, 2);
+    EXPECT_EQ(C->nbUpdates, 2);
+}
+
+TEST_F(DataEngineTaskGraph_test, wideGraph)
+{
+    simulation::DataEngineTaskGraph::setParallelUpdate(true);
+
+    // a binary reduction tree over 64 engines
+    std::vector<SumEngine::SPtr> engines;
+    std::vector<SumEngine::SPtr> level;
+    for (int i = 0; i < 64; ++i)
+    {
+        SumEngine::SPtr e = core::objectmodel::New<SumEngine>();
+        e->a.setValue(i);
+        e->b.setValue(1);
+        level.push_back(e);
+        engines.push_back(e);
+    }
+    while (level.size() > 1)
+    {
+        std::vector<SumEngine::SPtr> next;
+        for (std::size_t i = 0; i < level.size(); i += 2)
+        {
+            SumEngine::SPtr e = core::objectmodel::New<SumEngine>();
+            e->a.setParent(&level[i]->sum);
+            e->b.setParent(&level[i+1]->sum);
+            next.push_back(e);
+            engines.push_back(e);
+        }
+        level.swap(next);
+    }
+
+    simulation::DataEngineTaskGraph graph;
+    graph.addRequest(&level[0]->sum);
+    EXPECT_EQ(graph.getLevels().size(), 7u);
+
+    EXPECT_EQ(level[0]->sum.getValue(), 63*64/2 + 64);
+    for (const auto& e : engines)
+        EXPECT_EQ(e->nbUpdates, 1);
+}
+
+TEST_F(DataEngineTaskGraph_test, sharedOutputIsUpdatedAfterTheLevel)
+{
+    // D also writes the output of A: it is not updated concurrently with A
+    CopyEngine::SPtr D = core::objectmodel::New<CopyEngine>();
+    D->value.setValue(100);
+    D->setTarget(&A->sum);
+
+    simulation::DataEngineTaskGraph graph;
+    graph.addRequest(&C->sum);
+    ASSERT_EQ(graph.getLevels().size(), 2u);
+    ASSERT_EQ(graph.getLevels()[0].size(), 3u);
+    EXPECT_EQ(graph.getLevels()[0].back(), D.get());
+
+    graph.update();
+    EXPECT_EQ(A->nbUpdates, 1);
+    EXPECT_EQ(D->nbUpdates, 1);
+    EXPECT_EQ(C->nbUpdates, 1);
+    EXPECT_EQ(C->sum.getValue(), 107);
+}
+
+TEST_F(DataEngineTaskGraph_test, cycleIsNotValid)
+{
+    A->a.setParent(&C->sum);
+    simulation::DataEngineTaskGraph graph;
+    graph.addRequest(&C->sum);
+    EXPECT_FALSE(graph.isValid());
+    graph.update();
+    EXPECT_EQ(C->nbUpdates, 0);
+    A->a.setParent(nullptr);
+}
+
+} // namespace sofa
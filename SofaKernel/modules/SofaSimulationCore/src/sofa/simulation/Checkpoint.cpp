@@ -0,0 +1,338 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/Checkpoint.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/core/objectmodel/BaseData.h>
+#include <sofa/core/objectmodel/DDGNode.h>
+#include <sofa/helper/AdvancedTimer.h>
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <set>
+
+namespace sofa
+{
+
+namespace simulation
+{
+
+using core::objectmodel::Base;
+using core::objectmodel::BaseData;
+using core::objectmodel::BaseObject;
+
+namespace
+{
+
+const char CHECKPOINT_MAGIC[8] = { 'S', 'O', 'F', 'A', 'C', 'K', 'P', 'T' };
+const std::uint32_t CHECKPOINT_VERSION = 2;
+/// Written in the byte order of the machine, it reads differently on another byte order
+const std::uint32_t CHECKPOINT_BYTE_ORDER = 0x01020304;
+
+void writeBytes(std::ostream& out, const char* data, std::size_t size)
+{
+    const std::uint64_t n = size;
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    if (size)
+        out.write(data, std::streamsize(size));
+}
+
+bool readBytes(std::istream& in, std::vector<char>& data)
+{
+    std::uint64_t n = 0;
+    if (!in.read(reinterpret_cast<char*>(&n), sizeof(n)))
+        return false;
+    data.resize(std::size_t(n));
+    return n == 0 || bool(in.read(data.data(), std::streamsize(n)));
+}
+
+bool readString(std::istream& in, std::string& value)
+{
+    std::vector<char> data;
+    if (!readBytes(in, data))
+        return false;
+    value.assign(data.begin(), data.end());
+    return true;
+}
+
+/// Visit the nodes of the subgraph, each one once even if the graph is a DAG
+void collectNodes(Node* node, std::set<Node*>& visited, std::vector<Node*>& nodes)
+{
+    if (!visited.insert(node).second)
+        return;
+    nodes.push_back(node);
+    for (unsigned int i=0; i<node->child.size(); ++i)
+        collectNodes(node->child[i].get(), visited, nodes);
+}
+
+} // anonymous namespace
+
+Checkpoint::Checkpoint()
+{
+}
+
+void Checkpoint::clear()
+{
+    m_owners.clear();
+    m_buffer.clear();
+}
+
+void Checkpoint::writeString(std::vector<char>& buffer, const std::string& value)
+{
+    writeValue(buffer, std::uint64_t(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+bool Checkpoint::StateReader::readString(std::string& value)
+{
+    std::uint64_t n = 0;
+    if (!readValue(n) || std::uint64_t(m_end - m_cursor) < n)
+        return false;
+    value.assign(m_cursor, std::size_t(n));
+    m_cursor += n;
+    return true;
+}
+
+void Checkpoint::captureOwner(Base* owner, BaseObject* object, const std::string& path)
+{
+    OwnerState state;
+    state.owner = owner;
+    state.object = object;
+    state.path = path;
+    state.isNode = (object == nullptr);
+    for (BaseData* data : owner->getDataFields())
+    {
+        // linked Data get their value from their parent
+        if (data->getParent() != nullptr)
+            continue;
+        DataState ds;
+        ds.data = data;
+        ds.offset = m_buffer.size();
+        ds.binary = data->writeBinary(m_buffer);
+        if (!ds.binary)
+        {
+            const std::string value = data->getValueString();
+            m_buffer.insert(m_buffer.end(), value.begin(), value.end());
+        }
+        ds.size = m_buffer.size() - ds.offset;
+        ds.counter = data->getCounter();
+        state.data.push_back(ds);
+    }
+    state.internalOffset = m_buffer.size();
+    if (object)
+        object->writeInternalState(m_buffer);
+    state.internalSize = m_buffer.size() - state.internalOffset;
+    m_owners.push_back(state);
+}
+
+void Checkpoint::capture(Node* root)
+{
+    helper::ScopedAdvancedTimer timer("Checkpoint::capture");
+    clear();
+
+    std::set<Node*> visited;
+    std::vector<Node*> nodes;
+    collectNodes(root, visited, nodes);
+    for (Node* node : nodes)
+    {
+        captureOwner(node, nullptr, node->getPathName());
+        for (unsigned int i=0; i<node->object.size(); ++i)
+            captureOwner(node->object[i].get(), node->object[i].get(), node->object[i]->getPathName());
+    }
+}
+
+bool Checkpoint::restore(bool force)
+{
+    helper::ScopedAdvancedTimer timer("Checkpoint::restore");
+    bool ok = true;
+
+    std::vector<bool> modified(m_owners.size(), false);
+    {
+        // the outputs of the restored Data are set dirty once, at the end of the scope
+        core::objectmodel::DDGNode::BatchEdit batch;
+        for (std::size_t i = 0; i < m_owners.size(); ++i)
+        {
+            for (DataState& ds : m_owners[i].data)
+            {
+                if (!ds.data || (!force && ds.data->getCounter() == ds.counter))
+                    continue;
+                const char* value = m_buffer.data() + ds.offset;
+                const bool restored = ds.binary ? ds.data->readBinary(value, ds.size) == ds.size
+                                                : ds.data->read(std::string(value, ds.size));
+                if (!restored)
+                {
+                    msg_error(m_owners[i].owner.get()) << "Checkpoint: cannot restore the value of " << ds.data->getName();
+                    ok = false;
+                }
+                ds.counter = ds.data->getCounter();
+                modified[i] = true;
+            }
+        }
+    }
+
+    // the internal state is rebuilt once all the Data are up to date
+    for (std::size_t i = 0; i < m_owners.size(); ++i)
+    {
+        const OwnerState& state = m_owners[i];
+        if (!state.object || (!modified[i] && !state.internalSize))
+            continue;
+        if (!state.object->readInternalState(m_buffer.data() + state.internalOffset, state.internalSize))
+        {
+            msg_error(state.object) << "Checkpoint: cannot restore the internal state";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void Checkpoint::write(std::ostream& out) const
+{
+    out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    out.write(reinterpret_cast<const char*>(&CHECKPOINT_BYTE_ORDER), sizeof(CHECKPOINT_BYTE_ORDER));
+    out.write(reinterpret_cast<const char*>(&CHECKPOINT_VERSION), sizeof(CHECKPOINT_VERSION));
+    const std::uint64_t nbOwners = m_owners.size();
+    out.write(reinterpret_cast<const char*>(&nbOwners), sizeof(nbOwners));
+    for (const OwnerState& state : m_owners)
+    {
+        writeBytes(out, state.path.data(), state.path.size());
+        const std::uint8_t isNode = state.isNode ? 1 : 0;
+        out.write(reinterpret_cast<const char*>(&isNode), sizeof(isNode));
+        const std::uint64_t nbData = state.data.size();
+        out.write(reinterpret_cast<const char*>(&nbData), sizeof(nbData));
+        for (const DataState& ds : state.data)
+        {
+            const std::string& name = ds.data->getName();
+            writeBytes(out, name.data(), name.size());
+            const std::uint8_t binary = ds.binary ? 1 : 0;
+            out.write(reinterpret_cast<const char*>(&binary), sizeof(binary));
+            writeBytes(out, m_buffer.data() + ds.offset, ds.size);
+        }
+        writeBytes(out, m_buffer.data() + state.internalOffset, state.internalSize);
+    }
+}
+
+bool Checkpoint::read(std::istream& in, Node* root)
+{
+    clear();
+
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    std::uint32_t byteOrder = 0;
+    std::uint32_t version = 0;
+    std::uint64_t nbOwners = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0
+            || !in.read(reinterpret_cast<char*>(&byteOrder), sizeof(byteOrder)))
+    {
+        msg_error("Checkpoint") << "Invalid checkpoint header";
+        return false;
+    }
+    if (byteOrder != CHECKPOINT_BYTE_ORDER)
+    {
+        msg_error("Checkpoint") << "The checkpoint was written on a machine with another byte order";
+        return false;
+    }
+    if (!in.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != CHECKPOINT_VERSION
+            || !in.read(reinterpret_cast<char*>(&nbOwners), sizeof(nbOwners)))
+    {
+        msg_error("Checkpoint") << "Invalid checkpoint header";
+        return false;
+    }
+
+    // the nodes and components of the graph, by path
+    std::map<std::string, std::pair<Base*, BaseObject*> > owners;
+    std::set<Node*> visited;
+    std::vector<Node*> nodes;
+    collectNodes(root, visited, nodes);
+    for (Node* node : nodes)
+    {
+        owners[node->getPathName()] = std::make_pair(node, (BaseObject*)nullptr);
+        for (unsigned int i=0; i<node->object.size(); ++i)
+            owners[node->object[i]->getPathName()] = std::make_pair(node->object[i].get(), node->object[i].get());
+    }
+
+    std::vector<char> bytes;
+    for (std::uint64_t i = 0; i < nbOwners; ++i)
+    {
+        OwnerState state;
+        std::uint8_t isNode = 0;
+        std::uint64_t nbData = 0;
+        if (!readString(in, state.path)
+                || !in.read(reinterpret_cast<char*>(&isNode), sizeof(isNode))
+                || !in.read(reinterpret_cast<char*>(&nbData), sizeof(nbData)))
+        {
+            msg_error("Checkpoint") << "Truncated checkpoint";
+            clear();
+            return false;
+        }
+        state.isNode = (isNode != 0);
+        std::map<std::string, std::pair<Base*, BaseObject*> >::const_iterator it = owners.find(state.path);
+        Base* owner = nullptr;
+        state.object = nullptr;
+        if (it != owners.end() && state.isNode == (it->second.second == nullptr))
+        {
+            owner = it->second.first;
+            state.object = it->second.second;
+        }
+        msg_warning_when(!owner, "Checkpoint") << "No component at " << state.path << ", its state is ignored";
+        state.owner = owner;
+
+        for (std::uint64_t d = 0; d < nbData; ++d)
+        {
+            std::string name;
+            std::uint8_t binary = 0;
+            if (!readString(in, name) || !in.read(reinterpret_cast<char*>(&binary), sizeof(binary)) || !readBytes(in, bytes))
+            {
+                msg_error("Checkpoint") << "Truncated checkpoint";
+                clear();
+                return false;
+            }
+            BaseData* data = owner ? owner->findData(name) : nullptr;
+            if (!data)
+                continue;
+            DataState ds;
+            ds.data = data;
+            ds.binary = (binary != 0);
+            ds.offset = m_buffer.size();
+            ds.size = bytes.size();
+            ds.counter = data->getCounter();
+            m_buffer.insert(m_buffer.end(), bytes.begin(), bytes.end());
+            state.data.push_back(ds);
+        }
+        if (!readBytes(in, bytes))
+        {
+            msg_error("Checkpoint") << "Truncated checkpoint";
+            clear();
+            return false;
+        }
+        state.internalOffset = m_buffer.size();
+        state.internalSize = bytes.size();
+        m_buffer.insert(m_buffer.end(), bytes.begin(), bytes.end());
+        if (owner)
+            m_owners.push_back(state);
+    }
+    return true;
+}
+
+} // namespace simulation
+
+} // namespace sofa
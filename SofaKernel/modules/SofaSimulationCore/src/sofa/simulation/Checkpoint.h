@@ -0,0 +1,156 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_SIMULATION_CORE_CHECKPOINT_H
+#define SOFA_SIMULATION_CORE_CHECKPOINT_H
+
+#include <sofa/simulation/simulationcore.h>
+#include <sofa/core/objectmodel/BaseObject.h>
+#include <cstring>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace sofa
+{
+
+namespace simulation
+{
+
+class Node;
+
+/**
+ *  \brief In-memory snapshot of the state of a scene graph, restored without running init() again.
+ *
+ *  capture() stores the value of every Data of the nodes and components of a subgraph, except
+ *  the ones linked to a parent Data. The Data supporting it are copied in binary
+ *  (BaseData::writeBinary()), the other ones through their string value. The state of the
+ *  components which is not held by Data is stored by BaseObject::writeInternalState().
+ *
+ *  restore() only writes back the Data whose counter changed since the capture (or since the
+ *  last restore), with the propagation of the changes batched, then lets the components
+ *  rebuild their internal state. Restoring a checkpoint taken at the beginning of a step is
+ *  then mostly a copy of the mechanical vectors.
+ *
+ *  A checkpoint can also be written to a stream and read back into a graph with the same
+ *  structure, the nodes and components being matched by their path. The values are written
+ *  in the byte order of the machine, which is recorded in the header: a checkpoint written
+ *  with another byte order is rejected.
+ */
+class SOFA_SIMULATION_CORE_API Checkpoint
+{
+public:
+    Checkpoint();
+
+    /// Store the state of the subgraph, replacing the previous one
+    void capture(Node* root);
+
+    /// Write back the captured state.
+    /// If force is false, the Data which were not modified since the capture are skipped.
+    /// Returns false if a value could not be restored.
+    bool restore(bool force = false);
+
+    void clear();
+    bool empty() const { return m_owners.empty(); }
+
+    /// Number of bytes used by the captured values
+    std::size_t getByteSize() const { return m_buffer.size(); }
+
+    /// Write the captured state
+    void write(std::ostream& out) const;
+
+    /// Read a state written by write(), associating it to the nodes and components of the
+    /// subgraph with the same paths. Call restore(true) to apply it.
+    bool read(std::istream& in, Node* root);
+
+    /// @name Helpers for BaseObject::writeInternalState() and readInternalState()
+    /// @{
+    template<class T>
+    static void writeValue(std::vector<char>& buffer, const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be written");
+        const std::size_t offset = buffer.size();
+        buffer.resize(offset + sizeof(T));
+        std::memcpy(&buffer[offset], &value, sizeof(T));
+    }
+
+    static void writeString(std::vector<char>& buffer, const std::string& value);
+
+    /// Reads the values in the order they were written, checking the end of the buffer
+    class SOFA_SIMULATION_CORE_API StateReader
+    {
+    public:
+        StateReader(const char* buffer, std::size_t size) : m_cursor(buffer), m_end(buffer + size) {}
+
+        template<class T>
+        bool readValue(T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be read");
+            if (std::size_t(m_end - m_cursor) < sizeof(T))
+                return false;
+            std::memcpy(&value, m_cursor, sizeof(T));
+            m_cursor += sizeof(T);
+            return true;
+        }
+
+        bool readString(std::string& value);
+
+        bool atEnd() const { return m_cursor == m_end; }
+
+    protected:
+        const char* m_cursor;
+        const char* m_end;
+    };
+    /// @}
+
+protected:
+    struct DataState
+    {
+        core::objectmodel::BaseData* data;
+        int counter; ///< counter of the Data when it had the stored value
+        bool binary;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    struct OwnerState
+    {
+        core::objectmodel::Base::SPtr owner;
+        core::objectmodel::BaseObject* object; ///< the owner if it is a component, null for a node
+        std::string path;
+        bool isNode;
+        std::vector<DataState> data;
+        std::size_t internalOffset;
+        std::size_t internalSize;
+    };
+
+    void captureOwner(core::objectmodel::Base* owner, core::objectmodel::BaseObject* object, const std::string& path);
+
+    std::vector<OwnerState> m_owners;
+    std::vector<char> m_buffer;
+};
+
+} // namespace simulation
+
+} // namespace sofa
+
+#endif // SOFA_SIMULATION_CORE_CHECKPOINT_H
@@ -0,0 +1,240 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/DataEngineTaskGraph.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/simulation/SimulationContext.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <sofa/helper/system/thread/thread_specific_ptr.h>
+
+#include <algorithm>
+#include <climits>
+#include <set>
+
+namespace sofa
+{
+
+namespace simulation
+{
+
+namespace
+{
+
+/// Level of the nodes whose dependencies are being collected, to detect cycles
+const int VISITING = INT_MIN;
+
+/// Set while the engines of a graph are updated by this thread, so that their own update()
+/// does not collect their (clean) inputs again
+SOFA_THREAD_SPECIFIC_PTR(DataEngineTaskGraph, s_currentGraph);
+
+class DataEngineUpdateTask : public CpuTask
+{
+public:
+    DataEngineUpdateTask(DataEngineTaskGraph* graph, core::DataEngine* engine, CpuTask::Status* status)
+        : CpuTask(status), m_graph(graph), m_engine(engine), m_context(SimulationContext::getCurrent())
+    {
+    }
+
+    MemoryAlloc run() override
+    {
+        // the engine sends its messages and timers to the context of the scene being updated
+        SimulationContext::Scope scope(m_context);
+        DataEngineTaskGraph* previous = s_currentGraph;
+        s_currentGraph = m_graph;
+        m_engine->update();
+        s_currentGraph = previous;
+        return MemoryAlloc::Stack;
+    }
+
+protected:
+    DataEngineTaskGraph* m_graph;
+    core::DataEngine* m_engine;
+    SimulationContext* m_context;
+};
+
+void updateUpstreamEngines(core::DataEngine* engine)
+{
+    if (s_currentGraph)
+        return;
+    DataEngineTaskGraph graph;
+    for (auto input : engine->getInputs())
+        graph.addRequest(input);
+    // a single engine is pulled as usual
+    if (graph.getNbEngines() > 1)
+        graph.update();
+}
+
+} // anonymous namespace
+
+DataEngineTaskGraph::DataEngineTaskGraph()
+    : m_nbEngines(0)
+    , m_valid(true)
+{
+}
+
+void DataEngineTaskGraph::clear()
+{
+    m_visited.clear();
+    m_levels.clear();
+    m_nbEngines = 0;
+    m_valid = true;
+}
+
+void DataEngineTaskGraph::addRequest(DDGNode* node)
+{
+    if (node && m_valid)
+        collect(node);
+}
+
+void DataEngineTaskGraph::addRequests(Node* root)
+{
+    std::vector<core::DataEngine*> engines;
+    root->getTreeObjects<core::DataEngine>(&engines);
+    for (core::DataEngine* engine : engines)
+        addRequest(engine);
+}
+
+int DataEngineTaskGraph::collect(DDGNode* node)
+{
+    if (!m_valid || !node->isDirty())
+        return -1;
+
+    auto visited = m_visited.find(node);
+    if (visited != m_visited.end())
+    {
+        if (visited->second == VISITING)
+            m_valid = false;
+        return visited->second;
+    }
+
+    core::DataEngine* engine = nullptr;
+    if (!node->getData())
+    {
+        engine = dynamic_cast<core::DataEngine*>(node);
+        if (!engine)
+        {
+            m_valid = false;
+            return -1;
+        }
+    }
+
+    m_visited[node] = VISITING;
+    int level = -1;
+    for (auto input : node->getInputs())
+        level = std::max(level, collect(input));
+    if (!m_valid)
+        return -1;
+
+    if (engine)
+    {
+        ++level;
+        if (m_levels.size() <= std::size_t(level))
+            m_levels.resize(level+1);
+        m_levels[level].push_back(engine);
+        ++m_nbEngines;
+    }
+    m_visited[node] = level;
+    return level;
+}
+
+void DataEngineTaskGraph::update()
+{
+    if (!m_valid || m_nbEngines == 0)
+    {
+        clear();
+        return;
+    }
+
+    helper::ScopedAdvancedTimer timer("DataEngineTaskGraph");
+    DataEngineTaskGraph* previous = s_currentGraph;
+    s_currentGraph = this;
+
+    TaskScheduler* scheduler = nullptr;
+    for (const std::vector<core::DataEngine*>& level : m_levels)
+    {
+        // the engines of lower levels are up to date, the Data between them and this level
+        // only copy their parent, which is done here to not share them between the tasks
+        for (core::DataEngine* engine : level)
+            for (auto input : engine->getInputs())
+                input->updateIfDirty();
+
+        if (level.size() > 1 && !scheduler)
+            scheduler = TaskScheduler::getInstance();
+
+        // the threads running a SimulationContext other than the main one cannot add tasks
+        if (level.size() == 1 || scheduler->getThreadCount() < 2 || !scheduler->isSchedulerThread())
+        {
+            for (core::DataEngine* engine : level)
+                engine->updateIfDirty();
+            continue;
+        }
+
+        // an engine writing a Data already written by another engine of the level is updated
+        // after them, on this thread
+        std::vector<core::DataEngine*> parallel, serial;
+        std::set<DDGNode*> outputs;
+        for (core::DataEngine* engine : level)
+        {
+            bool shared = false;
+            for (auto output : engine->DDGNode::getOutputs())
+                shared = !outputs.insert(output).second || shared;
+            (shared ? serial : parallel).push_back(engine);
+        }
+
+        CpuTask::Status status;
+        std::vector<DataEngineUpdateTask> tasks;
+        tasks.reserve(parallel.size());
+        for (core::DataEngine* engine : parallel)
+        {
+            tasks.emplace_back(this, engine, &status);
+            scheduler->addTask(&tasks.back());
+        }
+        scheduler->workUntilDone(&status);
+
+        for (core::DataEngine* engine : serial)
+            engine->updateIfDirty();
+    }
+
+    s_currentGraph = previous;
+    clear();
+}
+
+void DataEngineTaskGraph::setParallelUpdate(bool parallel)
+{
+    core::DataEngine::setUpdateUpstreamFunction(parallel ? &updateUpstreamEngines : nullptr);
+}
+
+bool DataEngineTaskGraph::isParallelUpdate()
+{
+    return core::DataEngine::getUpdateUpstreamFunction() == &updateUpstreamEngines;
+}
+
+void DataEngineTaskGraph::updateDirtyEngines(Node* root)
+{
+    DataEngineTaskGraph graph;
+    graph.addRequests(root);
+    graph.update();
+}
+
+} // namespace simulation
+
+} // namespace sofa
@@ -0,0 +1,99 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_SIMULATION_CORE_DATAENGINETASKGRAPH_H
+#define SOFA_SIMULATION_CORE_DATAENGINETASKGRAPH_H
+
+#include <sofa/simulation/simulationcore.h>
+#include <sofa/core/DataEngine.h>
+#include <vector>
+#include <map>
+
+namespace sofa
+{
+
+namespace simulation
+{
+
+class Node;
+
+/**
+ *  \brief Evaluates the dirty DataEngines needed by a set of Data as a task graph.
+ *
+ *  The dirty engines upstream of the requested Data are collected and sorted in levels, each
+ *  engine depending only on engines of lower levels. The levels are updated in order, and the
+ *  engines of a level, which are independent, are updated in parallel by the TaskScheduler.
+ *  The engines writing a Data already written by another engine of their level are updated
+ *  afterwards, one after the other.
+ *
+ *  setParallelUpdate(true) installs it in DataEngine::update(), so that pulling the output of
+ *  an engine evaluates all the dirty engines it depends on this way.
+ */
+class SOFA_SIMULATION_CORE_API DataEngineTaskGraph
+{
+public:
+    typedef core::objectmodel::DDGNode DDGNode;
+
+    DataEngineTaskGraph();
+
+    /// Collect the dirty engines needed to update the node (a Data or a DataEngine, which is
+    /// then part of the graph).
+    void addRequest(DDGNode* node);
+
+    /// Collect all the dirty engines of the subtree.
+    void addRequests(Node* root);
+
+    /// Update the collected engines, then clear the graph.
+    /// Nothing is updated if the graph is not valid, the engines being then pulled as usual.
+    void update();
+
+    void clear();
+
+    /// The collected engines, by level
+    const std::vector< std::vector<core::DataEngine*> >& getLevels() const { return m_levels; }
+    std::size_t getNbEngines() const { return m_nbEngines; }
+
+    /// False if the dependencies contain a cycle, or a dirty DDGNode which is neither a Data
+    /// nor a DataEngine (i.e. a DataTrackerEngine), that cannot be updated concurrently.
+    bool isValid() const { return m_valid; }
+
+    /// Install (or remove) the evaluation of the upstream engines in DataEngine::update().
+    static void setParallelUpdate(bool parallel);
+    static bool isParallelUpdate();
+
+    /// Update the dirty engines of the subtree in parallel.
+    static void updateDirtyEngines(Node* root);
+
+protected:
+    /// Returns the level of the last engine to update before the node, or -1 if none
+    int collect(DDGNode* node);
+
+    std::map<DDGNode*, int> m_visited;
+    std::vector< std::vector<core::DataEngine*> > m_levels;
+    std::size_t m_nbEngines;
+    bool m_valid;
+};
+
+} // namespace simulation
+
+} // namespace sofa
+
+#endif
@@ -192,6 +192,11 @@ namespace sofa
             return thread->getType();
         }
         
+        bool DefaultTaskScheduler::isSchedulerThread()
+        {
+            return WorkerThread::getCurrent() != nullptr;
+        }
+        
         bool DefaultTaskScheduler::addTask(Task* task)
         {
             WorkerThread* thread = WorkerThread::getCurrent();
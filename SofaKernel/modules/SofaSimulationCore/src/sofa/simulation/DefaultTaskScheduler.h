@@ -176,6 +176,7 @@ namespace sofa  {
             virtual unsigned int getThreadCount(void)  const final { return m_threadCount; }
             virtual const char* getCurrentThreadName() override final;
             virtual int getCurrentThreadType() override final;
+            bool isSchedulerThread() override final;
             
             // queue task if there is space, and run it otherwise
             bool addTask(Task* task) override final;
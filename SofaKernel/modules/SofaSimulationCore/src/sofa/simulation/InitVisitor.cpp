@@ -22,9 +22,16 @@
 #include <sofa/simulation/InitVisitor.h>
 #include <sofa/simulation/MechanicalVisitor.h>
 #include <sofa/simulation/Simulation.h>
+#include <sofa/simulation/SimulationContext.h>
+#include <sofa/simulation/TaskScheduler.h>
 #include <sofa/core/BaseMapping.h>
 #include <sofa/core/visual/VisualModel.h>
 #include <sofa/defaulttype/BoundingBox.h>
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/helper/system/thread/CTime.h>
+#include <sofa/helper/AdvancedTimer.h>
+
+#include <atomic>
 
 //#include "MechanicalIntegration.h"
 
@@ -34,10 +41,139 @@ namespace sofa
 namespace simulation
 {
 
+namespace
+{
+
+/// Seconds elapsed since the given reference time
+double elapsed(sofa::helper::system::thread::ctime_t start)
+{
+    using sofa::helper::system::thread::CTime;
+    return double(CTime::getRefTime() - start) / double(CTime::getRefTicksPerSec());
+}
+
+std::atomic<bool> s_parallelInit(false);
+
+class InitObjectTask : public CpuTask
+{
+public:
+    InitObjectTask(core::objectmodel::BaseObject* obj, void (*init)(core::objectmodel::BaseObject*), CpuTask::Status* status)
+        : CpuTask(status), m_object(obj), m_init(init), m_context(SimulationContext::getCurrent())
+    {
+    }
+
+    MemoryAlloc run() override
+    {
+        // the object is initialized in the context of the scene being loaded
+        SimulationContext::Scope scope(m_context);
+        m_init(m_object);
+        return MemoryAlloc::Stack;
+    }
+
+protected:
+    core::objectmodel::BaseObject* m_object;
+    void (*m_init)(core::objectmodel::BaseObject*);
+    SimulationContext* m_context;
+};
+
+/// Collect the components of the subgraph, each one once even if the graph is a DAG
+void collectObjects(simulation::Node* node, std::set<core::objectmodel::BaseObject*>& visited, std::vector<core::objectmodel::BaseObject*>& objects)
+{
+    for (unsigned int i=0; i<node->object.size(); ++i)
+    {
+        if (visited.insert(node->object[i].get()).second)
+            objects.push_back(node->object[i].get());
+    }
+    for (unsigned int i=0; i<node->child.size(); ++i)
+        collectObjects(node->child[i].get(), visited, objects);
+}
+
+} // anonymous namespace
+
+void InitVisitor::setParallelInit(bool parallel)
+{
+    s_parallelInit = parallel;
+}
+
+bool InitVisitor::isParallelInit()
+{
+    return s_parallelInit;
+}
+
+bool InitVisitor::isIndependent(core::objectmodel::BaseObject* obj)
+{
+    if (!obj->hasSelfContainedInit())
+        return false;
+    for (core::objectmodel::BaseData* data : obj->getDataFields())
+    {
+        if (data->getParent() != nullptr || !data->getLinkPath().empty())
+            return false;
+    }
+    for (core::objectmodel::BaseLink* link : obj->getLinks())
+    {
+        if (link->getName() != "context" && link->getSize() != 0)
+            return false;
+    }
+    return true;
+}
+
+void InitVisitor::initObject(core::objectmodel::BaseObject* obj)
+{
+    core::ObjectFactory* factory = core::ObjectFactory::getInstance();
+    if (!factory->isProfiling())
+    {
+        obj->init();
+        return;
+    }
+    const sofa::helper::system::thread::ctime_t start = sofa::helper::system::thread::CTime::getRefTime();
+    obj->init();
+    const double t = elapsed(start);
+    factory->addInitTime(obj->getClassName(), t);
+    msg_info(obj) << "init: " << 1000.0*t << " ms";
+}
+
+void InitVisitor::initIndependentObjects(simulation::Node* node)
+{
+    std::set<core::objectmodel::BaseObject*> visited;
+    std::vector<core::objectmodel::BaseObject*> objects;
+    collectObjects(node, visited, objects);
+
+    std::vector<core::objectmodel::BaseObject*> independent;
+    for (core::objectmodel::BaseObject* obj : objects)
+    {
+        if (isIndependent(obj))
+            independent.push_back(obj);
+    }
+    if (independent.size() < 2)
+        return;
+
+    // the threads running a SimulationContext other than the main one cannot add tasks
+    TaskScheduler* scheduler = TaskScheduler::getInstance();
+    if (scheduler->getThreadCount() < 2 || !scheduler->isSchedulerThread())
+        return;
+
+    helper::ScopedAdvancedTimer timer("ParallelInit");
+    CpuTask::Status status;
+    std::vector<InitObjectTask> tasks;
+    tasks.reserve(independent.size());
+    for (core::objectmodel::BaseObject* obj : independent)
+    {
+        tasks.emplace_back(obj, &InitVisitor::initObject, &status);
+        scheduler->addTask(&tasks.back());
+    }
+    scheduler->workUntilDone(&status);
+
+    m_initialized.insert(independent.begin(), independent.end());
+}
+
 
 Visitor::Result InitVisitor::processNodeTopDown(simulation::Node* node)
 {
-    if (!rootNode) rootNode=node;
+    if (!rootNode)
+    {
+        rootNode=node;
+        if (isParallelInit())
+            initIndependentObjects(node);
+    }
 
     node->initialize();
 
@@ -47,7 +183,8 @@ Visitor::Result InitVisitor::processNodeTopDown(simulation::Node* node)
 
     for(unsigned int i=0; i<node->object.size(); ++i)
     {
-        node->object[i]->init();
+        if (m_initialized.find(node->object[i].get()) == m_initialized.end())
+            initObject(node->object[i].get());
         node->object[i]->computeBBox(params, true);
         nodeBBox->include(node->object[i]->f_bbox.getValue());
     }
@@ -62,9 +199,18 @@ void InitVisitor::processNodeBottomUp(simulation::Node* node)
     node->setDefaultVisualContextValue();
     sofa::defaulttype::BoundingBox* nodeBBox = node->f_bbox.beginEdit();
 
+    core::ObjectFactory* factory = core::ObjectFactory::getInstance();
+    const bool profiling = factory->isProfiling();
     for(unsigned int i=node->object.size(); i>0; --i)
     {
-        node->object[i-1]->bwdInit();
+        if (profiling)
+        {
+            const sofa::helper::system::thread::ctime_t start = sofa::helper::system::thread::CTime::getRefTime();
+            node->object[i-1]->bwdInit();
+            factory->addInitTime(node->object[i-1]->getClassName(), elapsed(start));
+        }
+        else
+            node->object[i-1]->bwdInit();
         nodeBBox->include(node->object[i-1]->f_bbox.getValue());
     }
 
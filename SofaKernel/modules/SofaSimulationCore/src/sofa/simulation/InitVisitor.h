@@ -26,6 +26,8 @@
 
 #include <sofa/simulation/Visitor.h>
 
+#include <set>
+
 namespace sofa
 {
 
@@ -38,6 +40,11 @@ namespace simulation
 
     Backward: OdeSolver::bwdInit()
 
+    When parallel init is enabled (see setParallelInit()), the components whose init() is
+    self-contained (BaseObject::hasSelfContainedInit()) and whose Data and links do not point
+    to other components, such as file loaders and grid topologies, are first initialized
+    concurrently by the TaskScheduler, before the usual traversal which skips them.
+
     */
 class SOFA_SIMULATION_CORE_API InitVisitor : public Visitor
 {
@@ -57,8 +64,22 @@ public:
     const char* getCategoryName() const override { return "init"; }
     const char* getClassName() const override { return "InitVisitor"; }
 
+    /// Initialize concurrently the components without dependencies, before the traversal
+    static void setParallelInit(bool parallel);
+    static bool isParallelInit();
+
+    /// Returns true if the init() of the given component depends only on its own Data
+    static bool isIndependent(core::objectmodel::BaseObject* obj);
+
 protected:
+    /// Initialize concurrently the independent components found below the given node
+    void initIndependentObjects(simulation::Node* node);
+
+    /// Call init() on the given component, recording the time it took when profiling
+    static void initObject(core::objectmodel::BaseObject* obj);
+
     Node *rootNode;
+    std::set<core::objectmodel::BaseObject*> m_initialized; ///< components initialized by initIndependentObjects()
 };
 
 } // namespace simulation
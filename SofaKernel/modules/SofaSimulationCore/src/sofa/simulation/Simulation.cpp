@@ -23,6 +23,7 @@
 #include <sofa/simulation/PrintVisitor.h>
 #include <sofa/simulation/ExportGnuplotVisitor.h>
 #include <sofa/simulation/InitVisitor.h>
+#include <sofa/simulation/SimulationContext.h>
 #include <sofa/simulation/AnimateVisitor.h>
 #include <sofa/simulation/MechanicalVisitor.h>
 #include <sofa/simulation/CollisionVisitor.h>
@@ -94,12 +95,19 @@ Simulation::SPtr Simulation::theSimulation;
 
 void setSimulation ( Simulation* s )
 {
+    if (SimulationContext* context = SimulationContext::getCurrent())
+    {
+        context->setSimulation(s);
+        return;
+    }
     Simulation::theSimulation.reset(s);
 
 }
 
 Simulation* getSimulation()
 {
+    if (SimulationContext* context = SimulationContext::getCurrent())
+        return context->getSimulation();
     return Simulation::theSimulation.get();
 }
 
@@ -224,6 +232,8 @@ void Simulation::initNode( Node* node)
 void Simulation::animate ( Node* root, SReal dt )
 {
     sofa::helper::AdvancedTimer::stepBegin("Simulation::animate");
+    // the counters of this thread only: the contexts stepped concurrently by other threads don't interfere
+    const sofa::core::objectmodel::DDGNode::PropagationCounters countersBefore = sofa::core::objectmodel::DDGNode::getThreadPropagationCounters();
 
     if ( !root ) {
         msg_error() << "Simulation::animate, no root found";
@@ -242,6 +252,16 @@ void Simulation::animate ( Node* root, SReal dt )
         return;
     }
 
+    if (sofa::helper::AdvancedTimer::isActive())
+    {
+        // dirty flags propagated by this thread during this step
+        const sofa::core::objectmodel::DDGNode::PropagationCounters counters = sofa::core::objectmodel::DDGNode::getThreadPropagationCounters();
+        sofa::helper::AdvancedTimer::valSet("DDGPropagations", (double)(counters.nbPropagations - countersBefore.nbPropagations));
+        sofa::helper::AdvancedTimer::valSet("DDGDirtyValues", (double)(counters.nbDirtyValues - countersBefore.nbDirtyValues));
+        sofa::helper::AdvancedTimer::valSet("DDGShortCircuits", (double)(counters.nbShortCircuits - countersBefore.nbShortCircuits));
+        sofa::helper::AdvancedTimer::valSet("DDGDeferred", (double)(counters.nbDeferred - countersBefore.nbDeferred));
+    }
+
     sofa::helper::AdvancedTimer::stepEnd("Simulation::animate");
 }
 
@@ -456,6 +476,8 @@ void Simulation::unload(Node::SPtr root)
     root->detachFromGraph();
     root->execute<CleanupVisitor>(params);
     root->execute<DeleteVisitor>(params);
+    // the messages of the unloaded scene are output before the next one is loaded
+    sofa::helper::logging::MessageDispatcher::flush();
 }
 
 } // namespace simulation
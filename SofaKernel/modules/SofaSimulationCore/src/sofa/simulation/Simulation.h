@@ -131,10 +131,12 @@ public:
 };
 
 /// Set the (unique) simulation which controls the scene
+/// (the one of the SimulationContext current in the calling thread, if any)
 SOFA_SIMULATION_CORE_API void setSimulation(Simulation* s);
 
 /** Get the (unique) simulation which controls the scene.
     Automatically creates one if no Simulation has been set.
+    Returns the one of the SimulationContext current in the calling thread, if any.
  */
 SOFA_SIMULATION_CORE_API Simulation* getSimulation();
 
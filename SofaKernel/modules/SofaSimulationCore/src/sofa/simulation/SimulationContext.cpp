@@ -0,0 +1,123 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/SimulationContext.h>
+#include <sofa/helper/logging/MessageDispatcher.h>
+#include <sofa/helper/system/thread/thread_specific_ptr.h>
+
+namespace sofa
+{
+
+namespace simulation
+{
+
+using helper::AdvancedTimer;
+using helper::logging::MessageDispatcher;
+
+namespace
+{
+
+SOFA_THREAD_SPECIFIC_PTR(SimulationContext, s_currentContext);
+
+} // anonymous namespace
+
+SimulationContext::SimulationContext(Simulation::SPtr simulation)
+    : m_simulation(simulation)
+    , m_messageHandlers(MessageDispatcher::getHandlers())
+    , m_timers(AdvancedTimer::createTimerSet())
+{
+}
+
+SimulationContext::~SimulationContext()
+{
+    if (m_root)
+        unload();
+    AdvancedTimer::deleteTimerSet(m_timers);
+}
+
+Simulation* SimulationContext::getSimulation() const
+{
+    if (m_simulation)
+        return m_simulation.get();
+    return Simulation::theSimulation.get();
+}
+
+Node::SPtr SimulationContext::load(const std::string& filename, const std::vector<std::string>& sceneArgs)
+{
+    Scope scope(this);
+    m_root = getSimulation()->load(filename, false, sceneArgs);
+    return m_root;
+}
+
+void SimulationContext::init()
+{
+    if (!m_root) return;
+    Scope scope(this);
+    getSimulation()->init(m_root.get());
+}
+
+void SimulationContext::animate(SReal dt)
+{
+    if (!m_root) return;
+    Scope scope(this);
+    getSimulation()->animate(m_root.get(), dt);
+}
+
+void SimulationContext::reset()
+{
+    if (!m_root) return;
+    Scope scope(this);
+    getSimulation()->reset(m_root.get());
+}
+
+void SimulationContext::unload()
+{
+    if (!m_root) return;
+    Scope scope(this);
+    getSimulation()->unload(m_root);
+    m_root.reset();
+}
+
+SimulationContext* SimulationContext::getCurrent()
+{
+    return s_currentContext;
+}
+
+SimulationContext::Scope::Scope(SimulationContext* context)
+    : m_previous(s_currentContext)
+    , m_previousHandlers(MessageDispatcher::getThreadHandlers())
+    , m_previousTimers(AdvancedTimer::getThreadTimers())
+{
+    s_currentContext = context;
+    MessageDispatcher::setThreadHandlers(context ? &context->m_messageHandlers : nullptr);
+    AdvancedTimer::setThreadTimers(context ? context->m_timers : nullptr);
+}
+
+SimulationContext::Scope::~Scope()
+{
+    AdvancedTimer::setThreadTimers(m_previousTimers);
+    MessageDispatcher::setThreadHandlers(m_previousHandlers);
+    s_currentContext = m_previous;
+}
+
+} // namespace simulation
+
+} // namespace sofa
@@ -0,0 +1,118 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_SIMULATION_CORE_SIMULATIONCONTEXT_H
+#define SOFA_SIMULATION_CORE_SIMULATIONCONTEXT_H
+
+#include <sofa/simulation/simulationcore.h>
+#include <sofa/simulation/Simulation.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <vector>
+
+namespace sofa
+{
+
+namespace helper { namespace logging { class MessageHandler; } }
+
+namespace simulation
+{
+
+/**
+ *  \brief State of one simulation instance, to run several scenes concurrently in one process.
+ *
+ *  A context owns what is otherwise process-wide: the Simulation returned by getSimulation(),
+ *  the MessageHandlers receiving the messages and the AdvancedTimer records and statistics.
+ *  While a Scope is alive, they replace the shared ones in the calling thread, so that each
+ *  thread can load and step its own scene. A context must be driven by one thread at a time.
+ *
+ *  The ObjectFactory, the loaded plugins and the TaskScheduler remain shared: they are
+ *  initialized once for all the contexts, which is the point of running them in one process.
+ *  The components created in a context use the context of the thread creating them. The tasks
+ *  of the parallel init and of the engine updates make the context of the thread which
+ *  scheduled them current while they run on the worker threads. Only the thread which
+ *  initialized the TaskScheduler can schedule them, the contexts driven by other threads
+ *  are initialized and updated sequentially.
+ */
+class SOFA_SIMULATION_CORE_API SimulationContext
+{
+public:
+    typedef std::vector<helper::logging::MessageHandler*> MessageHandlers;
+
+    /// The context uses the given simulation, or the shared one if it is null.
+    /// It starts with the message handlers currently installed in the MessageDispatcher.
+    explicit SimulationContext(Simulation::SPtr simulation = nullptr);
+    ~SimulationContext();
+
+    Simulation* getSimulation() const;
+    void setSimulation(Simulation::SPtr simulation) { m_simulation = simulation; }
+
+    MessageHandlers& getMessageHandlers() { return m_messageHandlers; }
+    helper::AdvancedTimer::TimerSet* getTimers() const { return m_timers; }
+
+    /// The root of the scene loaded or set in this context
+    Node::SPtr getRoot() const { return m_root; }
+    void setRoot(Node::SPtr root) { m_root = root; }
+
+    /// @name Shortcuts calling the simulation with this context made current
+    /// @{
+    Node::SPtr load(const std::string& filename, const std::vector<std::string>& sceneArgs = std::vector<std::string>(0));
+    void init();
+    void animate(SReal dt = 0.0);
+    void reset();
+    void unload();
+    /// @}
+
+    /// Make a context current for the calling thread, until the scope is destroyed
+    class SOFA_SIMULATION_CORE_API Scope
+    {
+    public:
+        explicit Scope(SimulationContext* context);
+        ~Scope();
+
+    protected:
+        SimulationContext* m_previous;
+        MessageHandlers* m_previousHandlers;
+        helper::AdvancedTimer::TimerSet* m_previousTimers;
+
+    private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+    };
+
+    /// The context made current in the calling thread, nullptr if none
+    static SimulationContext* getCurrent();
+
+protected:
+    Simulation::SPtr m_simulation;
+    MessageHandlers m_messageHandlers;
+    helper::AdvancedTimer::TimerSet* m_timers;
+    Node::SPtr m_root;
+
+private:
+    SimulationContext(const SimulationContext&);
+    SimulationContext& operator=(const SimulationContext&);
+};
+
+} // namespace simulation
+
+} // namespace sofa
+
+#endif // SOFA_SIMULATION_CORE_SIMULATIONCONTEXT_H
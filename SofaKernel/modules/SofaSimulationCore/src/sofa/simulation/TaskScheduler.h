@@ -72,6 +72,10 @@ namespace sofa
             
             virtual int getCurrentThreadType() = 0;
             
+            // false if the calling thread cannot add tasks: it is neither the thread which
+            // initialized the scheduler nor one of its workers
+            virtual bool isSchedulerThread() { return true; }
+            
             // queue task if there is space, and run it otherwise
             virtual bool addTask(Task* task) = 0;
             
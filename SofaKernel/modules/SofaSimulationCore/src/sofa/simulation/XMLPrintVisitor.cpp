@@ -34,6 +34,8 @@ namespace simulation
 {
 
 
+std::size_t XMLPrintVisitor::s_defaultBinaryThreshold = 0;
+
 static std::string xmlencode(const std::string& str)
 {
     std::string res;
@@ -65,7 +67,7 @@ void XMLPrintVisitor::processObject(T obj)
     if (!templatename.empty())
         m_out << " template=\"" << xmlencode(templatename) << "\"";
 
-    obj->writeDatas( m_out, " " );
+    obj->writeDatas( m_out, " ", m_binaryThreshold );
 
     m_out << "/>" << std::endl;
 }
@@ -95,7 +97,7 @@ Visitor::Result XMLPrintVisitor::processNodeTopDown(simulation::Node* node)
     m_out << "<Node \t";
 
     ++level;
-    node->writeDatas(m_out," ");
+    node->writeDatas(m_out, " ", m_binaryThreshold);
 
     m_out << " >\n";
 
@@ -40,8 +40,9 @@ class SOFA_SIMULATION_CORE_API XMLPrintVisitor : public Visitor
 protected:
     std::ostream& m_out;
     int level;
+    std::size_t m_binaryThreshold;
 public:
-    XMLPrintVisitor(const sofa::core::ExecParams* params, std::ostream& out) : Visitor(params), m_out(out),level(0) {}
+    XMLPrintVisitor(const sofa::core::ExecParams* params, std::ostream& out) : Visitor(params), m_out(out),level(0), m_binaryThreshold(s_defaultBinaryThreshold) {}
 
     template<class T>
     void processObject(T obj);
@@ -56,7 +57,19 @@ public:
     const char* getClassName() const override { return "XMLPrintVisitor"; }
     int getLevel() const {return level;}
     void setLevel(int l) {level=l;}
+
+    /// Data holding at least this number of integers or scalars are written in base64 (0 to disable)
+    std::size_t getBinaryThreshold() const { return m_binaryThreshold; }
+    void setBinaryThreshold(std::size_t n) { m_binaryThreshold = n; }
+
+    /// Binary threshold of the visitors created afterwards, such as the one of Simulation::exportXML()
+    static void setDefaultBinaryThreshold(std::size_t n) { s_defaultBinaryThreshold = n; }
+    static std::size_t getDefaultBinaryThreshold() { return s_defaultBinaryThreshold; }
+
 	bool treeTraversal(TreeTraversalRepetition& repeat) override;
+
+protected:
+    static std::size_t s_defaultBinaryThreshold;
 };
 
 } // namespace simulation
@@ -0,0 +1,243 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaSimulationGraph/testing/BaseSimulationTest.h>
+using sofa::helper::testing::BaseSimulationTest ;
+
+#include <SofaSimulationGraph/SimpleApi.h>
+using namespace sofa::simpleapi ;
+
+#include <sofa/simulation/Checkpoint.h>
+using sofa::simulation::Checkpoint ;
+
+#include <sofa/core/behavior/BaseMechanicalState.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace sofa {
+
+namespace
+{
+
+/// Component with a binary Data, a text Data and a state which is not held by Data
+class StatefulObject : public core::objectmodel::BaseObject
+{
+public:
+    SOFA_CLASS(StatefulObject, core::objectmodel::BaseObject);
+
+    Data<helper::vector<double> > d_values;
+    Data<std::string> d_label;
+    int steps;
+    int nbRestore;
+
+    StatefulObject()
+        : d_values(initData(&d_values, "values", "values"))
+        , d_label(initData(&d_label, std::string("initial"), "label", "label"))
+        , steps(0)
+        , nbRestore(0)
+    {
+    }
+
+    void writeInternalState(std::vector<char>& buffer) const override
+    {
+        Checkpoint::writeValue(buffer, steps);
+    }
+
+    bool readInternalState(const char* buffer, std::size_t size) override
+    {
+        ++nbRestore;
+        Checkpoint::StateReader reader(buffer, size);
+        return reader.readValue(steps) && reader.atEnd();
+    }
+};
+
+} // anonymous namespace
+
+struct Checkpoint_test : public BaseSimulationTest
+{
+};
+
+TEST_F(Checkpoint_test, captureAndRestore)
+{
+    EXPECT_MSG_NOEMIT(Error, Warning);
+
+    SceneInstance si("root") ;
+    Node::SPtr child = createChild(si.root, "child");
+    StatefulObject::SPtr obj = core::objectmodel::New<StatefulObject>();
+    StatefulObject::SPtr untouched = core::objectmodel::New<StatefulObject>();
+    obj->setName("obj");
+    untouched->setName("untouched");
+    child->addObject(obj);
+    child->addObject(untouched);
+    si.initScene();
+
+    obj->d_values.setValue(helper::vector<double>{ 1.0, 2.0, 3.0 });
+    obj->steps = 3;
+    si.root->setTime(1.5);
+
+    Checkpoint checkpoint;
+    checkpoint.capture(si.root.get());
+    EXPECT_FALSE(checkpoint.empty());
+    EXPECT_GT(checkpoint.getByteSize(), 3*sizeof(double));
+
+    obj->d_values.setValue(helper::vector<double>{ 4.0 });
+    obj->d_label.setValue("modified");
+    obj->steps = 10;
+    si.root->setTime(2.5);
+
+    EXPECT_TRUE(checkpoint.restore());
+    EXPECT_EQ(obj->d_values.getValue(), helper::vector<double>({ 1.0, 2.0, 3.0 }));
+    EXPECT_EQ(obj->d_label.getValue(), "initial");
+    EXPECT_EQ(obj->steps, 3);
+    EXPECT_DOUBLE_EQ(si.root->getTime(), 1.5);
+
+    // the state of the components with unchanged Data is restored only if they stored one
+    EXPECT_EQ(obj->nbRestore, 1);
+    EXPECT_EQ(untouched->nbRestore, 1);
+
+    // nothing changed since the last restore
+    const int counter = obj->d_values.getCounter();
+    EXPECT_TRUE(checkpoint.restore());
+    EXPECT_EQ(obj->d_values.getCounter(), counter);
+}
+
+TEST_F(Checkpoint_test, writeAndRead)
+{
+    EXPECT_MSG_NOEMIT(Error, Warning);
+
+    SceneInstance si("root") ;
+    StatefulObject::SPtr obj = core::objectmodel::New<StatefulObject>();
+    obj->setName("obj");
+    si.root->addObject(obj);
+    si.initScene();
+
+    obj->d_values.setValue(helper::vector<double>{ 0.5, -0.5 });
+    obj->d_label.setValue("saved");
+    obj->steps = 7;
+
+    std::stringstream stream;
+    {
+        Checkpoint checkpoint;
+        checkpoint.capture(si.root.get());
+        checkpoint.write(stream);
+    }
+
+    obj->d_values.setValue(helper::vector<double>());
+    obj->d_label.setValue("other");
+    obj->steps = 0;
+
+    Checkpoint checkpoint;
+    ASSERT_TRUE(checkpoint.read(stream, si.root.get()));
+    EXPECT_TRUE(checkpoint.restore(true));
+    EXPECT_EQ(obj->d_values.getValue(), helper::vector<double>({ 0.5, -0.5 }));
+    EXPECT_EQ(obj->d_label.getValue(), "saved");
+    EXPECT_EQ(obj->steps, 7);
+}
+
+TEST_F(Checkpoint_test, readInvalidStream)
+{
+    EXPECT_MSG_EMIT(Error);
+
+    SceneInstance si("root") ;
+    si.initScene();
+
+    std::stringstream invalid("not a checkpoint");
+    Checkpoint checkpoint;
+    EXPECT_FALSE(checkpoint.read(invalid, si.root.get()));
+    EXPECT_TRUE(checkpoint.empty());
+}
+
+TEST_F(Checkpoint_test, readOtherByteOrder)
+{
+    EXPECT_MSG_EMIT(Error);
+
+    SceneInstance si("root") ;
+    si.initScene();
+
+    std::stringstream stream;
+    {
+        Checkpoint checkpoint;
+        checkpoint.capture(si.root.get());
+        checkpoint.write(stream);
+    }
+    // swap the bytes of the byte order marker, following the magic
+    std::string bytes = stream.str();
+    std::reverse(bytes.begin() + 8, bytes.begin() + 12);
+
+    std::stringstream swapped(bytes);
+    Checkpoint checkpoint;
+    EXPECT_FALSE(checkpoint.read(swapped, si.root.get()));
+    EXPECT_TRUE(checkpoint.empty());
+}
+
+TEST_F(Checkpoint_test, restoreIntoLoadedScene)
+{
+    importPlugin("SofaComponentAll");
+    const std::string filename = std::string(FRAMEWORK_TEST_RESOURCES_DIR) + "/scenes/fallingGrids.scn";
+    simulation::Simulation* simulation = simulation::getSimulation();
+
+    auto firstY = [](Node* root)
+    {
+        core::behavior::BaseMechanicalState* dofs = dynamic_cast<core::behavior::BaseMechanicalState*>(root->getChild("A")->getObject("dofs"));
+        return dofs ? dofs->getPY(0) : SReal(0);
+    };
+    auto positions = [](Node* root)
+    {
+        return root->getChild("A")->getObject("dofs")->findData("position")->getValueString();
+    };
+
+    Node::SPtr root = simulation->load(filename);
+    ASSERT_NE(root, nullptr);
+    simulation->init(root.get());
+    for (int i = 0; i < 5; ++i)
+        simulation->animate(root.get());
+
+    std::stringstream stream;
+    {
+        Checkpoint checkpoint;
+        checkpoint.capture(root.get());
+        checkpoint.write(stream);
+    }
+    const std::string captured = positions(root.get());
+    for (int i = 0; i < 5; ++i)
+        simulation->animate(root.get());
+    const SReal expectedY = firstY(root.get());
+
+    // a new instance of the scene continues from the checkpoint
+    Node::SPtr loaded = simulation->load(filename);
+    ASSERT_NE(loaded, nullptr);
+    simulation->init(loaded.get());
+    Checkpoint checkpoint;
+    ASSERT_TRUE(checkpoint.read(stream, loaded.get()));
+    EXPECT_TRUE(checkpoint.restore(true));
+    EXPECT_NEAR(loaded->getTime(), 0.05, 1e-9);
+    EXPECT_EQ(positions(loaded.get()), captured);
+
+    for (int i = 0; i < 5; ++i)
+        simulation->animate(loaded.get());
+    EXPECT_NEAR(firstY(loaded.get()), expectedY, 1e-9);
+
+    simulation->unload(loaded);
+    simulation->unload(root);
+}
+
+}// namespace sofa
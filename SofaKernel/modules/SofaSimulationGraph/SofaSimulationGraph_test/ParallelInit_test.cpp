@@ -0,0 +1,116 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaSimulationGraph/testing/BaseSimulationTest.h>
+using sofa::helper::testing::BaseSimulationTest ;
+
+#include <SofaSimulationGraph/SimpleApi.h>
+using namespace sofa::simpleapi ;
+
+#include <sofa/simulation/InitVisitor.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/DefaultTaskScheduler.h>
+
+#include <atomic>
+
+namespace sofa {
+
+namespace
+{
+
+std::atomic<int> s_initOrder(0);
+
+/// Component whose init() only reads its own Data, recording when it was initialized
+class SelfContainedObject : public core::objectmodel::BaseObject
+{
+public:
+    SOFA_CLASS(SelfContainedObject, core::objectmodel::BaseObject);
+
+    Data<int> d_value;
+    int nbInit;
+    int initOrder;
+
+    SelfContainedObject()
+        : d_value(initData(&d_value, 0, "value", "value"))
+        , nbInit(0)
+        , initOrder(-1)
+    {
+    }
+
+    bool hasSelfContainedInit() const override { return true; }
+
+    void init() override
+    {
+        ++nbInit;
+        initOrder = s_initOrder++;
+    }
+};
+
+} // anonymous namespace
+
+struct ParallelInit_test : public BaseSimulationTest
+{
+    void SetUp() override
+    {
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(simulation::DefaultTaskScheduler::name());
+        scheduler->init(4);
+        simulation::InitVisitor::setParallelInit(true);
+    }
+
+    void TearDown() override
+    {
+        simulation::InitVisitor::setParallelInit(false);
+    }
+};
+
+TEST_F(ParallelInit_test, independentObjectsAreInitializedFirst)
+{
+    EXPECT_MSG_NOEMIT(Error, Warning);
+
+    SceneInstance si("root") ;
+    Node::SPtr A = createChild(si.root, "A");
+    Node::SPtr B = createChild(si.root, "B");
+
+    // 'linked' depends on 'a' through its Data, it is initialized by the traversal
+    SelfContainedObject::SPtr linked = core::objectmodel::New<SelfContainedObject>();
+    SelfContainedObject::SPtr a = core::objectmodel::New<SelfContainedObject>();
+    SelfContainedObject::SPtr b = core::objectmodel::New<SelfContainedObject>();
+    linked->d_value.setParent(&a->d_value);
+    A->addObject(linked);
+    A->addObject(a);
+    B->addObject(b);
+
+    EXPECT_TRUE(simulation::InitVisitor::isIndependent(a.get()));
+    EXPECT_TRUE(simulation::InitVisitor::isIndependent(b.get()));
+    EXPECT_FALSE(simulation::InitVisitor::isIndependent(linked.get()));
+
+    s_initOrder = 0;
+    si.initScene();
+
+    EXPECT_EQ(a->nbInit, 1);
+    EXPECT_EQ(b->nbInit, 1);
+    EXPECT_EQ(linked->nbInit, 1);
+    EXPECT_LT(a->initOrder, 2);
+    EXPECT_LT(b->initOrder, 2);
+    EXPECT_EQ(linked->initOrder, 2);
+}
+
+}// namespace sofa
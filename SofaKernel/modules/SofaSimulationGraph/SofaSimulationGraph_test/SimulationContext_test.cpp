@@ -0,0 +1,165 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest ;
+
+#include <sofa/simulation/SimulationContext.h>
+using sofa::simulation::SimulationContext ;
+
+#include <SofaSimulationGraph/DAGSimulation.h>
+using sofa::simulation::graph::DAGSimulation ;
+
+#include <sofa/helper/logging/MessageHandler.h>
+using sofa::helper::logging::MessageHandler ;
+using sofa::helper::logging::Message ;
+
+#include <sofa/simulation/DataEngineTaskGraph.h>
+#include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/InitVisitor.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+
+#include <thread>
+#include <memory>
+
+namespace sofa {
+
+namespace
+{
+
+/// Count the messages sent by this test
+class CountingHandler : public MessageHandler
+{
+public:
+    int count {0};
+
+    void process(Message& m) override
+    {
+        if (m.sender() == "SimulationContext_test")
+            ++count;
+    }
+};
+
+} // anonymous namespace
+
+/// State of a scene after it was stepped in its context
+struct SceneResult
+{
+    simulation::Simulation* simulation {nullptr};
+    SReal time {0};
+    std::size_t nbPoints {0};
+    SReal firstY {0};
+    std::string positions;
+    std::string indices;
+};
+
+struct SimulationContext_test : public BaseTest
+{
+    void SetUp() override
+    {
+        sofa::simpleapi::importPlugin("SofaComponentAll");
+        // this thread initializes the scheduler, the parallel init and engines update run
+        // on its workers for the context it drives
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(simulation::DefaultTaskScheduler::name());
+        scheduler->init(4);
+        simulation::InitVisitor::setParallelInit(true);
+        simulation::DataEngineTaskGraph::setParallelUpdate(true);
+    }
+
+    void TearDown() override
+    {
+        simulation::DataEngineTaskGraph::setParallelUpdate(false);
+        simulation::InitVisitor::setParallelInit(false);
+    }
+
+    /// Load the scene in the context, step it and record its state, from the calling thread
+    static void run(SimulationContext* context, int nbSteps, SceneResult& result)
+    {
+        context->load(std::string(FRAMEWORK_TEST_RESOURCES_DIR) + "/scenes/fallingGrids.scn");
+        ASSERT_NE(context->getRoot(), nullptr);
+        context->init();
+
+        SimulationContext::Scope scope(context);
+        result.simulation = simulation::getSimulation();
+        for (int step = 0; step < nbSteps; ++step)
+        {
+            msg_info("SimulationContext_test") << "step " << step;
+            context->animate();
+        }
+
+        simulation::Node* A = context->getRoot()->getChild("A");
+        ASSERT_NE(A, nullptr);
+        core::behavior::BaseMechanicalState* dofs = dynamic_cast<core::behavior::BaseMechanicalState*>(A->getObject("dofs"));
+        core::objectmodel::BaseObject* box = A->getObject("box");
+        ASSERT_NE(dofs, nullptr);
+        ASSERT_NE(box, nullptr);
+        result.time = context->getRoot()->getTime();
+        result.nbPoints = dofs->getSize();
+        result.firstY = dofs->getPY(0);
+        result.positions = dofs->findData("position")->getValueString();
+        result.indices = box->findData("indices")->getValueString();
+    }
+};
+
+TEST_F(SimulationContext_test, concurrentScenes)
+{
+    const int nbSteps = 10;
+    CountingHandler handlers[2];
+    std::vector< std::unique_ptr<SimulationContext> > contexts;
+    for (int i = 0; i < 2; ++i)
+    {
+        contexts.emplace_back(new SimulationContext(core::objectmodel::New<DAGSimulation>()));
+        contexts[i]->getMessageHandlers().assign(1, &handlers[i]);
+    }
+
+    simulation::Simulation* shared = simulation::getSimulation();
+    SceneResult results[2];
+
+    // one scene is driven by another thread while this one drives the other
+    std::thread other([&]() { run(contexts[1].get(), nbSteps + 1, results[1]); });
+    run(contexts[0].get(), nbSteps, results[0]);
+    other.join();
+
+    EXPECT_EQ(simulation::getSimulation(), shared);
+    EXPECT_EQ(SimulationContext::getCurrent(), nullptr);
+    for (int i = 0; i < 2; ++i)
+    {
+        EXPECT_EQ(results[i].simulation, contexts[i]->getSimulation());
+        EXPECT_NE(results[i].simulation, shared);
+        EXPECT_EQ(handlers[i].count, nbSteps + i);
+        EXPECT_NEAR(results[i].time, 0.01*(nbSteps + i), 1e-9);
+        EXPECT_EQ(results[i].nbPoints, 27u);
+        // the grid falls, and the box still contains it
+        EXPECT_LT(results[i].firstY, 0.0);
+        EXPECT_FALSE(results[i].indices.empty());
+    }
+    EXPECT_LT(results[1].firstY, results[0].firstY);
+
+    // stepping the first scene once more gives the same state as the other one
+    {
+        SimulationContext::Scope scope(contexts[0].get());
+        contexts[0]->animate();
+        EXPECT_EQ(contexts[0]->getRoot()->getChild("A")->getObject("dofs")->findData("position")->getValueString(), results[1].positions);
+    }
+}
+
+}// namespace sofa
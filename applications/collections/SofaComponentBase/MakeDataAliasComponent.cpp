@@ -87,11 +87,7 @@ void MakeDataAliasComponent::parse ( core::objectmodel::BaseObjectDescription* a
         return ;
     }
 
-    ObjectFactory::ClassEntry& creatorentry = ObjectFactory::getInstance()->getEntry(scomponent);
-    if(creatorentry.m_dataAlias.find(dataname) != creatorentry.m_dataAlias.end()){
-        creatorentry.m_dataAlias[dataname] = std::vector<std::string>();
-    }
-    creatorentry.m_dataAlias[dataname].push_back(salias) ;
+    ObjectFactory::getInstance()->addDataAlias(scomponent, sdataname, salias) ;
 
     m_componentstate = ComponentState::Valid ;
 }
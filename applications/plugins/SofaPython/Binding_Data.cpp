@@ -803,6 +803,46 @@ static PyObject * Data_getValueVoidPtr(PyObject * self, PyObject * /*args*/)
 }
 
 
+/// returns the value in binary form (see BaseData::writeBinary), or None if the type does not allow it
+static PyObject * Data_getValueBinary(PyObject * self, PyObject * args)
+{
+    const size_t argSize = PyTuple_Size(args);
+    if( argSize != 0 ) {
+        PyErr_SetString(PyExc_RuntimeError, "This function does not accept any argument.") ;
+        return nullptr;
+    }
+
+    BaseData* data = get_basedata( self );
+    std::vector<char> buffer;
+    if (!data->writeBinary(buffer))
+        Py_RETURN_NONE;
+
+    return PyString_FromStringAndSize(buffer.data(), buffer.size());
+}
+
+
+/// sets the value from its binary form, as returned by getValueBinary
+static PyObject * Data_setValueBinary(PyObject * self, PyObject * args)
+{
+    BaseData* data = get_basedata( self );
+
+    const char* buffer = nullptr;
+    int size = 0; // PY_SSIZE_T_CLEAN is not defined
+    if (!PyArg_ParseTuple(args, "s#", &buffer, &size))
+    {
+        return nullptr;
+    }
+
+    if (data->readBinary(buffer, (size_t)size) != (size_t)size)
+    {
+        PyErr_SetString(PyExc_ValueError, "The binary value does not match the type of the Data.") ;
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+
 /// returns the number of times the Data was modified
 static PyObject * Data_getCounter(PyObject * self, PyObject * args)
 {
@@ -917,6 +957,9 @@ SP_CLASS_METHOD_DOC(Data,getParentPath, "Returns the string containing the path
 SP_CLASS_METHOD_DOC(Data,hasParent, "Indicate if the string is linked to an other data field (its parent).")
 SP_CLASS_METHOD(Data,getLinkPath)
 SP_CLASS_METHOD(Data,getValueVoidPtr)
+SP_CLASS_METHOD_DOC(Data,getValueBinary, "Returns the value as raw memory (a header followed by the values), or None if the type is not made of contiguous integers or scalars.\n"
+                                         "Much faster than getValueString for large vectors.")
+SP_CLASS_METHOD_DOC(Data,setValueBinary, "Set the value from a string returned by getValueBinary.")
 SP_CLASS_METHOD(Data,getCounter)
 SP_CLASS_METHOD(Data,isDirty)
 SP_CLASS_METHOD(Data,getAsACreateObjectParameter)
@@ -44,6 +44,9 @@ using std::vector;
 #include <SofaSimulationTree/TreeSimulation.h>
 using sofa::simulation::Node;
 #include <sofa/simulation/SceneLoaderFactory.h>
+#include <sofa/simulation/XMLPrintVisitor.h>
+#include <sofa/simulation/InitVisitor.h>
+#include <sofa/core/ObjectFactory.h>
 #include <SofaGraphComponent/SceneCheckerListener.h>
 using sofa::simulation::scenechecking::SceneCheckerListener;
 
@@ -207,6 +210,11 @@ int main(int argc, char** argv)
     bool        testMode = false;
     bool        noAutoloadPlugins = false;
     bool        noSceneCheck = false;
+    bool        asyncLogging = false;
+    unsigned int logRateLimit = 0;
+    unsigned int binaryExportThreshold = 0;
+    bool        loadProfile = false;
+    bool        parallelInit = false;
     unsigned int nbMSSASamples = 1;
     bool computationTimeAtBegin = false;
     unsigned int computationTimeSampling=0; ///< Frequency of display of the computation time statistics, in number of animation steps. 0 means never.
@@ -266,7 +274,7 @@ int main(int argc, char** argv)
         boost::program_options::value<std::string>(&computationTimeOutputType)
         ->default_value("stdout"),
         "computationTimeOutputType,o",
-        "Output type for the computation time statistics: either stdout, json or ljson"
+        "Output type for the computation time statistics: either stdout, json, ljson or trace (Chrome trace timeline written to sofa_trace.json)"
     );
     argParser->addArgument(
         boost::program_options::value<std::string>(&gui)->default_value(""),
@@ -340,6 +348,39 @@ int main(int argc, char** argv)
         "formatting,f",
         "select the message formatting to use (auto, clang, sofa, rich, test)"
     );
+    argParser->addArgument(
+        boost::program_options::value<bool>(&asyncLogging)
+        ->default_value(false)
+        ->implicit_value(true),
+        "asyncLogging",
+        "process the messages in a background thread (errors are still processed immediately)"
+    );
+    argParser->addArgument(
+        boost::program_options::value<unsigned int>(&logRateLimit)
+        ->default_value(0),
+        "logRateLimit",
+        "maximum number of messages per second emitted from the same line of code (0 means no limit)"
+    );
+    argParser->addArgument(
+        boost::program_options::value<unsigned int>(&binaryExportThreshold)
+        ->default_value(0),
+        "binaryExportThreshold",
+        "when saving a scene, write the Data holding at least this number of values in base64 (0 means never)"
+    );
+    argParser->addArgument(
+        boost::program_options::value<bool>(&loadProfile)
+        ->default_value(false)
+        ->implicit_value(true),
+        "loadProfile",
+        "print the time spent creating and initializing the components of each type when loading the scene"
+    );
+    argParser->addArgument(
+        boost::program_options::value<bool>(&parallelInit)
+        ->default_value(false)
+        ->implicit_value(true),
+        "parallelInit",
+        "initialize in parallel the components which do not depend on other ones (loaders, grid topologies)"
+    );
     argParser->addArgument(
         boost::program_options::value<bool>(&enableInteraction)
         ->default_value(false)
@@ -446,6 +487,9 @@ int main(int argc, char** argv)
         msg_warning("") << "Invalid argument '" << messageHandler << "' for '--formatting'";
     }
     MessageDispatcher::addHandler(&MainPerComponentLoggingMessageHandler::getInstance()) ;
+    MessageDispatcher::setRateLimit(logRateLimit) ;
+    MessageDispatcher::setAsynchronous(asyncLogging) ;
+    sofa::simulation::XMLPrintVisitor::setDefaultBinaryThreshold(binaryExportThreshold) ;
 
     // Output FileRepositories
     msg_info("runSofa") << "PluginRepository paths = " << PluginRepository.getPathsJoined();
@@ -516,6 +560,9 @@ int main(int argc, char** argv)
         sofa::simulation::SceneLoader::addListener( SceneCheckerListener::getInstance() );
     }
 
+    sofa::core::ObjectFactory::getInstance()->setProfiling(loadProfile);
+    sofa::simulation::InitVisitor::setParallelInit(parallelInit);
+
     const std::vector<std::string> sceneArgs = sofa::helper::ArgumentParser::extra_args();
     Node::SPtr groot = sofa::simulation::getSimulation()->load(fileName, false, sceneArgs);
     if( !groot )
@@ -540,6 +587,14 @@ int main(int argc, char** argv)
         msg_info("") << sofa::helper::AdvancedTimer::end("Init", groot.get());
     }
 
+    if (loadProfile)
+    {
+        std::ostringstream report;
+        sofa::core::ObjectFactory::getInstance()->dumpProfilingReport(report);
+        msg_info("runSofa") << "Scene loading profile:" << msgendl << report.str();
+        sofa::core::ObjectFactory::getInstance()->setProfiling(false);
+    }
+
     //=======================================
     //Apply Options
 
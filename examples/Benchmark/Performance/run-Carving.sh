@@ -0,0 +1,11 @@
+#!/bin/bash
+# Carving benchmark: runs the SofaCarving example scenes in batch mode and prints the
+# AdvancedTimer statistics, including the "Update Tetra2TriangleTopologicalMapping" step.
+# Usage: run-Carving.sh [runSofa executable] [number of steps]
+runsofa=${1:-runSofa}
+n=${2:-500}
+for scene in SimpleCarving SimpleCarving_withPenetration CarvingTool;
+do
+echo $scene
+$runsofa -g batch -n $n --computationTimeSampling=$n applications/plugins/SofaCarving/examples/$scene.scn 2>&1 | tee examples/Benchmark/Performance/Carving-$scene-log.txt | grep -E "Animate|Tetra2TriangleTopologicalMapping|removeTetrahedra|iterations done"
+done
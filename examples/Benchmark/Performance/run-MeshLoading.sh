@@ -0,0 +1,52 @@
+#!/bin/bash
+# Mesh loading benchmark: generates triangulated grids in the OBJ, VTK and Gmsh formats
+# and measures the time needed by runSofa to load each of them in batch mode.
+# Usage: run-MeshLoading.sh [runSofa executable] [numbers of triangles...]
+runsofa=${1:-runSofa}
+shift
+sizes=${@:-100000 1000000 10000000}
+dir=${TMPDIR:-/tmp}/sofa-mesh-loading
+mkdir -p $dir
+
+for size in $sizes;
+do
+    # grid of m x m points, i.e. 2 (m-1)^2 triangles
+    m=$(awk -v s=$size 'BEGIN { print int(sqrt(s/2)) + 1 }')
+    awk -v m=$m -v f=$dir/grid-$size 'BEGIN {
+        np = m*m; nt = 2*(m-1)*(m-1);
+        obj = f ".obj"; vtk = f ".vtk"; msh = f ".msh";
+        print "# vtk DataFile Version 2.0\ngrid\nASCII\nDATASET UNSTRUCTURED_GRID\nPOINTS " np " double" > vtk;
+        print "$MeshFormat\n2 0 8\n$EndMeshFormat\n$Nodes\n" np > msh;
+        for (j = 0; j < m; ++j) for (i = 0; i < m; ++i) {
+            x = i/(m-1); y = j/(m-1); z = 0.1*sin(6*x)*cos(6*y);
+            printf "v %.9g %.9g %.9g\n", x, y, z > obj;
+            printf "%.9g %.9g %.9g\n", x, y, z > vtk;
+            printf "%d %.9g %.9g %.9g\n", j*m+i+1, x, y, z > msh;
+        }
+        print "CELLS " nt " " 4*nt > vtk;
+        print "$EndNodes\n$Elements\n" nt > msh;
+        e = 0;
+        for (j = 0; j < m-1; ++j) for (i = 0; i < m-1; ++i) {
+            a = j*m+i; b = a+1; c = a+m; d = c+1;
+            printf "f %d %d %d\nf %d %d %d\n", a+1, b+1, d+1, a+1, d+1, c+1 > obj;
+            printf "3 %d %d %d\n3 %d %d %d\n", a, b, d, a, d, c > vtk;
+            printf "%d 2 2 0 1 %d %d %d\n%d 2 2 0 1 %d %d %d\n", e+1, a+1, b+1, d+1, e+2, a+1, d+1, c+1 > msh;
+            e += 2;
+        }
+        print "CELL_TYPES " nt > vtk;
+        for (t = 0; t < nt; ++t) print "5" > vtk;
+        print "$EndElements" > msh;
+    }'
+
+    for format in Obj:obj VTK:vtk Gmsh:msh;
+    do
+        loader=Mesh${format%%:*}Loader
+        file=$dir/grid-$size.${format##*:}
+        scene=$dir/grid-$size-$loader.scn
+        echo "<Node name=\"root\"><$loader name=\"loader\" filename=\"$file\"/></Node>" > $scene
+        start=$(date +%s.%N)
+        $runsofa -g batch -n 1 $scene > $dir/grid-$size-$loader-log.txt 2>&1
+        end=$(date +%s.%N)
+        echo "$loader $(awk -v s=$start -v e=$end 'BEGIN { printf "%.3f", e-s }') s for $size triangles ($(du -h $file | cut -f1))"
+    done
+done
@@ -28,6 +28,7 @@
 #include <sofa/simulation/SolveVisitor.h>
 
 #include <sofa/simulation/Simulation.h>
+#include <sofa/simulation/Checkpoint.h>
 #include <sofa/helper/AdvancedTimer.h>
 #include <sofa/helper/system/thread/CTime.h>
 #include <cmath>
@@ -306,6 +307,64 @@ void LCPConstraintSolver::cleanup()
     core::behavior::ConstraintSolver::cleanup();
 }
 
+void LCPConstraintSolver::writeInternalState(std::vector<char>& buffer) const
+{
+    using simulation::Checkpoint;
+    Checkpoint::writeValue(buffer, (unsigned int)_previousForces.size());
+    for (double f : _previousForces)
+        Checkpoint::writeValue(buffer, f);
+    // the constraints are stored by path, to be found again in a graph read from a file
+    Checkpoint::writeValue(buffer, (unsigned int)_previousConstraints.size());
+    for (const auto& c : _previousConstraints)
+    {
+        Checkpoint::writeString(buffer, c.first->getPathName());
+        Checkpoint::writeValue(buffer, c.second.nbLines);
+        Checkpoint::writeValue(buffer, (unsigned int)c.second.persistentToConstraintIdMap.size());
+        for (const auto& id : c.second.persistentToConstraintIdMap)
+        {
+            Checkpoint::writeValue(buffer, id.first);
+            Checkpoint::writeValue(buffer, id.second);
+        }
+    }
+}
+
+bool LCPConstraintSolver::readInternalState(const char* buffer, std::size_t size)
+{
+    simulation::Checkpoint::StateReader reader(buffer, size);
+    _previousForces.clear();
+    _previousConstraints.clear();
+    if (!size) return true;
+
+    unsigned int nbForces = 0;
+    if (!reader.readValue(nbForces)) return false;
+    _previousForces.resize(nbForces);
+    for (double& f : _previousForces)
+        if (!reader.readValue(f)) return false;
+
+    unsigned int nbConstraints = 0;
+    if (!reader.readValue(nbConstraints)) return false;
+    for (unsigned int i = 0; i < nbConstraints; ++i)
+    {
+        std::string path;
+        ConstraintBlockBuf buf;
+        unsigned int nbIds = 0;
+        if (!reader.readString(path) || !reader.readValue(buf.nbLines) || !reader.readValue(nbIds))
+            return false;
+        for (unsigned int j = 0; j < nbIds; ++j)
+        {
+            PersistentID id = 0;
+            int constraintId = 0;
+            if (!reader.readValue(id) || !reader.readValue(constraintId))
+                return false;
+            buf.persistentToConstraintIdMap[id] = constraintId;
+        }
+        core::behavior::BaseConstraint* constraint = getContext()->get<core::behavior::BaseConstraint>(path);
+        if (constraint)
+            _previousConstraints[constraint] = buf;
+    }
+    return reader.atEnd();
+}
+
 void LCPConstraintSolver::removeConstraintCorrection(core::behavior::BaseConstraintCorrection *s)
 {
     constraintCorrections.erase(std::remove(constraintCorrections.begin(), constraintCorrections.end(), s), constraintCorrections.end());
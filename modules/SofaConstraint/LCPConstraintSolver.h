@@ -137,6 +137,10 @@ public:
 
     void cleanup() override;
 
+    /// Store the forces and constraint ids of the last step used as initial guess
+    void writeInternalState(std::vector<char>& buffer) const override;
+    bool readInternalState(const char* buffer, std::size_t size) override;
+
     bool prepareStates(const core::ConstraintParams * /*cParams*/, MultiVecId res1, MultiVecId res2=MultiVecId::null()) override;
     bool buildSystem(const core::ConstraintParams * /*cParams*/, MultiVecId res1, MultiVecId res2=MultiVecId::null()) override;
     bool solveSystem(const core::ConstraintParams * /*cParams*/, MultiVecId res1, MultiVecId res2=MultiVecId::null()) override;
@@ -0,0 +1,334 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "PrecomputedComplianceFile.h"
+
+#include <sofa/helper/logging/Messaging.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace constraintset
+{
+
+namespace
+{
+
+const char s_magic[8] = { 'S', 'O', 'F', 'A', 'C', 'O', 'M', 'P' };
+const std::uint32_t s_byteOrder = 0x01020304;
+
+/// zlib counts bytes with 32 bits integers: large buffers are fed by chunks
+const std::size_t s_zlibChunk = std::size_t(1) << 30;
+
+bool deflateBuffer(const char* in, std::size_t inSize, std::vector<char>& out)
+{
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK)
+        return false;
+
+    out.resize(std::max<std::size_t>(inSize / 2, 1024));
+    std::size_t consumed = 0;
+    std::size_t produced = 0;
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END)
+    {
+        if (stream.avail_in == 0)
+        {
+            const std::size_t chunk = std::min(inSize - consumed, s_zlibChunk);
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in + consumed));
+            stream.avail_in = static_cast<uInt>(chunk);
+            consumed += chunk;
+        }
+        if (produced == out.size())
+            out.resize(out.size() * 2);
+
+        const std::size_t available = std::min(out.size() - produced, s_zlibChunk);
+        stream.next_out = reinterpret_cast<Bytef*>(out.data() + produced);
+        stream.avail_out = static_cast<uInt>(available);
+
+        ret = deflate(&stream, consumed == inSize ? Z_FINISH : Z_NO_FLUSH);
+        if (ret == Z_STREAM_ERROR)
+        {
+            deflateEnd(&stream);
+            return false;
+        }
+        produced += available - stream.avail_out;
+    }
+    deflateEnd(&stream);
+    out.resize(produced);
+    return true;
+}
+
+bool inflateBuffer(const char* in, std::size_t inSize, char* out, std::size_t outSize)
+{
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK)
+        return false;
+
+    std::size_t consumed = 0;
+    std::size_t produced = 0;
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END)
+    {
+        if (stream.avail_in == 0)
+        {
+            if (consumed == inSize)
+                break;
+            const std::size_t chunk = std::min(inSize - consumed, s_zlibChunk);
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in + consumed));
+            stream.avail_in = static_cast<uInt>(chunk);
+            consumed += chunk;
+        }
+        if (produced == outSize)
+            break;
+
+        const std::size_t available = std::min(outSize - produced, s_zlibChunk);
+        stream.next_out = reinterpret_cast<Bytef*>(out + produced);
+        stream.avail_out = static_cast<uInt>(available);
+
+        ret = inflate(&stream, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END)
+        {
+            inflateEnd(&stream);
+            return false;
+        }
+        produced += available - stream.avail_out;
+    }
+    inflateEnd(&stream);
+    return ret == Z_STREAM_END && produced == outSize;
+}
+
+} // anonymous namespace
+
+static_assert(sizeof(PrecomputedComplianceFile::Header) == 64, "the payload of a compliance file must stay 64 bytes aligned");
+
+PrecomputedComplianceFile::PrecomputedComplianceFile()
+    : m_isLegacy(false)
+{
+    std::memset(&m_header, 0, sizeof(m_header));
+}
+
+std::uint64_t PrecomputedComplianceFile::checksum(const char* data, std::size_t size)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool PrecomputedComplianceFile::open(const std::string& filename, unsigned int nbRows, unsigned int nbCols, bool verifyChecksum)
+{
+    close();
+
+    if (!m_file.open(filename))
+    {
+        m_error = "unable to map the file";
+        return false;
+    }
+
+    const std::size_t count = std::size_t(nbRows) * nbCols;
+    if (m_file.size() < sizeof(Header) || std::memcmp(m_file.data(), s_magic, sizeof(s_magic)) != 0)
+    {
+        // File written before the introduction of the header: raw matrix of doubles
+        if (m_file.size() != count * sizeof(double))
+        {
+            m_error = "unknown file format";
+            close();
+            return false;
+        }
+        m_isLegacy = true;
+        std::memcpy(m_header.magic, s_magic, sizeof(s_magic));
+        m_header.byteOrder = s_byteOrder;
+        m_header.scalarType = FLOAT64;
+        m_header.compression = NONE;
+        m_header.nbRows = nbRows;
+        m_header.nbCols = nbCols;
+        m_header.payloadSize = m_file.size();
+        return true;
+    }
+
+    std::memcpy(&m_header, m_file.data(), sizeof(Header));
+
+    if (m_header.version > s_version)
+        m_error = "file version " + std::to_string(m_header.version) + " is not supported";
+    else if (m_header.byteOrder != s_byteOrder)
+        m_error = "file written with a different byte order";
+    else if (m_header.scalarType != FLOAT64 && m_header.scalarType != FLOAT32)
+        m_error = "unknown scalar type";
+    else if (m_header.compression != NONE && m_header.compression != ZLIB)
+        m_error = "unknown compression";
+    else if (m_header.nbRows != nbRows || m_header.nbCols != nbCols)
+        m_error = "matrix size is " + std::to_string(m_header.nbRows) + "x" + std::to_string(m_header.nbCols)
+                + " instead of " + std::to_string(nbRows) + "x" + std::to_string(nbCols);
+    else if (m_file.size() - sizeof(Header) != m_header.payloadSize
+             || (m_header.compression == NONE && m_header.payloadSize != count * scalarSize(m_header.scalarType)))
+        m_error = "truncated file";
+    else if (verifyChecksum && checksum(payload(), m_header.payloadSize) != m_header.checksum)
+        m_error = "checksum mismatch";
+    else
+        return true;
+
+    close();
+    return false;
+}
+
+void PrecomputedComplianceFile::close()
+{
+    m_file.close();
+    std::memset(&m_header, 0, sizeof(m_header));
+    m_isLegacy = false;
+    m_error.clear();
+}
+
+const char* PrecomputedComplianceFile::payload() const
+{
+    if (!m_file.isOpen())
+        return nullptr;
+    return m_isLegacy ? m_file.data() : m_file.data() + sizeof(Header);
+}
+
+template<class Real>
+bool PrecomputedComplianceFile::decode(Real* dest) const
+{
+    if (!m_file.isOpen())
+        return false;
+
+    const std::size_t count = std::size_t(m_header.nbRows) * m_header.nbCols;
+    const std::size_t size = count * scalarSize(m_header.scalarType);
+    const char* matrix = payload();
+
+    std::vector<char> inflated;
+    if (m_header.compression == ZLIB)
+    {
+        // decompress in place when no conversion is needed
+        char* out = reinterpret_cast<char*>(dest);
+        if (m_header.scalarType != scalarTypeOf<Real>())
+        {
+            inflated.resize(size);
+            out = inflated.data();
+        }
+        if (!inflateBuffer(matrix, m_header.payloadSize, out, size))
+            return false;
+        if (inflated.empty())
+            return true;
+        matrix = inflated.data();
+    }
+
+    if (m_header.scalarType == FLOAT32)
+        convert(reinterpret_cast<const float*>(matrix), dest, count);
+    else
+        convert(reinterpret_cast<const double*>(matrix), dest, count);
+    return true;
+}
+
+bool PrecomputedComplianceFile::copyTo(double* dest) const
+{
+    return decode(dest);
+}
+
+bool PrecomputedComplianceFile::copyTo(float* dest) const
+{
+    return decode(dest);
+}
+
+bool PrecomputedComplianceFile::writeRaw(const std::string& filename, const char* matrix, unsigned int nbRows, unsigned int nbCols,
+                                         double dt, ScalarType scalarType, Compression compression)
+{
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, s_magic, sizeof(s_magic));
+    header.version = s_version;
+    header.byteOrder = s_byteOrder;
+    header.scalarType = scalarType;
+    header.compression = compression;
+    header.nbRows = nbRows;
+    header.nbCols = nbCols;
+    header.dt = dt;
+
+    const std::size_t size = std::size_t(nbRows) * nbCols * scalarSize(scalarType);
+    std::vector<char> compressed;
+    const char* payload = matrix;
+    if (compression == ZLIB)
+    {
+        if (!deflateBuffer(matrix, size, compressed))
+        {
+            msg_error("PrecomputedComplianceFile") << "Unable to compress the compliance matrix saved in " << filename;
+            return false;
+        }
+        payload = compressed.data();
+        header.payloadSize = compressed.size();
+    }
+    else
+    {
+        header.payloadSize = size;
+    }
+    header.checksum = checksum(payload, header.payloadSize);
+
+    // Write in a temporary file renamed at the end, so that processes mapping
+    // the previous version of the file never see a partially written matrix.
+    const std::string tmpFilename = filename + ".tmp";
+    {
+        std::ofstream out(tmpFilename.c_str(), std::ofstream::binary | std::ofstream::trunc);
+        if (!out.is_open())
+        {
+            msg_error("PrecomputedComplianceFile") << "Unable to write file " << tmpFilename;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(payload, std::streamsize(header.payloadSize));
+        if (!out.good())
+        {
+            msg_error("PrecomputedComplianceFile") << "Error while writing file " << tmpFilename;
+            return false;
+        }
+    }
+#ifdef WIN32
+    // rename does not replace an existing file on Windows
+    std::remove(filename.c_str());
+#endif
+    if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0)
+    {
+        msg_error("PrecomputedComplianceFile") << "Unable to rename " << tmpFilename << " into " << filename;
+        return false;
+    }
+    return true;
+}
+
+} // namespace constraintset
+
+} // namespace component
+
+} // namespace sofa
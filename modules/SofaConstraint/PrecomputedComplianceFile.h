@@ -0,0 +1,150 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_COMPONENT_CONSTRAINTSET_PRECOMPUTEDCOMPLIANCEFILE_H
+#define SOFA_COMPONENT_CONSTRAINTSET_PRECOMPUTEDCOMPLIANCEFILE_H
+#include "config.h"
+
+#include <sofa/helper/io/MemoryMappedFile.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace constraintset
+{
+
+/**
+ *  \brief On-disk storage of a dense precomputed compliance matrix.
+ *
+ *  A file starts with a fixed size header (magic, version, byte order, scalar
+ *  type, compression, dimensions, time step and a checksum of the payload),
+ *  followed by the row-major matrix. The payload starts on a 64 bytes boundary
+ *  so that an uncompressed matrix can be used directly from a read-only
+ *  memory mapping, shared between all the processes of the node.
+ *
+ *  Files written by older versions (raw doubles, without header) are still
+ *  readable when the expected dimensions are given to open().
+ */
+class SOFA_CONSTRAINT_API PrecomputedComplianceFile
+{
+public:
+    enum ScalarType : std::uint32_t { FLOAT64 = 0, FLOAT32 = 1 };
+    enum Compression : std::uint32_t { NONE = 0, ZLIB = 1 };
+
+    static const std::uint32_t s_version = 1;
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t scalarType;
+        std::uint32_t compression;
+        std::uint32_t nbRows;
+        std::uint32_t nbCols;
+        double dt;
+        std::uint64_t payloadSize; ///< size in bytes of the stored (possibly compressed) matrix
+        std::uint64_t checksum;    ///< FNV-1a hash of the stored payload
+        std::uint64_t reserved;
+    };
+
+    PrecomputedComplianceFile();
+
+    /// Map the file and check its header against the expected dimensions.
+    bool open(const std::string& filename, unsigned int nbRows, unsigned int nbCols, bool verifyChecksum);
+    void close();
+
+    const Header& getHeader() const { return m_header; }
+    bool isLegacy() const { return m_isLegacy; }
+    const std::string& getErrorMessage() const { return m_error; }
+
+    /// Matrix stored in the mapped file, or nullptr if it is compressed or stored with another scalar type.
+    template<class Real>
+    const Real* getMappedData() const
+    {
+        if (m_header.compression != NONE || m_header.scalarType != scalarTypeOf<Real>())
+            return nullptr;
+        return reinterpret_cast<const Real*>(payload());
+    }
+
+    /// Decode (decompress and convert) the whole matrix into dest, which holds nbRows*nbCols values.
+    bool copyTo(double* dest) const;
+    bool copyTo(float* dest) const;
+
+    template<class Real>
+    static bool write(const std::string& filename, const Real* data, unsigned int nbRows, unsigned int nbCols,
+                      double dt, ScalarType scalarType, Compression compression)
+    {
+        const std::size_t count = std::size_t(nbRows) * nbCols;
+        if (scalarType == scalarTypeOf<Real>())
+            return writeRaw(filename, reinterpret_cast<const char*>(data), nbRows, nbCols, dt, scalarType, compression);
+
+        std::vector<char> converted(count * scalarSize(scalarType));
+        if (scalarType == FLOAT32)
+            convert(data, reinterpret_cast<float*>(converted.data()), count);
+        else
+            convert(data, reinterpret_cast<double*>(converted.data()), count);
+        return writeRaw(filename, converted.data(), nbRows, nbCols, dt, scalarType, compression);
+    }
+
+    static std::size_t scalarSize(std::uint32_t scalarType) { return scalarType == FLOAT32 ? sizeof(float) : sizeof(double); }
+
+    template<class Real>
+    static ScalarType scalarTypeOf() { return sizeof(Real) == sizeof(float) ? FLOAT32 : FLOAT64; }
+
+protected:
+    template<class In, class Out>
+    static void convert(const In* in, Out* out, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = static_cast<Out>(in[i]);
+    }
+
+    static bool writeRaw(const std::string& filename, const char* matrix, unsigned int nbRows, unsigned int nbCols,
+                         double dt, ScalarType scalarType, Compression compression);
+
+    static std::uint64_t checksum(const char* data, std::size_t size);
+
+    const char* payload() const;
+
+    template<class Real>
+    bool decode(Real* dest) const;
+
+    helper::io::MemoryMappedFile m_file;
+    Header m_header;
+    bool m_isLegacy;
+    std::string m_error;
+};
+
+} // namespace constraintset
+
+} // namespace component
+
+} // namespace sofa
+
+#endif // SOFA_COMPONENT_CONSTRAINTSET_PRECOMPUTEDCOMPLIANCEFILE_H
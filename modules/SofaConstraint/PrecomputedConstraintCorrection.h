@@ -23,14 +23,19 @@
 #define SOFA_CORE_COLLISION_CONTACTCORRECTION_H
 #include "config.h"
 
+#include <SofaConstraint/PrecomputedComplianceFile.h>
+
 #include <sofa/core/behavior/ConstraintCorrection.h>
 #include <sofa/core/objectmodel/DataFileName.h>
+#include <sofa/helper/OptionsGroup.h>
 
 #include <SofaBaseLinearSolver/FullMatrix.h>
 
 #include <sofa/defaulttype/Mat.h>
 #include <sofa/defaulttype/Vec.h>
 
+#include <memory>
+
 namespace sofa
 {
 
@@ -72,6 +77,10 @@ public:
 	Data<double> debugViewFrameScale; ///< Scale on computed node's frame
 	sofa::core::objectmodel::DataFileName f_fileCompliance; ///< Precomputed compliance matrix data file
 	Data<std::string> fileDir; ///< If not empty, the compliance will be saved in this repertory
+    Data<bool> d_useMemoryMapping; ///< If true, an uncompressed compliance file stored with the simulation precision is mapped in memory (read-only pages shared between processes) instead of being loaded
+    Data<helper::OptionsGroup> d_storagePrecision; ///< Scalar type used to save the compliance file (double or float)
+    Data<bool> d_compressCompliance; ///< If true, the saved compliance file is compressed (a compressed file cannot be mapped in memory)
+    Data<bool> d_verifyChecksum; ///< If true, the checksum of the whole compliance file is checked before using it (the header is always checked)
     
 protected:
     PrecomputedConstraintCorrection(sofa::core::behavior::MechanicalState<DataTypes> *mm = nullptr);
@@ -128,6 +137,8 @@ public:
     {
         Real* data;
         int nbref;
+        /// When set, data points to the read-only mapping of this file and must not be modified nor deleted
+        std::shared_ptr<PrecomputedComplianceFile> file;
         InverseStorage() : data(nullptr), nbref(0) {}
     };
 
@@ -39,6 +39,7 @@
 #include <sofa/core/behavior/RotationFinder.h>
 
 #include <sofa/helper/system/FileRepository.h>
+#include <sofa/helper/system/FileSystem.h>
 #include <sofa/helper/Quater.h>
 
 #include <SofaConstraint/LMConstraintSolver.h>
@@ -69,11 +70,18 @@ PrecomputedConstraintCorrection<DataTypes>::PrecomputedConstraintCorrection(sofa
     , debugViewFrameScale(initData(&debugViewFrameScale, 1.0, "debugViewFrameScale", "Scale on computed node's frame"))
     , f_fileCompliance(initData(&f_fileCompliance, "fileCompliance", "Precomputed compliance matrix data file"))
     , fileDir(initData(&fileDir, "fileDir", "If not empty, the compliance will be saved in this repertory"))
+    , d_useMemoryMapping(initData(&d_useMemoryMapping, true, "useMemoryMapping", "If true, an uncompressed compliance file stored with the simulation precision is mapped in memory (read-only pages shared between processes) instead of being loaded"))
+    , d_storagePrecision(initData(&d_storagePrecision, "storagePrecision", "Scalar type used to save the compliance file (double or float)"))
+    , d_compressCompliance(initData(&d_compressCompliance, false, "compressCompliance", "If true, the saved compliance file is compressed (a compressed file cannot be mapped in memory)"))
+    , d_verifyChecksum(initData(&d_verifyChecksum, false, "verifyChecksum", "If true, the checksum of the whole compliance file is checked before using it (the header is always checked)"))
     , invM(nullptr)
     , appCompliance(nullptr)
     , nbRows(0), nbCols(0), dof_on_node(0), nbNodes(0)
 {
     this->addAlias(&f_fileCompliance, "filePrefix");
+
+    helper::OptionsGroup precisions(2, "double", "float");
+    d_storagePrecision.setValue(precisions);
 }
 
 template<class DataTypes>
@@ -104,7 +112,8 @@ void PrecomputedConstraintCorrection<DataTypes>::releaseInverse(std::string name
     std::map< std::string, InverseStorage >& registry = getInverseMap();
     if (--inv->nbref == 0)
     {
-        if (inv->data) delete[] inv->data;
+        // mapped data is released with the file
+        if (inv->data && !inv->file) delete[] inv->data;
         registry.erase(name);
     }
 }
@@ -136,46 +145,54 @@ bool PrecomputedConstraintCorrection<DataTypes>::loadCompliance(std::string file
     invM = getInverse(fileName);
     dimensionAppCompliance = nbRows;
 
-    if (invM->data == nullptr)
-    {
-        // Try to load from file
-        msg_info() << "Try to load compliance from : " << fileName ;
-
-        std::string dir = fileDir.getValue();
-        if (!dir.empty())
-        {
-            std::ifstream compFileIn((dir + "/" + fileName).c_str(), std::ifstream::binary);
-            if (compFileIn.is_open())
-            {
-                invM->data = new Real[nbRows * nbCols];
-
-                msg_info() << "File " << dir + "/" + fileName << " found. Loading..." ;
+    if (invM->data != nullptr)
+        return true;
 
-                compFileIn.read((char*)invM->data, nbCols * nbRows * sizeof(double));
-                compFileIn.close();
+    // Try to load from file
+    msg_info() << "Try to load compliance from : " << fileName ;
 
-                return true;
-            }
-            else
-                return false;
-        }
-        else if (recompute.getValue() == false)
-        {
-            if(sofa::helper::system::DataRepository.findFile(fileName))
-            {
-                invM->data = new Real[nbRows * nbCols];
-
-                std::ifstream compFileIn(fileName.c_str(), std::ifstream::binary);
+    std::string filePath;
+    std::string dir = fileDir.getValue();
+    if (!dir.empty())
+    {
+        filePath = dir + "/" + fileName;
+        if (!sofa::helper::system::FileSystem::exists(filePath))
+            return false;
+    }
+    else if (recompute.getValue() == false && sofa::helper::system::DataRepository.findFile(fileName))
+    {
+        filePath = fileName;
+    }
+    else
+    {
+        return false;
+    }
 
-                msg_info() << "File " << fileName << " found. Loading..." ;
+    std::shared_ptr<PrecomputedComplianceFile> file = std::make_shared<PrecomputedComplianceFile>();
+    if (!file->open(filePath, nbRows, nbCols, d_verifyChecksum.getValue()))
+    {
+        msg_warning() << "File " << filePath << " cannot be used (" << file->getErrorMessage() << "), the compliance will be recomputed.";
+        return false;
+    }
 
-                compFileIn.read((char*)invM->data, nbCols * nbRows * sizeof(double));
-                compFileIn.close();
+    msg_info() << "File " << filePath << " found. Loading..." ;
 
-                return true;
-            }
-        }
+    const Real* mappedData = file->template getMappedData<Real>();
+    if (d_useMemoryMapping.getValue() && mappedData)
+    {
+        // The compliance is never written once computed: the read-only
+        // mapping is used as is, its pages are shared by all the processes
+        invM->data = const_cast<Real*>(mappedData);
+        invM->file = file;
+        return true;
+    }
 
+    invM->data = new Real[nbRows * nbCols];
+    if (!file->copyTo(invM->data))
+    {
+        msg_warning() << "File " << filePath << " cannot be decoded, the compliance will be recomputed.";
+        delete[] invM->data;
+        invM->data = nullptr;
         return false;
     }
 
@@ -196,9 +213,13 @@ void PrecomputedConstraintCorrection<DataTypes>::saveCompliance(const std::strin
     else
         filePathInSofaShare  = sofa::helper::system::DataRepository.getFirstPath() + "/" + fileName;
 
-    std::ofstream compFileOut(filePathInSofaShare.c_str(), std::fstream::out | std::fstream::binary);
-    compFileOut.write((char*)invM->data, nbCols * nbRows * sizeof(double));
-    compFileOut.close();
+    const PrecomputedComplianceFile::ScalarType scalarType = d_storagePrecision.getValue().getSelectedItem() == "float"
+            ? PrecomputedComplianceFile::FLOAT32 : PrecomputedComplianceFile::FLOAT64;
+    const PrecomputedComplianceFile::Compression compression = d_compressCompliance.getValue()
+            ? PrecomputedComplianceFile::ZLIB : PrecomputedComplianceFile::NONE;
+
+    PrecomputedComplianceFile::write(filePathInSofaShare, invM->data, nbRows, nbCols,
+                                     this->getContext()->getDt(), scalarType, compression);
 }
 
 
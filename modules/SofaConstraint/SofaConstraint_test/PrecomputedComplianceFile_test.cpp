@@ -0,0 +1,129 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest;
+
+#include <SofaConstraint/PrecomputedComplianceFile.h>
+using sofa::component::constraintset::PrecomputedComplianceFile;
+
+#include <boost/filesystem.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+
+struct PrecomputedComplianceFile_test : public BaseTest
+{
+    const unsigned int nbRows = 12;
+    const unsigned int nbCols = 12;
+    std::vector<double> matrix;
+    std::string filename;
+
+    void SetUp() override
+    {
+        matrix.resize(nbRows * nbCols);
+        for (unsigned int i = 0; i < matrix.size(); ++i)
+            matrix[i] = 1.0 / (1.0 + i);
+        filename = (boost::filesystem::temp_directory_path() / "PrecomputedComplianceFile_test.comp").string();
+    }
+
+    void TearDown() override
+    {
+        std::remove(filename.c_str());
+    }
+
+    void checkRoundTrip(PrecomputedComplianceFile::ScalarType scalarType, PrecomputedComplianceFile::Compression compression)
+    {
+        ASSERT_TRUE(PrecomputedComplianceFile::write(filename, matrix.data(), nbRows, nbCols, 0.01, scalarType, compression));
+
+        PrecomputedComplianceFile file;
+        ASSERT_TRUE(file.open(filename, nbRows, nbCols, true)) << file.getErrorMessage();
+        EXPECT_FALSE(file.isLegacy());
+        EXPECT_EQ(file.getHeader().dt, 0.01);
+
+        const bool isMappable = scalarType == PrecomputedComplianceFile::FLOAT64 && compression == PrecomputedComplianceFile::NONE;
+        EXPECT_EQ(file.getMappedData<double>() != nullptr, isMappable);
+
+        std::vector<double> loaded(matrix.size());
+        ASSERT_TRUE(file.copyTo(loaded.data()));
+        const double epsilon = scalarType == PrecomputedComplianceFile::FLOAT32 ? 1e-7 : 0.0;
+        for (unsigned int i = 0; i < matrix.size(); ++i)
+            EXPECT_NEAR(loaded[i], matrix[i], epsilon);
+    }
+};
+
+TEST_F(PrecomputedComplianceFile_test, roundTripDouble)
+{
+    checkRoundTrip(PrecomputedComplianceFile::FLOAT64, PrecomputedComplianceFile::NONE);
+}
+
+TEST_F(PrecomputedComplianceFile_test, roundTripFloat)
+{
+    checkRoundTrip(PrecomputedComplianceFile::FLOAT32, PrecomputedComplianceFile::NONE);
+}
+
+TEST_F(PrecomputedComplianceFile_test, roundTripCompressed)
+{
+    checkRoundTrip(PrecomputedComplianceFile::FLOAT64, PrecomputedComplianceFile::ZLIB);
+    checkRoundTrip(PrecomputedComplianceFile::FLOAT32, PrecomputedComplianceFile::ZLIB);
+}
+
+TEST_F(PrecomputedComplianceFile_test, rejectWrongSizeAndCorruption)
+{
+    ASSERT_TRUE(PrecomputedComplianceFile::write(filename, matrix.data(), nbRows, nbCols, 0.01,
+                                                 PrecomputedComplianceFile::FLOAT64, PrecomputedComplianceFile::NONE));
+
+    PrecomputedComplianceFile file;
+    EXPECT_FALSE(file.open(filename, nbRows + 1, nbCols + 1, true));
+
+    {
+        std::fstream out(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        out.seekp(sizeof(PrecomputedComplianceFile::Header) + 3);
+        out.put('x');
+    }
+    EXPECT_FALSE(file.open(filename, nbRows, nbCols, true));
+    EXPECT_TRUE(file.open(filename, nbRows, nbCols, false));
+}
+
+TEST_F(PrecomputedComplianceFile_test, readLegacyFile)
+{
+    {
+        std::ofstream out(filename.c_str(), std::ios::binary);
+        out.write(reinterpret_cast<const char*>(matrix.data()), matrix.size() * sizeof(double));
+    }
+
+    PrecomputedComplianceFile file;
+    ASSERT_TRUE(file.open(filename, nbRows, nbCols, true));
+    EXPECT_TRUE(file.isLegacy());
+    const double* mapped = file.getMappedData<double>();
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_EQ(mapped[5], matrix[5]);
+
+    std::vector<float> loaded(matrix.size());
+    ASSERT_TRUE(file.copyTo(loaded.data()));
+    EXPECT_FLOAT_EQ(loaded[7], float(matrix[7]));
+}
+
+}
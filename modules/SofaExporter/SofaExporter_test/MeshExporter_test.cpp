@@ -141,7 +141,8 @@ std::vector<std::vector<string>> params={
     {"vtk", "vtk"},
     {"mesh", "netgen"},
     {"node", "tetgen"},
-    {"gmsh", "gmsh"}
+    {"gmsh", "gmsh"},
+    {"sbm", "binary"}
 };
 
 #define NUM_PARAMS (unsigned int)2
@@ -202,5 +203,46 @@ INSTANTIATE_TEST_CASE_P(checkAllBehavior,
                         MeshExporter_test,
                         ::testing::ValuesIn(params));
 
+/// The binary format is opt-in: "ALL" does not write it
+class MeshExporterAll_test : public sofa::Sofa_test<>
+{
+public:
+    std::vector<string> dataPath {"outfile.vtu", "outfile.vtk", "outfile.mesh", "outfile.node", "outfile.gmsh", "outfile.sbm"} ;
+
+    void TearDown()
+    {
+        for(auto& pathToRemove : dataPath)
+        {
+            if(FileSystem::exists(pathToRemove))
+               FileSystem::removeAll(pathToRemove) ;
+        }
+    }
+};
+
+TEST_F( MeshExporterAll_test, allFormatsExceptBinary) {
+    EXPECT_MSG_NOEMIT(Error, Warning) ;
+    std::stringstream scene1;
+    scene1 <<
+            "<?xml version='1.0'?> \n"
+            "<Node 	name='Root' gravity='0 0 0' time='0' animate='0'   >       \n"
+            "   <DefaultAnimationLoop/>                                        \n"
+            "   <MechanicalObject position='0 1 2 3 4 5 6 7 8 9'/>             \n"
+            "   <RegularGridTopology name='grid' n='6 6 6' min='-10 -10 -10' max='10 10 10' p0='-30 -10 -10' computeHexaList='0'/> \n"
+            "   <MeshExporter name='exporter1' format='ALL' filename='outfile' exportAtBegin='true' /> \n"
+            "</Node>                                                           \n" ;
+
+    Node::SPtr root = SceneLoaderXML::loadFromMemory ("testscene",
+                                                      scene1.str().c_str(),
+                                                      scene1.str().size()) ;
+
+    ASSERT_NE(root.get(), nullptr) ;
+    root->init(ExecParams::defaultInstance()) ;
+    sofa::simulation::getSimulation()->animate(root.get(), 0.5);
+
+    EXPECT_TRUE( FileSystem::exists("outfile.vtu") ) ;
+    EXPECT_TRUE( FileSystem::exists("outfile.gmsh") ) ;
+    EXPECT_FALSE( FileSystem::exists("outfile.sbm") ) ;
+}
+
 
 }
@@ -35,6 +35,8 @@
 
 #include <sofa/core/behavior/BaseMechanicalState.h>
 #include <sofa/core/topology/BaseMeshTopology.h>
+#include <sofa/core/loader/BinaryMeshFile.h>
+#include <sofa/core/loader/MeshLoader.h>
 
 using sofa::core::objectmodel::ComponentState ;
 
@@ -53,11 +55,12 @@ int MeshExporterClass = core::RegisterObject("Export topology and positions into
                                              "- vtk" msgendl
                                              "- netgen" msgendl
                                              "- teten" msgendl
-                                             "- gmsh" msgendl)
+                                             "- gmsh" msgendl
+                                             "- binary (native format read by MeshBinaryLoader, not included in ALL)" msgendl)
         .add< MeshExporter >();
 
 MeshExporter::MeshExporter()
-    : d_fileFormat( initData(&d_fileFormat, sofa::helper::OptionsGroup(6,"ALL","vtkxml","vtk","netgen","tetgen","gmsh"), "format", "File format to use"))
+    : d_fileFormat( initData(&d_fileFormat, sofa::helper::OptionsGroup(7,"ALL","vtkxml","vtk","netgen","tetgen","gmsh","binary"), "format", "File format to use"))
     , d_position( initData(&d_position, "position", "points position (will use points from topology or mechanical state if this is empty)"))
     , d_writeEdges( initData(&d_writeEdges, true, "edges", "write edge topology"))
     , d_writeTriangles( initData(&d_writeTriangles, true, "triangles", "write triangle topology"))
@@ -101,9 +104,35 @@ void MeshExporter::doReInit()
         }
     }
 
+    if (d_fileFormat.getValue().getSelectedId() == 6)
+        checkBinaryExport();
+
     m_componentstate = ComponentState::Valid ;
 }
 
+void MeshExporter::checkBinaryExport()
+{
+    // The binary file only receives what the topology provides: the normals, groups, pentahedra
+    // and pyramids of a mesh loader in the same node are not exported.
+    sofa::core::loader::MeshLoader* loader = nullptr;
+    this->getContext()->get(loader, sofa::core::objectmodel::BaseContext::Local);
+    if (!loader)
+        return;
+
+    std::stringstream lost;
+    if (!loader->d_normals.getValue().empty()) lost << " normals";
+    if (!loader->d_pentahedra.getValue().empty()) lost << " pentahedra";
+    if (!loader->d_pyramids.getValue().empty()) lost << " pyramids";
+    if (!loader->d_edgesGroups.getValue().empty() || !loader->d_trianglesGroups.getValue().empty()
+            || !loader->d_quadsGroups.getValue().empty() || !loader->d_polygonsGroups.getValue().empty()
+            || !loader->d_tetrahedraGroups.getValue().empty() || !loader->d_hexahedraGroups.getValue().empty()
+            || !loader->d_pentahedraGroups.getValue().empty() || !loader->d_pyramidsGroups.getValue().empty())
+        lost << " groups";
+
+    msg_warning_when(!lost.str().empty()) << "The binary format only exports the positions and the elements of the topology, "
+                                          << "the following data of " << loader->getName() << " are not written:" << lost.str();
+}
+
 bool MeshExporter::write()
 {
     if(m_componentstate!=ComponentState::Valid)
@@ -124,6 +153,7 @@ bool MeshExporter::writeMesh()
     const bool netgen = all || (format == 3);
     const bool tetgen = all || (format == 4);
     const bool gmsh   = all || (format == 5);
+    const bool binary = (format == 6); // opt-in only
     msg_info() << "Exporting a mesh in '" << getMeshFilename("") << "'" << msgendl
                << "-" << d_position.getValue().size() << " points" << msgendl
                << "-" << m_inputtopology->getNbEdges() << " edges" << msgendl
@@ -143,6 +173,8 @@ bool MeshExporter::writeMesh()
         res = writeMeshTetgen();
     if (gmsh)
         res = writeMeshGmsh();
+    if (binary)
+        res = writeMeshBinary();
 
     return res ;
 }
@@ -686,6 +718,46 @@ bool MeshExporter::writeMeshNetgen()
     return true;
 }
 
+/// Native binary format, see sofa::core::loader::BinaryMeshFile.
+/// The edges and triangles of a volume topology are saved with the volume
+/// elements, so that the loading does not have to compute them again.
+/// Normals, groups, pentahedra and pyramids are not available from the topology
+/// and are not written (see checkBinaryExport).
+bool MeshExporter::writeMeshBinary()
+{
+    if(m_componentstate!=ComponentState::Valid)
+        return false;
+
+    using sofa::core::loader::BinaryMeshFile;
+
+    std::string filename = getMeshFilename(".sbm");
+
+    helper::ReadAccessor<Data<defaulttype::Vec3Types::VecCoord> > pointsPos = d_position;
+    helper::vector<defaulttype::Vec3d> positions(pointsPos.begin(), pointsPos.end());
+
+    std::vector<BinaryMeshFile::Section> sections;
+    sections.push_back(BinaryMeshFile::Section(BinaryMeshFile::POSITIONS, positions));
+    if (d_writeEdges.getValue())
+        sections.push_back(BinaryMeshFile::Section(BinaryMeshFile::EDGES, m_inputtopology->getEdges()));
+    if (d_writeTriangles.getValue())
+        sections.push_back(BinaryMeshFile::Section(BinaryMeshFile::TRIANGLES, m_inputtopology->getTriangles()));
+    if (d_writeQuads.getValue())
+        sections.push_back(BinaryMeshFile::Section(BinaryMeshFile::QUADS, m_inputtopology->getQuads()));
+    if (d_writeTetras.getValue())
+        sections.push_back(BinaryMeshFile::Section(BinaryMeshFile::TETRAHEDRA, m_inputtopology->getTetrahedra()));
+    if (d_writeHexas.getValue())
+        sections.push_back(BinaryMeshFile::Section(BinaryMeshFile::HEXAHEDRA, m_inputtopology->getHexahedra()));
+
+    if (!BinaryMeshFile::write(filename, sections))
+    {
+        msg_error() << "Unable to create file '"<<filename << "'";
+        return false;
+    }
+
+    msg_info() << filename << " written." ;
+    return true;
+}
+
 /// http://tetgen.berlios.de/fformats.html
 bool MeshExporter::writeMeshTetgen()
 {
@@ -95,6 +95,7 @@ public:
     bool writeMeshGmsh();
     bool writeMeshNetgen();
     bool writeMeshTetgen();
+    bool writeMeshBinary();
 
 
 protected:
@@ -105,6 +106,9 @@ protected:
     BaseMechanicalState*  m_inputmstate {nullptr};
 
     std::string getMeshFilename(const char* ext);
+
+    /// Warn about the data of a mesh loader of the node that the binary format cannot receive
+    void checkBinaryExport();
 };
 
 } /// namespace _meshexporter_
@@ -0,0 +1,317 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGeneralAnimationLoop/AdaptiveTimeStepAnimationLoop.h>
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/behavior/LinearSolver.h>
+#include <sofa/core/behavior/ConstraintSolver.h>
+#include <sofa/core/behavior/MultiVec.h>
+#include <sofa/simulation/VectorOperations.h>
+#include <sofa/simulation/MechanicalVisitor.h>
+#include <sofa/simulation/AnimateBeginEvent.h>
+#include <sofa/simulation/AnimateEndEvent.h>
+#include <sofa/simulation/UpdateMappingEndEvent.h>
+#include <sofa/simulation/UpdateBoundingBoxVisitor.h>
+#include <sofa/simulation/PropagateEventVisitor.h>
+#include <sofa/simulation/BehaviorUpdatePositionVisitor.h>
+#include <sofa/simulation/UpdateInternalDataVisitor.h>
+#include <sofa/simulation/UpdateContextVisitor.h>
+#include <sofa/simulation/UpdateMappingVisitor.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+
+using namespace sofa::simulation;
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace animationloop
+{
+
+int AdaptiveTimeStepAnimationLoopClass = core::RegisterObject("Animation loop adapting the integration time step to the convergence of the iterative linear solvers, with rollback of rejected steps.")
+        .add< AdaptiveTimeStepAnimationLoop >()
+        ;
+
+namespace
+{
+
+/// Read the first scalar value of a Data, whatever its numeric type.
+bool readScalar(core::objectmodel::BaseObject* obj, const char* name, SReal& value)
+{
+    core::objectmodel::BaseData* data = obj->findData(name);
+    if (!data) return false;
+    const defaulttype::AbstractTypeInfo* info = data->getValueTypeInfo();
+    if (!info->ValidInfo() || !(info->Integer() || info->Scalar()) || info->size(data->getValueVoidPtr()) == 0)
+        return false;
+    value = (SReal)info->getScalarValue(data->getValueVoidPtr(), 0);
+    return true;
+}
+
+} // anonymous namespace
+
+AdaptiveTimeStepAnimationLoop::AdaptiveTimeStepAnimationLoop(simulation::Node* gnode)
+    : Inherit(gnode)
+    , d_minDt( initData(&d_minDt, (SReal)1e-6, "minDt", "minimum internal time step") )
+    , d_maxDt( initData(&d_maxDt, (SReal)0, "maxDt", "maximum internal time step (0 means the frame time step)") )
+    , d_growFactor( initData(&d_growFactor, (SReal)1.5, "growFactor", "factor applied to the internal time step after a quickly converged sub-step") )
+    , d_shrinkFactor( initData(&d_shrinkFactor, (SReal)0.5, "shrinkFactor", "factor applied to the internal time step after a slowly converged or rejected sub-step") )
+    , d_lowIterationRatio( initData(&d_lowIterationRatio, (SReal)0.25, "lowIterationRatio", "the time step grows when iterations/maxIterations is below this ratio for all solvers") )
+    , d_highIterationRatio( initData(&d_highIterationRatio, (SReal)0.75, "highIterationRatio", "the time step shrinks when iterations/maxIterations is above this ratio for one solver") )
+    , d_maxSubSteps( initData(&d_maxSubSteps, 100u, "maxSubSteps", "maximum number of attempted sub-steps within one animation step") )
+    , d_currentDt( initData(&d_currentDt, (SReal)0, "currentDt", "OUTPUT: current internal time step") )
+    , d_lastIterationRatio( initData(&d_lastIterationRatio, (SReal)0, "lastIterationRatio", "OUTPUT: largest iterations/maxIterations ratio of the last sub-step") )
+    , d_nbAcceptedSteps( initData(&d_nbAcceptedSteps, 0u, "nbAcceptedSteps", "OUTPUT: total number of accepted sub-steps") )
+    , d_nbRejectedSteps( initData(&d_nbRejectedSteps, 0u, "nbRejectedSteps", "OUTPUT: total number of rejected (rolled back) sub-steps") )
+    , m_dt(0)
+{
+    d_currentDt.setReadOnly(true);
+    d_lastIterationRatio.setReadOnly(true);
+    d_nbAcceptedSteps.setReadOnly(true);
+    d_nbRejectedSteps.setReadOnly(true);
+}
+
+AdaptiveTimeStepAnimationLoop::~AdaptiveTimeStepAnimationLoop()
+{
+}
+
+void AdaptiveTimeStepAnimationLoop::init()
+{
+    Inherit::init();
+
+    if (d_growFactor.getValue() < 1)
+    {
+        msg_warning() << "growFactor should be greater or equal to 1, using 1.";
+        d_growFactor.setValue(1);
+    }
+    if (d_shrinkFactor.getValue() <= 0 || d_shrinkFactor.getValue() >= 1)
+    {
+        msg_warning() << "shrinkFactor should be in ]0,1[, using 0.5.";
+        d_shrinkFactor.setValue(0.5);
+    }
+    if (d_minDt.getValue() <= 0)
+    {
+        msg_warning() << "minDt should be strictly positive, using 1e-6.";
+        d_minDt.setValue(1e-6);
+    }
+
+    // The constraint solvers need the free motion / correction sequence of FreeMotionAnimationLoop
+    helper::vector<core::behavior::ConstraintSolver*> constraintSolvers;
+    this->gnode->getTreeObjects<core::behavior::ConstraintSolver>(&constraintSolvers);
+    if (!constraintSolvers.empty())
+    {
+        msg_error() << "Constraint solvers (found " << constraintSolvers[0]->getPathName() << ") are not supported: "
+                    << "they need FreeMotionAnimationLoop, which cannot be combined with this animation loop. "
+                    << "The simulation is not animated.";
+        d_componentstate.setValue(core::objectmodel::ComponentState::Invalid);
+        return;
+    }
+    d_componentstate.setValue(core::objectmodel::ComponentState::Valid);
+
+    reset();
+}
+
+void AdaptiveTimeStepAnimationLoop::reset()
+{
+    m_dt = 0;
+    d_currentDt.setValue(0);
+    d_lastIterationRatio.setValue(0);
+    d_nbAcceptedSteps.setValue(0);
+    d_nbRejectedSteps.setValue(0);
+}
+
+SReal AdaptiveTimeStepAnimationLoop::computeIterationRatio()
+{
+    typedef std::map < std::string, sofa::helper::vector<SReal> > GraphMap;
+    SReal ratio = 0;
+
+    helper::vector<core::behavior::BaseLinearSolver*> linearSolvers;
+    this->gnode->getTreeObjects<core::behavior::BaseLinearSolver>(&linearSolvers);
+    for (core::behavior::BaseLinearSolver* solver : linearSolvers)
+    {
+        // Only iterative solvers expose the residual of each iteration
+        Data<GraphMap>* graph = dynamic_cast<Data<GraphMap>*>(solver->findData("graph"));
+        SReal maxIter = 0;
+        if (!graph || !readScalar(solver, "iterations", maxIter) || maxIter <= 0)
+            continue;
+        const GraphMap& g = graph->getValue();
+        GraphMap::const_iterator it = g.find("Error");
+        if (it == g.end() || it->second.empty())
+            continue;
+        const SReal nbIter = (SReal)(it->second.size() - 1);
+        SReal tolerance = 0;
+        const bool converged = readScalar(solver, "tolerance", tolerance) && it->second.back() <= tolerance;
+        SReal r = nbIter / maxIter;
+        if (!converged && nbIter >= maxIter) r = std::max(r, (SReal)1) + 1;
+        ratio = std::max(ratio, r);
+    }
+
+    return ratio;
+}
+
+void AdaptiveTimeStepAnimationLoop::step(const sofa::core::ExecParams* params, SReal dt)
+{
+    if (!isComponentStateValid())
+        return;
+
+    if (dt == 0)
+        dt = this->gnode->getDt();
+
+
+    sofa::helper::AdvancedTimer::stepBegin("AnimationStep");
+#ifdef SOFA_DUMP_VISITOR_INFO
+    simulation::Visitor::printNode("Step");
+#endif
+
+    {
+        AnimateBeginEvent ev ( dt );
+        PropagateEventVisitor act ( params, &ev );
+        this->gnode->execute ( act );
+    }
+
+    const SReal startTime = this->gnode->getTime();
+    const SReal endTime = startTime + dt;
+
+    BehaviorUpdatePositionVisitor beh(params , dt);
+    this->gnode->execute ( beh );
+
+    UpdateInternalDataVisitor uid(params);
+    gnode->execute ( uid );
+
+    const SReal minDt = std::min(d_minDt.getValue(), dt);
+    const SReal maxDt = (d_maxDt.getValue() > 0) ? std::min(d_maxDt.getValue(), dt) : dt;
+    if (m_dt <= 0)
+        m_dt = maxDt;
+    m_dt = std::max(minDt, std::min(maxDt, m_dt));
+
+    // initialize a constraint params object with default MultiVecId for
+    // constraint jacobian, free positions, free velocity vectors
+    sofa::core::ConstraintParams cparams(*params);
+    sofa::core::MechanicalParams mparams(*params);
+
+    // Checkpoint of the independent states, restored when a sub-step is rejected
+    common::VectorOperations vop(params, this->getContext());
+    core::behavior::MultiVecCoord savedX(&vop);
+    core::behavior::MultiVecDeriv savedV(&vop);
+    core::behavior::MultiVecDeriv velocity(&vop, core::VecDerivId::velocity());
+
+    unsigned nbAccepted = d_nbAcceptedSteps.getValue();
+    unsigned nbRejected = d_nbRejectedSteps.getValue();
+    const unsigned maxSubSteps = d_maxSubSteps.getValue();
+
+    SReal time = startTime;
+    unsigned attempt = 0;
+    while (endTime - time > minDt * 1e-3)
+    {
+        // do not overshoot the end of the frame, but remember the controller's step.
+        // Once the budget of sub-steps is spent, the rest of the frame is done at once.
+        ++attempt;
+        const bool lastChance = (m_dt <= minDt) || (attempt >= maxSubSteps);
+        const SReal h = (attempt >= maxSubSteps) ? endTime - time : std::min(m_dt, endTime - time);
+
+        savedX.eq(core::VecCoordId::position());
+        savedV.eq(core::VecDerivId::velocity());
+
+        sofa::helper::AdvancedTimer::stepBegin("AdaptiveSubStep");
+        sofa::simulation::MechanicalResetConstraintVisitor(&cparams).execute(this->getContext());
+        computeCollision(params);
+        integrate(params, h);
+        sofa::helper::AdvancedTimer::stepEnd("AdaptiveSubStep");
+
+        const SReal ratio = computeIterationRatio();
+        const SReal v2 = velocity.dot(velocity);
+        const bool diverged = ratio > 1 || !std::isfinite(v2);
+        d_lastIterationRatio.setValue(ratio);
+
+        if (diverged && !lastChance)
+        {
+            // roll back and redo the sub-step with a smaller time step
+            vop.v_eq(core::VecCoordId::position(), savedX);
+            vop.v_eq(core::VecDerivId::velocity(), savedV);
+            sofa::simulation::MechanicalPropagateOnlyPositionAndVelocityVisitor(&mparams, time).execute(this->getContext());
+            m_dt = std::max(minDt, h * d_shrinkFactor.getValue());
+            ++nbRejected;
+            msg_info() << "sub-step of " << h << " rejected at time " << time << " (iteration ratio " << ratio << "), retrying with " << m_dt;
+            continue;
+        }
+
+        if (diverged)
+            msg_warning() << "sub-step of " << h << " at time " << time << " did not converge with the minimum time step or maximum number of sub-steps, accepting it anyway.";
+
+        ++nbAccepted;
+        time += h;
+        this->gnode->setTime ( time );
+        this->gnode->execute<UpdateSimulationContextVisitor>(params);  // propagate time
+
+        if (ratio < d_lowIterationRatio.getValue())
+            m_dt = std::min(maxDt, m_dt * d_growFactor.getValue());
+        else if (ratio > d_highIterationRatio.getValue())
+            m_dt = std::max(minDt, m_dt * d_shrinkFactor.getValue());
+    }
+    this->gnode->setTime ( endTime );
+    this->gnode->execute<UpdateSimulationContextVisitor>(params);
+
+    d_currentDt.setValue(m_dt);
+    d_nbAcceptedSteps.setValue(nbAccepted);
+    d_nbRejectedSteps.setValue(nbRejected);
+    sofa::helper::AdvancedTimer::valSet("AdaptiveDt", m_dt);
+
+    {
+        AnimateEndEvent ev ( dt );
+        PropagateEventVisitor act ( params, &ev );
+        this->gnode->execute ( act );
+    }
+
+    sofa::helper::AdvancedTimer::stepBegin("UpdateMapping");
+    //Visual Information update: Ray Pick add a MechanicalMapping used as VisualMapping
+    this->gnode->execute<UpdateMappingVisitor>(params);
+    sofa::helper::AdvancedTimer::step("UpdateMappingEndEvent");
+    {
+        UpdateMappingEndEvent ev ( dt );
+        PropagateEventVisitor act ( params , &ev );
+        this->gnode->execute ( act );
+    }
+    sofa::helper::AdvancedTimer::stepEnd("UpdateMapping");
+
+    if (!SOFA_NO_UPDATE_BBOX)
+    {
+        sofa::helper::AdvancedTimer::stepBegin("UpdateBBox");
+        this->gnode->execute<UpdateBoundingBoxVisitor>(params);
+        sofa::helper::AdvancedTimer::stepEnd("UpdateBBox");
+    }
+#ifdef SOFA_DUMP_VISITOR_INFO
+    simulation::Visitor::printCloseNode("Step");
+#endif
+
+    sofa::helper::AdvancedTimer::stepEnd("AnimationStep");
+}
+
+} // namespace animationloop
+
+} // namespace component
+
+} // namespace sofa
+
@@ -0,0 +1,104 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_COMPONENT_ANIMATIONLOOP_ADAPTIVETIMESTEPANIMATIONLOOP_H
+#define SOFA_COMPONENT_ANIMATIONLOOP_ADAPTIVETIMESTEPANIMATIONLOOP_H
+#include "config.h"
+
+#include <sofa/core/behavior/BaseAnimationLoop.h>
+#include <sofa/simulation/CollisionAnimationLoop.h>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace animationloop
+{
+
+/** Animation loop integrating each frame with a variable number of sub-steps whose size
+ *  is driven by the convergence of the solvers found in the scene.
+ *
+ *  After each sub-step, the iteration counts of the iterative linear solvers (read from
+ *  their "graph" output) are compared to their maximum number of iterations. When all of
+ *  them converged quickly the internal time step grows, when they needed many iterations
+ *  it shrinks. When a solver reached its maximum number of iterations, or when the
+ *  velocities became non-finite, the independent mechanical states are rolled back to the
+ *  beginning of the sub-step and the sub-step is redone with a smaller time step.
+ *
+ *  Constraint solvers are not supported: they are driven by FreeMotionAnimationLoop, which
+ *  this loop replaces. A scene containing a ConstraintSolver is rejected at init.
+ */
+class SOFA_GENERAL_ANIMATION_LOOP_API AdaptiveTimeStepAnimationLoop : public sofa::simulation::CollisionAnimationLoop
+{
+public:
+    typedef sofa::simulation::CollisionAnimationLoop Inherit;
+    SOFA_CLASS(AdaptiveTimeStepAnimationLoop, sofa::simulation::CollisionAnimationLoop);
+protected:
+    AdaptiveTimeStepAnimationLoop(simulation::Node* gnode);
+
+    ~AdaptiveTimeStepAnimationLoop() override;
+public:
+    void init() override;
+    void reset() override;
+
+    void step (const sofa::core::ExecParams* params, SReal dt) override;
+
+    /// Construction method called by ObjectFactory.
+    template<class T>
+    static typename T::SPtr create(T*, BaseContext* context, BaseObjectDescription* arg)
+    {
+        simulation::Node* gnode = dynamic_cast<simulation::Node*>(context);
+        typename T::SPtr obj = sofa::core::objectmodel::New<T>(gnode);
+        if (context) context->addObject(obj);
+        if (arg) obj->parse(arg);
+        return obj;
+    }
+
+    Data<SReal> d_minDt; ///< minimum internal time step
+    Data<SReal> d_maxDt; ///< maximum internal time step (0 means the frame time step)
+    Data<SReal> d_growFactor; ///< factor applied to the internal time step after a quickly converged sub-step
+    Data<SReal> d_shrinkFactor; ///< factor applied to the internal time step after a slowly converged or rejected sub-step
+    Data<SReal> d_lowIterationRatio; ///< the time step grows when iterations/maxIterations is below this ratio for all solvers
+    Data<SReal> d_highIterationRatio; ///< the time step shrinks when iterations/maxIterations is above this ratio for one solver
+    Data<unsigned> d_maxSubSteps; ///< maximum number of attempted sub-steps within one animation step
+
+    Data<SReal> d_currentDt; ///< OUTPUT: current internal time step
+    Data<SReal> d_lastIterationRatio; ///< OUTPUT: largest iterations/maxIterations ratio of the last sub-step
+    Data<unsigned> d_nbAcceptedSteps; ///< OUTPUT: total number of accepted sub-steps
+    Data<unsigned> d_nbRejectedSteps; ///< OUTPUT: total number of rejected (rolled back) sub-steps
+
+protected:
+    /// Returns the largest iterations/maxIterations ratio over the linear solvers of the scene,
+    /// or a value above 1 if one of them did not converge.
+    SReal computeIterationRatio();
+
+    SReal m_dt; ///< internal time step, before being clamped to the end of the frame
+};
+
+} // namespace animationloop
+
+} // namespace component
+
+} // namespace sofa
+
+#endif /* SOFA_COMPONENT_ANIMATIONLOOP_ADAPTIVETIMESTEPANIMATIONLOOP_H */
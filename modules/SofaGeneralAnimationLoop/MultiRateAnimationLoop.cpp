@@ -0,0 +1,292 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGeneralAnimationLoop/MultiRateAnimationLoop.h>
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/behavior/MultiVec.h>
+#include <sofa/simulation/VectorOperations.h>
+#include <sofa/simulation/MechanicalVisitor.h>
+#include <sofa/simulation/AnimateBeginEvent.h>
+#include <sofa/simulation/AnimateEndEvent.h>
+#include <sofa/simulation/IntegrateBeginEvent.h>
+#include <sofa/simulation/IntegrateEndEvent.h>
+#include <sofa/simulation/UpdateMappingEndEvent.h>
+#include <sofa/simulation/UpdateBoundingBoxVisitor.h>
+#include <sofa/simulation/PropagateEventVisitor.h>
+#include <sofa/simulation/BehaviorUpdatePositionVisitor.h>
+#include <sofa/simulation/UpdateInternalDataVisitor.h>
+#include <sofa/simulation/UpdateContextVisitor.h>
+#include <sofa/simulation/UpdateMappingVisitor.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <algorithm>
+
+
+using namespace sofa::simulation;
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace animationloop
+{
+
+int MultiRateAnimationLoopClass = core::RegisterObject("Multirate animation loop, each ODE solver is integrated with its own number of sub-steps within an animation step.")
+        .add< MultiRateAnimationLoop >()
+        ;
+
+namespace
+{
+
+/// Integration visitor restricted to a single ODE solver. The interaction force fields
+/// located above the solvers are still accumulated as external forces, as done by
+/// MechanicalIntegrationVisitor.
+class SingleSolverIntegrationVisitor : public MechanicalIntegrationVisitor
+{
+public:
+    SingleSolverIntegrationVisitor(const sofa::core::ExecParams* params, SReal dt, core::behavior::OdeSolver* target)
+        : MechanicalIntegrationVisitor(params, dt), target(target)
+    {
+    }
+
+    Result fwdOdeSolver(simulation::Node* node, core::behavior::OdeSolver* obj) override
+    {
+        if (obj != target)
+            return RESULT_PRUNE;
+        return MechanicalIntegrationVisitor::fwdOdeSolver(node, obj);
+    }
+
+    const char* getClassName() const override { return "SingleSolverIntegrationVisitor"; }
+
+protected:
+    core::behavior::OdeSolver* target;
+};
+
+} // anonymous namespace
+
+MultiRateAnimationLoop::MultiRateAnimationLoop(simulation::Node* gnode)
+    : Inherit(gnode)
+    , l_solvers( initLink("solvers", "ODE solvers integrated with a specific number of sub-steps") )
+    , d_substeps( initData(&d_substeps, "substeps", "number of sub-steps of each solver listed in \"solvers\" (other solvers use 1)") )
+{
+}
+
+MultiRateAnimationLoop::~MultiRateAnimationLoop()
+{
+}
+
+void MultiRateAnimationLoop::init()
+{
+    Inherit::init();
+
+    if (d_substeps.getValue().size() != l_solvers.size())
+    {
+        msg_warning() << l_solvers.size() << " solvers are linked but " << d_substeps.getValue().size()
+                      << " sub-step counts are given, missing counts default to 1.";
+    }
+    for (unsigned n : d_substeps.getValue())
+    {
+        if (n == 0)
+            msg_warning() << "a number of sub-steps of 0 is replaced by 1.";
+    }
+}
+
+helper::vector<MultiRateAnimationLoop::SolverRate> MultiRateAnimationLoop::collectSolvers()
+{
+    helper::vector<core::behavior::OdeSolver*> solvers;
+    this->gnode->getTreeObjects<core::behavior::OdeSolver>(&solvers);
+
+    const helper::vector<unsigned>& substeps = d_substeps.getValue();
+    helper::vector<SolverRate> result;
+    for (core::behavior::OdeSolver* solver : solvers)
+    {
+        simulation::Node* node = dynamic_cast<simulation::Node*>(solver->getContext());
+        if (!node) continue;
+
+        // solvers nested below another solver are driven by it
+        bool nested = false;
+        for (simulation::Node* parent = (node == this->gnode) ? nullptr : dynamic_cast<simulation::Node*>(node->getFirstParent());
+             parent && !nested; parent = (parent == this->gnode) ? nullptr : dynamic_cast<simulation::Node*>(parent->getFirstParent()))
+        {
+            nested = !parent->solver.empty();
+        }
+        if (nested) continue;
+
+        SolverRate rate;
+        rate.solver = solver;
+        rate.node = node;
+        rate.substeps = 1;
+        for (unsigned i = 0; i < l_solvers.size() && i < substeps.size(); ++i)
+        {
+            if (l_solvers.get(i) == solver)
+                rate.substeps = std::max(1u, substeps[i]);
+        }
+        result.push_back(rate);
+    }
+
+    std::stable_sort(result.begin(), result.end(), [](const SolverRate& a, const SolverRate& b) { return a.substeps < b.substeps; });
+    return result;
+}
+
+void MultiRateAnimationLoop::step(const sofa::core::ExecParams* params, SReal dt)
+{
+    if (dt == 0)
+        dt = this->gnode->getDt();
+
+
+    sofa::helper::AdvancedTimer::stepBegin("AnimationStep");
+#ifdef SOFA_DUMP_VISITOR_INFO
+    simulation::Visitor::printNode("Step");
+#endif
+
+    {
+        AnimateBeginEvent ev ( dt );
+        PropagateEventVisitor act ( params, &ev );
+        this->gnode->execute ( act );
+    }
+
+    const SReal startTime = this->gnode->getTime();
+
+    BehaviorUpdatePositionVisitor beh(params , dt);
+    this->gnode->execute ( beh );
+
+    UpdateInternalDataVisitor uid(params);
+    gnode->execute ( uid );
+
+    // initialize a constraint params object with default MultiVecId for
+    // constraint jacobian, free positions, free velocity vectors
+    sofa::core::ConstraintParams cparams(*params);
+    sofa::core::MechanicalParams mparams(*params);
+
+    sofa::simulation::MechanicalResetConstraintVisitor(&cparams).execute(this->getContext());
+    computeCollision(params);
+
+    const helper::vector<SolverRate> solvers = collectSolvers();
+
+    // States at the beginning and at the end of the animation step, used to interpolate
+    // the boundary states of the subsystems already advanced
+    common::VectorOperations vop(params, this->getContext());
+    core::behavior::MultiVecCoord x0(&vop), x1(&vop), xTmp(&vop);
+    core::behavior::MultiVecDeriv v0(&vop), v1(&vop), vTmp(&vop);
+    x0.eq(core::VecCoordId::position());
+    v0.eq(core::VecDerivId::velocity());
+
+    {
+        IntegrateBeginEvent evBegin;
+        PropagateEventVisitor eventPropagation( params, &evBegin);
+        eventPropagation.execute(getContext());
+    }
+
+    for (size_t s = 0; s < solvers.size(); ++s)
+    {
+        const SolverRate& current = solvers[s];
+        const SReal h = dt / current.substeps;
+
+        for (unsigned k = 0; k < current.substeps; ++k)
+        {
+            const SReal time = startTime + k * h;
+            // the sub-step integrates up to time+h: the boundary states are taken at that time
+            const SReal alpha = SReal(k + 1) / current.substeps;
+
+            // boundary states of the subsystems already advanced over the whole step
+            for (size_t c = 0; c < s; ++c)
+            {
+                common::VectorOperations vopc(params, solvers[c].node);
+                vopc.v_eq(xTmp, x0, 1 - alpha);
+                vopc.v_op(core::VecCoordId::position(), xTmp, x1, alpha);
+                vopc.v_eq(vTmp, v0, 1 - alpha);
+                vopc.v_op(core::VecDerivId::velocity(), vTmp, v1, alpha);
+                sofa::simulation::MechanicalPropagateOnlyPositionAndVelocityVisitor(&mparams, time + h).execute(solvers[c].node);
+            }
+
+            this->gnode->setTime ( time );
+            this->gnode->execute<UpdateSimulationContextVisitor>(params);  // propagate time
+
+            // external forces left by the coupling of the previous integrations
+            vop.v_clear(core::VecDerivId::externalForce());
+
+            sofa::helper::AdvancedTimer::stepBegin("MultiRateSubStep");
+            SingleSolverIntegrationVisitor act( params, h, current.solver );
+            act.execute( this->getContext() );
+            sofa::helper::AdvancedTimer::stepEnd("MultiRateSubStep");
+        }
+
+        common::VectorOperations vops(params, current.node);
+        vops.v_eq(x1, core::VecCoordId::position());
+        vops.v_eq(v1, core::VecDerivId::velocity());
+    }
+
+    // every subsystem ends the step at its own final state
+    for (size_t c = 0; c + 1 < solvers.size(); ++c)
+    {
+        common::VectorOperations vopc(params, solvers[c].node);
+        vopc.v_eq(core::VecCoordId::position(), x1);
+        vopc.v_eq(core::VecDerivId::velocity(), v1);
+        sofa::simulation::MechanicalPropagateOnlyPositionAndVelocityVisitor(&mparams, startTime + dt).execute(solvers[c].node);
+    }
+    vop.v_clear(core::VecDerivId::externalForce());
+
+    {
+        IntegrateEndEvent evEnd;
+        PropagateEventVisitor eventPropagation( params, &evEnd);
+        eventPropagation.execute(getContext());
+    }
+
+    this->gnode->setTime ( startTime + dt );
+    this->gnode->execute<UpdateSimulationContextVisitor>(params);  // propagate time
+
+    {
+        AnimateEndEvent ev ( dt );
+        PropagateEventVisitor act ( params, &ev );
+        this->gnode->execute ( act );
+    }
+
+    sofa::helper::AdvancedTimer::stepBegin("UpdateMapping");
+    //Visual Information update: Ray Pick add a MechanicalMapping used as VisualMapping
+    this->gnode->execute<UpdateMappingVisitor>(params);
+    sofa::helper::AdvancedTimer::step("UpdateMappingEndEvent");
+    {
+        UpdateMappingEndEvent ev ( dt );
+        PropagateEventVisitor act ( params , &ev );
+        this->gnode->execute ( act );
+    }
+    sofa::helper::AdvancedTimer::stepEnd("UpdateMapping");
+
+    if (!SOFA_NO_UPDATE_BBOX)
+    {
+        sofa::helper::AdvancedTimer::stepBegin("UpdateBBox");
+        this->gnode->execute<UpdateBoundingBoxVisitor>(params);
+        sofa::helper::AdvancedTimer::stepEnd("UpdateBBox");
+    }
+#ifdef SOFA_DUMP_VISITOR_INFO
+    simulation::Visitor::printCloseNode("Step");
+#endif
+
+    sofa::helper::AdvancedTimer::stepEnd("AnimationStep");
+}
+
+} // namespace animationloop
+
+} // namespace component
+
+} // namespace sofa
+
@@ -0,0 +1,102 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_COMPONENT_ANIMATIONLOOP_MULTIRATEANIMATIONLOOP_H
+#define SOFA_COMPONENT_ANIMATIONLOOP_MULTIRATEANIMATIONLOOP_H
+#include "config.h"
+
+#include <sofa/core/behavior/BaseAnimationLoop.h>
+#include <sofa/core/behavior/OdeSolver.h>
+#include <sofa/simulation/CollisionAnimationLoop.h>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace animationloop
+{
+
+/** Multirate animation loop: each ODE solver of the scene is integrated with its own
+ *  integer number of sub-steps within one animation step.
+ *
+ *  The solvers listed in "solvers" use the matching entry of "substeps", the others
+ *  use a single step. Solvers are advanced one after the other, from the coarsest to
+ *  the finest rate. While a solver is sub-stepping, the states of the solvers already
+ *  advanced over the whole animation step are linearly interpolated between their
+ *  values at the beginning and at the end of the step, at the end time of the current
+ *  sub-step, so that the interaction force fields coupling the subsystems see
+ *  consistent boundary states. States not advanced yet keep their values at the
+ *  beginning of the step (explicit coupling).
+ *
+ *  Interpolation is linear on the state vectors, which suits vector DOFs (positions of
+ *  deformable bodies); rigid DOFs coupled across rates should be integrated at the same
+ *  rate.
+ */
+class SOFA_GENERAL_ANIMATION_LOOP_API MultiRateAnimationLoop : public sofa::simulation::CollisionAnimationLoop
+{
+public:
+    typedef sofa::simulation::CollisionAnimationLoop Inherit;
+    SOFA_CLASS(MultiRateAnimationLoop, sofa::simulation::CollisionAnimationLoop);
+protected:
+    MultiRateAnimationLoop(simulation::Node* gnode);
+
+    ~MultiRateAnimationLoop() override;
+public:
+    void init() override;
+
+    void step (const sofa::core::ExecParams* params, SReal dt) override;
+
+    /// Construction method called by ObjectFactory.
+    template<class T>
+    static typename T::SPtr create(T*, BaseContext* context, BaseObjectDescription* arg)
+    {
+        simulation::Node* gnode = dynamic_cast<simulation::Node*>(context);
+        typename T::SPtr obj = sofa::core::objectmodel::New<T>(gnode);
+        if (context) context->addObject(obj);
+        if (arg) obj->parse(arg);
+        return obj;
+    }
+
+    typedef MultiLink<MultiRateAnimationLoop, core::behavior::OdeSolver, BaseLink::FLAG_STOREPATH> LinkSolvers;
+    LinkSolvers l_solvers; ///< ODE solvers integrated with a specific number of sub-steps
+    Data<helper::vector<unsigned> > d_substeps; ///< number of sub-steps of each solver listed in "solvers"
+
+protected:
+    struct SolverRate
+    {
+        core::behavior::OdeSolver* solver;
+        simulation::Node* node;
+        unsigned substeps;
+    };
+
+    /// Top-level ODE solvers of the scene with their number of sub-steps, coarsest first.
+    helper::vector<SolverRate> collectSolvers();
+};
+
+} // namespace animationloop
+
+} // namespace component
+
+} // namespace sofa
+
+#endif /* SOFA_COMPONENT_ANIMATIONLOOP_MULTIRATEANIMATIONLOOP_H */
@@ -0,0 +1,122 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaSimulationGraph/testing/BaseSimulationTest.h>
+using sofa::helper::testing::BaseSimulationTest;
+
+#include <SofaGeneralAnimationLoop/AdaptiveTimeStepAnimationLoop.h>
+using sofa::component::animationloop::AdaptiveTimeStepAnimationLoop;
+
+#include <SofaSimulationGraph/SimpleApi.h>
+
+#include <sstream>
+
+namespace
+{
+
+/// Zigzag chain of springs in gravity, its first particle being fixed.
+/// The springs couple the x and y directions, so CG needs several iterations.
+std::string chainScene(int cgIterations, const std::string& extra = "")
+{
+    std::stringstream scene;
+    scene << "<Node name='root' dt='0.01' gravity='0 -9.81 0'>\n"
+             "   <RequiredPlugin name='SofaComponentAll'/>\n"
+             "   <AdaptiveTimeStepAnimationLoop name='loop' minDt='0.0025' />\n"
+             "   <EulerImplicitSolver rayleighStiffness='0' rayleighMass='0' />\n"
+             "   <CGLinearSolver iterations='" << cgIterations << "' tolerance='1e-12' threshold='1e-20' />\n"
+          << extra <<
+             "   <MeshTopology position='0 0 0  1 1 0  2 0 0  3 1 0  4 0 0  5 1 0' edges='0 1  1 2  2 3  3 4  4 5' />\n"
+             "   <MechanicalObject />\n"
+             "   <UniformMass totalMass='1' />\n"
+             "   <FixedConstraint indices='0' />\n"
+             "   <MeshSpringForceField linesStiffness='10000' />\n"
+             "</Node>\n";
+    return scene.str();
+}
+
+struct AdaptiveTimeStepAnimationLoop_test : BaseSimulationTest
+{
+    void SetUp() override
+    {
+        sofa::simpleapi::importPlugin("SofaComponentAll");
+    }
+
+    AdaptiveTimeStepAnimationLoop* getLoop(SceneInstance& scene)
+    {
+        return dynamic_cast<AdaptiveTimeStepAnimationLoop*>(scene.root->getObject("loop"));
+    }
+};
+
+TEST_F(AdaptiveTimeStepAnimationLoop_test, convergedStepsAreAccepted)
+{
+    EXPECT_MSG_NOEMIT(Error, Warning);
+
+    SceneInstance scene("xml", chainScene(100));
+    scene.initScene();
+    AdaptiveTimeStepAnimationLoop* loop = getLoop(scene);
+    ASSERT_NE(loop, nullptr);
+
+    for (int i = 0; i < 5; ++i)
+        scene.simulate(0.01);
+
+    // the iterations of CG are read after each sub-step
+    EXPECT_GT(loop->d_lastIterationRatio.getValue(), 0);
+    EXPECT_LE(loop->d_lastIterationRatio.getValue(), 1);
+    EXPECT_EQ(loop->d_nbRejectedSteps.getValue(), 0u);
+    EXPECT_EQ(loop->d_nbAcceptedSteps.getValue(), 5u);
+    EXPECT_NEAR(scene.root->getTime(), 0.05, 1e-10);
+}
+
+TEST_F(AdaptiveTimeStepAnimationLoop_test, unconvergedStepsAreRolledBack)
+{
+    // CG stops at its maximum number of iterations without reaching the tolerance: the sub-steps are
+    // rejected until the minimum time step is reached, then accepted with a warning
+    EXPECT_MSG_EMIT(Warning);
+
+    SceneInstance scene("xml", chainScene(2));
+    scene.initScene();
+    AdaptiveTimeStepAnimationLoop* loop = getLoop(scene);
+    ASSERT_NE(loop, nullptr);
+
+    scene.simulate(0.01);
+
+    EXPECT_GT(loop->d_lastIterationRatio.getValue(), 1);
+    EXPECT_GT(loop->d_nbRejectedSteps.getValue(), 0u);
+    EXPECT_GE(loop->d_nbAcceptedSteps.getValue(), 4u);
+    EXPECT_NEAR(loop->d_currentDt.getValue(), 0.0025, 1e-10);
+    EXPECT_NEAR(scene.root->getTime(), 0.01, 1e-10);
+}
+
+TEST_F(AdaptiveTimeStepAnimationLoop_test, constraintSolversAreRejected)
+{
+    EXPECT_MSG_EMIT(Error);
+
+    SceneInstance scene("xml", chainScene(100, "   <GenericConstraintSolver />\n"));
+    scene.initScene();
+    AdaptiveTimeStepAnimationLoop* loop = getLoop(scene);
+    ASSERT_NE(loop, nullptr);
+    EXPECT_FALSE(loop->isComponentStateValid());
+
+    scene.simulate(0.01);
+    EXPECT_EQ(loop->d_nbAcceptedSteps.getValue(), 0u);
+}
+
+} // namespace
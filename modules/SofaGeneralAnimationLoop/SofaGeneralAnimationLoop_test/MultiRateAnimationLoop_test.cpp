@@ -0,0 +1,117 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaSimulationGraph/testing/BaseSimulationTest.h>
+using sofa::helper::testing::BaseSimulationTest;
+
+#include <SofaGeneralAnimationLoop/MultiRateAnimationLoop.h>
+using sofa::component::animationloop::MultiRateAnimationLoop;
+
+#include <sofa/core/behavior/OdeSolver.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/core/behavior/MultiVec.h>
+#include <sofa/simulation/VectorOperations.h>
+#include <sofa/simulation/Node.h>
+
+#include <SofaSimulationGraph/SimpleApi.h>
+
+namespace
+{
+
+using namespace sofa;
+
+/// Moves its subsystem at constant velocity, and records the position seen in another
+/// subsystem at each integration.
+class ConstantVelocitySolver : public core::behavior::OdeSolver
+{
+public:
+    SOFA_CLASS(ConstantVelocitySolver, core::behavior::OdeSolver);
+
+    core::behavior::BaseMechanicalState* watched {nullptr};
+    helper::vector<SReal> seenPositions;
+
+    void solve(const core::ExecParams* params, SReal dt, core::MultiVecCoordId xResult, core::MultiVecDerivId vResult) override
+    {
+        simulation::common::VectorOperations vop(params, this->getContext());
+        core::behavior::MultiVecCoord pos(&vop, xResult);
+        core::behavior::MultiVecDeriv vel(&vop, vResult);
+        pos.peq(vel, dt);
+        if (watched)
+            seenPositions.push_back(watched->getPX(0));
+    }
+};
+
+struct MultiRateAnimationLoop_test : BaseSimulationTest
+{
+    void SetUp() override
+    {
+        sofa::simpleapi::importPlugin("SofaComponentAll");
+    }
+};
+
+TEST_F(MultiRateAnimationLoop_test, boundaryStatesAreInterpolatedAtTheEndOfTheSubSteps)
+{
+    EXPECT_MSG_NOEMIT(Error, Warning);
+
+    SceneInstance scene("xml",
+                        "<Node name='root' dt='0.04' gravity='0 0 0'>\n"
+                        "   <RequiredPlugin name='SofaComponentAll'/>\n"
+                        "   <MultiRateAnimationLoop name='loop' />\n"
+                        "   <Node name='coarse'>\n"
+                        "       <MechanicalObject position='0 0 0' velocity='1 0 0' />\n"
+                        "   </Node>\n"
+                        "   <Node name='fine'>\n"
+                        "       <MechanicalObject position='0 0 0' />\n"
+                        "   </Node>\n"
+                        "</Node>\n");
+
+    simulation::Node* coarse = scene.root->getChild("coarse");
+    simulation::Node* fine = scene.root->getChild("fine");
+    ASSERT_NE(coarse, nullptr);
+    ASSERT_NE(fine, nullptr);
+
+    ConstantVelocitySolver::SPtr coarseSolver = core::objectmodel::New<ConstantVelocitySolver>();
+    coarse->addObject(coarseSolver);
+    ConstantVelocitySolver::SPtr fineSolver = core::objectmodel::New<ConstantVelocitySolver>();
+    fineSolver->watched = coarse->getMechanicalState();
+    fine->addObject(fineSolver);
+
+    MultiRateAnimationLoop* loop = dynamic_cast<MultiRateAnimationLoop*>(scene.root->getObject("loop"));
+    ASSERT_NE(loop, nullptr);
+    loop->l_solvers.add(fineSolver.get());
+    loop->d_substeps.setValue(helper::vector<unsigned>(1, 4));
+
+    scene.initScene();
+    scene.simulate(0.04);
+
+    // the coarse subsystem goes from 0 to 0.04 in one step. Each sub-step of the fine one
+    // integrates up to (k+1)*0.01 and must see the coarse position at that time.
+    const helper::vector<SReal>& seen = fineSolver->seenPositions;
+    ASSERT_EQ(seen.size(), 4u);
+    for (unsigned k = 0; k < 4; ++k)
+        EXPECT_NEAR(seen[k], 0.01 * (k + 1), 1e-12) << "sub-step " << k;
+
+    // at the end of the step every subsystem is at its own final state
+    EXPECT_NEAR(coarse->getMechanicalState()->getPX(0), 0.04, 1e-12);
+    EXPECT_NEAR(scene.root->getTime(), 0.04, 1e-12);
+}
+
+} // namespace
@@ -42,6 +42,10 @@ public:
     /// Inherited from MeshLoader
     bool load() override;
 
+    /// helper::io::XspLoader sets the process-wide C locale (TemporaryLocale), which is not
+    /// safe to change while other components are initialized concurrently
+    bool hasSelfContainedInit() const override { return false; }
+
 protected:
     MeshXspLoader();
 };
@@ -37,6 +37,8 @@ public:
 
         auto loader = sofa::simpleapi::createObject(root, "MeshXspLoader",
                                       {{"filename", std::string(SOFAGENERALLOADER_TESTFILES_DIR)+"test.xs3"}});
+        // the locale is changed while reading, it must not be initialized in parallel
+        EXPECT_FALSE(loader->hasSelfContainedInit());
         simulation->init(root.get());
 
         return true;
@@ -45,6 +45,10 @@ public:
     Data< defaulttype::Vector3 > d_scale; ///< Scale applied to sphere positions
     Data< defaulttype::Vector3 > d_translation; ///< Translation applied to sphere positions
     bool load() override;
+
+    /// The file is read with a process-wide C locale (TemporaryLocale), which is not safe
+    /// to change while other components are initialized concurrently
+    bool hasSelfContainedInit() const override { return false; }
 };
 
 } //loader
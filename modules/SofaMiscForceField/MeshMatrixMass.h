@@ -222,6 +222,9 @@ public:
     // -- Mass interface
     void addMDx(const core::MechanicalParams*, DataVecDeriv& f, const DataVecDeriv& dx, SReal factor) override;
 
+    /// The mass has no stiffness: $ df += mFactor M dx $ is computed in a single pass over the mass matrix
+    void addMBKdx(const core::MechanicalParams* mparams, core::MultiVecDerivId dfId) override;
+
     void accFromF(const core::MechanicalParams*, DataVecDeriv& a, const DataVecDeriv& f) override; // This function can't be used as it use M^-1
 
     void addForce(const core::MechanicalParams*, DataVecDeriv& f, const DataVecCoord& x, const DataVecDeriv& v) override;
@@ -428,6 +431,24 @@ protected:
     EdgeMassHandler* m_edgeMassHandler;
 
     sofa::core::topology::BaseMeshTopology* m_topology;
+
+    /// Rebuild the compressed mass matrix if the masses or the topology changed since the last build
+    void updateMassMatrix();
+
+    /// @name Mass matrix in compressed row storage, built from the vertex and edge masses.
+    /// The first entry of each row is the diagonal one.
+    /// @{
+    helper::vector<unsigned int> m_rowBegin;
+    helper::vector<unsigned int> m_columns;
+    helper::vector<MassType> m_values;
+    /// @}
+    /// Diagonal of the lumped mass matrix
+    helper::vector<MassType> m_lumpedMass;
+    /// Revisions of the masses and of the topology used to build the matrix
+    int m_vertexMassCounter;
+    int m_edgeMassCounter;
+    int m_topologyRevision;
+    Real m_builtLumpingCoeff;
 };
 
 #if  !defined(SOFA_COMPONENT_MASS_MESHMATRIXMASS_CPP)
@@ -38,6 +38,7 @@
 #include <SofaBaseTopology/QuadSetGeometryAlgorithms.h>
 #include <SofaBaseTopology/HexahedronSetGeometryAlgorithms.h>
 #include <sofa/simulation/AnimateEndEvent.h>
+#include <sofa/helper/IndexOpenMP.h>
 
 
 namespace sofa
@@ -71,6 +72,10 @@ MeshMatrixMass<DataTypes, MassType>::MeshMatrixMass()
     , m_vertexMassHandler(nullptr)
     , m_edgeMassHandler(nullptr)
     , m_topology(nullptr)
+    , m_vertexMassCounter(-1)
+    , m_edgeMassCounter(-1)
+    , m_topologyRevision(-1)
+    , m_builtLumpingCoeff(0)
 {
     f_graph.setWidget("graph");
 
@@ -1762,63 +1767,114 @@ void MeshMatrixMass<DataTypes, MassType>::clear()
 }
 
 
+template <class DataTypes, class MassType>
+void MeshMatrixMass<DataTypes, MassType>::updateMassMatrix()
+{
+    const int topologyRevision = m_topology ? m_topology->getRevision() : 0;
+    if (d_vertexMassInfo.getCounter() == m_vertexMassCounter && d_edgeMassInfo.getCounter() == m_edgeMassCounter
+        && topologyRevision == m_topologyRevision && m_massLumpingCoeff == m_builtLumpingCoeff)
+        return;
+
+    const MassVector &vertexMass = d_vertexMassInfo.getValue();
+    const MassVector &edgeMass = d_edgeMassInfo.getValue();
+    const size_t nbPoints = vertexMass.size();
+    const size_t nbEdges = m_topology ? std::min(edgeMass.size(), size_t(m_topology->getNbEdges())) : 0;
+
+    m_lumpedMass.resize(nbPoints);
+    for (size_t i = 0; i < nbPoints; ++i)
+        m_lumpedMass[i] = vertexMass[i] * m_massLumpingCoeff;
+
+    // count the entries of each row: the diagonal plus one per incident edge
+    m_rowBegin.assign(nbPoints + 1, 0);
+    for (size_t i = 0; i < nbPoints; ++i)
+        m_rowBegin[i + 1] = 1;
+    for (size_t j = 0; j < nbEdges; ++j)
+    {
+        const core::topology::BaseMeshTopology::Edge& e = m_topology->getEdge(j);
+        ++m_rowBegin[e[0] + 1];
+        ++m_rowBegin[e[1] + 1];
+    }
+    for (size_t i = 0; i < nbPoints; ++i)
+        m_rowBegin[i + 1] += m_rowBegin[i];
+
+    m_columns.resize(m_rowBegin[nbPoints]);
+    m_values.resize(m_rowBegin[nbPoints]);
+    helper::vector<unsigned int> next(m_rowBegin.begin(), m_rowBegin.end() - 1);
+    for (size_t i = 0; i < nbPoints; ++i)
+    {
+        m_columns[next[i]] = (unsigned int)i;
+        m_values[next[i]++] = vertexMass[i];
+    }
+    for (size_t j = 0; j < nbEdges; ++j)
+    {
+        const core::topology::BaseMeshTopology::Edge& e = m_topology->getEdge(j);
+        m_columns[next[e[0]]] = e[1];
+        m_values[next[e[0]]++] = edgeMass[j];
+        m_columns[next[e[1]]] = e[0];
+        m_values[next[e[1]]++] = edgeMass[j];
+    }
+
+    m_vertexMassCounter = d_vertexMassInfo.getCounter();
+    m_edgeMassCounter = d_edgeMassInfo.getCounter();
+    m_topologyRevision = topologyRevision;
+    m_builtLumpingCoeff = m_massLumpingCoeff;
+}
+
+
 // -- Mass interface
 template <class DataTypes, class MassType>
 void MeshMatrixMass<DataTypes, MassType>::addMDx(const core::MechanicalParams*, DataVecDeriv& vres, const DataVecDeriv& vdx, SReal factor)
 {
-    const MassVector &vertexMass= d_vertexMassInfo.getValue();
-    const MassVector &edgeMass= d_edgeMassInfo.getValue();
+    updateMassMatrix();
 
     helper::WriteAccessor< DataVecDeriv > res = vres;
     helper::ReadAccessor< DataVecDeriv > dx = vdx;
-
-    SReal massTotal = 0.0;
+    const Real f = Real(factor);
 
     //using a lumped matrix (default)-----
     if(d_lumping.getValue())
     {
-        for (size_t i=0; i<dx.size(); i++)
+        const size_t n = std::min(dx.size(), m_lumpedMass.size());
+        const MassType* lumpedMass = m_lumpedMass.data();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (helper::IndexOpenMP<size_t>::type i = 0; i < n; i++)
         {
-            res[i] += dx[i] * vertexMass[i] * m_massLumpingCoeff * Real(factor);
-            massTotal += vertexMass[i]*m_massLumpingCoeff * Real(factor);
+            res[i] += dx[i] * (lumpedMass[i] * f);
         }
-
     }
     //using a sparse matrix---------------
     else
     {
-        size_t nbEdges=m_topology->getNbEdges();
-        size_t v0,v1;
-
-        for (unsigned int i=0; i<dx.size(); i++)
+        // rows are independent: each one gathers the dx of its neighbors
+        const size_t n = std::min(dx.size(), m_rowBegin.size() - 1);
+        const unsigned int* rowBegin = m_rowBegin.data();
+        const unsigned int* columns = m_columns.data();
+        const MassType* values = m_values.data();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (helper::IndexOpenMP<size_t>::type i = 0; i < n; i++)
         {
-            res[i] += dx[i] * vertexMass[i] * Real(factor);
-            massTotal += vertexMass[i] * Real(factor);
+            Deriv sum = dx[i] * values[rowBegin[i]];
+            for (unsigned int k = rowBegin[i] + 1; k < rowBegin[i + 1]; ++k)
+                sum += dx[columns[k]] * values[k];
+            res[i] += sum * f;
         }
+    }
 
-        Real tempMass=0.0;
+    if(d_printMass.getValue())
+    {
+        SReal massTotal = 0.0;
+        for (const MassType& m : d_lumping.getValue() ? m_lumpedMass : m_values)
+            massTotal += m * Real(factor);
 
-        for (unsigned int j=0; j<nbEdges; ++j)
+        if (this->getContext()->getTime()==0.0)
         {
-            tempMass = edgeMass[j] * Real(factor);
-
-            v0=m_topology->getEdge(j)[0];
-            v1=m_topology->getEdge(j)[1];
-
-            res[v0] += dx[v1] * tempMass;
-            res[v1] += dx[v0] * tempMass;
-
-            massTotal += 2*edgeMass[j] * Real(factor);
+            msg_info() <<"Total Mass = "<<massTotal;
         }
-    }
 
-    if(d_printMass.getValue() && (this->getContext()->getTime()==0.0))
-    {
-        msg_info() <<"Total Mass = "<<massTotal;
-    }
-
-    if(d_printMass.getValue())
-    {
         std::map < std::string, sofa::helper::vector<double> >& graph = *f_graph.beginEdit();
         sofa::helper::vector<double>& graph_error = graph["Mass variations"];
         graph_error.push_back(massTotal+0.000001);
@@ -1828,6 +1884,17 @@ void MeshMatrixMass<DataTypes, MassType>::addMDx(const core::MechanicalParams*,
 }
 
 
+template <class DataTypes, class MassType>
+void MeshMatrixMass<DataTypes, MassType>::addMBKdx(const core::MechanicalParams* mparams, core::MultiVecDerivId dfId)
+{
+    const SReal mFactor = mparams->mFactorIncludingRayleighDamping(this->rayleighMass.getValue());
+    if (mFactor != 0.0)
+    {
+        addMDx(mparams, *dfId[this->mstate.get(mparams)].write(), *mparams->readDx(this->mstate), mFactor);
+    }
+}
+
+
 template <class DataTypes, class MassType>
 void MeshMatrixMass<DataTypes, MassType>::accFromF(const core::MechanicalParams* mparams, DataVecDeriv& a, const DataVecDeriv& f)
 {
@@ -1839,13 +1906,18 @@ void MeshMatrixMass<DataTypes, MassType>::accFromF(const core::MechanicalParams*
         return;
     }
 
+    updateMassMatrix();
+
     helper::WriteAccessor< DataVecDeriv > _a = a;
     const VecDeriv& _f = f.getValue();
-    const MassVector &vertexMass= d_vertexMassInfo.getValue();
+    const MassType* lumpedMass = m_lumpedMass.data();
 
-    for (unsigned int i=0; i<vertexMass.size(); i++)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<size_t>::type i = 0; i < m_lumpedMass.size(); i++)
     {
-        _a[i] = _f[i] / ( vertexMass[i] * m_massLumpingCoeff);
+        _a[i] = _f[i] / lumpedMass[i];
     }
 }
 
@@ -1858,9 +1930,9 @@ void MeshMatrixMass<DataTypes, MassType>::addForce(const core::MechanicalParams*
     if(this->m_separateGravity.getValue())
         return ;
 
-    helper::WriteAccessor< DataVecDeriv > f = vf;
+    updateMassMatrix();
 
-    const MassVector &vertexMass= d_vertexMassInfo.getValue();
+    helper::WriteAccessor< DataVecDeriv > f = vf;
 
     // gravity
     defaulttype::Vec3d g ( this->getContext()->getGravity() );
@@ -1868,8 +1940,13 @@ void MeshMatrixMass<DataTypes, MassType>::addForce(const core::MechanicalParams*
     DataTypes::set ( theGravity, g[0], g[1], g[2]);
 
     // add weight and inertia force
-    for (unsigned int i=0; i<f.size(); ++i)
-        f[i] += theGravity * vertexMass[i] * m_massLumpingCoeff;
+    const size_t n = std::min(f.size(), m_lumpedMass.size());
+    const MassType* lumpedMass = m_lumpedMass.data();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (helper::IndexOpenMP<size_t>::type i = 0; i < n; ++i)
+        f[i] += theGravity * lumpedMass[i];
 }
 
 
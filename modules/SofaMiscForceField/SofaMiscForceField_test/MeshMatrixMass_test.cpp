@@ -1281,6 +1281,61 @@ TEST_F(MeshMatrixMass3_test, singleHexahedron)
             expectedMass);
 }
 
+TEST_F(MeshMatrixMass3_test, addMDx_Tetrahedra)
+{
+    VecCoord positions;
+    positions.push_back(Coord(0.0f, 0.0f, 0.0f));
+    positions.push_back(Coord(1.0f, 0.0f, 0.0f));
+    positions.push_back(Coord(0.0f, 1.0f, 0.0f));
+    positions.push_back(Coord(0.0f, 0.0f, 1.0f));
+    positions.push_back(Coord(1.0f, 1.0f, 1.0f));
+
+    TetrahedronSetTopologyContainer::SPtr topologyContainer = New<TetrahedronSetTopologyContainer>();
+    topologyContainer->addTetra(0, 1, 2, 3);
+    topologyContainer->addTetra(1, 2, 3, 4);
+
+    TetrahedronSetGeometryAlgorithms<Vec3Types>::SPtr geometryAlgorithms
+        = New<TetrahedronSetGeometryAlgorithms<Vec3Types> >();
+
+    createSceneGraph(positions, topologyContainer, geometryAlgorithms);
+    simulation::getSimulation()->init(root.get());
+
+    const VecMass& vertexMass = mass->d_vertexMassInfo.getValue();
+    const VecMass& edgeMass = mass->d_edgeMassInfo.getValue();
+    const SReal factor = 2.0;
+
+    Vec3Types::VecDeriv dx;
+    for (size_t i = 0; i < positions.size(); ++i)
+        dx.push_back(Vec3Types::Deriv(i + 1.0, 2.0 - i, 0.5 * i));
+
+    // reference product, computed from the vertex and edge masses
+    Vec3Types::VecDeriv expected(dx.size());
+    for (size_t i = 0; i < dx.size(); ++i)
+        expected[i] = dx[i] * vertexMass[i] * factor;
+    for (size_t j = 0; j < topologyContainer->getNbEdges(); ++j)
+    {
+        const auto& e = topologyContainer->getEdge(j);
+        expected[e[0]] += dx[e[1]] * edgeMass[j] * factor;
+        expected[e[1]] += dx[e[0]] * edgeMass[j] * factor;
+    }
+
+    core::objectmodel::Data<Vec3Types::VecDeriv> vdx, vres;
+    vdx.setValue(dx);
+    vres.setValue(Vec3Types::VecDeriv(dx.size()));
+    mass->addMDx(core::MechanicalParams::defaultInstance(), vres, vdx, factor);
+    for (size_t i = 0; i < dx.size(); ++i)
+        for (unsigned c = 0; c < 3; ++c)
+            EXPECT_NEAR(expected[i][c], vres.getValue()[i][c], 1e-12);
+
+    // lumped mass: diagonal product
+    mass->d_lumping.setValue(true);
+    vres.setValue(Vec3Types::VecDeriv(dx.size()));
+    mass->addMDx(core::MechanicalParams::defaultInstance(), vres, vdx, factor);
+    for (size_t i = 0; i < dx.size(); ++i)
+        for (unsigned c = 0; c < 3; ++c)
+            EXPECT_NEAR(dx[i][c] * vertexMass[i] * 2.5 * factor, vres.getValue()[i][c], 1e-12);
+}
+
 TEST_F(MeshMatrixMass3_test, check_DefaultAttributes_Hexa){
     check_DefaultAttributes_Hexa() ;
 }
@@ -0,0 +1,178 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaMiscMapping/BarycentricMappingRigid.h>
+#include <SofaBaseTopology/TriangleSetTopologyContainer.h>
+#include <sofa/helper/io/PrecomputedDataCache.h>
+#include <sofa/helper/system/FileSystem.h>
+
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest ;
+
+#include <boost/filesystem.hpp>
+
+#include <memory>
+
+using sofa::helper::io::PrecomputedDataCache ;
+using sofa::helper::system::FileSystem ;
+using sofa::component::topology::TriangleSetTopologyContainer ;
+
+namespace sofa {
+namespace {
+
+/// Mapper exposing the state of its nearest element search
+template <class In, class Out>
+struct CachedTriangleMapper : public component::mapping::BarycentricMapperTriangleSetTopology<In,Out>
+{
+    typedef component::mapping::BarycentricMapperTriangleSetTopology<In,Out> Inherit;
+
+    CachedTriangleMapper(TriangleSetTopologyContainer* topology) : Inherit(topology, nullptr) {}
+
+    using Inherit::d_map;
+    using Inherit::m_hashTable;
+};
+
+/**  Test the reuse of the nearest elements of a barycentric mapper through the precomputed
+ * data cache, for the output types whose coordinates are not only positions.
+ */
+template <class Out>
+struct BarycentricMapperCache_test : public BaseTest
+{
+    typedef defaulttype::Vec3Types In;
+    typedef CachedTriangleMapper<In,Out> Mapper;
+
+    std::string directory = boost::filesystem::temp_directory_path().string() + "/BarycentricMapperCache_test";
+
+    In::VecCoord m_in;
+    typename Out::VecCoord m_out;
+    TriangleSetTopologyContainer::SPtr m_topology;
+
+    void SetUp() override
+    {
+        if (FileSystem::exists(directory))
+            FileSystem::removeAll(directory);
+        PrecomputedDataCache::setDirectory(directory);
+
+        // a 2x2 grid of squares split in triangles
+        for (int j=0; j<=2; j++)
+            for (int i=0; i<=2; i++)
+                m_in.push_back(defaulttype::Vector3(i, j, 0));
+        m_topology = core::objectmodel::New<TriangleSetTopologyContainer>();
+        for (int j=0; j<2; j++)
+            for (int i=0; i<2; i++)
+            {
+                const int v = i + 3*j;
+                m_topology->addTriangle(v, v+1, v+4);
+                m_topology->addTriangle(v, v+4, v+3);
+            }
+
+        m_out.resize(5);
+        for (unsigned int i=0; i<m_out.size(); i++)
+            Out::setCPos(m_out[i], defaulttype::Vector3(0.1 + 0.45*i, 1.9 - 0.4*i, 0.1*i));
+    }
+
+    void TearDown() override
+    {
+        PrecomputedDataCache::setDirectory("");
+        if (FileSystem::exists(directory))
+            FileSystem::removeAll(directory);
+    }
+
+    std::unique_ptr<Mapper> initMapper(const typename Out::VecCoord& out)
+    {
+        std::unique_ptr<Mapper> mapper(new Mapper(m_topology.get()));
+        mapper->init(out, m_in);
+        return mapper;
+    }
+
+    std::size_t nbCacheFiles()
+    {
+        std::vector<std::string> files;
+        FileSystem::listDirectory(directory, files);
+        return files.size();
+    }
+
+    void sameResultFromCache()
+    {
+        std::unique_ptr<Mapper> computed = initMapper(m_out);
+        EXPECT_FALSE(computed->m_hashTable.empty());
+        EXPECT_EQ(1u, nbCacheFiles());
+
+        // the second mapper finds the result of the first one and skips the search
+        std::unique_ptr<Mapper> cached = initMapper(m_out);
+        EXPECT_TRUE(cached->m_hashTable.empty());
+        EXPECT_EQ(1u, nbCacheFiles());
+        EXPECT_EQ(m_out.size(), cached->d_map.getValue().size());
+        EXPECT_EQ(computed->d_map.getValueString(), cached->d_map.getValueString());
+    }
+
+    void movedPointsAreSearchedAgain()
+    {
+        initMapper(m_out);
+
+        typename Out::VecCoord moved = m_out;
+        Out::setCPos(moved[0], defaulttype::Vector3(1.9, 0.1, 0.0));
+        std::unique_ptr<Mapper> mapper = initMapper(moved);
+        EXPECT_FALSE(mapper->m_hashTable.empty());
+        EXPECT_EQ(2u, nbCacheFiles());
+    }
+};
+
+typedef BarycentricMapperCache_test<defaulttype::Vec3Types> BarycentricMapperCache_test_Vec3;
+typedef BarycentricMapperCache_test<defaulttype::Rigid3Types> BarycentricMapperCache_test_Rigid3;
+
+TEST_F(BarycentricMapperCache_test_Vec3, sameResultFromCache)
+{
+    sameResultFromCache();
+}
+
+TEST_F(BarycentricMapperCache_test_Vec3, movedPointsAreSearchedAgain)
+{
+    movedPointsAreSearchedAgain();
+}
+
+TEST_F(BarycentricMapperCache_test_Rigid3, sameResultFromCache)
+{
+    sameResultFromCache();
+}
+
+TEST_F(BarycentricMapperCache_test_Rigid3, movedPointsAreSearchedAgain)
+{
+    movedPointsAreSearchedAgain();
+}
+
+/// Only the positions of the rigid frames are used to find their element:
+/// the result of the search is reused when the frames are rotated
+TEST_F(BarycentricMapperCache_test_Rigid3, orientationIsNotPartOfTheKey)
+{
+    std::unique_ptr<Mapper> computed = initMapper(m_out);
+
+    defaulttype::Rigid3Types::VecCoord rotated = m_out;
+    for (unsigned int i=0; i<rotated.size(); i++)
+        rotated[i].getOrientation() = defaulttype::Quat(defaulttype::Vector3(0, 0, 1), 0.3*(i+1));
+    std::unique_ptr<Mapper> cached = initMapper(rotated);
+    EXPECT_TRUE(cached->m_hashTable.empty());
+    EXPECT_EQ(1u, nbCacheFiles());
+    EXPECT_EQ(computed->d_map.getValueString(), cached->d_map.getValueString());
+}
+
+} // namespace
+} // namespace sofa
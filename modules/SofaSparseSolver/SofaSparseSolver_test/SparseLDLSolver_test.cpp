@@ -0,0 +1,115 @@
+/******************************************************************************
+*       SOFA, Simulation Open-Framework Architecture, development version     *
+*                (c) 2006-2019 INRIA, USTL, UJF, CNRS, MGH                    *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest ;
+
+#include <SofaSparseSolver/SparseLDLSolver.h>
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
+#include <SofaBaseLinearSolver/FullVector.h>
+
+#include <cmath>
+
+namespace sofa {
+
+using component::linearsolver::SparseLDLSolver ;
+using component::linearsolver::CompressedRowSparseMatrix ;
+using component::linearsolver::FullVector ;
+
+struct SparseLDLSolver_test : public BaseTest
+{
+    typedef CompressedRowSparseMatrix<double> Matrix;
+    typedef FullVector<double> Vector;
+    typedef SparseLDLSolver<Matrix, Vector> Solver;
+
+    Matrix M;
+    Vector b;
+
+    void SetUp() override
+    {
+        // symmetric positive definite tridiagonal system
+        const int n = 200;
+        M.resize(n, n);
+        b.resize(n);
+        for (int i = 0; i < n; ++i)
+        {
+            M.add(i, i, 4.0 + 1e-3 * i);
+            if (i > 0) M.add(i, i-1, -1.0);
+            if (i < n-1) M.add(i, i+1, -1.0);
+            b[i] = std::sin(0.1 * i);
+        }
+        M.compress();
+    }
+
+    /// ||b - Mx|| / ||b||
+    double relativeResidual(const Vector& x)
+    {
+        double r2 = 0, b2 = 0;
+        for (int i = 0; i < M.rowSize(); ++i)
+        {
+            double r = b[i];
+            for (int j = std::max(0, i-1); j <= std::min(int(M.colSize())-1, i+1); ++j)
+                r -= M.element(i, j) * x[j];
+            r2 += r * r;
+            b2 += b[i] * b[i];
+        }
+        return std::sqrt(r2 / b2);
+    }
+
+    Vector solve(bool mixedPrecision, bool printLog)
+    {
+        Solver::SPtr solver = core::objectmodel::New<Solver>();
+        solver->d_mixedPrecision.setValue(mixedPrecision);
+        solver->f_printLog.setValue(printLog);
+        Vector x(b.size());
+        solver->invert(M);
+        solver->solve(M, x, b);
+        return x;
+    }
+};
+
+TEST_F(SparseLDLSolver_test, mixedPrecisionReachesDoublePrecisionAccuracy)
+{
+    // a warning would mean that the refinement failed and the solver fell back to double
+    EXPECT_MSG_NOEMIT(Warning, Error);
+
+    const Vector xDouble = solve(false, false);
+    const Vector xMixed = solve(true, false);
+
+    EXPECT_LT(relativeResidual(xDouble), 1e-12);
+    EXPECT_LT(relativeResidual(xMixed), 1e-11);
+    for (int i = 0; i < b.size(); ++i)
+        EXPECT_NEAR(xMixed[i], xDouble[i], 1e-10);
+}
+
+TEST_F(SparseLDLSolver_test, refinementIsOnlyLoggedWithPrintLog)
+{
+    {
+        EXPECT_MSG_NOEMIT(Info);
+        solve(true, false);
+    }
+    {
+        EXPECT_MSG_EMIT(Info);
+        solve(true, true);
+    }
+}
+
+}// namespace sofa
@@ -66,6 +66,9 @@ public :
     Data<bool> f_saveMatrixToFile;      ///< save matrix to a text file (can be very slow, as full matrix is stored)
     sofa::core::objectmodel::DataFileName d_filename;   ///< file where this matrix will be saved
     Data<int> d_precision;      ///< number of digits used to save system's matrix, default is 6
+    Data<bool> d_mixedPrecision; ///< factorize in single precision and recover the accuracy with iterative refinement
+    Data<int> d_refinementMaxIter; ///< maximum number of iterative refinement steps in mixed precision
+    Data<Real> d_refinementTolerance; ///< relative residual reached by the iterative refinement in mixed precision
 
     MatrixInvertData * createInvertData() override {
         return new InvertData();
@@ -76,6 +79,9 @@ protected :
 
     FullMatrix<Real> Jminv,Jdense;
     sofa::component::linearsolver::CompressedRowSparseMatrix<Real> Mfiltered;
+
+    /// false once the iterative refinement failed: the next factorizations are done in double precision
+    bool m_useMixedPrecision;
 };
 
 #if  !defined(SOFA_COMPONENT_LINEARSOLVER_SPARSELDLSOLVER_CPP)
@@ -49,11 +49,36 @@ SparseLDLSolver<TMatrix,TVector,TThreadManager>::SparseLDLSolver()
     , f_saveMatrixToFile( initData(&f_saveMatrixToFile, false, "savingMatrixToFile", "save matrix to a text file (can be very slow, as full matrix is stored"))
     , d_filename( initData(&d_filename, std::string("MatrixInLDL_%04d.txt"),"savingFilename", "Name of file where system matrix (mass, stiffness and damping) will be stored."))
     , d_precision( initData(&d_precision, 6, "savingPrecision", "Number of digits used to store system's matrix. Default is 6."))
+    , d_mixedPrecision( initData(&d_mixedPrecision, false, "mixedPrecision", "Factorize the matrix in single precision (half the memory of the factors) and recover the accuracy with iterative refinement. Falls back to a double precision factorization if the refinement does not converge."))
+    , d_refinementMaxIter( initData(&d_refinementMaxIter, 10, "refinementMaxIter", "Maximum number of iterative refinement steps in mixed precision"))
+    , d_refinementTolerance( initData(&d_refinementTolerance, (Real)1e-12, "refinementTolerance", "Relative residual ||b-Ax||/||b|| to reach with the iterative refinement in mixed precision"))
+    , m_useMixedPrecision(true)
 {}
 
 template<class TMatrix, class TVector, class TThreadManager>
 void SparseLDLSolver<TMatrix,TVector,TThreadManager>::solve (Matrix& M, Vector& z, Vector& r) {
-    Inherit::solve_cpu(&z[0],&r[0],(InvertData *) this->getMatrixInvertData(&M));
+    InvertData * data = (InvertData *) this->getMatrixInvertData(&M);
+
+    if (data->single_precision_factor)
+    {
+        int nbIterations = 0;
+        Real residual = 0;
+        if (Inherit::solve_refined(&z[0],&r[0],data,d_refinementMaxIter.getValue(),d_refinementTolerance.getValue(),nbIterations,residual))
+        {
+            msg_info_when(this->f_printLog.getValue()) << "Mixed precision solve converged in " << nbIterations << " refinement steps (relative residual " << residual << ")" ;
+            return;
+        }
+
+        msg_warning() << "Iterative refinement did not converge (relative residual " << residual << " after " << nbIterations
+                      << " steps), the system is now factorized in double precision" ;
+        m_useMixedPrecision = false;
+
+        // Mfiltered still holds the matrix factorized in invert
+        Inherit::factorize(data->n,(int *) &Mfiltered.getRowBegin()[0],(int *) &Mfiltered.getColsIndex()[0],
+                           (Real *) &Mfiltered.getColsValue()[0],data,false);
+    }
+
+    Inherit::solve_cpu(&z[0],&r[0],data);
 }
 
 template<class TMatrix, class TVector, class TThreadManager>
@@ -88,7 +113,8 @@ void SparseLDLSolver<TMatrix,TVector,TThreadManager>::invert(Matrix& M) {
         return ;
     }
 
-    Inherit::factorize(n,M_colptr,M_rowind,M_values,(InvertData *) this->getMatrixInvertData(&M));
+    Inherit::factorize(n,M_colptr,M_rowind,M_values,(InvertData *) this->getMatrixInvertData(&M),
+                       d_mixedPrecision.getValue() && m_useMixedPrecision);
 
     numStep++;
 }
@@ -115,27 +141,36 @@ bool SparseLDLSolver<TMatrix,TVector,TThreadManager>::addJMInvJtLocal(TMatrix *
         }
     }
 
-    //Solve the lower triangular system
-    for (unsigned c=0;c<(unsigned)J->rowSize();c++) {
-        Real * line = Jdense[c];
-
-        for (int j=0; j<data->n; j++) {
-            for (int p = data->LT_colptr[j] ; p<data->LT_colptr[j+1] ; p++) {
-                int col = data->LT_rowind[p];
-                double val = data->LT_values[p];
-                line[j] -= val * line[col];
+    // the factors are used in the precision they are stored in (no refinement here)
+    auto solveLowerAndApplyDiagonal = [&](const auto * LT_values, const auto * invD)
+    {
+        //Solve the lower triangular system
+        for (unsigned c=0;c<(unsigned)J->rowSize();c++) {
+            Real * line = Jdense[c];
+
+            for (int j=0; j<data->n; j++) {
+                for (int p = data->LT_colptr[j] ; p<data->LT_colptr[j+1] ; p++) {
+                    int col = data->LT_rowind[p];
+                    double val = LT_values[p];
+                    line[j] -= val * line[col];
+                }
             }
         }
-    }
 
-    //apply diagonal
-    for (unsigned j=0; j<(unsigned)J->rowSize(); j++) {
-        Real * lineD = Jdense[j];
-        Real * lineM = Jminv[j];
-        for (unsigned i=0;i<(unsigned)J->colSize();i++) {
-            lineM[i] = lineD[i] * data->invD[i];
+        //apply diagonal
+        for (unsigned j=0; j<(unsigned)J->rowSize(); j++) {
+            Real * lineD = Jdense[j];
+            Real * lineM = Jminv[j];
+            for (unsigned i=0;i<(unsigned)J->colSize();i++) {
+                lineM[i] = lineD[i] * invD[i];
+            }
         }
-    }
+    };
+
+    if (data->single_precision_factor)
+        solveLowerAndApplyDiagonal(data->LT_values_f.data(), data->invD_f.data());
+    else
+        solveLowerAndApplyDiagonal(data->LT_values.data(), data->invD.data());
 
     for (unsigned j=0; j<(unsigned)J->rowSize(); j++) {
         Real * lineJ = Jminv[j];
@@ -26,6 +26,9 @@
 #include <sofa/core/behavior/LinearSolver.h>
 #include <SofaBaseLinearSolver/MatrixLinearSolver.h>
 
+#include <cmath>
+#include <limits>
+
 extern "C" {
 #include <metis.h>
 }
@@ -49,6 +52,10 @@ public :
     VecReal P_values,L_values,LT_values,invD;
     helper::vector<int> Parent;
     bool new_factorization_needed;
+
+    // single precision factors, used instead of L_values, LT_values and invD when single_precision_factor is true
+    helper::vector<float> L_values_f,LT_values_f,invD_f;
+    bool single_precision_factor = false;
 };
 
 inline void CSPARSE_symbolic (int n,int * M_colptr,int * M_rowind,int * colptr,int * perm,int * invperm,int * Parent, int * Flag, int * Lnz)
@@ -168,35 +175,93 @@ protected :
 
     template<class VecInt,class VecReal>
     void solve_cpu(Real * x,const Real * b,SparseLDLImplInvertData<VecInt,VecReal> * data) {
-        int n = data->n;
-        const Real * invD = data->invD.data();
-        const int * perm = data->perm.data();
-        const int * L_colptr = data->L_colptr.data();
-        const int * L_rowind = data->L_rowind.data();
-        const Real * L_values = data->L_values.data();
-        const int * LT_colptr = data->LT_colptr.data();
-        const int * LT_rowind = data->LT_rowind.data();
-        const Real * LT_values = data->LT_values.data();
-
-        Tmp.clear();
-        Tmp.fastResize(n);
+        LDL_solve(x,b,data->n,data->perm.data(),data->L_colptr.data(),data->L_rowind.data(),data->L_values.data(),
+                  data->LT_colptr.data(),data->LT_rowind.data(),data->LT_values.data(),data->invD.data(),Tmp);
+    }
+
+    /// Solve with the single precision factorization, then recover the accuracy of Real with
+    /// iterative refinement, the residual being computed with the matrix P kept in data.
+    /// @return false if the relative residual does not reach the tolerance in maxIterations,
+    /// or stops decreasing. In that case the matrix must be factorized in double precision.
+    template<class VecInt,class VecReal>
+    bool solve_refined(Real * x,const Real * b,SparseLDLImplInvertData<VecInt,VecReal> * data,int maxIterations,Real tolerance,int & nbIterations,Real & residual) {
+        const int n = data->n;
+        const int * P_colptr = data->P_colptr.data();
+        const int * P_rowind = data->P_rowind.data();
+        const Real * P_values = data->P_values.data();
+
+        nbIterations = 0;
+        residual = 0;
+
+        Real normB = 0;
+        for (int i = 0 ; i < n ; i++) normB += b[i] * b[i];
+        normB = std::sqrt(normB);
+        if (normB == 0) {
+            for (int i = 0 ; i < n ; i++) x[i] = 0;
+            return true;
+        }
+
+        R.resize(n);
+        R_f.resize(n);
+        DX_f.resize(n);
+
+        // initial solution
+        for (int i = 0 ; i < n ; i++) R_f[i] = (float) (b[i] / normB);
+        LDL_solve(DX_f.data(),R_f.data(),n,data->perm.data(),data->L_colptr.data(),data->L_rowind.data(),data->L_values_f.data(),
+                  data->LT_colptr.data(),data->LT_rowind.data(),data->LT_values_f.data(),data->invD_f.data(),Tmp_f);
+        for (int i = 0 ; i < n ; i++) x[i] = DX_f[i] * normB;
+
+        Real previousResidual = std::numeric_limits<Real>::max();
+        for (;;) {
+            // r = b - P x, in the precision of the system
+            Real normR = 0;
+            for (int i = 0 ; i < n ; i++) {
+                Real acc = b[i];
+                for (int p = P_colptr[i] ; p < P_colptr[i+1] ; p++) acc -= P_values[p] * x[P_rowind[p]];
+                R[i] = acc;
+                normR += acc * acc;
+            }
+            normR = std::sqrt(normR);
+            residual = normR / normB;
+
+            if (residual <= tolerance) return true;
+            // the comparison with the previous residual also catches NaN
+            if (nbIterations >= maxIterations || !(residual < previousResidual)) return false;
+
+            previousResidual = residual;
+            ++nbIterations;
+
+            // dx = A^-1 r with the single precision factor, on the normalized residual to stay in the float range
+            for (int i = 0 ; i < n ; i++) R_f[i] = (float) (R[i] / normR);
+            LDL_solve(DX_f.data(),R_f.data(),n,data->perm.data(),data->L_colptr.data(),data->L_rowind.data(),data->L_values_f.data(),
+                      data->LT_colptr.data(),data->LT_rowind.data(),data->LT_values_f.data(),data->invD_f.data(),Tmp_f);
+            for (int i = 0 ; i < n ; i++) x[i] += DX_f[i] * normR;
+        }
+    }
+
+    /// forward/backward substitutions with the factors L, D and the permutation perm
+    template<class T, class TIn, class TOut>
+    static void LDL_solve(TOut * x,const TIn * b,int n,const int * perm,const int * L_colptr,const int * L_rowind,const T * L_values,
+                          const int * LT_colptr,const int * LT_rowind,const T * LT_values,const T * invD,helper::vector<T> & tmp) {
+        tmp.clear();
+        tmp.fastResize(n);
 
         for (int j = 0 ; j < n ; j++) {
-            Real acc = b[perm[j]];
+            T acc = b[perm[j]];
             for (int p = LT_colptr [j] ; p < LT_colptr[j+1] ; p++) {
-                acc -= LT_values[p] * Tmp[LT_rowind[p]];
+                acc -= LT_values[p] * tmp[LT_rowind[p]];
             }
-            Tmp[j] = acc;
+            tmp[j] = acc;
         }
 
         for (int j = n-1 ; j >= 0 ; j--) {
-            Tmp[j] *= invD[j];
+            tmp[j] *= invD[j];
 
             for (int p = L_colptr[j] ; p < L_colptr[j+1] ; p++) {
-                Tmp[j] -= L_values[p] * Tmp[L_rowind[p]];
+                tmp[j] -= L_values[p] * tmp[L_rowind[p]];
             }
 
-            x[perm[j]] = Tmp[j];
+            x[perm[j]] = tmp[j];
         }
     }
 
@@ -272,14 +337,77 @@ protected :
         CSPARSE_symbolic(n,M_colptr,M_rowind,colptr,perm,invperm,Parent,Flag.data(),Lnz.data());
     }
 
-    void LDL_numeric(int n,int * M_colptr,int * M_rowind,Real * M_values,int * colptr,int * rowind,Real * values,Real * D,int * perm,int * invperm,int * Parent) {
+    template<class T>
+    void LDL_numeric(int n,int * M_colptr,int * M_rowind,T * M_values,int * colptr,int * rowind,T * values,T * D,int * perm,int * invperm,int * Parent,helper::vector<T> & Y) {
         Y.resize(n);
 
-        CSPARSE_numeric<Real>(n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,perm,invperm,Parent,Flag.data(),Lnz.data(),Pattern.data(),Y.data());
+        CSPARSE_numeric<T>(n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,perm,invperm,Parent,Flag.data(),Lnz.data(),Pattern.data(),Y.data());
+    }
+
+    void LDL_numeric(int n,int * M_colptr,int * M_rowind,Real * M_values,int * colptr,int * rowind,Real * values,Real * D,int * perm,int * invperm,int * Parent) {
+        LDL_numeric<Real>(n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,perm,invperm,Parent,Y);
+    }
+
+    /// Numeric factorization in the precision T, followed by the inversion of D and the transposition of L
+    /// @return false if a pivot is null or not finite
+    template<class VecInt,class VecReal,class T>
+    bool LDL_numeric_and_transpose(int * M_colptr,int * M_rowind,T * M_values,SparseLDLImplInvertData<VecInt,VecReal> * data,
+                                   helper::vector<T> & values,helper::vector<T> & tran_values,helper::vector<T> & D,helper::vector<T> & Y) {
+        values.fastResize(data->L_nnz);
+        tran_values.fastResize(data->L_nnz);
+        D.fastResize(data->n);
+
+        //Numeric Factorization
+        LDL_numeric<T>(data->n,M_colptr,M_rowind,M_values,data->L_colptr.data(),data->L_rowind.data(),values.data(),D.data(),
+                       data->perm.data(),data->invperm.data(),data->Parent.data(),Y);
+
+        //inverse the diagonal
+        bool valid = true;
+        for (int i=0;i<data->n;i++) {
+            D[i] = 1.0/D[i];
+            if (!std::isfinite(D[i])) valid = false;
+        }
+
+        int * rowind = data->L_rowind.data();
+        int * colptr = data->L_colptr.data();
+        int * tran_rowind = data->LT_rowind.data();
+        int * tran_colptr = data->LT_colptr.data();
+
+        // split the bloc diag in data->Bdiag
+
+        if (data->new_factorization_needed) {
+            //Compute transpose in tran_colptr, tran_rowind, tran_values, tran_D
+            tran_countvec.clear();
+            tran_countvec.resize(data->n);
+
+            //First we count the number of value on each row.
+            for (int j=0;j<data->L_nnz;j++) tran_countvec[rowind[j]]++;
+
+            //Now we make a scan to build tran_colptr
+            tran_colptr[0] = 0;
+            for (int j=0;j<data->n;j++) tran_colptr[j+1] = tran_colptr[j] + tran_countvec[j];
+        }
+
+        //we clear tran_countvec becaus we use it now to stro hown many value are written on each line
+        tran_countvec.clear();
+        tran_countvec.resize(data->n);
+
+        for (int j=0;j<data->n;j++) {
+          for (int i=colptr[j];i<colptr[j+1];i++) {
+            int line = rowind[i];
+            tran_rowind[tran_colptr[line] + tran_countvec[line]] = j;
+            tran_values[tran_colptr[line] + tran_countvec[line]] = values[i];
+            tran_countvec[line]++;
+          }
+        }
+
+        return valid;
     }
 
+    /// Factorize M. If singlePrecision is true, the numeric factors are computed and stored
+    /// in float (see solve_refined), unless the factorization fails in single precision.
     template<class VecInt,class VecReal>
-    void factorize(int n,int * M_colptr, int * M_rowind, Real * M_values, SparseLDLImplInvertData<VecInt,VecReal> * data) {
+    void factorize(int n,int * M_colptr, int * M_rowind, Real * M_values, SparseLDLImplInvertData<VecInt,VecReal> * data, bool singlePrecision = false) {
         data->new_factorization_needed = data->P_colptr.size() == 0 || data->P_rowind.size() == 0 || CSPARSE_need_symbolic_factorization(n, M_colptr, M_rowind, data->n,
                                                                                                                                          (int *) data->P_colptr.data(),(int *) data->P_rowind.data());
 
@@ -294,7 +422,6 @@ protected :
 
             data->perm.clear();data->perm.fastResize(data->n);
             data->invperm.clear();data->invperm.fastResize(data->n);
-            data->invD.clear();data->invD.fastResize(data->n);
             data->P_colptr.clear();data->P_colptr.fastResize(data->n+1);
             data->L_colptr.clear();data->L_colptr.fastResize(data->n+1);
             data->LT_colptr.clear();data->LT_colptr.fastResize(data->n+1);
@@ -316,52 +443,34 @@ protected :
             data->L_nnz = data->L_colptr[data->n];
 
             data->L_rowind.clear();data->L_rowind.fastResize(data->L_nnz);
-            data->L_values.clear();data->L_values.fastResize(data->L_nnz);
             data->LT_rowind.clear();data->LT_rowind.fastResize(data->L_nnz);
-            data->LT_values.clear();data->LT_values.fastResize(data->L_nnz);
         }
 
-        Real * D = data->invD.data();
-        int * rowind = data->L_rowind.data();
-        int * colptr = data->L_colptr.data();
-        Real * values = data->L_values.data();
-        int * tran_rowind = data->LT_rowind.data();
-        int * tran_colptr = data->LT_colptr.data();
-        Real * tran_values = data->LT_values.data();
-
-        //Numeric Factorization
-        LDL_numeric(data->n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,
-                    data->perm.data(),data->invperm.data(),data->Parent.data());
-
-        //inverse the diagonal
-        for (int i=0;i<data->n;i++) D[i] = 1.0/D[i];
-
-        // split the bloc diag in data->Bdiag
-
-        if (data->new_factorization_needed) {
-            //Compute transpose in tran_colptr, tran_rowind, tran_values, tran_D
-            tran_countvec.clear();
-            tran_countvec.resize(data->n);
-
-            //First we count the number of value on each row.
-            for (int j=0;j<data->L_nnz;j++) tran_countvec[rowind[j]]++;
+        if (singlePrecision) {
+            M_values_f.resize(data->P_nnz);
+            for (int i=0;i<data->P_nnz;i++) M_values_f[i] = (float) M_values[i];
 
-            //Now we make a scan to build tran_colptr
-            tran_colptr[0] = 0;
-            for (int j=0;j<data->n;j++) tran_colptr[j+1] = tran_colptr[j] + tran_countvec[j];
+            data->single_precision_factor = LDL_numeric_and_transpose(M_colptr,M_rowind,M_values_f.data(),data,
+                                                                      data->L_values_f,data->LT_values_f,data->invD_f,Y_f);
+            if (!data->single_precision_factor)
+                msg_warning() << "Single precision factorization failed, the matrix is factorized in double precision" ;
+        }
+        else {
+            data->single_precision_factor = false;
         }
 
-        //we clear tran_countvec becaus we use it now to stro hown many value are written on each line
-        tran_countvec.clear();
-        tran_countvec.resize(data->n);
+        // only the factors of the precision in use are kept in memory
+        if (data->single_precision_factor) {
+            VecReal().swap(data->L_values);
+            VecReal().swap(data->LT_values);
+            VecReal().swap(data->invD);
+        }
+        else {
+            LDL_numeric_and_transpose(M_colptr,M_rowind,M_values,data,data->L_values,data->LT_values,data->invD,Y);
 
-        for (int j=0;j<data->n;j++) {
-          for (int i=colptr[j];i<colptr[j+1];i++) {
-            int line = rowind[i];
-            tran_rowind[tran_colptr[line] + tran_countvec[line]] = j;
-            tran_values[tran_colptr[line] + tran_countvec[line]] = values[i];
-            tran_countvec[line]++;
-          }
+            helper::vector<float>().swap(data->L_values_f);
+            helper::vector<float>().swap(data->LT_values_f);
+            helper::vector<float>().swap(data->invD_f);
         }
     }
 
@@ -369,6 +478,9 @@ protected :
 protected : //the folowing variables are used during the factorization they canno be used in the main thread !
     helper::vector<int> xadj,adj,t_xadj,t_adj;
     helper::vector<Real> Y;
+    helper::vector<float> Y_f,M_values_f;
+    helper::vector<Real> R; // residual of the iterative refinement
+    helper::vector<float> Tmp_f,R_f,DX_f;
     helper::vector<int> Lnz,Flag,Pattern;
     helper::vector<int> tran_countvec;
 
@@ -30,11 +30,13 @@
 #include <SofaBaseTopology/TetrahedronSetTopologyContainer.h>
 #include <SofaBaseTopology/TetrahedronSetTopologyModifier.h>
 #include <sofa/helper/AdvancedTimer.h>
+#include <sofa/helper/IndexOpenMP.h>
 
 #include <sofa/core/topology/TopologyChange.h>
 
 #include <sofa/defaulttype/Vec.h>
 #include <map>
+#include <algorithm>
 #include <sofa/defaulttype/VecTypes.h>
 
 namespace sofa
@@ -135,9 +137,22 @@ void Tetra2TriangleTopologicalMapping::init()
     Loc2GlobVec.clear();
     Glob2LocMap.clear();
 
-    for (Topology::TriangleID triId=0; triId<triangleArray.size(); ++triId)
+    // flag the triangles on the border. The shells are created by the first access, before being read in parallel.
+    const size_t nbTriangles = triangleArray.size();
+    sofa::helper::vector<char> onBorder(nbTriangles, 0);
+    if (nbTriangles > 0 && fromModel->getNbTetrahedra() > 0)
     {
-        if (fromModel->getTetrahedraAroundTriangle(triId).size() == 1)
+        fromModel->getTetrahedraAroundTriangle(0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (helper::IndexOpenMP<unsigned int>::type triId=0; triId<nbTriangles; ++triId)
+            onBorder[triId] = (fromModel->getTetrahedraAroundTriangle(triId).size() == 1);
+    }
+
+    for (Topology::TriangleID triId=0; triId<nbTriangles; ++triId)
+    {
+        if (onBorder[triId])
         {
             const core::topology::BaseMeshTopology::Triangle& t = triangleArray[triId];
             if(flipN)
@@ -363,14 +378,34 @@ void Tetra2TriangleTopologicalMapping::updateTopologicalMappingTopDown()
             // For each tetrahedron removed inside the tetra2Remove array. Will look for each face if it shared with another tetrahedron.
             // If none, it means it will be added to the triangle border topoloy.
             // NB: doesn't check if triangle is inbetween 2 tetrahedra removed. This will be handle in TriangleRemoved event.
-            for (Topology::TetrahedronID i = 0; i < tetraIds2Remove.size(); ++i)
+            const size_t nbTetraRemoved = tetraIds2Remove.size();
+            if (nbTetraRemoved == 0)
+                break;
+
+            // first position of each removed tetrahedron in the list, to know if a neighbor has already been processed
+            sofa::helper::vector< std::pair<Topology::TetrahedronID, unsigned int> > removedOrder(nbTetraRemoved);
+            for (unsigned int i = 0; i < nbTetraRemoved; ++i)
+                removedOrder[i] = std::make_pair(tetraIds2Remove[i], i);
+            std::sort(removedOrder.begin(), removedOrder.end());
+
+            // the shells are created by the first access, before being read in parallel
+            fromModel->getTetrahedraAroundTriangle(fromModel->getTrianglesInTetrahedron(tetraIds2Remove[0])[0]);
+
+            // compute the new border triangle behind each face of the removed tetrahedra, in parallel
+            sofa::helper::vector< core::topology::BaseMeshTopology::Triangle > newTriangles(nbTetraRemoved * 4);
+            sofa::helper::vector< char > isNewTriangle(nbTetraRemoved * 4, 0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (helper::IndexOpenMP<unsigned int>::type i = 0; i < nbTetraRemoved; ++i)
             {
                 Topology::TetrahedronID tetraId = tetraIds2Remove[i];
                 const auto & triInTetra = fromModel->getTrianglesInTetrahedron(tetraId);
 
                 // get each triangle of the tetrahedron involved
-                for (auto triangleId : triInTetra)
+                for (unsigned int j = 0; j < 4; ++j)
                 {
+                    const Topology::TriangleID triangleId = triInTetra[j];
                     const auto & tetraATriangle = fromModel->getTetrahedraAroundTriangle(triangleId);
 
                     if (tetraATriangle.size() != 2) // means either more than 2 tetra sharing the triangle (so will not be on border) or only one, will be removed by TriangleRemoved later.
@@ -384,26 +419,19 @@ void Tetra2TriangleTopologicalMapping::updateTopologicalMappingTopDown()
                         idOtherTetra = tetraATriangle[0];
 
                     // check if tetrahedron already processed in a previous iteration
-                    bool is_present = false;
-                    for (unsigned int k=0; k<i; ++k)
-                        if (idOtherTetra == tetraIds2Remove[k])
-                        {
-                            is_present = true;
-                            break;
-                        }
-                    if (is_present) // already done, continue.
+                    auto other = std::lower_bound(removedOrder.begin(), removedOrder.end(), std::make_pair(idOtherTetra, 0u));
+                    if (other != removedOrder.end() && other->first == idOtherTetra && other->second < i) // already done, continue.
                         continue;
 
                     core::topology::BaseMeshTopology::Triangle tri;
                     const auto & otherTetra = tetrahedronArray[idOtherTetra];
                     const auto & triInOtherTetra = fromModel->getTrianglesInTetrahedron(idOtherTetra);
-
                     int posInTetra = fromModel->getTriangleIndexInTetrahedron(triInOtherTetra, triangleId);
 
-                    for (int i=0; i<3; i++)
+                    for (int k=0; k<3; k++)
                     {
-                        unsigned int vIdInTetra = trianglesOrientationInTetrahedronArray[posInTetra][i];
-                        tri[i] = otherTetra[vIdInTetra];
+                        unsigned int vIdInTetra = trianglesOrientationInTetrahedronArray[posInTetra][k];
+                        tri[k] = otherTetra[vIdInTetra];
                     }
 
                     if(flipN)
@@ -419,21 +447,30 @@ void Tetra2TriangleTopologicalMapping::updateTopologicalMappingTopDown()
                         int val=tri[0]; tri[0]=tri[1]; tri[1]=tri[2]; tri[2]=val;
                     }
 
-                    // Add triangle to creation buffers
-                    triangles_to_create.push_back(tri);
-                    trianglesIndexList.push_back(nb_elems);
-                    nb_elems+=1;
+                    newTriangles[i*4+j] = tri;
+                    isNewTriangle[i*4+j] = 1;
+                }
+            }
+
+            // Add triangles to creation buffers and update topology maps, in the order of the removed tetrahedra
+            for (size_t slot = 0; slot < newTriangles.size(); ++slot)
+            {
+                if (!isNewTriangle[slot])
+                    continue;
 
-                    // update topology maps
-                    Loc2GlobVec.push_back(triangleId);
+                const Topology::TriangleID triangleId = fromModel->getTrianglesInTetrahedron(tetraIds2Remove[slot/4])[slot%4];
+                triangles_to_create.push_back(newTriangles[slot]);
+                trianglesIndexList.push_back(nb_elems);
+                nb_elems+=1;
 
-                    // check if already exist
-                    auto iter_1 = Glob2LocMap.find(triangleId);
-                    if(iter_1 != Glob2LocMap.end() )
-                        Glob2LocMap.erase(iter_1);
+                Loc2GlobVec.push_back(triangleId);
 
-                    Glob2LocMap[triangleId] = (unsigned int)Loc2GlobVec.size()-1;
-                }
+                // check if already exist
+                auto iter_1 = Glob2LocMap.find(triangleId);
+                if(iter_1 != Glob2LocMap.end() )
+                    Glob2LocMap.erase(iter_1);
+
+                Glob2LocMap[triangleId] = (unsigned int)Loc2GlobVec.size()-1;
             }
 
             m_outTopoModifier->addTriangles(triangles_to_create);